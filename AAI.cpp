@@ -9,7 +9,8 @@
 
 #include <math.h>
 #include <stdarg.h>
-#include <time.h>
+#include <algorithm>
+#include <chrono>
 
 #include "AAI.h"
 #include "AAIMap.h"
@@ -26,6 +27,15 @@
 #include "AAIGroup.h"
 #include "AAISector.h"
 #include "AAIUnitTypes.h"
+#include "AAITaskScheduler.h"
+#include "AAIFrameTimeGovernor.h"
+#include "AAIIncrementalPlanner.h"
+#include "AAIMemoryUsage.h"
+#include "AAIPerformanceMonitor.h"
+#include "AAITrace.h"
+#include "AAIUnitQueryCache.h"
+#include "AAIDamageEventAccumulator.h"
+#include "AAIEnemySightings.h"
 
 #include "System/SafeUtil.h"
 
@@ -35,7 +45,7 @@ using namespace springLegacyAI;
 
 
 #include "CUtils/SimpleProfiler.h"
-#define AAI_SCOPED_TIMER(part) SCOPED_TIMER(part, profiler);
+#define AAI_SCOPED_TIMER(part) SCOPED_TIMER(part, profiler); AAIScopedPerformanceTimer aaiPerformanceTimerFromMacro(part, m_performanceMonitor); AAI_TRACE_SCOPE(part)
 
 // C++ < C++17 does not support initialization of static const within class declaration
 const std::vector<int> GamePhase::m_startFrameOfGamePhase  = {0, 10800, 27000, 72000};
@@ -50,7 +60,13 @@ constexpr std::array<ETargetType, 5>         AAITargetType::m_targetTypes;
 
 AAIBuildTree AAI::s_buildTree;
 
-int AAI::s_aaiInstances = 0;
+AAIPlanningWorker AAI::s_planningWorker;
+
+AAIThreadPool AAI::s_threadPool;
+
+std::atomic<int> AAI::s_aaiInstances(0);
+
+std::mutex AAI::s_sharedDataMutex;
 
 AAI::AAI(int skirmishAIId, const struct SSkirmishAICallback* callback) :
 	m_aiCallback(nullptr),
@@ -63,23 +79,57 @@ AAI::AAI(int skirmishAIId, const struct SSkirmishAICallback* callback) :
 	m_buildTable(nullptr),
 	m_airForceManager(nullptr),
 	m_attackManager(nullptr),
+	m_damageEventAccumulator(nullptr),
+	m_enemySightings(nullptr),
+	m_taskScheduler(nullptr),
+	m_frameTimeGovernor(nullptr),
+	m_incrementalPlanners(nullptr),
 	profiler(nullptr),
+	m_performanceMonitor(nullptr),
+	m_unitQueryCache(nullptr),
 	m_side(0),
-	m_logFile(nullptr),
+	m_logger(nullptr),
 	m_initialized(false),
 	m_configLoaded(false),
 	m_aaiInstance(0),
 	m_gamePhase(0)
 {
-	// initialize random numbers generator
-	srand (time(nullptr));
 }
 
 AAI::~AAI()
 {
+	std::lock_guard<std::mutex> lock(s_sharedDataMutex);
+
 	--s_aaiInstances;
+
+	// discard pending planning tasks as they may refer to data of this instance
+	s_planningWorker.RemoveTasks(this);
+
+	if(s_aaiInstances == 0)
+	{
+		s_planningWorker.Stop();
+		s_threadPool.Stop();
+
+		// write execution trace after all threads have stopped recording
+		if(AAITrace::IsEnabled() && m_aiCallback)
+		{
+			AAITrace::Enable(false);
+
+			char traceFilename[2048];
+			SNPRINTF(traceFilename, 2048, "%sAAI_trace.json", AILOG_PATH);
+			m_aiCallback->GetValue(AIVAL_LOCATE_FILE_W, traceFilename);
+			AAITrace::WriteToFile(traceFilename);
+		}
+	}
+
 	if (m_initialized == false)
+	{
+		// profiler and performance monitor are created before the config is loaded
+		spring::SafeDelete(profiler);
+		spring::SafeDelete(m_performanceMonitor);
+		spring::SafeDelete(m_logger);
 		return;
+	}
 
 	// save several AI data
 	Log("\nShutting down....\n\n");
@@ -109,6 +159,17 @@ AAI::~AAI()
 
 	Log("Unit production rate: %i\n\n", m_execute->GetUnitProductionRate());
 
+	m_taskScheduler->LogStatistics();
+
+	Log("Frame time governor: cadence factor %.2f after %i adjustments\n", m_frameTimeGovernor->GetCadenceFactor(), m_frameTimeGovernor->GetNumberOfAdjustments());
+
+	Log("Incremental planners: %i finished in %i steps, %i dropped, %i pending\n", m_incrementalPlanners->GetNumberOfFinishedPlanners(), m_incrementalPlanners->GetNumberOfSteps(), m_incrementalPlanners->GetNumberOfDroppedPlanners(), m_incrementalPlanners->GetNumberOfPendingPlanners());
+
+	m_execute->LogOrderStatistics();
+
+	if(m_unitQueryCache)
+		m_unitQueryCache->LogStatistics(this);
+
 	Log("Active/under construction/requested constructors:\n");
 	for(const auto factory : s_buildTree.GetUnitsInCategory(EUnitCategory::STATIC_CONSTRUCTOR, m_side))
 	{
@@ -142,7 +203,12 @@ AAI::~AAI()
 	if(GetAAIInstance() == 1)
 		m_buildTable->SaveModLearnData(gamePhase, m_brain->GetAttackedByRates(), m_map->GetMapType());
 
+	spring::SafeDelete(m_taskScheduler);
+	spring::SafeDelete(m_frameTimeGovernor);
+	spring::SafeDelete(m_incrementalPlanners);
 	spring::SafeDelete(m_attackManager);
+	spring::SafeDelete(m_damageEventAccumulator);
+	spring::SafeDelete(m_enemySightings);
 	spring::SafeDelete(m_airForceManager);
 
 	// delete unit groups
@@ -161,9 +227,20 @@ AAI::~AAI()
 	spring::SafeDelete(m_buildTable);
 	spring::SafeDelete(profiler);
 
+	if(m_performanceMonitor)
+		m_performanceMonitor->WriteToFile();
+	spring::SafeDelete(m_performanceMonitor);
+
+	if(m_unitQueryCache)
+	{
+		m_aiCallback = m_unitQueryCache->GetEngineCallback();
+		spring::SafeDelete(m_unitQueryCache);
+	}
+
 	m_initialized = false;
-	fclose(m_logFile);
-	m_logFile = nullptr;
+
+	Log("\nDropped log messages: %i\n", m_logger->GetNumberOfDroppedMessages());
+	spring::SafeDelete(m_logger);
 
 	// last instance of AAI shall clean up config
 	if(s_aaiInstances == 0)
@@ -176,10 +253,18 @@ AAI::~AAI()
 
 void AAI::InitAI(IGlobalAICallback* callback, int team)
 {
+	std::lock_guard<std::mutex> lock(s_sharedDataMutex);
+
 	char profilerName[16];
 	SNPRINTF(profilerName, sizeof(profilerName), "%s:%i", "AAI", team);
 	profiler = new Profiler(profilerName);
 
+	// performance statistics are written next to the log file
+	char performanceFilename[2048];
+	SNPRINTF(performanceFilename, 2048, "%sAAI_perf_team_%d.json", AILOG_PATH, team);
+	callback->GetAICallback()->GetValue(AIVAL_LOCATE_FILE_W, performanceFilename);
+	m_performanceMonitor = new AAIPerformanceMonitor(performanceFilename);
+
 	AAI_SCOPED_TIMER("InitAI")
 	m_aiCallback = callback->GetAICallback();
 
@@ -192,14 +277,15 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 
 	m_aiCallback->GetValue(AIVAL_LOCATE_FILE_W, filename);
 
-	m_logFile = fopen(filename,"w");
+	m_logger = new AAILogger(filename);
 
 	Log("AAI %s running game %s\n \n", AAI_VERSION, m_aiCallback->GetModHumanName());
 
-	++s_aaiInstances;
-	m_aaiInstance = s_aaiInstances; //! @todo This might not be 100% thread safe (if multiple instances off AAI are initialized by several threads at the same time)
+	m_aaiInstance = ++s_aaiInstances;
 	Log("AAI instance: %i\n", m_aaiInstance); 
 
+	s_planningWorker.Start();
+
 	// init config (if not already done by other instance of AAI) and load from file
 	AAIConfig::Init();
 	cfg = AAIConfig::GetConfig();
@@ -209,6 +295,18 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 
 	m_configLoaded = gameConfigLoaded && generalConfigLoaded;
 
+	// set levels of logged messages as configured in general config
+	for(int category = 0; category < static_cast<int>(ELogCategory::NUMBER_OF_CATEGORIES); ++category)
+	{
+		const int level = (cfg->LOG_CATEGORY_LEVELS[category] >= 0) ? cfg->LOG_CATEGORY_LEVELS[category] : cfg->LOG_LEVEL;
+		m_logger->SetLevel(static_cast<ELogCategory>(category), static_cast<ELogLevel>(level));
+	}
+
+	// seed random number generator (seed from general config allows to reproduce the decisions of a previous game)
+	const int randomSeed = (cfg->RANDOM_SEED != 0) ? cfg->RANDOM_SEED : std::max(static_cast<int>(std::chrono::steady_clock::now().time_since_epoch().count() & 0x7fffffff), 1);
+	m_random.SetSeed(static_cast<uint32_t>(randomSeed) + static_cast<uint32_t>(m_myTeamId));
+	Log("Random seed: %i\n", randomSeed);
+
 	if (m_configLoaded == false)
 	{
 		std::string errorMsg =
@@ -219,6 +317,16 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 		return;
 	}
 
+	// start worker threads (if not already done by other instance)
+	s_threadPool.Start(cfg->MAX_WORKER_THREADS);
+
+	if(cfg->TRACE_EXECUTION)
+		AAITrace::Enable(true);
+
+	// from here on, all calls to the engine callback pass the unit query cache (which also counts/times them if profiling is enabled)
+	m_unitQueryCache = new AAIUnitQueryCache(m_aiCallback, cfg->MAX_UNITS, cfg->PROFILE_CALLBACKS);
+	m_aiCallback     = m_unitQueryCache;
+
 	// generate buildtree (if not already done by other instance)
 	s_buildTree.Generate(m_aiCallback);
 
@@ -254,77 +362,36 @@ void AAI::InitAI(IGlobalAICallback* callback, int team)
 	// init attack manager
 	m_attackManager = new AAIAttackManager(this);
 
-	Log("Tidal/Wind strength: %f / %f\n", m_aiCallback->GetTidalStrength(), (m_aiCallback->GetMaxWind() + m_aiCallback->GetMinWind()) * 0.5f);
-
-	LogConsole("AAI loaded");
-}
-
-void AAI::UnitDamaged(int damaged, int attacker, float /*damage*/, float3 /*dir*/)
-{
-	AAI_SCOPED_TIMER("UnitDamaged")
-
-	const springLegacyAI::UnitDef* attackedDef = m_aiCallback->GetUnitDef(damaged);
-	if(attackedDef == nullptr)
-		return;
-		
-	const UnitDefId unitDefId(attackedDef->id);
-	const AAIUnitCategory& category = s_buildTree.GetUnitCategory(unitDefId);
-
-	if(category.IsCommander())
-		m_brain->DefendCommander(attacker);
+	// init damage event processing
+	m_damageEventAccumulator = new AAIDamageEventAccumulator(this);
 
-	const springLegacyAI::UnitDef* attackerDef = m_aiCallback->GetUnitDef(attacker);
+	// init tracking of enemy units within LOS/radar
+	m_enemySightings = new AAIEnemySightings(this, cfg->MAX_UNITS);
 
-	if(attackerDef == nullptr)
-	{
-		// ------------------------------------------------------------------------------------------------------------
-		// unknown attacker
-		// ------------------------------------------------------------------------------------------------------------
+	// init task scheduler
+	m_taskScheduler = new AAITaskScheduler(this, AAIConstants::scheduledTasksFrameBudget);
+	InitTaskScheduler();
 
-		// retreat builders
-		if (category.IsMobileConstructor() && m_unitTable->units[damaged].cons)
-			m_unitTable->units[damaged].cons->CheckRetreatFromAttackBy(EUnitCategory::UNKNOWN);	
-	}
-	else 
-	{
-		// ------------------------------------------------------------------------------------------------------------
-		// known attacker
-		// ------------------------------------------------------------------------------------------------------------
+	// init adaption of the cadence of non-critical tasks to the time spent per frame
+	m_frameTimeGovernor = new AAIFrameTimeGovernor(cfg->FRAME_TIME_BUDGET, cfg->MIN_CADENCE_FACTOR, cfg->MAX_CADENCE_FACTOR);
 
-		// filter out friendly fire
-		if (m_aiCallback->GetUnitAllyTeam(attacker) == m_aiCallback->GetMyAllyTeam())
-			return;
+	// init execution of expensive decisions spread over several frames
+	m_incrementalPlanners = new AAIIncrementalPlanners(this, AAIConstants::plannerFrameBudget);
 
-		const UnitId    unit(damaged);
-		const UnitDefId enemyDefId(attackerDef->id);
+	Log("Tidal/Wind strength: %f / %f\n", m_aiCallback->GetTidalStrength(), (m_aiCallback->GetMaxWind() + m_aiCallback->GetMinWind()) * 0.5f);
 
-		if (category.IsCombatUnit())
-			m_execute->CheckKeepDistanceToEnemy(unit, unitDefId, enemyDefId);
+	LogMemoryUsage();
 
-		const AAITargetType&  enemyTargetType = s_buildTree.GetTargetType(enemyDefId);
-		const float3          pos = m_aiCallback->GetUnitPos(attacker);
-		
-		// building has been attacked
-		if (category.IsBuilding() )
-			m_execute->DefendUnitVS(unit, enemyTargetType, pos, 115);
-		// builder
-		else if ( category.IsMobileConstructor() )
-		{
-			const AAIUnitCategory&  enemyCategory = s_buildTree.GetUnitCategory(enemyDefId);
+	LogConsole("AAI loaded");
+}
 
-			m_execute->DefendUnitVS(unit, enemyTargetType, pos, 110);
+void AAI::UnitDamaged(int damaged, int attacker, float /*damage*/, float3 /*dir*/)
+{
+	AAI_SCOPED_TIMER("UnitDamaged")
 
-			if(m_unitTable->units[damaged].cons)
-				m_unitTable->units[damaged].cons->CheckRetreatFromAttackBy(enemyCategory);
-		}
-		// normal units
-		else
-		{
-			if(enemyTargetType.IsAir() && (s_buildTree.GetUnitType(unitDefId).CanFightTargetType(enemyTargetType) == false) ) 
-				m_execute->DefendUnitVS(unit, enemyTargetType, pos, 105);
-		}	
-		
-	}
+	// reaction to damage is determined once per frame for all events (see AAI::Update())
+	if(m_damageEventAccumulator)
+		m_damageEventAccumulator->AddEvent(UnitId(damaged), UnitId(attacker));
 }
 
 void AAI::UnitCreated(int unit, int builder)
@@ -333,6 +400,9 @@ void AAI::UnitCreated(int unit, int builder)
 	if (m_configLoaded == false)
 		return;
 
+	// unit id may have been used by a unit destroyed earlier in this frame
+	m_unitQueryCache->InvalidateUnit(unit);
+
 	// get unit's id
 	const springLegacyAI::UnitDef* def = m_aiCallback->GetUnitDef(unit);
 	UnitDefId unitDefId(def->id);
@@ -425,6 +495,8 @@ void AAI::UnitFinished(int unit)
 	if (m_initialized == false)
         return;
 
+	m_unitQueryCache->InvalidateUnit(unit);
+
 	// get unit's id
 	const springLegacyAI::UnitDef* def = m_aiCallback->GetUnitDef(unit);
 	UnitDefId unitDefId(def->id);
@@ -537,6 +609,13 @@ void AAI::UnitFinished(int unit)
 void AAI::UnitDestroyed(int unit, int attacker)
 {
 	AAI_SCOPED_TIMER("UnitDestroyed")
+	if(m_unitQueryCache)
+		m_unitQueryCache->InvalidateUnit(unit);
+
+	// orders that have not been passed to the engine yet are obsolete
+	if(m_execute)
+		m_execute->DiscardStagedOrders(UnitId(unit));
+
 	// get unit's id
 	const springLegacyAI::UnitDef* def = m_aiCallback->GetUnitDef(unit);
 	UnitDefId unitDefId(def->id);
@@ -695,6 +774,8 @@ void AAI::UnitDestroyed(int unit, int attacker)
 					m_unitTable->units[unit].group->GetNewRallyPoint();
 
 				m_unitTable->units[unit].group->RemoveUnit(UnitId(unit), UnitId(attacker) );
+
+				m_brain->RemoveDefenceCapabilities(unitDefId);
 			}
 			// builder (incl. commander)
 			else if (s_buildTree.GetUnitType(unitDefId).IsBuilder())
@@ -747,8 +828,8 @@ void AAI::UnitMoveFailed(int unit)
 
 	float3 pos = m_aiCallback->GetUnitPos(unit);
 
-	pos.x = pos.x - 64 + 32 * (rand()%5);
-	pos.z = pos.z - 64 + 32 * (rand()%5);
+	pos.x = pos.x - 64 + 32 * m_random.GetInteger(5);
+	pos.z = pos.z - 64 + 32 * m_random.GetInteger(5);
 
 	if (pos.x < 0)
 		pos.x = 0;
@@ -760,20 +841,68 @@ void AAI::UnitMoveFailed(int unit)
 	if (m_aiCallback->GetCurrentFrame() - m_unitTable->units[unit].last_order < 5)
 		return;
 	else
-		m_execute->MoveUnitTo(unit, &pos);
+		m_execute->MoveUnitTo(unit, &pos, EOrderPriority::NORMAL);
 }
 
-void AAI::EnemyEnterLOS(int /*enemy*/) {}
-void AAI::EnemyLeaveLOS(int /*enemy*/) {}
-void AAI::EnemyEnterRadar(int /*enemy*/) {}
-void AAI::EnemyLeaveRadar(int /*enemy*/) {}
+void AAI::EnemyEnterLOS(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyEnterLOS")
+	// unit definition of enemy units is only available within LOS
+	if(m_unitQueryCache)
+		m_unitQueryCache->InvalidateUnit(enemy);
+
+	if(m_initialized)
+		m_enemySightings->EnemyEnteredLOS(UnitId(enemy));
+}
+
+void AAI::EnemyLeaveLOS(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyLeaveLOS")
+	// unit definition of enemy units is only available within LOS
+	if(m_unitQueryCache)
+		m_unitQueryCache->InvalidateUnit(enemy);
+
+	if(m_initialized)
+		m_enemySightings->EnemyLeftLOS(UnitId(enemy));
+}
+
+void AAI::EnemyEnterRadar(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyEnterRadar")
+	// unit definition of enemy units is only available within LOS
+	if(m_unitQueryCache)
+		m_unitQueryCache->InvalidateUnit(enemy);
+
+	if(m_initialized)
+		m_enemySightings->EnemyEnteredRadar(UnitId(enemy));
+}
+
+void AAI::EnemyLeaveRadar(int enemy)
+{
+	AAI_SCOPED_TIMER("EnemyLeaveRadar")
+	// unit definition of enemy units is only available within LOS
+	if(m_unitQueryCache)
+		m_unitQueryCache->InvalidateUnit(enemy);
+
+	if(m_initialized)
+		m_enemySightings->EnemyLeftRadar(UnitId(enemy));
+}
 
 void AAI::EnemyDestroyed(int enemy, int attacker)
 {
 	AAI_SCOPED_TIMER("EnemyDestroyed")
+	if(m_unitQueryCache)
+		m_unitQueryCache->InvalidateUnit(enemy);
+
+	if(m_initialized == false)
+		return;
+
 	// remove enemy from unittable
 	if(UnitId(enemy).IsValid())
+	{
 		m_unitTable->EnemyKilled(enemy);
+		m_enemySightings->EnemyDestroyed(UnitId(enemy));
+	}
 
 	if(UnitId(attacker).IsValid())
 	{
@@ -788,6 +917,8 @@ void AAI::EnemyDestroyed(int enemy, int attacker)
 
 void AAI::Update()
 {
+	AAI_TRACE_SCOPE("Update")
+
 	const int tick = m_aiCallback->GetCurrentFrame();
 
 	if (tick < 0)
@@ -795,6 +926,13 @@ void AAI::Update()
 		return;
 	}
 
+	// events are reported by the engine after the update of the frame, thus frame starts with update
+	if(m_performanceMonitor)
+		m_performanceMonitor->StartFrame(tick);
+
+	if(m_unitQueryCache)
+		m_unitQueryCache->StartFrame();
+
 	GamePhase gamePhase(tick);
 
 	if(gamePhase > m_gamePhase)
@@ -813,137 +951,179 @@ void AAI::Update()
 		return;
 	}
 
-	// scouting
-	if (!((tick + 2 * GetAAIInstance()) % 45))
+	// react to units having been damaged since last update
 	{
-		AAI_SCOPED_TIMER("Scouting_1")
-		m_map->CheckUnitsInLOSUpdate();
+		AAI_SCOPED_TIMER("Process-Damage-Events")
+		m_damageEventAccumulator->ProcessEvents();
 	}
 
-	// update groups
-	if (!((tick+7) % 150))
+	// execute orders resulting from planning tasks finished since last update
 	{
-		AAI_SCOPED_TIMER("Groups")
-		for (const auto& category : s_buildTree.GetCombatUnitCatgegories())
-		{
-			for (auto group : GetUnitGroupsList(category))
-			{
-				group->Update();
-			}
-		}
+		AAI_SCOPED_TIMER("Commit-Planning-Tasks")
+		s_planningWorker.CommitFinishedTasks(this);
+	}
 
-		return;
+	// stretch/tighten the periods of non-critical tasks according to the time spent in the previous frames
+	if(m_frameTimeGovernor->AddFrameTime(m_performanceMonitor->GetLastFrameTime()))
+	{
+		Log(ELogCategory::GENERAL, ELogLevel::INFO, "Frame %i: average time per frame %i us (budget %i us) - cadence factor of non-critical tasks %.2f -> %.2f\n",
+		    tick, m_frameTimeGovernor->GetAverageFrameTime(), m_frameTimeGovernor->GetFrameTimeBudget(), m_taskScheduler->GetCadenceFactor(), m_frameTimeGovernor->GetCadenceFactor());
+		m_taskScheduler->SetCadenceFactor(m_frameTimeGovernor->GetCadenceFactor());
+	}
+
+	m_taskScheduler->Update(tick, profiler, m_performanceMonitor);
+
+	// continue expensive decisions (e.g. base expansion, placement of static defences) spread over several frames
+	{
+		AAI_SCOPED_TIMER("Incremental-Planners")
+		m_incrementalPlanners->Update();
 	}
 
-	// unit management
-	if (!(tick % 650))
+	// pass orders given since last update to the engine
 	{
-		AAI_SCOPED_TIMER("Unit-Management")
+		AAI_SCOPED_TIMER("Issue-Orders")
+		m_execute->IssueStagedOrders();
+	}
+}
+
+void AAI::InitTaskScheduler()
+{
+	// tasks are listed with period, first frame (to spread tasks with similar periods), priority, and expected execution time (microseconds);
+	// the periods of non-critical tasks (marked adaptive) are stretched if AAI exceeds its time budget per frame (see AAIFrameTimeGovernor)
+	const int scoutingOffset = (45 - (2 * GetAAIInstance()) % 45) % 45;
+
+	m_taskScheduler->AddTask("Update-Income", [this]() {
+		m_brain->UpdateResources(m_aiCallback);
+	}, 30, 0, 10, 50);
+
+	m_taskScheduler->AddTask("Scouting_1", [this]() {
+		m_map->CheckUnitsInLOSUpdate();
+	}, 45, scoutingOffset, 9, 300, true);
+
+	m_taskScheduler->AddTask("Update-Sector-Slice", [this]() {
+		m_map->UpdateSectorSlice();
+	}, AAIConstants::sectorSliceUpdateInterval, 2, 9, 150, true);
+
+	m_taskScheduler->AddTask("Building-Management", [this]() {
+		m_execute->CheckConstruction();
+	}, 97, 0, 8, 500);
+
+	m_taskScheduler->AddTask("Unit-Management", [this]() {
 		m_execute->CheckBuildqueues();
 		m_brain->BuildUnits();
 		m_execute->BuildScouts();
-	}
+	}, 650, 0, 7, 1500);
 
-	if (!((tick+39) % 500))
-	{
-		AAI_SCOPED_TIMER("Check-Attack")
-		// check attack
+	m_taskScheduler->AddTask("Groups", [this]() {
+		for (const auto& category : s_buildTree.GetCombatUnitCatgegories())
+		{
+			for (auto group : GetUnitGroupsList(category))
+				group->Update();
+		}
+	}, 150, 143, 6, 300);
+
+	m_taskScheduler->AddTask("Check-Attack", [this]() {
 		m_attackManager->Update();
 		m_airForceManager->BombBestTarget(2.0f);
-		return;
-	}
+	}, 500, 461, 6, 1000);
 
-	// ressource management
-	if (!(tick % 200))
-	{
-		AAI_SCOPED_TIMER("Resource-Management")
+	m_taskScheduler->AddTask("Resource-Management", [this]() {
 		m_execute->CheckRessources();
-	}
+	}, 200, 0, 5, 1000);
 
-	// update sectors
-	if (!((tick+15) % 120))
-	{
-		AAI_SCOPED_TIMER("Update-Sectors")
+	m_taskScheduler->AddTask("Update-Sectors", [this]() {
 		m_brain->UpdateAttackedByValues();
 		m_map->UpdateSectors();
 		m_brain->UpdatePressureByEnemy();
-	}
-
-	// builder management
-	if (!(tick % 917))
-	{
-		AAI_SCOPED_TIMER("Builder-Management")
-		m_brain->UpdateDefenceCapabilities();
-	}
-
-	// update income
-	if (!(tick % 30))
-	{
-		AAI_SCOPED_TIMER("Update-Income")
-		m_brain->UpdateResources(m_aiCallback);
-	}
+	}, 120, 105, 5, 1500, true);
 
-	// building management
-	if (!(tick % 97))
-	{
-		AAI_SCOPED_TIMER("Building-Management")
-		m_execute->CheckConstruction();
-	}
+	m_taskScheduler->AddTask("Check-Factories", [this]() {
+		m_execute->CheckFactories();
+	}, 337, 0, 4, 500);
 
-	// builder/factory management
-	if (!(tick % 677))
-	{
-		AAI_SCOPED_TIMER("BuilderAndFactory-Management")
+	m_taskScheduler->AddTask("BuilderAndFactory-Management", [this]() {
 		m_unitTable->UpdateConstructors();
 		m_execute->CheckConstructionOfNanoTurret();
-	}
-
-	if (!(tick % 337))
-	{
-		AAI_SCOPED_TIMER("Check-Factories")
-		m_execute->CheckFactories();
-	}
+	}, 677, 0, 4, 500);
 
-	if (!(tick % 1079))
-	{
-		AAI_SCOPED_TIMER("Check-Defenses")
+	m_taskScheduler->AddTask("Check-Defenses", [this]() {
 		m_execute->CheckDefences();
-	}
+	}, 1079, 0, 3, 1500);
 
-	// build radar/jammer
-	if (!((tick+77) % 1200))
-	{
+	m_taskScheduler->AddTask("Check Upgrades", [this]() {
+		m_execute->CheckExtractorUpgrade();
+		m_execute->CheckRadarUpgrade();
+		//execute->CheckJammerUpgrade();
+	}, 300, 289, 2, 500, true);
+
+	m_taskScheduler->AddTask("Check-Recon", [this]() {
 		m_execute->CheckRecon();
 		//execute->CheckJammer();
 		m_execute->CheckStationaryArty();
 		//execute->CheckAirBase();
-	}
-
-	// upgrade mexes
-	if (!((tick+11) % 300))
-	{
-		AAI_SCOPED_TIMER("Check Upgrades")
-		m_execute->CheckExtractorUpgrade();
-		m_execute->CheckRadarUpgrade();
-		//execute->CheckJammerUpgrade();
-	}
+	}, 1200, 1123, 2, 500, true);
 
-	// recheck rally points
-	if (!(tick % 1877))
-	{
-		AAI_SCOPED_TIMER("Recheck-Rally-Points")
-		for (auto category = s_buildTree.GetCombatUnitCatgegories().begin();  category != s_buildTree.GetCombatUnitCatgegories().end(); ++category)
+	m_taskScheduler->AddTask("Recheck-Rally-Points", [this]() {
+		for (const auto& category : s_buildTree.GetCombatUnitCatgegories())
 		{
-			for (auto group = GetUnitGroupsList(*category).begin(); group != GetUnitGroupsList(*category).end(); ++group)
-			{
-				(*group)->UpdateRallyPoint();
-			}
+			for (auto group : GetUnitGroupsList(category))
+				group->UpdateRallyPoint();
 		}
+	}, 1877, 0, 1, 500, true);
+
+	m_taskScheduler->AddTask("Memory-Report", [this]() {
+		LogMemoryUsage();
+	}, AAIConstants::memoryReportInterval, AAIConstants::memoryReportInterval, 0, 100, true);
+
+#ifndef NDEBUG
+	// check incrementally updated combat power of own units
+	m_taskScheduler->AddTask("Check-Defence-Capabilities", [this]() {
+		m_brain->CheckDefenceCapabilities();
+	}, 917, 0, 0, 200);
+#endif
+}
+
+void AAI::DetermineMemoryUsage(AAIMemoryReport& report) const
+{
+	size_t unitGroupsMemory = GetAllocatedMemory(m_unitGroupsOfCategoryLists);
+
+	for(const auto& groupList : m_unitGroupsOfCategoryLists)
+	{
+		for(const auto group : groupList)
+			unitGroupsMemory += sizeof(AAIGroup) + group->GetMemoryUsage();
 	}
+
+	report.Add("Map",                m_map->GetMemoryUsage());
+	report.Add("Unit table",         m_unitTable->GetMemoryUsage());
+	report.Add("Build table",        m_buildTable->GetMemoryUsage());
+	report.Add("Execute",            m_execute->GetMemoryUsage());
+	report.Add("Brain",              m_brain->GetMemoryUsage());
+	report.Add("Unit groups",        unitGroupsMemory);
+	report.Add("Air force manager",  m_airForceManager->GetMemoryUsage());
+	report.Add("Attack manager",     m_attackManager->GetMemoryUsage());
+	report.Add("Enemy sightings",    m_enemySightings->GetMemoryUsage());
+	report.Add("Build tasks",        GetAllocatedMemory(build_tasks) + build_tasks.size() * sizeof(AAIBuildTask));
+	report.Add("Map (shared)",       AAIMap::GetSharedMemoryUsage(), true);
+	report.Add("Build tree (shared)", s_buildTree.GetMemoryUsage(), true);
+}
+
+void AAI::LogMemoryUsage()
+{
+	AAIMemoryReport report;
+	DetermineMemoryUsage(report);
+
+	Log("Memory usage in frame %i: %.1f kB (this instance) + %.1f kB (shared by all AAI instances)\n", m_aiCallback->GetCurrentFrame(),
+	    static_cast<float>(report.GetTotalMemory(false)) / 1024.0f, static_cast<float>(report.GetTotalMemory(true)) / 1024.0f);
+
+	for(const auto& entry : report.GetEntries())
+		Log("  %-20s %10.1f kB\n", entry.subsystem, static_cast<float>(entry.bytes) / 1024.0f);
 }
 
 const int* AAI::GetLosMap()
 {
+	AAI_TRACE_SCOPE("SSkirmishAICallback::Map_getLosMap")
+	AAICallbackProxy::ScopedCall callTimer(m_unitQueryCache, ECallbackFunction::GET_LOS_MAP);
+
 	if (m_losMap.empty()) {
 		m_losMap.resize(m_skirmishAICallbacks->Map_getLosMap(m_skirmishAIId, nullptr, 0));
 	}
@@ -973,6 +1153,9 @@ int AAI::HandleEvent(int msg, const void* data)
 			{
 				const IGlobalAI::ChangeTeamEvent* cte = (const IGlobalAI::ChangeTeamEvent*) data;
 
+				if(m_unitQueryCache)
+					m_unitQueryCache->InvalidateUnit(cte->unit);
+
 				const int myAllyTeamId = m_aiCallback->GetMyAllyTeam();
 				const bool oldEnemy = !m_aiCallback->IsAllied(myAllyTeamId, m_aiCallback->GetTeamAllyTeam(cte->oldteam));
 				const bool newEnemy = !m_aiCallback->IsAllied(myAllyTeamId, m_aiCallback->GetTeamAllyTeam(cte->newteam));
@@ -985,6 +1168,10 @@ int AAI::HandleEvent(int msg, const void* data)
 					// unit changed from an ally to an enemy team
 					// we lost a friend! :(
 					EnemyCreated(cte->unit);
+
+					// unit will not enter LOS as it has been visible before
+					if(m_initialized)
+						m_enemySightings->EnemyEnteredLOS(UnitId(cte->unit));
 					if (!m_aiCallback->UnitBeingBuilt(cte->unit)) {
 						EnemyFinished(cte->unit);
 					}
@@ -1009,14 +1196,22 @@ int AAI::HandleEvent(int msg, const void* data)
 
 void AAI::Log(const char* format, ...)
 {
-	if(m_logFile != NULL)
+	if(m_logger)
 	{
 		va_list args;
 		va_start(args, format);
-		const int bytes = vfprintf(m_logFile, format, args);
-		if (bytes<0) { //write to stderr if write to file failed
-			vfprintf(stderr, format, args);
-		}
+		m_logger->Write(ELogCategory::GENERAL, ELogLevel::INFO, format, args);
+		va_end(args);
+	}
+}
+
+void AAI::Log(ELogCategory category, ELogLevel level, const char* format, ...)
+{
+	if(m_logger && m_logger->IsEnabled(category, level))
+	{
+		va_list args;
+		va_start(args, format);
+		m_logger->Write(category, level, format, args);
 		va_end(args);
 	}
 }
@@ -12,12 +12,18 @@
 
 #include <list>
 #include <vector>
+#include <atomic>
+#include <mutex>
 
 #include "ExternalAI/Interface/SSkirmishAICallback.h"
 #include "LegacyCpp/IGlobalAI.h"
 
 #include "aidef.h"
 #include "AAIBuildTree.h"
+#include "AAIPlanningWorker.h"
+#include "AAIThreadPool.h"
+#include "AAILogger.h"
+#include "AAIRandom.h"
 
 namespace springLegacyAI {
 	class IAICallback;
@@ -35,6 +41,14 @@ class AAIBuildTable;
 class AAIUnitTable;
 class AAIMap;
 class AAIGroup;
+class AAITaskScheduler;
+class AAIFrameTimeGovernor;
+class AAIIncrementalPlanners;
+class AAIPerformanceMonitor;
+class AAIUnitQueryCache;
+class AAIDamageEventAccumulator;
+class AAIEnemySightings;
+class AAIMemoryReport;
 
 class AAI : public IGlobalAI
 {
@@ -62,7 +76,12 @@ public:
 
 	void EnemyDamaged(int /*damaged*/,int /*attacker*/,float /*damage*/,float3 /*dir*/) {}	//called when an enemy inside los or radar is damaged
 	void EnemyDestroyed(int enemy, int attacker);
+	//! @brief Writes the given message to the log file (category general, level info)
 	void Log(const char* format, ...);
+
+	//! @brief Writes the given message to the log file if logging of messages of the given category and level is enabled in the general config
+	void Log(ELogCategory category, ELogLevel level, const char* format, ...);
+
 	void LogConsole(const char* format, ...);
 
 	int HandleEvent(int msg, const void *data);
@@ -114,13 +133,41 @@ public:
 	AAIUnitTable* const       UnitTable() { return m_unitTable; }
 	AAIBuildTable* const      BuildTable() { return m_buildTable; }
 	AAIAirForceManager* const AirForceMgr() { return m_airForceManager; }
+	AAIEnemySightings* const  EnemySightings() { return m_enemySightings; }
+
+	//! @brief Returns the random number generator of this instance (to be used instead of rand())
+	AAIRandom&                Random() { return m_random; }
+
+	//! @brief Returns the task scheduler (nullptr if AAI has not been initialized)
+	const AAITaskScheduler* GetTaskScheduler() const { return m_taskScheduler; }
+
+	//! @brief Returns the frame time governor (nullptr if AAI has not been initialized)
+	const AAIFrameTimeGovernor* GetFrameTimeGovernor() const { return m_frameTimeGovernor; }
+
+	//! @brief Returns the incremental planners, i.e. expensive decisions spread over several frames (nullptr if AAI has not been initialized)
+	AAIIncrementalPlanners* const IncrementalPlanners() { return m_incrementalPlanners; }
+
+	//! @brief Adds the memory used by the subsystems of this instance and by the data shared by all AAI instances to the given report
+	void DetermineMemoryUsage(AAIMemoryReport& report) const;
 
 	//! The buildtree (who builds what, which unit belongs to which side, ...)
 	static AAIBuildTree s_buildTree;
 
+	//! Executes planning tasks of all AAI instances outside of the main thread
+	static AAIPlanningWorker s_planningWorker;
+
+	//! Worker threads for parallel processing shared by all AAI instances (started by first, stopped by last instance)
+	static AAIThreadPool s_threadPool;
+
 private:
 	Profiler* GetProfiler(){ return profiler; }
 
+	//! @brief Registers the periodic tasks (e.g. checking construction orders, updating groups) at the task scheduler
+	void InitTaskScheduler();
+
+	//! @brief Writes the memory used per subsystem to the log file
+	void LogMemoryUsage();
+
 	//! Pointer to AI callback
 	IAICallback* m_aiCallback;
 
@@ -157,19 +204,43 @@ private:
 	//! The attack manager coordinates attakcs by ground and sea units
 	AAIAttackManager *m_attackManager;
 
+	//! Collects damage events to process them once per frame
+	AAIDamageEventAccumulator* m_damageEventAccumulator;
+
+	//! Enemy units within LOS/radar (maintained via enemy enter/leave LOS/radar events)
+	AAIEnemySightings* m_enemySightings;
+
+	//! Executes the periodic tasks while limiting the time spent per frame
+	AAITaskScheduler *m_taskScheduler;
+
+	//! Adapts the cadence of the non-critical scheduled tasks to the time spent by AAI per frame
+	AAIFrameTimeGovernor* m_frameTimeGovernor;
+
+	//! Executes expensive decisions (e.g. base expansion, placement of static defences) in bounded steps over several frames
+	AAIIncrementalPlanners* m_incrementalPlanners;
+
 	//! List of groups of unit of the different categories
 	std::vector< std::list<AAIGroup*> > m_unitGroupsOfCategoryLists;
 
 	Profiler* profiler;
 
+	//! Latency histograms of the timed parts of AAI and detection of frames in which AAI needed exceptionally long
+	AAIPerformanceMonitor* m_performanceMonitor;
+
+	//! Proxy in front of the engine callback caching unit data per frame (and counting/timing calls if enabled in general config)
+	AAIUnitQueryCache* m_unitQueryCache;
+
 	//! Id of the team (not ally team) of the AAI instance
 	int m_myTeamId;
 
 	//! Side of this AAI instance; 0 always neutral, for TA-like mods 1 = Arm, 2 = Core
 	int m_side;
 
-	//! File to which log messages are written
-	FILE *m_logFile;
+	//! Writes the log messages to file (in a background thread)
+	AAILogger* m_logger;
+
+	//! Random number generator (seeded in InitAI())
+	AAIRandom m_random;
 
 	//! Initialization state - true if AAI has been sucessfully initialized and ready to run
 	bool m_initialized;
@@ -178,7 +249,10 @@ private:
 	bool m_configLoaded; 
 
 	//! Counter how many instances of AAI exist - if there is more than one instance of AAI, needed to ensure to allocate/free shared memory (e.g. unit learning data) only once
-	static int s_aaiInstances;
+	static std::atomic<int> s_aaiInstances;
+
+	//! Serializes initialization and shutdown of AAI instances (as shared data is created by the first and released by the last instance)
+	static std::mutex s_sharedDataMutex;
 
 	//! Id of this instance of AAI
 	int m_aaiInstance;
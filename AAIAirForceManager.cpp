@@ -19,6 +19,7 @@
 #include "AAIGroup.h"
 #include "AAISector.h"
 #include "AAIBrain.h"
+#include "AAIMemoryUsage.h"
 
 #include "LegacyCpp/UnitDef.h"
 
@@ -31,6 +32,13 @@ AAIAirForceManager::~AAIAirForceManager(void)
 {
 }
 
+size_t AAIAirForceManager::GetMemoryUsage() const
+{
+	const size_t numberOfTargets = m_economyTargets.size() + m_militaryTargets.size();
+
+	return GetAllocatedMemory(m_economyTargets) + GetAllocatedMemory(m_militaryTargets) + numberOfTargets * sizeof(AirRaidTarget);
+}
+
 void AAIAirForceManager::CheckTarget(const UnitId& unitId, const AAIUnitCategory& category, float health)
 {
 	// do not attack own units
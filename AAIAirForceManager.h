@@ -45,6 +45,9 @@ public:
 	AAIAirForceManager(AAI *ai);
 	~AAIAirForceManager(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the air force manager (including the air raid targets)
+	size_t GetMemoryUsage() const;
+
 	//! @brief Checks if a certain unit is worth attacking it and tries to order air units to do it
 	void CheckTarget(const UnitId& unitId, const AAIUnitCategory& category, float health);
 
@@ -12,6 +12,7 @@
 #include "AAIAttackManager.h"
 #include "AAIMap.h"
 #include "AAIGroup.h"
+#include "AAIMemoryUsage.h"
 
 #include "LegacyCpp/IAICallback.h"
 using namespace springLegacyAI;
@@ -32,6 +33,11 @@ AAIAttack::~AAIAttack(void)
 		(*group)->attack = nullptr;
 }
 
+size_t AAIAttack::GetMemoryUsage() const
+{
+	return GetAllocatedMemory(m_combatUnitGroups) + GetAllocatedMemory(m_antiAirUnitGroups);
+}
+
 bool AAIAttack::CheckIfFailed()
 {
 	if(!m_combatUnitGroups.empty())
@@ -66,8 +72,8 @@ bool AAIAttack::HasTargetBeenCleared()
 		if( ai->Map()->IsPositionInLOS(targetPosition) )
 		{
 			// if target is in LOS but no enemy units in LOS target is supposed to be cleared
-			const int numberOfEnemyUnits = ai->GetAICallback()->GetEnemyUnits(&(ai->Map()->UnitsInLOS().front()), targetPosition, 128.0f);
-			return (numberOfEnemyUnits == 0);
+			ai->Map()->CheckUnitsInLOSUpdate();
+			return (ai->Map()->GetEnemyUnitGrid().IsUnitInRadius(targetPosition, 128.0f, true) == false);
 		}
 		
 		return false;
@@ -190,7 +196,7 @@ void AAIAttack::AttackSector(const AAISector *sector)
 				Command c(CMD_GUARD);
 				c.PushParam(unitId.id);
 
-				(*group)->GiveOrderToGroup(&c, 110, GUARDING, "Group::AttackSector");
+				(*group)->GiveOrderToGroup(&c, 110, GUARDING, "Group::AttackSector", EOrderPriority::NORMAL);
 			}
 		}
 	}
@@ -23,6 +23,9 @@ public:
 	AAIAttack(AAI *ai);
 	~AAIAttack(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the attack
+	size_t GetMemoryUsage() const;
+
 	//! @brief Adds group to the attack, returns whether it has been successful
 	bool AddGroup(AAIGroup *group);
 
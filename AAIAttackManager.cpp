@@ -15,8 +15,47 @@
 #include "AAIGroup.h"
 #include "AAIMap.h"
 #include "AAISector.h"
+#include "AAIMemoryUsage.h"
 
-AAIAttackManager::AAIAttackManager(AAI *ai)
+//! Selects the target sector for a new attack based on a snapshot of the sector data
+class AAIAttackPlanningTask : public AAIPlanningTask
+{
+public:
+	AAIAttackPlanningTask(AAIAttackManager* attackManager, int availableAttackId, std::shared_ptr<const std::vector<SectorAttackData>> sectorData, 
+	                      const std::vector<float>& combatPowerGlobal, const std::vector< std::vector<float> >& combatPowerOnContinent, const MobileTargetTypeValues& numberOfAssaultGroupsOfTargetType) :
+		m_attackManager(attackManager),
+		m_availableAttackId(availableAttackId),
+		m_sectorData(sectorData),
+		m_combatPowerGlobal(combatPowerGlobal),
+		m_combatPowerOnContinent(combatPowerOnContinent),
+		m_numberOfAssaultGroupsOfTargetType(numberOfAssaultGroupsOfTargetType),
+		m_targetSector(nullptr)
+	{
+	}
+
+	void Plan() override
+	{
+		m_targetSector = AAIMap::DetermineSectorToAttack(*m_sectorData, m_combatPowerGlobal, m_combatPowerOnContinent, m_numberOfAssaultGroupsOfTargetType);
+	}
+
+	void Commit() override
+	{
+		m_attackManager->m_attackPlanningPending = false;
+		m_attackManager->LaunchAttack(m_availableAttackId, m_targetSector);
+	}
+
+private:
+	AAIAttackManager*                                    m_attackManager;
+	int                                                  m_availableAttackId;
+	std::shared_ptr<const std::vector<SectorAttackData>> m_sectorData;
+	std::vector<float>                                   m_combatPowerGlobal;
+	std::vector< std::vector<float> >                    m_combatPowerOnContinent;
+	MobileTargetTypeValues                               m_numberOfAssaultGroupsOfTargetType;
+	const AAISector*                                     m_targetSector;
+};
+
+AAIAttackManager::AAIAttackManager(AAI *ai) :
+	m_attackPlanningPending(false)
 {
 	this->ai = ai;
 
@@ -34,6 +73,19 @@ AAIAttackManager::~AAIAttackManager(void)
 	m_activeAttacks.clear();
 }
 
+size_t AAIAttackManager::GetMemoryUsage() const
+{
+	size_t memoryUsage = GetAllocatedMemory(m_activeAttacks);
+
+	for(const auto attack : m_activeAttacks)
+	{
+		if(attack)
+			memoryUsage += sizeof(AAIAttack) + attack->GetMemoryUsage();
+	}
+
+	return memoryUsage;
+}
+
 void AAIAttackManager::Update()
 {
 	int availableAttackId(-1);
@@ -56,7 +108,7 @@ void AAIAttackManager::Update()
 	}
 
 	// at least one attack id is available -> check if new attack should be launched
-	if(availableAttackId >= 0)
+	if( (availableAttackId >= 0) && (m_attackPlanningPending == false) )
 		TryToLaunchAttack(availableAttackId);
 }
 
@@ -94,37 +146,60 @@ void AAIAttackManager::TryToLaunchAttack(int availableAttackId)
 		DetermineCombatPowerOfGroups(availableAssaultGroupsOnContinent[continent], combatPowerOnContinent[continent], numberOfAssaultGroupsOfTargetType);
 
 	//////////////////////////////////////////////////////////////////////////////////////////////
-	// determine attack sector
+	// determine attack sector (in planning worker thread)
 	//////////////////////////////////////////////////////////////////////////////////////////////
 
-	const AAISector* targetSector = ai->Map()->DetermineSectorToAttack(combatPowerGlobal, combatPowerOnContinent, numberOfAssaultGroupsOfTargetType);			
+	std::unique_ptr<AAIPlanningTask> planningTask(new AAIAttackPlanningTask(this, availableAttackId, ai->Map()->GetSectorAttackDataSnapshot(), 
+	                                                                         combatPowerGlobal, combatPowerOnContinent, numberOfAssaultGroupsOfTargetType));
+	m_attackPlanningPending = true;
+	AAI::s_planningWorker.AddTask(ai, std::move(planningTask));
+}
+
+void AAIAttackManager::LaunchAttack(int availableAttackId, const AAISector* targetSector)
+{
+	//////////////////////////////////////////////////////////////////////////////////////////////
+	// check if attack is still possible (situation may have changed since planning has been started)
+	//////////////////////////////////////////////////////////////////////////////////////////////
+
+	if( (targetSector == nullptr) || (targetSector->GetNumberOfEnemyBuildings() <= 0) || (m_activeAttacks[availableAttackId] != nullptr) )
+		return;
+
+	const int numberOfContinents( AAIMap::GetNumberOfContinents() );
+	std::vector< std::list<AAIGroup*> > availableAssaultGroupsOnContinent(numberOfContinents);
+	std::vector< std::list<AAIGroup*> > availableAAGroupsOnContinent(numberOfContinents);
+
+	std::list<AAIGroup*> availableAssaultGroupsGlobal;
+	std::list<AAIGroup*> availableAAGroupsGlobal;
+
+	const int numberOfAssaultUnitGroups = DetermineCombatUnitGroupsAvailableForattack(availableAssaultGroupsGlobal, availableAAGroupsGlobal,
+																				availableAssaultGroupsOnContinent, availableAAGroupsOnContinent);
+
+	if(numberOfAssaultUnitGroups == 0)
+		return;
 
 	//////////////////////////////////////////////////////////////////////////////////////////////
 	// order attack
 	//////////////////////////////////////////////////////////////////////////////////////////////
 
-	if(targetSector)
-	{
-		AAIAttack *attack = new AAIAttack(ai);
-		m_activeAttacks[availableAttackId] = attack;
+	AAIAttack *attack = new AAIAttack(ai);
+	m_activeAttacks[availableAttackId] = attack;
 
-		// add combat unit groups
-		AddGroupsToAttack(attack, availableAssaultGroupsOnContinent[targetSector->GetContinentID()]);
-		AddGroupsToAttack(attack, availableAssaultGroupsGlobal);
+	// add combat unit groups
+	AddGroupsToAttack(attack, availableAssaultGroupsOnContinent[targetSector->GetContinentID()]);
+	AddGroupsToAttack(attack, availableAssaultGroupsGlobal);
 
-		// add anti air units if necessary
-		if(    (ai->Brain()->m_maxSpottedCombatUnitsOfTargetType.GetValueOfTargetType(ETargetType::AIR) > 0.2f)
-			|| (ai->Brain()->GetRecentAttacksBy(ETargetType::AIR) > 0.9f) )
-		{
-			std::list<AAIGroup*> antiAirGroups;
-			SelectNumberOfGroups(antiAirGroups, 1, availableAAGroupsOnContinent[targetSector->GetContinentID()], availableAAGroupsGlobal);
+	// add anti air units if necessary
+	if(    (ai->Brain()->m_maxSpottedCombatUnitsOfTargetType.GetValueOfTargetType(ETargetType::AIR) > 0.2f)
+		|| (ai->Brain()->GetRecentAttacksBy(ETargetType::AIR) > 0.9f) )
+	{
+		std::list<AAIGroup*> antiAirGroups;
+		SelectNumberOfGroups(antiAirGroups, 1, availableAAGroupsOnContinent[targetSector->GetContinentID()], availableAAGroupsGlobal);
 
-			AddGroupsToAttack(attack, antiAirGroups);
-		}
-		
-		// start the attack
-		attack->AttackSector(targetSector);
+		AddGroupsToAttack(attack, antiAirGroups);
 	}
+	
+	// start the attack
+	attack->AttackSector(targetSector);
 }
 
 void AAIAttackManager::SelectNumberOfGroups(std::list<AAIGroup*> selectedGroupList, int maxNumberOfGroups, std::list<AAIGroup*> groupList1, std::list<AAIGroup*> groupList2)
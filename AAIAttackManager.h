@@ -22,10 +22,15 @@ class AAISector;
 
 class AAIAttackManager
 {
+	friend class AAIAttackPlanningTask;
+
 public:
 	AAIAttackManager(AAI *ai);
 	~AAIAttackManager(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the attack manager (including the active attacks)
+	size_t GetMemoryUsage() const;
+
 	//! @brief Checks all active attacks whether they should be aborted or continue with a different destination
 	void Update();
 
@@ -50,16 +55,22 @@ private:
 	//! @brief Determines the combat power against the different target types for the given list of groups
 	void DetermineCombatPowerOfGroups(const std::list<AAIGroup*>& groups, std::vector<float>& combatPower, MobileTargetTypeValues& numberOfGroupsOfTargetType) const;
 
-	//! @brief Checks which combat unit groups are available for to attack a target (for each continent), 
-	//!        selects a possible target and launches attack if it seems reasonable (i.e. sufficient combat power available)
+	//! @brief Checks which combat unit groups are available for to attack a target (for each continent) and 
+	//!        starts planning task to select a possible target (attack is launched when planning is finished)
 	void TryToLaunchAttack(int availableAttackId);
 
+	//! @brief Launches attack of the given target sector with the currently available groups (called after planning task has selected target sector)
+	void LaunchAttack(int availableAttackId, const AAISector* targetSector);
+
 	//! @brief Stops the attack and removes it from the list of active attacks
 	void AbortAttack(AAIAttack* attack);
 
 	//! The currently active attacks (nullptr if no active attack)
 	std::vector<AAIAttack*> m_activeAttacks;
 
+	//! Flag if a planning task to select the target of the next attack has been started but not finished yet
+	bool m_attackPlanningPending;
+
 	AAI *ai;
 };
 
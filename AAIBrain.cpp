@@ -17,15 +17,21 @@
 #include "AAIMap.h"
 #include "AAIGroup.h"
 #include "AAISector.h"
+#include "AAIIncrementalPlanner.h"
+#include "AAIMemoryUsage.h"
 
 #include <unordered_map>
+#include <algorithm>
+#include <cmath>
 
 #include "LegacyCpp/UnitDef.h"
 using namespace springLegacyAI;
 
 AttackedByRatesPerGamePhase AAIBrain::s_attackedByRates;
+std::mutex AAIBrain::s_attackedByRatesMutex;
 
 AAIBrain::AAIBrain(AAI *ai, int maxSectorDistanceToBase) :
+	m_combatPowerRevision(0),
 	m_baseFlatLandRatio(0.0f),
 	m_baseWaterRatio(0.0f),
 	m_centerOfBase(0, 0),
@@ -46,8 +52,14 @@ AAIBrain::~AAIBrain(void)
 {
 }
 
+size_t AAIBrain::GetMemoryUsage() const
+{
+	return GetAllocatedMemory(m_sectorsInDistToBase);
+}
+
 void AAIBrain::InitAttackedByRates(const AttackedByRatesPerGamePhase& attackedByRates)
 {
+	std::lock_guard<std::mutex> lock(s_attackedByRatesMutex);
 	s_attackedByRates = attackedByRates;
 }
 
@@ -159,128 +171,212 @@ bool AAIBrain::IsCommanderAllowedForConstructionInSector(const AAISector *sector
 struct SectorForBaseExpansion
 {
 	SectorForBaseExpansion(AAISector* _sector, float _distance, float _totalAttacks) :
-		sector(_sector), distance(_distance), totalAttacks(_totalAttacks) { }
+		sector(_sector), distance(_distance), totalAttacks(_totalAttacks), rating(0.0f) { }
 
 	AAISector* sector;
 	float      distance;
 	float      totalAttacks;
+	float      rating;
 };
 
-void AAIBrain::ExpandBaseAtStartup()
+//! @brief Returns the name of the planner for base expansion into sectors of the given type (at most one planner per sector type is pending at the same time)
+static std::string GetBaseExpansionPlannerName(const AAIMapType& sectorType)
 {
-	if(m_sectorsInDistToBase[0].size() == 0)
-	{
-		ai->Log("ERROR: Failed to expand initial base - no starting sector set!\n");
-		return;
-	}
-
-	AAISector* sector = *m_sectorsInDistToBase[0].begin();
-
-	const bool preferSafeSector = (sector->GetEdgeDistance() > 0) ? true : false;
-
-	ExpandBase( ai->Map()->GetMapType(), preferSafeSector);
+	return "Base-Expansion (" + sectorType.GetName() + ")";
 }
 
-bool AAIBrain::ExpandBase(const AAIMapType& sectorType, bool preferSafeSector)
+//! Selects the sector to be added to the base in several steps and assigns it to the base
+class AAIBaseExpansionPlanner : public AAIIncrementalPlanner
 {
-	if(m_sectorsInDistToBase[0].size() >= cfg->MAX_BASE_SIZE)
-		return false;
-
-	// if aai is looking for a water sector to expand into ocean, allow greater search_dist
-	const bool expandLandBaseInWater = sectorType.IsWater() && (m_baseWaterRatio < 0.1f);
-	const int  maxSearchDistance     = expandLandBaseInWater ? 3 : 1;
+public:
+	AAIBaseExpansionPlanner(AAI* ai, const AAIMapType& sectorType, bool preferSafeSector) :
+		ai(ai),
+		m_name(GetBaseExpansionPlannerName(sectorType)),
+		m_sectorType(sectorType),
+		m_preferSafeSector(preferSafeSector),
+		m_nextSector(0),
+		m_expanded(false)
+	{
+		// if aai is looking for a water sector to expand into ocean, allow greater search_dist
+		const bool expandLandBaseInWater = sectorType.IsWater() && (ai->Brain()->GetBaseWaterRatio() < 0.1f);
+		const int  maxSearchDistance     = expandLandBaseInWater ? 3 : 1;
 
-	//-----------------------------------------------------------------------------------------------------------------
-	// assemble a list of potential sectors for base expansion
-	//-----------------------------------------------------------------------------------------------------------------
-	std::list<SectorForBaseExpansion> expansionCandidateList;
-	StatisticalData sectorDistances;
-	StatisticalData sectorAttacks;
+		for(int distanceToBase = 1; distanceToBase <= maxSearchDistance; ++distanceToBase)
+			m_sectorsToCheck.insert(m_sectorsToCheck.end(), ai->Brain()->m_sectorsInDistToBase[distanceToBase].begin(), ai->Brain()->m_sectorsInDistToBase[distanceToBase].end());
+	}
 
-	for(int distanceToBase = 1; distanceToBase <= maxSearchDistance; ++distanceToBase)
+	bool Step() override
 	{
-		for(auto sector : m_sectorsInDistToBase[distanceToBase])
+		//-----------------------------------------------------------------------------------------------------------------
+		// assemble a list of potential sectors for base expansion
+		//-----------------------------------------------------------------------------------------------------------------
+		const int lastSector = std::min(m_nextSector + AAIConstants::plannerSectorsPerStep, static_cast<int>(m_sectorsToCheck.size()));
+
+		for( ; m_nextSector < lastSector; ++m_nextSector)
 		{
+			AAISector* sector = m_sectorsToCheck[m_nextSector];
+
 			if(sector->IsSectorSuitableForBaseExpansion() )
 			{
 				float sectorDistance(0.0f);
-				for(auto baseSector : m_sectorsInDistToBase[0]) 
+				for(auto baseSector : ai->Brain()->m_sectorsInDistToBase[0]) 
 				{
 					const int deltaX = sector->x - baseSector->x;
 					const int deltaY = sector->y - baseSector->y;
 					sectorDistance += (deltaX * deltaX + deltaY * deltaY); // try squared distances, use fastmath::apxsqrt() otherwise
 				}
 
-				sectorDistances.AddValue(sectorDistance);
+				m_sectorDistances.AddValue(sectorDistance);
 
 				const float totalAttacks = sector->GetTotalAttacksInThisGame() + sector->GetTotalAttacksInPreviousGames();
-				sectorAttacks.AddValue(totalAttacks);
+				m_sectorAttacks.AddValue(totalAttacks);
 
-				expansionCandidateList.push_back( SectorForBaseExpansion(sector, sectorDistance, totalAttacks) );
+				m_expansionCandidates.push_back( SectorForBaseExpansion(sector, sectorDistance, totalAttacks) );
 			}
 		}
-	}
 
-	sectorDistances.Finalize();
-	sectorAttacks.Finalize();
-
-	//-----------------------------------------------------------------------------------------------------------------
-	// select best sector from the list
-	//-----------------------------------------------------------------------------------------------------------------
-	AAISector *selectedSector(nullptr);
-	float highestRating(0.0f);
+		if(m_nextSector < static_cast<int>(m_sectorsToCheck.size()))
+			return false;
 
-	for(auto candidate = expansionCandidateList.begin(); candidate != expansionCandidateList.end(); ++candidate)
-	{
-		// prefer sectors that result in more compact bases, with more metal spots, that are safer (i.e. less attacks in the past)
-		float rating = static_cast<float>( candidate->sector->GetNumberOfMetalSpots() );
-						+ 4.0f * sectorDistances.GetDeviationFromMax(candidate->distance);
+		m_sectorDistances.Finalize();
+		m_sectorAttacks.Finalize();
 
-		if(preferSafeSector)
-		{
-			rating += 4.0f * sectorAttacks.GetDeviationFromMax(candidate->totalAttacks);
-			rating += 4.0f / static_cast<float>( candidate->sector->GetEdgeDistance() + 1 );
-		}
-		else
+		//-----------------------------------------------------------------------------------------------------------------
+		// rate sectors from the list
+		//-----------------------------------------------------------------------------------------------------------------
+		for(auto& candidate : m_expansionCandidates)
 		{
-			rating += std::min(static_cast<float>( candidate->sector->GetEdgeDistance() ), 4.0f);
-		}
+			// prefer sectors that result in more compact bases, with more metal spots, that are safer (i.e. less attacks in the past)
+			float rating = static_cast<float>( candidate.sector->GetNumberOfMetalSpots() );
+							+ 4.0f * m_sectorDistances.GetDeviationFromMax(candidate.distance);
 
-		if(sectorType.IsLand())
-		{
-			// prefer flat sectors
-			rating += 3.0f * candidate->sector->GetFlatTilesRatio();
+			if(m_preferSafeSector)
+			{
+				rating += 4.0f * m_sectorAttacks.GetDeviationFromMax(candidate.totalAttacks);
+				rating += 4.0f / static_cast<float>( candidate.sector->GetEdgeDistance() + 1 );
+			}
+			else
+			{
+				rating += std::min(static_cast<float>( candidate.sector->GetEdgeDistance() ), 4.0f);
+			}
+
+			if(m_sectorType.IsLand())
+			{
+				// prefer flat sectors
+				rating += 3.0f * candidate.sector->GetFlatTilesRatio();
+			}
+			else if(m_sectorType.IsWater())
+			{
+				// check for continent size (to prevent AAI to expand into little ponds instead of big ocean)
+				if( candidate.sector->ConnectedToOcean() )
+					rating += 3.0f * candidate.sector->GetWaterTilesRatio();
+			}
+			else // LAND_WATER_SECTOR
+				rating += 3.0f * (candidate.sector->GetFlatTilesRatio() + candidate.sector->GetWaterTilesRatio());
+
+			candidate.rating = rating;
 		}
-		else if(sectorType.IsWater())
+
+		// highest rated sector first (stable to select the first one of equally rated sectors)
+		std::stable_sort(m_expansionCandidates.begin(), m_expansionCandidates.end(),
+		                 [](const SectorForBaseExpansion& lhs, const SectorForBaseExpansion& rhs) { return lhs.rating > rhs.rating; });
+
+		return true;
+	}
+
+	bool Commit() override
+	{
+		AAIBrain* brain = ai->Brain();
+
+		if(brain->m_sectorsInDistToBase[0].size() >= cfg->MAX_BASE_SIZE)
+			return true;
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// assign highest rated sector that is still suitable to base (situation may have changed since planning has been started)
+		//-----------------------------------------------------------------------------------------------------------------
+		for(const auto& candidate : m_expansionCandidates)
 		{
-			// check for continent size (to prevent AAI to expand into little ponds instead of big ocean)
-			if( candidate->sector->ConnectedToOcean() )
-				rating += 3.0f * candidate->sector->GetWaterTilesRatio();
+			if(candidate.rating <= 0.0f)
+				break;
+
+			AAISector* sector = candidate.sector;
+
+			if( (sector->GetDistanceToBase() > 0) && sector->IsSectorSuitableForBaseExpansion() )
+			{
+				brain->AssignSectorToBase(sector, true);
+				m_expanded = true;
+
+				std::string sectorTypeString = m_sectorType.IsLand() ? "land" : "water";
+				ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "\nAdding %s sector %i,%i to base; base size: " _STPF_, sectorTypeString.c_str(), sector->x, sector->y, brain->m_sectorsInDistToBase[0].size());
+				ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "\nNew land : water ratio within base: %f : %f\n\n", brain->GetBaseFlatLandRatio(), brain->GetBaseWaterRatio());
+				break;
+			}
 		}
-		else // LAND_WATER_SECTOR
-			rating += 3.0f * (candidate->sector->GetFlatTilesRatio() + candidate->sector->GetWaterTilesRatio());
 
-		if(rating > highestRating)
-		{
-			highestRating  = rating;
-			selectedSector = candidate->sector;
-		}			
+		return true;
 	}
 
-	//-----------------------------------------------------------------------------------------------------------------
-	// assign selected sector to base
-	//-----------------------------------------------------------------------------------------------------------------
-	if(selectedSector)
+	const char* GetName() const override { return m_name.c_str(); }
+
+	//! @brief Returns whether a sector has been added to the base
+	bool IsBaseExpanded() const { return m_expanded; }
+
+private:
+	AAI*                                ai;
+	std::string                         m_name;
+	AAIMapType                          m_sectorType;
+	bool                                m_preferSafeSector;
+
+	//! Sectors that are checked for base expansion
+	std::vector<AAISector*>             m_sectorsToCheck;
+
+	//! Index of the next sector to be checked
+	int                                 m_nextSector;
+
+	std::vector<SectorForBaseExpansion> m_expansionCandidates;
+	StatisticalData                     m_sectorDistances;
+	StatisticalData                     m_sectorAttacks;
+	bool                                m_expanded;
+};
+
+void AAIBrain::ExpandBaseAtStartup()
+{
+	if(m_sectorsInDistToBase[0].size() == 0)
 	{
-		AssignSectorToBase(selectedSector, true);
-	
-		std::string sectorTypeString = sectorType.IsLand() ? "land" : "water";
-		ai->Log("\nAdding %s sector %i,%i to base; base size: " _STPF_, sectorTypeString.c_str(), selectedSector->x, selectedSector->y, m_sectorsInDistToBase[0].size());
-		ai->Log("\nNew land : water ratio within base: %f : %f\n\n", m_baseFlatLandRatio, m_baseWaterRatio);
-		return true;
+		ai->Log(ELogCategory::GENERAL, ELogLevel::ERRORS, "ERROR: Failed to expand initial base - no starting sector set!\n");
+		return;
 	}
 
-	return false;
+	AAISector* sector = *m_sectorsInDistToBase[0].begin();
+
+	const bool preferSafeSector = (sector->GetEdgeDistance() > 0) ? true : false;
+
+	ExpandBase( ai->Map()->GetMapType(), preferSafeSector);
+}
+
+bool AAIBrain::ExpandBase(const AAIMapType& sectorType, bool preferSafeSector)
+{
+	if(m_sectorsInDistToBase[0].size() >= cfg->MAX_BASE_SIZE)
+		return false;
+
+	// perform all steps at once
+	AAIBaseExpansionPlanner planner(ai, sectorType, preferSafeSector);
+
+	while(planner.Step() == false)
+		;
+
+	planner.Commit();
+
+	return planner.IsBaseExpanded();
+}
+
+void AAIBrain::RequestBaseExpansion(const AAIMapType& sectorType, bool preferSafeSector)
+{
+	if(    (m_sectorsInDistToBase[0].size() >= cfg->MAX_BASE_SIZE)
+		|| ai->IncrementalPlanners()->IsPlanning(GetBaseExpansionPlannerName(sectorType)) )
+		return;
+
+	ai->IncrementalPlanners()->AddPlanner( std::unique_ptr<AAIIncrementalPlanner>(new AAIBaseExpansionPlanner(ai, sectorType, preferSafeSector)) );
 }
 
 void AAIBrain::UpdateResources(springLegacyAI::IAICallback* cb)
@@ -344,48 +440,39 @@ void AAIBrain::AttackedBy(const AAITargetType& attackerTargetType)
 	m_recentlyAttackedByRates.AddValueForTargetType(attackerTargetType, 1.0f);
 	
 	// update counter for memory dependent on playtime
+	std::lock_guard<std::mutex> lock(s_attackedByRatesMutex);
 	s_attackedByRates.AddAttack(gamePhase, attackerTargetType);
 }
 
-void AAIBrain::UpdateDefenceCapabilities()
+void AAIBrain::CheckDefenceCapabilities() const
 {
-	m_totalMobileCombatPower.Reset();
+	MobileTargetTypeValues combatPowerOfGroups;
 
-	// anti air power
 	for(auto category = ai->s_buildTree.GetCombatUnitCatgegories().begin(); category != ai->s_buildTree.GetCombatUnitCatgegories().end(); ++category)
 	{
 		for(auto group = ai->GetUnitGroupsList(*category).begin(); group != ai->GetUnitGroupsList(*category).end(); ++group)
 		{
-			if((*group)->GetUnitTypeOfGroup().IsAssaultUnit())
-			{
-				switch((*group)->GetUnitCategoryOfGroup().GetUnitCategory())
-				{
-					case EUnitCategory::GROUND_COMBAT:
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SURFACE, (*group)->GetCombatPowerVsTargetType(ETargetType::SURFACE));
-						break;
-					case EUnitCategory::HOVER_COMBAT:
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SURFACE, (*group)->GetCombatPowerVsTargetType(ETargetType::SURFACE));
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::FLOATER, (*group)->GetCombatPowerVsTargetType(ETargetType::FLOATER));
-						break;
-					case EUnitCategory::SEA_COMBAT:
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SURFACE,   (*group)->GetCombatPowerVsTargetType(ETargetType::SURFACE));
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::FLOATER,   (*group)->GetCombatPowerVsTargetType(ETargetType::FLOATER));
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SUBMERGED, (*group)->GetCombatPowerVsTargetType(ETargetType::SUBMERGED));
-						break;
-					case EUnitCategory::SUBMARINE_COMBAT:
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::FLOATER,   (*group)->GetCombatPowerVsTargetType(ETargetType::FLOATER));
-						m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SUBMERGED, (*group)->GetCombatPowerVsTargetType(ETargetType::SUBMERGED));
-						break;
-				}	
-			}
-			else if((*group)->GetUnitTypeOfGroup().IsAntiAir())
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::AIR, (*group)->GetCombatPowerVsTargetType(ETargetType::AIR));
+			const MobileTargetTypeValues combatPowerOfUnit = DetermineDefenceCapabilitiesOfUnitType((*group)->GetUnitDefIdOfGroup());
+			combatPowerOfGroups.AddMobileTargetValues(combatPowerOfUnit, static_cast<float>((*group)->GetCurrentSize()) );
 		}
 	}
+
+	const MobileTargetTypeValues& totalMobileCombatPower = GetTotalMobileCombatPower();
+
+	for(const auto& targetType : AAITargetType::m_mobileTargetTypes)
+	{
+		const float expected = combatPowerOfGroups.GetValueOfTargetType(targetType);
+		const float actual   = totalMobileCombatPower.GetValueOfTargetType(targetType);
+
+		if(std::fabs(expected - actual) > 0.001f * (1.0f + expected))
+			ai->Log(ELogCategory::GENERAL, ELogLevel::ERRORS, "Error: Combat power vs %s deviates from combat power of groups: %f vs %f\n", AAITargetType(targetType).GetName().c_str(), actual, expected);
+	}
 }
 
-void AAIBrain::AddDefenceCapabilities(UnitDefId unitDefId)
+MobileTargetTypeValues AAIBrain::DetermineDefenceCapabilitiesOfUnitType(UnitDefId unitDefId) const
 {
+	MobileTargetTypeValues defenceCapabilities;
+
 	const TargetTypeValues& combatPower = ai->s_buildTree.GetCombatPower(unitDefId);
 
 	if(ai->s_buildTree.GetUnitType(unitDefId).IsAssaultUnit())
@@ -396,33 +483,95 @@ void AAIBrain::AddDefenceCapabilities(UnitDefId unitDefId)
 		{
 			case EUnitCategory::GROUND_COMBAT:
 			{
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SURFACE, combatPower.GetValue(ETargetType::SURFACE));
+				defenceCapabilities.AddValueForTargetType(ETargetType::SURFACE, combatPower.GetValue(ETargetType::SURFACE));
 				break;
 			}
 			case EUnitCategory::HOVER_COMBAT:
 			{
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SURFACE, combatPower.GetValue(ETargetType::SURFACE));
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::FLOATER, combatPower.GetValue(ETargetType::FLOATER));
+				defenceCapabilities.AddValueForTargetType(ETargetType::SURFACE, combatPower.GetValue(ETargetType::SURFACE));
+				defenceCapabilities.AddValueForTargetType(ETargetType::FLOATER, combatPower.GetValue(ETargetType::FLOATER));
 				break;
 			}
 			case EUnitCategory::SEA_COMBAT:
 			{
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SURFACE,   combatPower.GetValue(ETargetType::SURFACE));
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::FLOATER,   combatPower.GetValue(ETargetType::FLOATER));
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SUBMERGED, combatPower.GetValue(ETargetType::SUBMERGED));
+				defenceCapabilities.AddValueForTargetType(ETargetType::SURFACE,   combatPower.GetValue(ETargetType::SURFACE));
+				defenceCapabilities.AddValueForTargetType(ETargetType::FLOATER,   combatPower.GetValue(ETargetType::FLOATER));
+				defenceCapabilities.AddValueForTargetType(ETargetType::SUBMERGED, combatPower.GetValue(ETargetType::SUBMERGED));
 				break;
 			}
 			case EUnitCategory::SUBMARINE_COMBAT:
 			{
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::FLOATER,   combatPower.GetValue(ETargetType::FLOATER));
-				m_totalMobileCombatPower.AddValueForTargetType(ETargetType::SUBMERGED, combatPower.GetValue(ETargetType::SUBMERGED));
+				defenceCapabilities.AddValueForTargetType(ETargetType::FLOATER,   combatPower.GetValue(ETargetType::FLOATER));
+				defenceCapabilities.AddValueForTargetType(ETargetType::SUBMERGED, combatPower.GetValue(ETargetType::SUBMERGED));
+				break;
 			}
 			default:
 				break;
 		}
 	}
 	else if(ai->s_buildTree.GetUnitType(unitDefId).IsAntiAir())
-		m_totalMobileCombatPower.AddValueForTargetType(ETargetType::AIR, combatPower.GetValue(ETargetType::AIR));
+		defenceCapabilities.AddValueForTargetType(ETargetType::AIR, combatPower.GetValue(ETargetType::AIR));
+
+	return defenceCapabilities;
+}
+
+const MobileTargetTypeValues& AAIBrain::GetTotalMobileCombatPower() const
+{
+	// combat power of unit types is shared among all AAI instances and may have been changed (by this or any other instance)
+	if(m_combatPowerRevision != ai->s_buildTree.GetCombatPowerRevision())
+	{
+		m_combatPowerRevision = ai->s_buildTree.GetCombatPowerRevision();
+
+		for(auto& unitType : m_combatPowerOfUnitTypes)
+		{
+			const MobileTargetTypeValues combatPower = DetermineDefenceCapabilitiesOfUnitType(UnitDefId(unitType.first));
+			const float numberOfUnits = static_cast<float>(unitType.second.numberOfUnits);
+
+			m_totalMobileCombatPower.AddMobileTargetValues(unitType.second.combatPower, -numberOfUnits);
+			m_totalMobileCombatPower.AddMobileTargetValues(combatPower, numberOfUnits);
+			unitType.second.combatPower = combatPower;
+		}
+	}
+
+	return m_totalMobileCombatPower;
+}
+
+void AAIBrain::AddDefenceCapabilities(UnitDefId unitDefId)
+{
+	// make sure contributions of other units are up to date before adding the current combat power of the given unit type
+	GetTotalMobileCombatPower();
+
+	CombatPowerOfUnitType& unitType = m_combatPowerOfUnitTypes[unitDefId.id];
+
+	unitType.combatPower = DetermineDefenceCapabilitiesOfUnitType(unitDefId);
+	++unitType.numberOfUnits;
+
+	m_totalMobileCombatPower.AddMobileTargetValues(unitType.combatPower);
+}
+
+void AAIBrain::RemoveDefenceCapabilities(UnitDefId unitDefId)
+{
+	GetTotalMobileCombatPower();
+
+	auto unitType = m_combatPowerOfUnitTypes.find(unitDefId.id);
+
+	if(unitType != m_combatPowerOfUnitTypes.end())
+	{
+		m_totalMobileCombatPower.AddMobileTargetValues(unitType->second.combatPower, -1.0f);
+
+		--unitType->second.numberOfUnits;
+
+		// start from zero once last unit of that type has been killed to prevent accumulation of rounding errors
+		if(unitType->second.numberOfUnits <= 0)
+		{
+			m_combatPowerOfUnitTypes.erase(unitType);
+
+			if(m_combatPowerOfUnitTypes.empty())
+				m_totalMobileCombatPower.Reset();
+		}
+	}
+	else
+		ai->Log(ELogCategory::GENERAL, ELogLevel::ERRORS, "Error: Failed to remove combat power of %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str());
 }
 
 float AAIBrain::Affordable()
@@ -430,10 +579,10 @@ float AAIBrain::Affordable()
 	return 25.0f / (ai->GetAICallback()->GetMetalIncome() + 5.0f);
 }
 
-bool IsRandomNumberBelow(float threshold)
+bool IsRandomNumberBelow(AAIRandom& random, float threshold)
 {
 	// determine random float in [0:1]
-	const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+	const float randomValue = 0.01f * static_cast<float>(random.GetInteger(101));
 	return randomValue < threshold;
 }
 
@@ -465,7 +614,7 @@ void AAIBrain::BuildUnits()
 			// bomber preference ratio between 0 (no targets or high enemy pressure) and 0.9 (low enemy pressure and many possible targets for bombing run) 
 			const float bomberRatio = std::max(ai->AirForceMgr()->GetNumberOfBombTargets() - m_estimatedPressureByEnemies - 0.1f, 0.0f);
 
-			if(IsRandomNumberBelow(bomberRatio))
+			if(IsRandomNumberBelow(ai->Random(), bomberRatio))
 			{
 				finalCombatPower.SetValue(ETargetType::SURFACE, 0.0f);
 				finalCombatPower.SetValue(ETargetType::FLOATER, 0.0f);
@@ -490,6 +639,8 @@ TargetTypeValues AAIBrain::DetermineCombatPowerVsTargetType() const
 	StatisticalData unitsSpottedStatistics;
 	StatisticalData defenceStatistics;
 
+	const MobileTargetTypeValues& totalMobileCombatPower = GetTotalMobileCombatPower();
+
 	const GamePhase gamePhase(ai->GetAICallback()->GetCurrentFrame());
 
 	for(const auto& targetType : AAITargetType::m_mobileTargetTypes)
@@ -499,7 +650,7 @@ TargetTypeValues AAIBrain::DetermineCombatPowerVsTargetType() const
 
 		unitsSpottedStatistics.AddValue( m_maxSpottedCombatUnitsOfTargetType.GetValueOfTargetType(targetType) );
 
-		defenceStatistics.AddValue(m_totalMobileCombatPower.GetValueOfTargetType(targetType));
+		defenceStatistics.AddValue(totalMobileCombatPower.GetValueOfTargetType(targetType));
 	}
 
 	attackedByCatStatistics.Finalize();
@@ -540,7 +691,7 @@ TargetTypeValues AAIBrain::DetermineCombatPowerVsTargetType() const
 						  + attackedByCatStatistics.GetDeviationFromZero( attackedByCategory.GetValueOfTargetType(targetType) ) 
 						  + unitsSpottedStatistics.GetDeviationFromZero( m_maxSpottedCombatUnitsOfTargetType.GetValueOfTargetType(targetType) );
 
-		const float threat = sum / (0.1f + defenceStatistics.GetDeviationFromMax(m_totalMobileCombatPower.GetValueOfTargetType(targetType)) );
+		const float threat = sum / (0.1f + defenceStatistics.GetDeviationFromMax(totalMobileCombatPower.GetValueOfTargetType(targetType)) );
 		combatPowerVsTargetType.SetValue(targetType, threat);
 
 		if(threat > highestThreat)
@@ -598,7 +749,7 @@ AAIMovementType AAIBrain::DetermineMovementTypeForCombatUnitConstruction(const G
 	// boost air craft ratio if many possible targets for bombing run identified (boost factor between 0.75 and 1.5)
 	const float dynamicAirCraftRatio = cfg->AIRCRAFT_RATIO * (0.75f * (1.0f + ai->AirForceMgr()->GetNumberOfBombTargets()));
 
-	if( IsRandomNumberBelow(dynamicAirCraftRatio) && !gamePhase.IsStartingPhase())
+	if( IsRandomNumberBelow(ai->Random(), dynamicAirCraftRatio) && !gamePhase.IsStartingPhase())
 	{
 		moveType.SetMovementType(EMovementType::MOVEMENT_TYPE_AIR);
 	}
@@ -619,7 +770,7 @@ AAIMovementType AAIBrain::DetermineMovementTypeForCombatUnitConstruction(const G
 		else if(waterUnitRatio > 0.95f)
 			waterUnitRatio = 1.0f;
 
-		if(IsRandomNumberBelow(waterUnitRatio) )
+		if(IsRandomNumberBelow(ai->Random(), waterUnitRatio) )
 		{
 			moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_SEA_FLOATER);
 			moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_SEA_SUBMERGED);
@@ -628,7 +779,7 @@ AAIMovementType AAIBrain::DetermineMovementTypeForCombatUnitConstruction(const G
 		{
 			moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_AMPHIBIOUS);
 
-			if(IsRandomNumberBelow(1.0f - waterUnitRatio))
+			if(IsRandomNumberBelow(ai->Random(), 1.0f - waterUnitRatio))
 				moveType.AddMovementType(EMovementType::MOVEMENT_TYPE_GROUND);
 		}
 	}
@@ -664,30 +815,30 @@ UnitSelectionCriteria AAIBrain::DetermineCombatUnitSelectionCriteria() const
 	}
 	else
 	{
-		if( IsRandomNumberBelow(cfg->FAST_UNITS_RATIO) )
+		if( IsRandomNumberBelow(ai->Random(), cfg->FAST_UNITS_RATIO) )
 		{
 			// speed in 0.5 to 1.5
-			const float speed = static_cast<float>(rand()%6);
+			const float speed = static_cast<float>(ai->Random().GetInteger(6));
 			unitSelectionCriteria.speed = 0.5f + 0.2f * speed;
 		}
 		else
 		{
 			// speed in 0.1 to 0.5
-			const float speed = static_cast<float>(rand()%5);
+			const float speed = static_cast<float>(ai->Random().GetInteger(5));
 			unitSelectionCriteria.speed = 0.1f + 0.1f * speed;
 		}
 		
 
-		if( IsRandomNumberBelow(cfg->HIGH_RANGE_UNITS_RATIO) )
+		if( IsRandomNumberBelow(ai->Random(), cfg->HIGH_RANGE_UNITS_RATIO) )
 		{
 			// range in 0.5 to 1.5
-			const float range = static_cast<float>(rand()%6);
+			const float range = static_cast<float>(ai->Random().GetInteger(6));
 			unitSelectionCriteria.range = 0.5f + 0.2f * range;
 		}
 		else
 		{
 			// range in 0.1 to 0.5
-			const float range = static_cast<float>(rand()%5);
+			const float range = static_cast<float>(ai->Random().GetInteger(5));
 			unitSelectionCriteria.range = 0.1f + 0.1f * range;
 		}
 	}
@@ -697,6 +848,8 @@ UnitSelectionCriteria AAIBrain::DetermineCombatUnitSelectionCriteria() const
 
 float AAIBrain::GetAttacksBy(const AAITargetType& targetType, const GamePhase& gamePhase) const
 {
+	std::lock_guard<std::mutex> lock(s_attackedByRatesMutex);
+
 	return (  0.3f * s_attackedByRates.GetAttackedByRate(gamePhase, targetType) 
 	        + 0.7f * m_recentlyAttackedByRates.GetValueOfTargetType(targetType) );
 }
@@ -903,16 +1056,16 @@ void AAIBrain::DetermineStaticDefenceSelectionCriteria(StaticDefenceSelectionCri
 	selectionCriteria.buildtime = 0.25f + 0.32f * m_estimatedPressureByEnemies + defenceFactor;
 
 	// range ranges from 0.1 to 1.5, depending on ratio of units with high ranges
-	if( IsRandomNumberBelow(cfg->HIGH_RANGE_UNITS_RATIO) && (sector->GetNumberOfBuildings(EUnitCategory::STATIC_DEFENCE) > 1) )
+	if( IsRandomNumberBelow(ai->Random(), cfg->HIGH_RANGE_UNITS_RATIO) && (sector->GetNumberOfBuildings(EUnitCategory::STATIC_DEFENCE) > 1) )
 	{
 		// range in 0.5 to 1.5
-		const float range = static_cast<float>(rand()%6);
+		const float range = static_cast<float>(ai->Random().GetInteger(6));
 		selectionCriteria.range = 0.5f + 0.2f * range;
 	}
 	else
 	{
 		// range in 0.1 to 0.5
-		const float range = static_cast<float>(rand()%5);
+		const float range = static_cast<float>(ai->Random().GetInteger(5));
 		selectionCriteria.range = 0.1f + 0.1f * range;
 	}
 
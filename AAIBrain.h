@@ -15,6 +15,9 @@ class AAIExecute;
 class AIIMap;
 class AAISector;
 
+#include <mutex>
+#include <unordered_map>
+
 #include "aidef.h"
 #include "AAIMapRelatedTypes.h"
 #include "AAIUnitStatistics.h"
@@ -26,6 +29,9 @@ public:
 	AAIBrain(AAI *ai, int maxSectorDistanceToBase);
 	~AAIBrain(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the brain
+	size_t GetMemoryUsage() const;
+
 	void InitAttackedByRates(const AttackedByRatesPerGamePhase& attackedByRates);
 
 	//! @brief Returns the current estimation how much the AAI instance is under pressure by the enemies, values ranging from 0 (min) to 1 (max).
@@ -62,20 +68,32 @@ public:
 	void AttackedBy(const AAITargetType& attackerTargetType);
 
 	//! @brief Returns the frequencies of attacks by different combat unit categories in different phases of the game
-	const AttackedByRatesPerGamePhase& GetAttackedByRates() const { return s_attackedByRates; }
+	//!        (a copy, as the frequencies are updated by all AAI instances)
+	AttackedByRatesPerGamePhase GetAttackedByRates() const
+	{
+		std::lock_guard<std::mutex> lock(s_attackedByRatesMutex);
+		return s_attackedByRates;
+	}
 
-	// recalculates def capabilities of all units
-	void UpdateDefenceCapabilities();
+	//! @brief Recalculates defence capabilities from all groups and logs any deviation from the incrementally maintained values (consistency check for debugging)
+	void CheckDefenceCapabilities() const;
 
 	//! @brief Adds the combat power of the given unit type to the global defence capabilities 
 	void AddDefenceCapabilities(UnitDefId unitDefId);
 
+	//! @brief Removes the combat power of the given unit type from the global defence capabilities (called when unit has been killed)
+	void RemoveDefenceCapabilities(UnitDefId unitDefId);
+
 	//! @brief Expands base for the first time at startup (chooses sector based on map type and start sector)
 	void ExpandBaseAtStartup();
 
 	//! @brief Tries to add a new sectors to base, returns true if successful (may fail because base already reached maximum size or no suitable sectors found)
 	bool ExpandBase(const AAIMapType& sectorType, bool preferSafeSector = true);
 
+	//! @brief Starts the selection of a sector to be added to the base which is spread over the next frames (unless base already reached
+	//!        maximum size or another base expansion is pending)
+	void RequestBaseExpansion(const AAIMapType& sectorType, bool preferSafeSector = true);
+
 	// returns how much ressources can be spent for unit construction atm
 	float Affordable();
 
@@ -150,8 +168,27 @@ private:
 	//! @brief Determines criteria for combat unit selection based on current economical and combat/pressure situation
 	UnitSelectionCriteria DetermineCombatUnitSelectionCriteria() const;
 
-	//! The combat power of all mobile units against the different target types
-	MobileTargetTypeValues m_totalMobileCombatPower;
+	//! @brief Returns the contribution of a single unit of the given type to the global defence capabilities
+	MobileTargetTypeValues DetermineDefenceCapabilitiesOfUnitType(UnitDefId unitDefId) const;
+
+	//! @brief Returns the combat power of all mobile units (after applying changes of the combat power of unit types since the last call)
+	const MobileTargetTypeValues& GetTotalMobileCombatPower() const;
+
+	//! Number of active units of a certain type and the combat power per unit that has been added to m_totalMobileCombatPower
+	struct CombatPowerOfUnitType
+	{
+		int                    numberOfUnits;
+		MobileTargetTypeValues combatPower;
+	};
+
+	//! The combat power of all mobile units against the different target types (maintained incrementally)
+	mutable MobileTargetTypeValues m_totalMobileCombatPower;
+
+	//! Active combat units per unit type (key: unitDefId) contributing to m_totalMobileCombatPower
+	mutable std::unordered_map<int, CombatPowerOfUnitType> m_combatPowerOfUnitTypes;
+
+	//! Combat power revision of the build tree that m_totalMobileCombatPower is based on
+	mutable unsigned int m_combatPowerRevision;
 
 	//! Ratio of cells with flat land of all base sectors (ranging from 0 (none) to 1(all))
 	float m_baseFlatLandRatio;
@@ -186,6 +223,9 @@ private:
 	//! Frequency of attacks by different combat categories throughout the gane
 	static AttackedByRatesPerGamePhase s_attackedByRates;
 
+	//! Guards s_attackedByRates (as AAI instances may run concurrently)
+	static std::mutex s_attackedByRatesMutex;
+
 	//! Estimation how much the AAI instance is under pressure in the current game situation, values ranging from 0 (min) to 1 (max).
 	float m_estimatedPressureByEnemies;	
 
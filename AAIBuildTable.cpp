@@ -15,12 +15,14 @@
 #include "AAIUnitTable.h"
 #include "AAIConfig.h"
 #include "AAIMap.h"
+#include "AAIMemoryUsage.h"
 
 #include "LegacyCpp/UnitDef.h"
 #include "LegacyCpp/MoveData.h"
 using namespace springLegacyAI;
 
 AttackedByRatesPerGamePhaseAndMapType AAIBuildTable::s_attackedByRates;
+std::mutex AAIBuildTable::s_attackedByRatesMutex;
 
 AAIBuildTable::AAIBuildTable(AAI* ai)
 {
@@ -73,6 +75,22 @@ AAIBuildTable::~AAIBuildTable(void)
 	unitList.clear();
 }
 
+size_t AAIBuildTable::GetMemoryUsage() const
+{
+	size_t memoryUsage = GetAllocatedMemory(units_dynamic) + GetAllocatedMemory(m_factoryBuildqueue) + GetAllocatedMemory(unitList) + m_ratingTable.GetMemoryUsage();
+
+	for(const auto& candidates : m_combatUnitCandidates)
+	{
+		const CombatUnitCandidateTable& table = *candidates.second;
+
+		memoryUsage += sizeof(candidates) + listNodeOverhead + sizeof(CombatUnitCandidateTable) + GetAllocatedMemory(table.unitDefIds) + GetAllocatedMemory(table.costs) 
+		             + GetAllocatedMemory(table.ranges) + GetAllocatedMemory(table.speeds) + GetAllocatedMemory(table.combatPowers) + GetAllocatedMemory(table.factoryIds)
+		             + GetAllocatedMemory(table.factoryIdsOffsets);
+	}
+
+	return memoryUsage;
+}
+
 void AAIBuildTable::ConstructorRequested(UnitDefId constructor)
 {
 	for(const auto unitDefId : ai->s_buildTree.GetCanConstructList(constructor))
@@ -88,6 +106,8 @@ void AAIBuildTable::ConstructorFinished(UnitDefId constructor)
 		++units_dynamic[unitDefId.id].constructorsAvailable;
 		--units_dynamic[unitDefId.id].constructorsRequested;
 	}
+
+	InvalidateCombatUnitCandidates(constructor);
 }
 
 void AAIBuildTable::ConstructorKilled(UnitDefId constructor)
@@ -96,6 +116,8 @@ void AAIBuildTable::ConstructorKilled(UnitDefId constructor)
 	{
 		--units_dynamic[unitDefId.id].constructorsAvailable;
 	}
+
+	InvalidateCombatUnitCandidates(constructor);
 }
 
 void AAIBuildTable::UnfinishedConstructorKilled(UnitDefId constructor)
@@ -106,6 +128,12 @@ void AAIBuildTable::UnfinishedConstructorKilled(UnitDefId constructor)
 	}
 }
 
+UnitTypeRatingTable& AAIBuildTable::GetRatingTable(int numberOfFeatures) const
+{
+	m_ratingTable.Reset(numberOfFeatures);
+	return m_ratingTable;
+}
+
 bool AAIBuildTable::IsBuildingSelectable(UnitDefId building, bool water, bool mustBeConstructable) const
 {
 	const bool constructablePassed = !mustBeConstructable || (units_dynamic[building.id].constructorsAvailable > 0);
@@ -115,6 +143,32 @@ bool AAIBuildTable::IsBuildingSelectable(UnitDefId building, bool water, bool mu
 	return constructablePassed && (landCheckPassed || seaCheckPassed );
 }
 
+void AAIBuildTable::DetermineCandidatesOnParetoFront(std::vector<UnitDefId>& candidates, const AAIUnitCategory& category, int side, bool water, bool mustBeConstructable, float maxPrimaryAbility) const
+{
+	std::vector<int> candidateIds;
+
+	for(auto building : ai->s_buildTree.GetParetoFront(category, side, water))
+	{
+		if( IsBuildingSelectable(building, water, mustBeConstructable) && (ai->s_buildTree.GetPrimaryAbility(building) < maxPrimaryAbility) )
+			candidateIds.push_back(building.id);
+		else
+		{
+			// dominated buildings may be the best choice if building on the pareto front cannot be selected
+			for(auto dominatedBuilding : ai->s_buildTree.GetDominatedUnitTypes(building))
+				candidateIds.push_back(dominatedBuilding.id);
+		}
+	}
+
+	// units in category lists are sorted by their ids -> restore order (important if buildings share the same rating)
+	std::sort(candidateIds.begin(), candidateIds.end());
+	candidateIds.erase( std::unique(candidateIds.begin(), candidateIds.end()), candidateIds.end() );
+
+	candidates.clear();
+
+	for(auto id : candidateIds)
+		candidates.push_back(UnitDefId(id));
+}
+
 UnitDefId AAIBuildTable::SelectPowerPlant(int side, const PowerPlantSelectionCriteria& selectionCriteria, bool water)
 {
 	UnitDefId powerPlant = SelectPowerPlant(side, selectionCriteria, water, false);
@@ -157,7 +211,6 @@ UnitDefId AAIBuildTable::SelectPowerPlant(int side, const PowerPlantSelectionCri
 	StatisticalData generatedEnergies;
 	StatisticalData buildtimes;
 	StatisticalData costs;
-	std::list<UnitDefId> powerPlants;
 
 	for(auto powerPlant : ai->s_buildTree.GetUnitsInCategory(EUnitCategory::POWER_PLANT, side))
 	{
@@ -165,8 +218,6 @@ UnitDefId AAIBuildTable::SelectPowerPlant(int side, const PowerPlantSelectionCri
 		{
 			if(ai->s_buildTree.GetPrimaryAbility(powerPlant) < (maxPower+1.0f))
 			{
-				powerPlants.push_back(powerPlant);
-
 				// cap energy at current energy production (to avoid jumping to very advanced power plants to fast)
 				const float cappedEnergy = std::min(ai->s_buildTree.GetPrimaryAbility(powerPlant), energyGenerationLimit);
 
@@ -185,28 +236,28 @@ UnitDefId AAIBuildTable::SelectPowerPlant(int side, const PowerPlantSelectionCri
 	// select power plant
 	//-----------------------------------------------------------------------------------------------------------------
 
-	UnitDefId selectedPowerPlant;
-	float     bestRating(0.0f);
+	std::vector<UnitDefId> powerPlants;
+	DetermineCandidatesOnParetoFront(powerPlants, EUnitCategory::POWER_PLANT, side, water, mustBeConstructable, maxPower+1.0f);
+
+	const UnitTypeFeatures weights = { selectionCriteria.powerProduction, selectionCriteria.cost, selectionCriteria.buildtime };
+
+	UnitTypeRatingTable& ratingTable = GetRatingTable(3);
 
 	for(auto powerPlant : powerPlants)
 	{
-		if(!mustBeConstructable || (units_dynamic[powerPlant.id].constructorsAvailable > 0) )
+		if( IsBuildingSelectable(powerPlant, water, false) && (ai->s_buildTree.GetPrimaryAbility(powerPlant) < (maxPower+1.0f)) )
 		{
 			const float cappedEnergy = std::min(ai->s_buildTree.GetPrimaryAbility(powerPlant), energyGenerationLimit);
 
-			const float rating =  selectionCriteria.powerProduction * generatedEnergies.GetDeviationFromZero(cappedEnergy)
-								+ selectionCriteria.cost            * costs.GetDeviationFromMax(ai->s_buildTree.GetTotalCost(powerPlant))
-								+ selectionCriteria.buildtime       * buildtimes.GetDeviationFromMax(ai->s_buildTree.GetBuildtime(powerPlant));
+			const UnitTypeFeatures features = { generatedEnergies.GetDeviationFromZero(cappedEnergy),
+			                                    costs.GetDeviationFromMax(ai->s_buildTree.GetTotalCost(powerPlant)),
+			                                    buildtimes.GetDeviationFromMax(ai->s_buildTree.GetBuildtime(powerPlant)) };
 
-			if(rating > bestRating)
-			{
-				bestRating = rating;
-				selectedPowerPlant = powerPlant;
-			}
+			ratingTable.AddCandidate(powerPlant, features, !mustBeConstructable || (units_dynamic[powerPlant.id].constructorsAvailable > 0) );
 		}
 	}
 
-	return selectedPowerPlant;
+	return ratingTable.SelectHighestRatedCandidate(weights);
 }
 
 UnitDefId AAIBuildTable::SelectExtractor(int side, const ExtractorSelectionCriteria& selectionCriteria, bool water)
@@ -224,34 +275,30 @@ UnitDefId AAIBuildTable::SelectExtractor(int side, const ExtractorSelectionCrite
 
 UnitDefId AAIBuildTable::SelectExtractor(int side, const ExtractorSelectionCriteria& selectionCriteria, bool water, bool mustBeConstructable) const
 {
-	UnitDefId selectedExtractorDefId;
-	float     bestRating(0.0f);
-
 	const AAIUnitStatistics& unitStatistics           = ai->s_buildTree.GetUnitStatistics(side);
 	const StatisticalData&   extractedMetalStatistics = unitStatistics.GetUnitPrimaryAbilityStatistics(EUnitCategory::METAL_EXTRACTOR);
 	const StatisticalData&   costStatistics           = unitStatistics.GetUnitCostStatistics(EUnitCategory::METAL_EXTRACTOR);
 
-	for(auto extractorDefId : ai->s_buildTree.GetUnitsInCategory(EUnitCategory::METAL_EXTRACTOR, side))
+	const UnitTypeFeatures weights = { selectionCriteria.extractedMetal, selectionCriteria.cost };
+
+	std::vector<UnitDefId> extractors;
+	DetermineCandidatesOnParetoFront(extractors, EUnitCategory::METAL_EXTRACTOR, side, water, mustBeConstructable);
+
+	UnitTypeRatingTable& ratingTable = GetRatingTable(2);
+
+	for(auto extractorDefId : extractors)
 	{
 		// check if under water or ground || water = true and building under water
 		if( IsBuildingSelectable(extractorDefId, water, mustBeConstructable) )
 		{
-			const float metalExtraction = ai->s_buildTree.GetMaxRange(extractorDefId);
-			const float isArmed         = GetUnitDef(extractorDefId.id).weapons.empty() ? 0.0f : 1.0f;
-
-			const float myRating =   selectionCriteria.extractedMetal * extractedMetalStatistics.GetDeviationFromZero(metalExtraction)
-						           + selectionCriteria.cost           * costStatistics.GetDeviationFromMax(ai->s_buildTree.GetTotalCost(extractorDefId));
-								   + selectionCriteria.armed          * isArmed;
+			const UnitTypeFeatures features = { extractedMetalStatistics.GetDeviationFromZero( ai->s_buildTree.GetMaxRange(extractorDefId) ),
+			                                    costStatistics.GetDeviationFromMax( ai->s_buildTree.GetTotalCost(extractorDefId) ) };
 
-			if(myRating > bestRating)
-			{
-				bestRating             = myRating;
-				selectedExtractorDefId = extractorDefId;
-			}
+			ratingTable.AddCandidate(extractorDefId, features);
 		}
 	}
 
-	return selectedExtractorDefId;
+	return ratingTable.SelectHighestRatedCandidate(weights);
 }
 
 UnitDefId AAIBuildTable::SelectStorage(int side, const StorageSelectionCriteria& selectionCriteria, bool water)
@@ -277,28 +324,27 @@ UnitDefId AAIBuildTable::SelectStorage(int side, const StorageSelectionCriteria&
 	const StatisticalData&   metalStored     = unitStatistics.GetUnitPrimaryAbilityStatistics(EUnitCategory::STORAGE);
 	const StatisticalData&   energyStored    = unitStatistics.GetUnitSecondaryAbilityStatistics(EUnitCategory::STORAGE);
 
-	UnitDefId selectedStorage;
-	float highestRating(0.0f);
+	const UnitTypeFeatures weights = { selectionCriteria.cost, selectionCriteria.buildtime, selectionCriteria.storedMetal, selectionCriteria.storedEnergy };
+
+	std::vector<UnitDefId> storages;
+	DetermineCandidatesOnParetoFront(storages, EUnitCategory::STORAGE, side, water, mustBeConstructable);
 
-	for(auto storage : ai->s_buildTree.GetUnitsInCategory(EUnitCategory::STORAGE, side))
+	UnitTypeRatingTable& ratingTable = GetRatingTable(4);
+
+	for(auto storage : storages)
 	{
-		
 		if( IsBuildingSelectable(storage.id, water, mustBeConstructable) )
 		{
-			const float rating =      selectionCriteria.cost         * costs.GetDeviationFromMax( ai->s_buildTree.GetTotalCost(storage) )
-									+ selectionCriteria.buildtime    * buildtimes.GetDeviationFromMax( ai->s_buildTree.GetBuildtime(storage) )
-									+ selectionCriteria.storedMetal  * metalStored.GetDeviationFromZero( ai->s_buildTree.GetMaxRange(storage) )
-									+ selectionCriteria.storedEnergy * energyStored.GetDeviationFromZero( ai->s_buildTree.GetMaxSpeed(storage) );
+			const UnitTypeFeatures features = { costs.GetDeviationFromMax( ai->s_buildTree.GetTotalCost(storage) ),
+			                                    buildtimes.GetDeviationFromMax( ai->s_buildTree.GetBuildtime(storage) ),
+			                                    metalStored.GetDeviationFromZero( ai->s_buildTree.GetMaxRange(storage) ),
+			                                    energyStored.GetDeviationFromZero( ai->s_buildTree.GetMaxSpeed(storage) ) };
 
-			if(rating > highestRating)
-			{
-				highestRating   = rating;
-				selectedStorage = storage;
-			}
+			ratingTable.AddCandidate(storage, features);
 		}
 	}
 
-	return selectedStorage;
+	return ratingTable.SelectHighestRatedCandidate(weights);
 }
 
 UnitDefId AAIBuildTable::GetMetalMaker(int side, float cost, float efficiency, float metal, float urgency, bool water, bool canBuild) const
@@ -315,6 +361,8 @@ UnitDefId AAIBuildTable::GetMetalMaker(int side, float cost, float efficiency, f
 
 void AAIBuildTable::DetermineCombatPowerWeights(MobileTargetTypeValues& combatPowerWeights, const AAIMapType& mapType) const
 {
+	std::lock_guard<std::mutex> lock(s_attackedByRatesMutex);
+
 	combatPowerWeights.SetValueForTargetType(ETargetType::AIR,     0.1f + s_attackedByRates.GetAttackedByRateUntilEarlyPhase(mapType, ETargetType::AIR));
 	combatPowerWeights.SetValueForTargetType(ETargetType::SURFACE, 1.0f + s_attackedByRates.GetAttackedByRateUntilEarlyPhase(mapType, ETargetType::SURFACE));
 	
@@ -498,50 +546,93 @@ UnitDefId AAIBuildTable::SelectStaticDefence(int side, const StaticDefenceSelect
 {
 	// get data needed for selection
 	AAIUnitCategory category(EUnitCategory::STATIC_DEFENCE);
-	const std::list<UnitDefId> unitList = ai->s_buildTree.GetUnitsInCategory(category, side);
+	const std::list<UnitDefId>& unitList = ai->s_buildTree.GetUnitsInCategory(category, side);
 
 	const StatisticalData& costs      = ai->s_buildTree.GetUnitStatistics(side).GetUnitCostStatistics(category);
 	const StatisticalData& ranges     = ai->s_buildTree.GetUnitStatistics(side).GetUnitPrimaryAbilityStatistics(category);
 	const StatisticalData& buildtimes = ai->s_buildTree.GetUnitStatistics(side).GetUnitBuildtimeStatistics(category);
 
+	// combat power and pareto fronts are taken from the same snapshot
+	const CombatPowerSnapshot& combatPowerSnapshot = ai->s_buildTree.GetCombatPowerSnapshot();
+
 	// calculate combat power
 	StatisticalData combatPowerStat;		
 
 	for(auto defence : unitList)
 	{
-		const float defenceCombatPower = ai->s_buildTree.GetCombatPower(defence).GetValue(selectionCriteria.targetType);
+		const float defenceCombatPower = combatPowerSnapshot.combatPowerOfUnits[defence.id].GetValue(selectionCriteria.targetType);
 		combatPowerStat.AddValue(defenceCombatPower);
 	}
 
 	combatPowerStat.Finalize();
 
 	// start with selection
-	UnitDefId selectedDefence;
-	float bestRating(0.0f);
+	const UnitTypeFeatures weights = { selectionCriteria.cost, selectionCriteria.buildtime, selectionCriteria.range, selectionCriteria.combatPower, 1.0f };
+
+	// features of the given defence without the random term, and rating based on them (same order of summation as in the rating table)
+	auto determineFeatures = [&](UnitDefId defence) -> UnitTypeFeatures
+	{
+		const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(defence);
+
+		const UnitTypeFeatures features = { costs.GetDeviationFromMax( unitData.m_totalCost ),
+		                                    buildtimes.GetDeviationFromMax( unitData.m_buildtime ),
+		                                    ranges.GetDeviationFromZero( unitData.m_primaryAbility ),
+		                                    combatPowerStat.GetDeviationFromZero( combatPowerSnapshot.combatPowerOfUnits[defence.id].GetValue(selectionCriteria.targetType) ) };
+		return features;
+	};
+
+	auto determineRating = [&weights](const UnitTypeFeatures& features)
+	{
+		float rating(0.0f);
+
+		for(int feature = 0; feature < 4; ++feature)
+			rating += weights[feature] * features[feature];
+
+		return rating;
+	};
+
+	// the highest rating (without random term) of a selectable defence on the pareto front is a lower bound for the rating of the selected defence
+	const std::vector<UnitDefId>& paretoFront = combatPowerSnapshot.staticDefenceParetoFronts[side-1][water ? 1 : 0];
+
+	float minRatingOfSelectedDefence(0.0f);
+
+	for(auto defence : paretoFront)
+	{
+		if( IsBuildingSelectable(defence, water, mustBeConstructable) )
+			minRatingOfSelectedDefence = std::max(minRatingOfSelectedDefence, determineRating(determineFeatures(defence)));
+	}
+
+	const float maxRandomRating = 0.05f * static_cast<float>( std::max(selectionCriteria.randomness, 0) );
+
+	UnitTypeRatingTable& ratingTable = GetRatingTable(5);
+
+	// pareto front is sorted like the list of units
+	auto nextDefenceOnParetoFront = paretoFront.begin();
 
 	for(auto defence : unitList)
 	{
+		const bool onParetoFront = (nextDefenceOnParetoFront != paretoFront.end()) && (*nextDefenceOnParetoFront == defence);
+
+		if(onParetoFront)
+			++nextDefenceOnParetoFront;
+
 		if( IsBuildingSelectable(defence, water, mustBeConstructable) )
 		{
-			const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(defence);
+			// random number is drawn for every selectable defence (regardless of whether it is rated) to keep the selection unchanged
+			const float randomRating = 0.05f * ((float)(ai->Random().GetInteger(selectionCriteria.randomness+1)));
 
-			const float myCombatPower = ai->s_buildTree.GetCombatPower(defence).GetValue(selectionCriteria.targetType);
+			UnitTypeFeatures features = determineFeatures(defence);
 
-			float myRating =  selectionCriteria.cost        * costs.GetDeviationFromMax( unitData.m_totalCost )
-							+ selectionCriteria.buildtime   * buildtimes.GetDeviationFromMax( unitData.m_buildtime )
-							+ selectionCriteria.range       * ranges.GetDeviationFromZero( unitData.m_primaryAbility )
-							+ selectionCriteria.combatPower * combatPowerStat.GetDeviationFromZero( myCombatPower )
-							+ 0.05f * ((float)(rand()%(selectionCriteria.randomness+1)));
-
-			if(myRating > bestRating)
+			// dominated defences are skipped if they cannot be rated higher than a defence of the pareto front even with the highest possible random term
+			if( onParetoFront || (determineRating(features) + maxRandomRating >= minRatingOfSelectedDefence) )
 			{
-				bestRating = myRating;
-				selectedDefence = defence;
+				features[4] = randomRating;
+				ratingTable.AddCandidate(defence, features);
 			}
 		}
 	}
 
-	return selectedDefence;
+	return ratingTable.SelectHighestRatedCandidate(weights);
 }
 
 UnitDefId AAIBuildTable::SelectNanoTurret(int side, bool water) const
@@ -635,12 +726,13 @@ UnitDefId AAIBuildTable::SelectRadar(int side, float cost, float range, bool wat
 	
 UnitDefId AAIBuildTable::SelectRadar(int side, float cost, float range, bool water, bool mustBeConstructable) const
 {
-	UnitDefId selectedRadar;
-	float bestRating(0.0f);
-
 	const StatisticalData& costs  = ai->s_buildTree.GetUnitStatistics(side).GetSensorStatistics().m_radarCosts;
 	const StatisticalData& ranges = ai->s_buildTree.GetUnitStatistics(side).GetSensorStatistics().m_radarRanges;
 
+	const UnitTypeFeatures weights = { cost, range };
+
+	UnitTypeRatingTable& ratingTable = GetRatingTable(2);
+
 	for(auto sensor = ai->s_buildTree.GetUnitsInCategory(EUnitCategory::STATIC_SENSOR, side).begin(); sensor != ai->s_buildTree.GetUnitsInCategory(EUnitCategory::STATIC_SENSOR, side).end(); ++sensor)
 	{
 		//! @todo replace by checking unit type for radar when implemented.
@@ -648,19 +740,15 @@ UnitDefId AAIBuildTable::SelectRadar(int side, float cost, float range, bool wat
 		{
 			if(IsBuildingSelectable(*sensor, water, mustBeConstructable))
 			{
-				const float myRating =   cost * costs.GetNormalizedDeviationFromMax(ai->s_buildTree.GetTotalCost(sensor->id))
-				                       + range * ranges.GetNormalizedDeviationFromMin(ai->s_buildTree.GetMaxRange(sensor->id));
+				const UnitTypeFeatures features = { costs.GetNormalizedDeviationFromMax(ai->s_buildTree.GetTotalCost(sensor->id)),
+				                                    ranges.GetNormalizedDeviationFromMin(ai->s_buildTree.GetMaxRange(sensor->id)) };
 
-				if(myRating > bestRating)
-				{
-					selectedRadar = *sensor;
-					bestRating    = myRating;
-				}
+				ratingTable.AddCandidate(*sensor, features);
 			}
 		}
 	}
 
-	return selectedRadar;
+	return ratingTable.SelectHighestRatedCandidate(weights);
 }
 
 int AAIBuildTable::GetJammer(int side, float cost, float range, bool water, bool canBuild)
@@ -700,7 +788,7 @@ UnitDefId AAIBuildTable::SelectScout(int side, float sightRange, float cost, flo
 		{
 			float rating =     sightRange * sightRanges.GetDeviationFromZero(ai->s_buildTree.GetMaxRange(scoutUnitDefId))
 							+  cost       * costs.GetDeviationFromMax( ai->s_buildTree.GetTotalCost(scoutUnitDefId) )
-							+ (0.1f * ((float)(rand()%randomness)));
+							+ (0.1f * ((float)(ai->Random().GetInteger(randomness))));
 
 			if(GetUnitDef(scoutUnitDefId.id).canCloak)
 				rating += cloakable;
@@ -721,7 +809,63 @@ UnitDefId AAIBuildTable::SelectScout(int side, float sightRange, float cost, flo
 	return selectedScout;
 }
 
-void AAIBuildTable::SelectCombatUnits(std::list<UnitDefId>& unitList, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const
+void AAIBuildTable::InvalidateCombatUnitCandidates(UnitDefId constructor)
+{
+	bool combatUnitsAffected(false);
+
+	for(const auto unitDefId : ai->s_buildTree.GetCanConstructList(constructor))
+	{
+		if(ai->s_buildTree.GetUnitCategory(unitDefId).IsCombatUnit())
+		{
+			combatUnitsAffected = true;
+			break;
+		}
+	}
+
+	if(combatUnitsAffected)
+	{
+		// lowest bit of key indicates whether table has been created for available constructors
+		for(auto table = m_combatUnitCandidates.begin(); table != m_combatUnitCandidates.end(); )
+		{
+			if(table->first & 1u)
+				table = m_combatUnitCandidates.erase(table);
+			else
+				++table;
+		}
+	}
+}
+
+std::shared_ptr<const CombatUnitCandidateTable> AAIBuildTable::GetCombatUnitCandidates(int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const
+{
+	const uint64_t key =  (static_cast<uint64_t>(side) << 33) 
+	                    | (static_cast<uint64_t>(allowedMoveTypes.GetMovementType()) << 1) 
+						| (constructorAvailable ? 1u : 0u);
+
+	auto table = m_combatUnitCandidates.find(key);
+
+	if(table == m_combatUnitCandidates.end())
+	{
+		std::shared_ptr<CombatUnitCandidateTable> candidates = std::make_shared<CombatUnitCandidateTable>();
+		CreateCombatUnitCandidates(*candidates, side, allowedMoveTypes, constructorAvailable);
+
+		table = m_combatUnitCandidates.emplace(key, std::move(candidates)).first;
+	}
+	// combat power of unit types may have changed since table has been created/last used -> replace table (old one may still be used by a planning task)
+	else if(table->second->combatPowerRevision != ai->s_buildTree.GetCombatPowerRevision())
+	{
+		std::shared_ptr<CombatUnitCandidateTable> candidates = std::make_shared<CombatUnitCandidateTable>(*table->second);
+		candidates->combatPowerRevision = ai->s_buildTree.GetCombatPowerRevision();
+
+		for(int i = 0; i < candidates->GetNumberOfCandidates(); ++i)
+			candidates->combatPowers[i] = ai->s_buildTree.GetCombatPower(candidates->unitDefIds[i]);
+
+		table->second = std::move(candidates);
+	}
+
+	return table->second;
+}
+
+void AAIBuildTable::CreateCombatUnitCandidates(CombatUnitCandidateTable& candidates, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const
 {
 	const auto& combatUnitCategories = ai->s_buildTree.GetCombatUnitCatgegories();
 
@@ -748,6 +892,8 @@ void AAIBuildTable::SelectCombatUnits(std::list<UnitDefId>& unitList, int side,
 	if(allowedMoveTypes.Includes(EMovementType::MOVEMENT_TYPE_SEA_SUBMERGED))
 		checkCategory[4] = true;
 
+	candidates.factoryIdsOffsets.push_back(0);
+
 	int i(0);
 	for(auto unitCategory : combatUnitCategories)
 	{
@@ -758,51 +904,64 @@ void AAIBuildTable::SelectCombatUnits(std::list<UnitDefId>& unitList, int side,
 				const bool constructorAvailabilityCheckPassed = (constructorAvailable == false) || (units_dynamic[unitDefId.id].constructorsAvailable > 0);
 				
 				if(constructorAvailabilityCheckPassed && ai->s_buildTree.GetMovementType(unitDefId).IsIncludedIn(allowedMoveTypes))
-					unitList.push_back(unitDefId);
+				{
+					const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(unitDefId);
+
+					candidates.unitDefIds.push_back(unitDefId);
+					candidates.costs.push_back(unitData.m_totalCost);
+					candidates.ranges.push_back(unitData.m_primaryAbility);
+					candidates.speeds.push_back(unitData.m_secondaryAbility);
+					candidates.combatPowers.push_back(ai->s_buildTree.GetCombatPower(unitDefId));
+
+					for(const auto& factory : ai->s_buildTree.GetConstructedByList(unitDefId))
+					{
+						const FactoryId& factoryId = ai->s_buildTree.GetUnitTypeProperties(factory).m_factoryId;
+
+						if(factoryId.IsValid())
+							candidates.factoryIds.push_back(factoryId.id);
+					}
+					candidates.factoryIdsOffsets.push_back( static_cast<int>(candidates.factoryIds.size()) );
+
+					candidates.costStatistics.AddValue(unitData.m_totalCost);
+					candidates.rangeStatistics.AddValue(unitData.m_primaryAbility);
+					candidates.speedStatistics.AddValue(unitData.m_secondaryAbility);
+				}
 			}
 		}
 
 		++i;
 	}
+
+	candidates.costStatistics.Finalize();
+	candidates.rangeStatistics.Finalize();
+	candidates.speedStatistics.Finalize();
+
+	candidates.combatPowerRevision = ai->s_buildTree.GetCombatPowerRevision();
 }
 
-UnitDefId AAIBuildTable::SelectCombatUnit(int side, const AAIMovementType& allowedMoveTypes, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitCriteria, const std::vector<float>& factoryUtilization, int randomness, bool constructorAvailable) const
+UnitDefId AAIBuildTable::SelectCombatUnit(const CombatUnitCandidateTable& candidates, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitCriteria, 
+                                          const std::vector<float>& factoryUtilization, const std::vector<float>& randomValues, std::vector<float>& weightedCombatPowers, UnitTypeRatingTable& ratingTable)
 {
 	//-----------------------------------------------------------------------------------------------------------------
-	// get data needed for selection
+	// get data needed for selection (cost/range/speed statistics do not depend on selection criteria and are precomputed)
 	//-----------------------------------------------------------------------------------------------------------------
 
-	std::list<UnitDefId> unitList;
-	SelectCombatUnits(unitList, side, allowedMoveTypes, constructorAvailable);
+	const int numberOfCandidates = candidates.GetNumberOfCandidates();
+
+	weightedCombatPowers.resize(numberOfCandidates);
 
-	StatisticalData costStatistics;
-	StatisticalData rangeStatistics;
-	StatisticalData speedStatistics;
 	StatisticalData combatPowerStat;
 	StatisticalData combatEfficiencyStat;
-	std::vector<float> combatPowerValues(unitList.size()); // values for individual units (in order of appearance in unitList)
 
-	int i = 0;
-	for(auto unitDefId : unitList)
+	for(int i = 0; i < numberOfCandidates; ++i)
 	{
-		const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(unitDefId);
-
-		const float combatPower = combatPowerCriteria.CalculateWeightedSum(ai->s_buildTree.GetCombatPower(unitDefId)); 
-		const float combatEff   = combatPower / unitData.m_totalCost;
+		const float combatPower = combatPowerCriteria.CalculateWeightedSum(candidates.combatPowers[i]); 
 
-		costStatistics.AddValue(unitData.m_totalCost);
-		rangeStatistics.AddValue(unitData.m_primaryAbility);
-		speedStatistics.AddValue(unitData.m_secondaryAbility);
 		combatPowerStat.AddValue(combatPower);
-		combatEfficiencyStat.AddValue(combatEff);
-		combatPowerValues[i] = combatPower;
-
-		++i;
+		combatEfficiencyStat.AddValue(combatPower / candidates.costs[i]);
+		weightedCombatPowers[i] = combatPower;
 	}
 
-	costStatistics.Finalize();
-	rangeStatistics.Finalize();
-	speedStatistics.Finalize();
 	combatPowerStat.Finalize();
 	combatEfficiencyStat.Finalize();
 
@@ -810,54 +969,35 @@ UnitDefId AAIBuildTable::SelectCombatUnit(int side, const AAIMovementType& allow
 	// begin with selection
 	//-----------------------------------------------------------------------------------------------------------------
 
-	//ai->Log("Selected combat unit (move type %u): cost %f  range %f   speed %f   power %f   efficiency %f   fact. ut. %f   combat: %f %f %f %f %f\n", static_cast<uint32_t>(allowedMoveTypes.GetMovementType()),
-	//unitCriteria.cost, unitCriteria.range, unitCriteria.speed, unitCriteria.power, unitCriteria.efficiency, unitCriteria.factoryUtilization,
-	//combatPowerCriteria.m_values[0], combatPowerCriteria.m_values[1], combatPowerCriteria.m_values[2], combatPowerCriteria.m_values[3], combatPowerCriteria.m_values[4]);
+	const UnitTypeFeatures weights = { unitCriteria.cost, unitCriteria.range, unitCriteria.speed, unitCriteria.power, unitCriteria.efficiency, unitCriteria.factoryUtilization, 1.0f };
 
-	UnitDefId selectedUnitType;
-	float highestRating(0.0f);
-	i = 0;
-	for(const auto& unitDefId : unitList)
-	{
-		const UnitTypeProperties& unitData = ai->s_buildTree.GetUnitTypeProperties(unitDefId);
+	ratingTable.Reset(7);
 
+	for(int i = 0; i < numberOfCandidates; ++i)
+	{
 		float minFactoryUtilization(0.0f);
-		for(const auto& factory : ai->s_buildTree.GetConstructedByList(unitDefId))
+		for(int factory = candidates.factoryIdsOffsets[i]; factory < candidates.factoryIdsOffsets[i+1]; ++factory)
 		{
-			const float utilization = factoryUtilization[ai->s_buildTree.GetUnitTypeProperties(factory).m_factoryId.id];
+			const float utilization = factoryUtilization[candidates.factoryIds[factory]];
 
 			if(utilization > minFactoryUtilization)
 				minFactoryUtilization = utilization;
 		}
 			
-		const float combatEff = combatPowerValues[i] / unitData.m_totalCost;
-
-		const float rating =  unitCriteria.cost  * costStatistics.GetDeviationFromMax( unitData.m_totalCost )
-							+ unitCriteria.range * rangeStatistics.GetDeviationFromZero( unitData.m_primaryAbility )
-							+ unitCriteria.speed * speedStatistics.GetDeviationFromZero( unitData.m_secondaryAbility )
-							+ unitCriteria.power * combatPowerStat.GetDeviationFromZero( combatPowerValues[i] )
-							+ unitCriteria.efficiency * combatEfficiencyStat.GetDeviationFromZero( combatEff )
-							+ unitCriteria.factoryUtilization * minFactoryUtilization
-							+ 0.1f * ((float)(rand()%randomness));
-
-		/*ai->Log("%s: %f  -  %f %f %f %f %f %f\n", unitData.m_name.c_str(), rating, 
-												unitCriteria.cost * costStatistics.GetDeviationFromMax(unitData.m_totalCost), 
-												unitCriteria.range * rangeStatistics.GetDeviationFromZero(unitData.m_primaryAbility),
-												unitCriteria.speed * speedStatistics.GetDeviationFromZero(unitData.m_secondaryAbility),
-												unitCriteria.power * combatPowerStat.GetDeviationFromZero(combatPowerValues[i]),
-												unitCriteria.efficiency * combatEfficiencyStat.GetDeviationFromZero(combatEff),
-												minFactoryUtilization);*/
-
-		if(rating > highestRating)
-		{
-			highestRating       = rating;
-			selectedUnitType.id = unitDefId.id;
-		}
-		
-		++i;
+		const float combatEff = weightedCombatPowers[i] / candidates.costs[i];
+
+		const UnitTypeFeatures features = { candidates.costStatistics.GetDeviationFromMax( candidates.costs[i] ),
+		                                    candidates.rangeStatistics.GetDeviationFromZero( candidates.ranges[i] ),
+		                                    candidates.speedStatistics.GetDeviationFromZero( candidates.speeds[i] ),
+		                                    combatPowerStat.GetDeviationFromZero( weightedCombatPowers[i] ),
+		                                    combatEfficiencyStat.GetDeviationFromZero( combatEff ),
+		                                    minFactoryUtilization,
+		                                    randomValues[i] };
+
+		ratingTable.AddCandidate(candidates.unitDefIds[i], features);
 	}
 
-	//ai->Log("Selected: %s\n", ai->s_buildTree.GetUnitTypeProperties(selectedUnitType).m_name.c_str() );
+	const UnitDefId selectedUnitType = ratingTable.SelectHighestRatedCandidate(weights);
 
 	return selectedUnitType;
 }
@@ -887,6 +1027,8 @@ bool AAIBuildTable::LoadModLearnData()
 		}
 
 		// load attacked_by table
+		std::unique_lock<std::mutex> lock(s_attackedByRatesMutex);
+
 		for(AAIMapType mapType(AAIMapType::first); mapType.End() == false; mapType.Next())
 		{
 			for(GamePhase gamePhase(0); gamePhase.End() == false; gamePhase.Next())
@@ -900,6 +1042,8 @@ bool AAIBuildTable::LoadModLearnData()
 			}
 		}
 
+		lock.unlock();
+
 		const bool combatPowerLoaded = ai->s_buildTree.LoadCombatPowerOfUnits(inputFile);
 		fclose(inputFile);
 		return combatPowerLoaded;
@@ -917,6 +1061,8 @@ void AAIBuildTable::SaveModLearnData(const GamePhase& gamePhase, const AttackedB
 	fprintf(saveFile, "%s \n", MOD_LEARN_VERSION);
 
 	// update attacked_by values
+	std::lock_guard<std::mutex> lock(s_attackedByRatesMutex);
+
 	AttackedByRatesPerGamePhase& updateRates = s_attackedByRates.GetAttackedByRates(mapType);
 	updateRates = attackedByRates;
 	updateRates.DecreaseByFactor(gamePhase, 0.7f);
@@ -1060,7 +1206,7 @@ void AAIBuildTable::RequestFactoryFor(UnitDefId unitDefId)
 			}
 
 			// debug
-			ai->Log("RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
+			ai->Log(ELogCategory::BUILD_TABLE, ELogLevel::VERBOSE, "RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
 		}
 		// mobile constructor requested
 		else
@@ -1068,7 +1214,7 @@ void AAIBuildTable::RequestFactoryFor(UnitDefId unitDefId)
 			const bool successful = RequestMobileConstructor(selectedConstructor);
 
 			if(successful)
-				ai->Log("RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
+				ai->Log(ELogCategory::BUILD_TABLE, ELogLevel::VERBOSE, "RequestFactoryFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
 			//else
 			//	ai->Log("RequestFactoryFor(%s) failed to request %s\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedConstructor).m_name.c_str());
 		}
@@ -1084,7 +1230,7 @@ void AAIBuildTable::RequestBuilderFor(UnitDefId building)
 		const bool successful = RequestMobileConstructor(selectedBuilder);
 
 		if(successful)
-			ai->Log("RequestBuilderFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedBuilder).m_name.c_str());
+			ai->Log(ELogCategory::BUILD_TABLE, ELogLevel::VERBOSE, "RequestBuilderFor(%s) requested %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedBuilder).m_name.c_str());
 		//else
 		//	ai->Log("RequestBuilderFor(%s) failed to request %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(selectedBuilder).m_name.c_str());
 	}
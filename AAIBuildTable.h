@@ -21,10 +21,15 @@ using namespace springLegacyAI;
 #include "aidef.h"
 #include "AAIBuildTree.h"
 #include "AAIUnitTypes.h"
+#include "AAIUnitTypeRating.h"
 #include <assert.h>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
+#include <unordered_map>
+#include <limits>
 
 //using namespace std;
 
@@ -111,12 +116,54 @@ public:
 	bool        canConstructScout;
 };
 
+//! Precomputed data of the combat units that may be selected for a certain side, allowed movement types and constructor availability
+//! (tables are not modified once created, i.e. they may be read by planning tasks while the AAI instance continues)
+class CombatUnitCandidateTable
+{
+public:
+	CombatUnitCandidateTable() : combatPowerRevision(0u) {}
+
+	//! @brief Returns the number of candidates
+	int GetNumberOfCandidates() const { return static_cast<int>(unitDefIds.size()); }
+
+	//! The candidates (in the order they are rated)
+	std::vector<UnitDefId>        unitDefIds;
+
+	//! Total cost of every candidate
+	std::vector<float>            costs;
+
+	//! Max range of every candidate
+	std::vector<float>            ranges;
+
+	//! Max speed of every candidate
+	std::vector<float>            speeds;
+
+	//! Combat power of every candidate (updated if combat power of unit types has changed)
+	std::vector<TargetTypeValues> combatPowers;
+
+	//! Factory ids of the factories that can construct candidate i are stored from factoryIdsOffsets[i] to factoryIdsOffsets[i+1]-1
+	std::vector<int>              factoryIds;
+
+	//! Index of first factory id of every candidate (one additional element marking the end of the last candidate)
+	std::vector<int>              factoryIdsOffsets;
+
+	StatisticalData               costStatistics;
+	StatisticalData               rangeStatistics;
+	StatisticalData               speedStatistics;
+
+	//! Combat power revision of build tree that combatPowers have been taken from
+	unsigned int                  combatPowerRevision;
+};
+
 class AAIBuildTable
 {
 public:
 	AAIBuildTable(AAI* ai);
 	~AAIBuildTable(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the build table of this AAI instance
+	size_t GetMemoryUsage() const;
+
 	//! @brief Updates the stored combat efficiencies and attack frequencies by enemy target types for the given map type
 	void SaveModLearnData(const GamePhase& gamePhase, const AttackedByRatesPerGamePhase& atackedByRates, const AAIMapType& mapType) const;
 
@@ -150,7 +197,11 @@ public:
 	float DetermineFactoryRating(UnitDefId factoryDefId, const TargetTypeValues& combatPowerVsTargetType) const;
 
 	//! @brief Returns the attackedByRates read from the mod learning file upon initialization
-	const AttackedByRatesPerGamePhase& GetAttackedByRates(const AAIMapType& mapType) const { return s_attackedByRates.GetAttackedByRates(mapType); }
+	AttackedByRatesPerGamePhase GetAttackedByRates(const AAIMapType& mapType) const
+	{
+		std::lock_guard<std::mutex> lock(s_attackedByRatesMutex);
+		return s_attackedByRates.GetAttackedByRates(mapType);
+	}
 
 	//! @brief Indicates that construction of unit has started
 	void ConstructionStarted(UnitDefId unitDefId)
@@ -207,8 +258,13 @@ public:
 	// return repair pad
 	int GetAirBase(int side, float cost, bool water, bool canBuild);
 
-	//! @brief Selects a combat unit of specified movement type according to given criteria
-	UnitDefId SelectCombatUnit(int side, const AAIMovementType& moveType, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitCriteria, const std::vector<float>& factoryUtilization, int randomness, bool constructorAvailable) const;
+	//! @brief Returns the combat units matching the given criteria (table is created upon first request and replaced if combat power of units has changed)
+	std::shared_ptr<const CombatUnitCandidateTable> GetCombatUnitCandidates(int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const;
+
+	//! @brief Selects a combat unit from the given candidates according to given criteria (randomValues holds the random part of the rating of every candidate,
+	//!        weightedCombatPowers and ratingTable are used as buffers). Does not access any data of an AAI instance, i.e. may be called by planning tasks.
+	static UnitDefId SelectCombatUnit(const CombatUnitCandidateTable& candidates, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitCriteria, 
+	                                  const std::vector<float>& factoryUtilization, const std::vector<float>& randomValues, std::vector<float>& weightedCombatPowers, UnitTypeRatingTable& ratingTable);
 
 	//! @brief Selects a static artillery according to given criteria
 	UnitDefId SelectStaticArtillery(int side, float cost, float range, bool water) const;
@@ -241,11 +297,22 @@ private:
 	//! @brief Loads mod learn data from file
 	bool LoadModLearnData();
 
+	//! @brief Returns the (emptied) rating table of this instance prepared for a selection with the given number of features
+	UnitTypeRatingTable& GetRatingTable(int numberOfFeatures) const;
+
 	//! @brief Helper function used for building selection
 	bool IsBuildingSelectable(UnitDefId building, bool water, bool mustBeConstructable) const;
 
-	//! @brief Adds combat units matching the given criteria to the list
-	void SelectCombatUnits(std::list<UnitDefId>& unitList, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const;
+	//! @brief Determines the buildings of the given category that need to be rated: the selectable ones on the pareto front and the ones dominated by
+	//!        unselectable buildings of the front (buildings with a primary ability exceeding the given limit are not selectable). 
+	//!        Candidates are returned in the same order as in the list of units of the category.
+	void DetermineCandidatesOnParetoFront(std::vector<UnitDefId>& candidates, const AAIUnitCategory& category, int side, bool water, bool mustBeConstructable, float maxPrimaryAbility = std::numeric_limits<float>::max()) const;
+
+	//! @brief Fills the given table with all combat units matching the given criteria
+	void CreateCombatUnitCandidates(CombatUnitCandidateTable& candidates, int side, const AAIMovementType& allowedMoveTypes, bool constructorAvailable) const;
+
+	//! @brief Deletes candidate tables that depend on availability of constructors if the given constructor can construct combat units
+	void InvalidateCombatUnitCandidates(UnitDefId constructor);
 
 	//! @brief Returns a power plant based on the given criteria
 	UnitDefId SelectPowerPlant(int side, const PowerPlantSelectionCriteria& selectionCriteria, bool water, bool mustBeConstructable) const;
@@ -274,9 +341,18 @@ private:
 	//! A list containing the next factories that shall be built
 	std::list<UnitDefId> m_factoryBuildqueue;
 
+	//! Combat unit candidates for combinations of side, allowed movement types and constructor availability (see GetCombatUnitCandidates())
+	mutable std::unordered_map<uint64_t, std::shared_ptr<const CombatUnitCandidateTable>> m_combatUnitCandidates;
+
+	//! Buffer used by the selection of unit types (to avoid reallocation for every selection)
+	mutable UnitTypeRatingTable m_ratingTable;
+
 	//! Rates of attacks by different combat categories per map and game phase
 	static AttackedByRatesPerGamePhaseAndMapType s_attackedByRates;
 
+	//! Guards s_attackedByRates (read by all AAI instances, updated when the learning data is saved)
+	static std::mutex s_attackedByRatesMutex;
+
 	AAI *ai;
 
 	// all the unit defs, FIXME: this can't be made static as spring seems to free the memory returned by GetUnitDefList()
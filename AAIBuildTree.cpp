@@ -12,6 +12,7 @@
 #include "AAIBuildTree.h"
 #include "AAIConfig.h"
 #include "AAIUnitTypes.h"
+#include "AAIMemoryUsage.h"
 
 #include "LegacyCpp/IGlobalAICallback.h"
 
@@ -27,7 +28,8 @@ using namespace springLegacyAI;
 
 AAIBuildTree::AAIBuildTree() :
 	m_initialized(false),
-	m_numberOfSides(0)
+	m_numberOfSides(0),
+	m_combatPowerRevision(0)
 {
 	m_unitCategoryNames.resize(AAIUnitCategory::numberOfUnitCategories);
 	m_unitCategoryNames[AAIUnitCategory(EUnitCategory::UNKNOWN).GetArrayIndex()].append("Unknown");
@@ -71,8 +73,30 @@ AAIBuildTree::~AAIBuildTree(void)
 	m_unitCategoryNames.clear();
 }
 
+size_t AAIBuildTree::GetMemoryUsage() const
+{
+	size_t memoryUsage = GetAllocatedMemory(m_unitTypeCanBeConstructedtByLists) + GetAllocatedMemory(m_unitTypeCanConstructLists);
+
+	memoryUsage += GetAllocatedMemory(m_unitTypeProperties) + GetAllocatedMemory(m_sideOfUnitType) + GetAllocatedMemory(m_startUnitsOfSide);
+
+	for(const auto& properties : m_unitTypeProperties)
+		memoryUsage += GetAllocatedMemory(properties.m_name);
+
+	memoryUsage += GetAllocatedMemory(m_unitsInCategory) + GetAllocatedMemory(m_unitsInCombatCategory) + GetAllocatedMemory(m_unitCategoryStatisticsOfSide);
+	memoryUsage += GetAllocatedMemory(m_unitCategoryNames) + GetAllocatedMemory(m_combatPowerOfUnits) + GetAllocatedMemory(m_paretoFronts);
+
+	const std::shared_ptr<const CombatPowerSnapshot> snapshot = std::atomic_load(&m_combatPowerSnapshot);
+
+	if(snapshot)
+		memoryUsage += sizeof(CombatPowerSnapshot) + GetAllocatedMemory(snapshot->combatPowerOfUnits);
+
+	return memoryUsage + GetAllocatedMemory(m_dominatedUnitTypes) + GetAllocatedMemory(m_factoryIdsTable);
+}
+
 void AAIBuildTree::SaveCombatPowerOfUnits(FILE* saveFile) const
 {
+	std::lock_guard<std::mutex> lock(m_combatPowerMutex);
+
 	fprintf(saveFile, "%i\n", static_cast<int>(m_combatPowerOfUnits.size()));
 
 	for(int id = 1; id < m_combatPowerOfUnits.size(); ++id)
@@ -96,6 +120,8 @@ bool AAIBuildTree::LoadCombatPowerOfUnits(FILE* inputFile)
 
 	float inputValues[5];
 
+	std::lock_guard<std::mutex> lock(m_combatPowerMutex);
+
 	for(int id = 1; id < m_combatPowerOfUnits.size(); ++id)
 	{
 		fscanf(inputFile, "%f %f %f %f %f", &inputValues[0], &inputValues[1], &inputValues[2], &inputValues[3], &inputValues[4]);
@@ -183,6 +209,8 @@ void AAIBuildTree::InitCombatPowerOfUnits(springLegacyAI::IAICallback* cb)
 	std::vector<const springLegacyAI::UnitDef*> unitDefs(numberOfUnitTypes+1);
 	cb->GetUnitDefList(&unitDefs[1]);
 
+	std::lock_guard<std::mutex> lock(m_combatPowerMutex);
+
 	for(int id = 1; id < m_combatPowerOfUnits.size(); ++id)
 	{
 		const UnitDefId unitDefId(id);
@@ -229,6 +257,8 @@ void AAIBuildTree::InitCombatPowerOfUnits(springLegacyAI::IAICallback* cb)
 
 void AAIBuildTree::UpdateUnitTypesOfCombatUnits()
 {
+	PublishCombatPower(true);
+
 	for(int id = 1; id < m_unitTypeProperties.size(); ++id)
 	{
 		if(m_unitTypeProperties[id].m_unitCategory.IsCombatUnit() || m_unitTypeProperties[id].m_unitCategory.IsStaticDefence() )
@@ -274,6 +304,61 @@ float AAIBuildTree::CalculateCombatPowerChange(UnitDefId attackerUnitDefId, Unit
 		return AAIConstants::maxCombatPowerChangeAfterSingleCombat;
 }
 
+void AAIBuildTree::PublishCombatPower(bool updateStaticDefenceParetoFronts)
+{
+	const unsigned int revision = m_combatPowerRevision.load(std::memory_order_relaxed) + 1u;
+
+	std::shared_ptr<CombatPowerSnapshot> snapshot = std::make_shared<CombatPowerSnapshot>(revision, m_combatPowerOfUnits);
+
+	const std::shared_ptr<const CombatPowerSnapshot> previousSnapshot = std::atomic_load(&m_combatPowerSnapshot);
+
+	if(updateStaticDefenceParetoFronts || (previousSnapshot == nullptr) )
+	{
+		const AAIUnitCategory category(EUnitCategory::STATIC_DEFENCE);
+
+		snapshot->staticDefenceParetoFronts.resize(m_numberOfSides);
+
+		for(int side = 1; side <= m_numberOfSides; ++side)
+		{
+			const std::list<UnitDefId>&  unitList = GetUnitsInCategory(category, side);
+			const std::vector<UnitDefId> unitTypes(unitList.begin(), unitList.end());
+
+			std::vector<UnitTypeFeatures> criteria;
+
+			for(auto unitDefId : unitTypes)
+				criteria.push_back( DetermineParetoCriteria(unitDefId, true) );
+
+			for(int water = 0; water < 2; ++water)
+			{
+				std::vector<int> front;
+				std::vector<int> dominated;
+				DetermineParetoFront(front, dominated, unitTypes, criteria, (water == 1));
+
+				for(auto i : front)
+					snapshot->staticDefenceParetoFronts[side-1][water].push_back(unitTypes[i]);
+			}
+		}
+	}
+	else
+		snapshot->staticDefenceParetoFronts = previousSnapshot->staticDefenceParetoFronts;
+
+	std::atomic_store(&m_combatPowerSnapshot, std::shared_ptr<const CombatPowerSnapshot>(std::move(snapshot)));
+
+	// revision is increased after the snapshot has been published, i.e. a thread that detects a new revision will find the corresponding snapshot
+	m_combatPowerRevision.store(revision, std::memory_order_release);
+}
+
+const CombatPowerSnapshot& AAIBuildTree::GetCombatPowerSnapshot() const
+{
+	// every thread keeps the snapshot it has used last (there is only one build tree, shared by all AAI instances)
+	thread_local std::shared_ptr<const CombatPowerSnapshot> snapshot;
+
+	if( (snapshot == nullptr) || (snapshot->revision != m_combatPowerRevision.load(std::memory_order_acquire)) )
+		snapshot = std::atomic_load(&m_combatPowerSnapshot);
+
+	return *snapshot;
+}
+
 void AAIBuildTree::UpdateCombatPowerStatistics(UnitDefId attackerUnitDefId, UnitDefId killedUnitDefId)
 {
 	const AAIUnitCategory& attackerCategory = GetUnitCategory(attackerUnitDefId);
@@ -282,10 +367,108 @@ void AAIBuildTree::UpdateCombatPowerStatistics(UnitDefId attackerUnitDefId, Unit
 	if(    (attackerCategory.IsCombatUnit() || attackerCategory.IsStaticDefence())
 		&& (killedCategory.IsCombatUnit()   || killedCategory.IsStaticDefence()) )
 	{
+		std::lock_guard<std::mutex> lock(m_combatPowerMutex);
+
 		const float combatPowerChange = CalculateCombatPowerChange(attackerUnitDefId, killedUnitDefId);
 
 		m_combatPowerOfUnits[attackerUnitDefId.id].IncreaseCombatPower(GetTargetType(killedUnitDefId), combatPowerChange);
 		m_combatPowerOfUnits[killedUnitDefId.id].DecreaseCombatPower(GetTargetType(attackerUnitDefId), combatPowerChange);
+
+		PublishCombatPower(attackerCategory.IsStaticDefence() || killedCategory.IsStaticDefence());
+	}
+}
+
+UnitTypeFeatures AAIBuildTree::DetermineParetoCriteria(UnitDefId unitDefId, bool armed) const
+{
+	const UnitTypeProperties& properties = m_unitTypeProperties[unitDefId.id];
+
+	// lower cost/buildtime is better -> use negative values
+	UnitTypeFeatures criteria = { -properties.m_totalCost, -properties.m_buildtime, properties.m_primaryAbility };
+
+	if(properties.m_unitCategory.IsStorage())
+		criteria[3] = properties.m_secondaryAbility;
+	else if(properties.m_unitCategory.IsMetalExtractor())
+		criteria[3] = armed ? 1.0f : 0.0f;
+	else if(properties.m_unitCategory.IsStaticDefence())
+	{
+		const TargetTypeValues& combatPower = m_combatPowerOfUnits[unitDefId.id];
+
+		for(size_t targetType = 0; targetType < combatPower.m_values.size(); ++targetType)
+			criteria[3+targetType] = combatPower.m_values[targetType];
+	}
+
+	return criteria;
+}
+
+bool AAIBuildTree::IsDominatedBy(const UnitTypeFeatures& criteria, const UnitTypeFeatures& otherCriteria) const
+{
+	for(size_t i = 0; i < criteria.size(); ++i)
+	{
+		if(criteria[i] > otherCriteria[i])
+			return false;
+	}
+
+	return true;
+}
+
+void AAIBuildTree::DetermineParetoFront(std::vector<int>& front, std::vector<int>& dominated, const std::vector<UnitDefId>& unitTypes, const std::vector<UnitTypeFeatures>& criteria, bool water) const
+{
+	// a unit type is dominated if it is not better than a preceding unit type in any aspect (i.e. it will never be rated higher
+	// and it loses ties); as this relation is transitive, every dominated unit type is dominated by a unit type on the pareto front
+	for(int i = 0; i < static_cast<int>(unitTypes.size()); ++i)
+	{
+		const AAIMovementType& moveType = GetMovementType(unitTypes[i]);
+
+		if( water ? !moveType.IsStaticSea() : !moveType.IsStaticLand() )
+			continue;
+
+		bool isDominated(false);
+
+		for(auto j : front)
+		{
+			if(IsDominatedBy(criteria[i], criteria[j]))
+			{
+				isDominated = true;
+				break;
+			}
+		}
+
+		if(isDominated)
+			dominated.push_back(i);
+		else
+			front.push_back(i);
+	}
+}
+
+void AAIBuildTree::UpdateParetoFronts(const AAIUnitCategory& category, int side, const std::vector<UnitTypeFeatures>& criteria)
+{
+	const std::list<UnitDefId>&  unitList = GetUnitsInCategory(category, side);
+	const std::vector<UnitDefId> unitTypes(unitList.begin(), unitList.end());
+
+	for(int water = 0; water < 2; ++water)
+	{
+		std::vector<UnitDefId>& paretoFront = m_paretoFronts[side-1][category.GetArrayIndex()][water];
+
+		for(auto unitDefId : paretoFront)
+			m_dominatedUnitTypes[unitDefId.id].clear();
+
+		paretoFront.clear();
+
+		std::vector<int> front;
+		std::vector<int> dominated;
+		DetermineParetoFront(front, dominated, unitTypes, criteria, (water == 1));
+
+		for(auto i : front)
+			paretoFront.push_back(unitTypes[i]);
+
+		for(auto i : dominated)
+		{
+			for(auto j : front)
+			{
+				if(IsDominatedBy(criteria[i], criteria[j]))
+					m_dominatedUnitTypes[unitTypes[j].id].push_back(unitTypes[i]);
+			}
+		}
 	}
 }
 
@@ -465,6 +648,34 @@ bool AAIBuildTree::Generate(springLegacyAI::IAICallback* cb)
 		m_unitCategoryStatisticsOfSide[side].Init(unitDefs, m_unitTypeProperties, m_unitsInCategory[side], m_unitsInCombatCategory[side]);
 	}
 
+	//-----------------------------------------------------------------------------------------------------------------
+	// determine pareto fronts of buildings
+	//-----------------------------------------------------------------------------------------------------------------
+
+	m_paretoFronts.resize(m_numberOfSides, std::vector< std::array<std::vector<UnitDefId>, 2> >(AAIUnitCategory::numberOfUnitCategories) );
+	m_dominatedUnitTypes.resize(numberOfUnitTypes+1);
+
+	const std::array<AAIUnitCategory, 3> categories = { AAIUnitCategory(EUnitCategory::POWER_PLANT), AAIUnitCategory(EUnitCategory::STORAGE), AAIUnitCategory(EUnitCategory::METAL_EXTRACTOR) };
+
+	for(int side = 1; side <= m_numberOfSides; ++side)
+	{
+		for(const auto& category : categories)
+		{
+			std::vector<UnitTypeFeatures> criteria;
+
+			for(auto unitDefId : GetUnitsInCategory(category, side))
+				criteria.push_back( DetermineParetoCriteria(unitDefId, !unitDefs[unitDefId.id]->weapons.empty()) );
+
+			UpdateParetoFronts(category, side, criteria);
+		}
+	}
+
+	// pareto fronts of static defences depend on combat power and are published with it (updated after combat power has been loaded/initialized)
+	{
+		std::lock_guard<std::mutex> lock(m_combatPowerMutex);
+		PublishCombatPower(true);
+	}
+
     return true;
 }
 
@@ -527,6 +738,8 @@ void AAIBuildTree::PrintSummaryToFile(const std::string& filename, springLegacyA
 			fprintf(file, "\n");
 		}
 
+		std::lock_guard<std::mutex> lock(m_combatPowerMutex);
+
 		fprintf(file, "\nCombat power of combat units & static defences (vs. surface, air, ship, submarine, buildings)\n");
 		for(auto category : AAICombatUnitCategory::m_combatUnitCategories )
 		{
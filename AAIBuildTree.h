@@ -13,12 +13,32 @@
 #include "AAIUnitTypes.h"
 #include "AAITypes.h"
 #include "AAIUnitStatistics.h"
+#include "AAIUnitTypeRating.h"
 #include "LegacyCpp/IAICallback.h"
 
 #include <stdio.h>
+#include <array>
+#include <atomic>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <vector>
 
+//! Combat power of all unit types at a certain revision (published as immutable snapshot, i.e. it may be read without locking)
+struct CombatPowerSnapshot
+{
+	CombatPowerSnapshot(unsigned int revision, const std::vector<TargetTypeValues>& combatPowerOfUnits) : revision(revision), combatPowerOfUnits(combatPowerOfUnits) {}
+
+	//! The revision of the combat power (see AAIBuildTree::GetCombatPowerRevision())
+	unsigned int                  revision;
+
+	//! The combat power of every unit type
+	std::vector<TargetTypeValues> combatPowerOfUnits;
+
+	//! For every side and land/sea the static defences not dominated by another one (order: staticDefenceParetoFronts[side][water]), as they depend on combat power
+	std::vector< std::array<std::vector<UnitDefId>, 2> > staticDefenceParetoFronts;
+};
+
 //! @brief This class stores the build-tree, this includes which unit builds another, to which side each unit belongs
 class AAIBuildTree
 {
@@ -27,6 +47,9 @@ public:
 
 	~AAIBuildTree(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the build tree (shared by all AAI instances)
+	size_t GetMemoryUsage() const;
+
 	//! @brief Generates buildtree for current game/mod
 	bool Generate(springLegacyAI::IAICallback* cb);
 
@@ -108,8 +131,15 @@ public:
 	//! @brief Returns the target type
 	const AAITargetType& GetTargetType(UnitDefId unitDefId)     const  { return m_unitTypeProperties[unitDefId.id].m_targetType; }
 
-	//! @brief Returns combat power of given unit type
-	const TargetTypeValues& GetCombatPower(UnitDefId unitDefId)   const { return m_combatPowerOfUnits[unitDefId.id]; }
+	//! @brief Returns combat power of given unit type (a copy, as the combat power may be updated by other AAI instances concurrently)
+	TargetTypeValues GetCombatPower(UnitDefId unitDefId) const { return GetCombatPowerSnapshot().combatPowerOfUnits[unitDefId.id]; }
+
+	//! @brief Returns the latest combat power snapshot known to the calling thread; only fetches the current snapshot if the revision has changed
+	//!        (the returned reference stays valid until the calling thread requests combat power again)
+	const CombatPowerSnapshot& GetCombatPowerSnapshot() const;
+
+	//! @brief Returns a counter that is increased every time the combat power of any unit type changes
+	unsigned int GetCombatPowerRevision() const { return m_combatPowerRevision.load(std::memory_order_acquire); }
 
 	//! @brief Returns the list of units of the given category for given side
 	const std::list<UnitDefId>& GetUnitsInCategory(const AAIUnitCategory& category, int side) const { return m_unitsInCategory[side-1][category.GetArrayIndex()]; }
@@ -117,6 +147,14 @@ public:
 	//! @brief Returns the list of units of the given combat category for given side
 	const std::list<UnitDefId>& GetUnitsInCombatUnitCategory(const AAICombatUnitCategory& combatUnitCategory, int side) const { return m_unitsInCombatCategory[side-1][combatUnitCategory.GetArrayIndex()]; }
 
+	//! @brief Returns the unit types of the given category (power plants, storages, extractors) and side that are not dominated by another
+	//!        unit type (i.e. one that is at least as good in every aspect and precedes it in the list of units of the category) for land (water = false) or sea
+	//!        (pareto fronts of static defences depend on combat power and are part of the combat power snapshot)
+	const std::vector<UnitDefId>& GetParetoFront(const AAIUnitCategory& category, int side, bool water) const { return m_paretoFronts[side-1][category.GetArrayIndex()][water ? 1 : 0]; }
+
+	//! @brief Returns the unit types dominated by the given unit type of a pareto front (need to be considered if the given unit type cannot be selected)
+	const std::vector<UnitDefId>& GetDominatedUnitTypes(UnitDefId unitDefId) const { return m_dominatedUnitTypes[unitDefId.id]; }
+
 	//! @brief Returns the list of units of the given target type
 	const std::list<UnitDefId>& GetUnitsOfTargetType(const AAITargetType& targetType, int side) const;
 
@@ -159,12 +197,29 @@ private:
 	//! @brief Determines and sets the unit types for the given unit.
 	void UpdateUnitTypes(UnitDefId unitDefId, const springLegacyAI::UnitDef* unitDef);
 
-	//! @brief Determines the unit type of combat units (called after combat power has been loaded/initialized)
+	//! @brief Determines the unit type of combat units (called after combat power has been loaded/initialized, with m_combatPowerMutex locked)
 	void UpdateUnitTypesOfCombatUnits();
 
-	//! @brief Calculates the value for the update of the combar power of the given attacker and killed unit type
+	//! @brief Calculates the value for the update of the combar power of the given attacker and killed unit type (m_combatPowerMutex must be locked)
 	float CalculateCombatPowerChange(UnitDefId attackerUnitDefId, UnitDefId killedUnitDefId) const;
 
+	//! @brief Publishes a new snapshot of the current combat power and increases the revision; pareto fronts of static defences are determined
+	//!        anew if requested, otherwise taken from the previous snapshot (m_combatPowerMutex must be locked)
+	void PublishCombatPower(bool updateStaticDefenceParetoFronts);
+
+	//! @brief Returns the criteria (higher values are better) used to determine whether a unit type is dominated by another unit type of the same category
+	UnitTypeFeatures DetermineParetoCriteria(UnitDefId unitDefId, bool armed) const;
+
+	//! @brief Returns true if a unit type with the given criteria is not better in any aspect than a unit type with the other criteria
+	bool IsDominatedBy(const UnitTypeFeatures& criteria, const UnitTypeFeatures& otherCriteria) const;
+
+	//! @brief Determines the indices of the given unit types (static land or sea buildings) that are not dominated by a preceding one (front)
+	//!        and of the remaining ones (dominated); criteria must contain the pareto criteria of every given unit type
+	void DetermineParetoFront(std::vector<int>& front, std::vector<int>& dominated, const std::vector<UnitDefId>& unitTypes, const std::vector<UnitTypeFeatures>& criteria, bool water) const;
+
+	//! @brief Determines the pareto fronts (land and sea) of the given category and side; criteria must contain the pareto criteria of every unit in the category
+	void UpdateParetoFronts(const AAIUnitCategory& category, int side, const std::vector<UnitTypeFeatures>& criteria);
+
 	//-----------------------------------------------------------------------------------------------------------------
 	// helper functions for determineUnitCategory(...)
 	//-----------------------------------------------------------------------------------------------------------------
@@ -219,6 +274,21 @@ private:
 	//! The combat power of every unit
 	std::vector<TargetTypeValues>                 m_combatPowerOfUnits;
 
+	//! Counter increased whenever combat power of units changes (allows AAI instances to detect outdated data derived from combat power)
+	std::atomic<unsigned int>                     m_combatPowerRevision;
+
+	//! Guards the combat power of units (learning data updated by all AAI instances)
+	mutable std::mutex                            m_combatPowerMutex;
+
+	//! The latest published combat power (only accessed via std::atomic_load/std::atomic_store)
+	std::shared_ptr<const CombatPowerSnapshot>    m_combatPowerSnapshot;
+
+	//! For every side, category, and land/sea the unit types not dominated by other ones (order: m_paretoFronts[side][category][water]), only set for power plants, storages, extractors
+	std::vector< std::vector< std::array<std::vector<UnitDefId>, 2> > > m_paretoFronts;
+
+	//! For every unit type on a pareto front, the unit types dominated by it
+	std::vector< std::vector<UnitDefId> >         m_dominatedUnitTypes;
+
 	//! This vetcor stores the UnitDefIds corresponding to any valid factory id
 	std::vector<UnitDefId>                        m_factoryIdsTable;
 };
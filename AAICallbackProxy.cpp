@@ -0,0 +1,114 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "AAICallbackProxy.h"
+#include "AAIPerformanceMonitor.h"
+#include "AAI.h"
+
+//! Scope used for calls made outside of any AAI_SCOPED_TIMER
+static const char* const noScope = "(no timer)";
+
+AAICallbackProxy::AAICallbackProxy(IAICallback* callback, bool profileCalls) :
+	m_callback(callback),
+	m_profileCalls(profileCalls),
+	m_lastScope(nullptr),
+	m_lastScopeStatistics(nullptr)
+{
+}
+
+void AAICallbackProxy::AddCall(ECallbackFunction function, int64_t time)
+{
+	const char* scope = AAIPerformanceMonitor::GetActiveScope();
+
+	if(scope == nullptr)
+		scope = noScope;
+
+	if(scope != m_lastScope)
+	{
+		m_lastScope           = scope;
+		m_lastScopeStatistics = &m_statisticsOfScope[scope];
+	}
+
+	CallStatistics& statistics = (*m_lastScopeStatistics)[static_cast<int>(function)];
+	++statistics.calls;
+	statistics.time += time;
+}
+
+const char* AAICallbackProxy::GetFunctionName(ECallbackFunction function)
+{
+	static const char* const names[] = {
+		"GetCurrentFrame", "GetUnitPos", "GetUnitDef", "GetUnitDef(name)", "GetUnitDefById", "GetUnitTeam", "GetUnitAllyTeam",
+		"GetUnitHealth", "GetUnitMaxHealth", "GetUnitSpeed", "GetUnitPower", "GetUnitMaxRange", "UnitBeingBuilt", "GetEnemyUnits",
+		"GetEnemyUnitsInRadarAndLos", "GetFriendlyUnits", "GetElevation", "CanBuildAt", "ClosestBuildSite", "GiveOrder",
+		"GetCurrentUnitCommands", "GetMetal", "GetMetalIncome", "GetMetalUsage", "GetMetalStorage", "GetEnergy", "GetEnergyIncome",
+		"GetEnergyUsage", "GetEnergyStorage", "GetFeatures", "GetFeaturePos", "Map_getLosMap"
+	};
+
+	static_assert(sizeof(names)/sizeof(names[0]) == static_cast<size_t>(ECallbackFunction::NUMBER_OF_FUNCTIONS), "Name missing for callback function");
+
+	return names[static_cast<int>(function)];
+}
+
+void AAICallbackProxy::LogStatistics(AAI* ai) const
+{
+	if(m_profileCalls == false)
+		return;
+
+	struct Entry
+	{
+		ECallbackFunction function;
+		const char*       scope;
+		CallStatistics    statistics;
+	};
+
+	// totals per function and per function/scope
+	CallStatisticsOfFunctions totals;
+	std::vector<Entry>        entries;
+
+	for(const auto& scope : m_statisticsOfScope)
+	{
+		for(int function = 0; function < static_cast<int>(ECallbackFunction::NUMBER_OF_FUNCTIONS); ++function)
+		{
+			const CallStatistics& statistics = scope.second[function];
+
+			if(statistics.calls > 0)
+			{
+				totals[function].calls += statistics.calls;
+				totals[function].time  += statistics.time;
+				entries.push_back( Entry{static_cast<ECallbackFunction>(function), scope.first, statistics} );
+			}
+		}
+	}
+
+	std::vector<int> functions;
+	for(int function = 0; function < static_cast<int>(ECallbackFunction::NUMBER_OF_FUNCTIONS); ++function)
+	{
+		if(totals[function].calls > 0)
+			functions.push_back(function);
+	}
+
+	std::sort(functions.begin(), functions.end(), [&totals](int lhs, int rhs) { return totals[lhs].time > totals[rhs].time; });
+	std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) { return lhs.statistics.time > rhs.statistics.time; });
+
+	ai->Log("\nEngine callback calls - function: calls, total time (ms), avg time (ns):\n");
+	for(int function : functions)
+	{
+		ai->Log("%-30s: %10lld %10.2f %8lld\n", GetFunctionName(static_cast<ECallbackFunction>(function)), static_cast<long long>(totals[function].calls),
+		        1.0e-6 * static_cast<double>(totals[function].time), static_cast<long long>(totals[function].time / totals[function].calls));
+	}
+
+	ai->Log("\nEngine callback calls per calling subsystem - function / subsystem: calls, total time (ms), avg time (ns):\n");
+	for(const Entry& entry : entries)
+	{
+		ai->Log("%-30s / %-30s: %10lld %10.2f %8lld\n", GetFunctionName(entry.function), entry.scope, static_cast<long long>(entry.statistics.calls),
+		        1.0e-6 * static_cast<double>(entry.statistics.time), static_cast<long long>(entry.statistics.time / entry.statistics.calls));
+	}
+}
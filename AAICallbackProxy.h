@@ -0,0 +1,321 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_CALLBACK_PROXY_H
+#define AAI_CALLBACK_PROXY_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LegacyCpp/IAICallback.h"
+
+using namespace springLegacyAI;
+
+class AAI;
+
+//! The engine callback functions whose calls are counted/timed by the callback proxy
+enum class ECallbackFunction : int
+{
+	GET_CURRENT_FRAME,
+	GET_UNIT_POS,
+	GET_UNIT_DEF,
+	GET_UNIT_DEF_BY_NAME,
+	GET_UNIT_DEF_BY_ID,
+	GET_UNIT_TEAM,
+	GET_UNIT_ALLY_TEAM,
+	GET_UNIT_HEALTH,
+	GET_UNIT_MAX_HEALTH,
+	GET_UNIT_SPEED,
+	GET_UNIT_POWER,
+	GET_UNIT_MAX_RANGE,
+	UNIT_BEING_BUILT,
+	GET_ENEMY_UNITS,
+	GET_ENEMY_UNITS_IN_RADAR_AND_LOS,
+	GET_FRIENDLY_UNITS,
+	GET_ELEVATION,
+	CAN_BUILD_AT,
+	CLOSEST_BUILD_SITE,
+	GIVE_ORDER,
+	GET_CURRENT_UNIT_COMMANDS,
+	GET_METAL,
+	GET_METAL_INCOME,
+	GET_METAL_USAGE,
+	GET_METAL_STORAGE,
+	GET_ENERGY,
+	GET_ENERGY_INCOME,
+	GET_ENERGY_USAGE,
+	GET_ENERGY_STORAGE,
+	GET_FEATURES,
+	GET_FEATURE_POS,
+	GET_LOS_MAP,                //!< Map_getLosMap() of the C callback (called by AAI directly)
+	NUMBER_OF_FUNCTIONS
+};
+
+#define AAI_INSTRUMENTED_CALLBACK(function) AAICallbackProxy::ScopedCall callbackTimerFromMacro(this, ECallbackFunction::function);
+
+//! @brief Forwards all calls to the engine callback; if profiling is enabled, calls of the functions that are frequently used by AAI 
+//!        (see ECallbackFunction) are counted and timed. The statistics are attributed to the calling subsystem, i.e. the innermost active 
+//!        AAI_SCOPED_TIMER. Only to be used from the thread calling the AI interface (like the engine callback itself).
+class AAICallbackProxy : public IAICallback
+{
+public:
+	AAICallbackProxy(IAICallback* callback, bool profileCalls);
+
+	//! @brief Measures the time until it goes out of scope and adds the call to the statistics of the given proxy 
+	//!        (no-op if proxy is nullptr or profiling is disabled)
+	class ScopedCall
+	{
+	public:
+		ScopedCall(AAICallbackProxy* proxy, ECallbackFunction function) :
+			m_proxy( (proxy && proxy->m_profileCalls) ? proxy : nullptr),
+			m_function(function),
+			m_start(m_proxy ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+		{}
+
+		~ScopedCall()
+		{
+			if(m_proxy)
+				m_proxy->AddCall(m_function, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+		}
+
+	private:
+		AAICallbackProxy*                     m_proxy;
+		ECallbackFunction                     m_function;
+		std::chrono::steady_clock::time_point m_start;
+	};
+
+	//! @brief Writes the number of calls and the time spent per callback function (in total and per calling subsystem) to the log file
+	//!        (nothing if profiling is disabled)
+	void LogStatistics(AAI* ai) const;
+
+	//! @brief Returns the wrapped engine callback
+	IAICallback* GetEngineCallback() const { return m_callback; }
+
+	void SendTextMsg(const char* text, int zone) { m_callback->SendTextMsg(text, zone); }
+	void SetLastMsgPos(const float3& pos) { m_callback->SetLastMsgPos(pos); }
+	void AddNotification(const float3& pos, const float3& color, float alpha) { m_callback->AddNotification(pos, color, alpha); }
+	bool SendResources(float mAmount, float eAmount, int receivingTeam) { return m_callback->SendResources(mAmount, eAmount, receivingTeam); }
+	int SendUnits(const std::vector<int>& unitIDs, int receivingTeam) { return m_callback->SendUnits(unitIDs, receivingTeam); }
+	bool PosInCamera(const float3& pos, float radius) { return m_callback->PosInCamera(pos, radius); }
+
+	int GetCurrentFrame() { AAI_INSTRUMENTED_CALLBACK(GET_CURRENT_FRAME) return m_callback->GetCurrentFrame(); }
+	int GetMySkirmishAIId() { return m_callback->GetMySkirmishAIId(); }
+	int GetMyTeam() { return m_callback->GetMyTeam(); }
+	int GetMyAllyTeam() { return m_callback->GetMyAllyTeam(); }
+	int GetPlayerTeam(int player) { return m_callback->GetPlayerTeam(player); }
+	int GetTeams() { return m_callback->GetTeams(); }
+	const char* GetTeamSide(int team) { return m_callback->GetTeamSide(team); }
+	int GetTeamAllyTeam(int team) { return m_callback->GetTeamAllyTeam(team); }
+	float GetTeamMetalCurrent(int team) { return m_callback->GetTeamMetalCurrent(team); }
+	float GetTeamMetalIncome(int team) { return m_callback->GetTeamMetalIncome(team); }
+	float GetTeamMetalUsage(int team) { return m_callback->GetTeamMetalUsage(team); }
+	float GetTeamMetalStorage(int team) { return m_callback->GetTeamMetalStorage(team); }
+	float GetTeamEnergyCurrent(int team) { return m_callback->GetTeamEnergyCurrent(team); }
+	float GetTeamEnergyIncome(int team) { return m_callback->GetTeamEnergyIncome(team); }
+	float GetTeamEnergyUsage(int team) { return m_callback->GetTeamEnergyUsage(team); }
+	float GetTeamEnergyStorage(int team) { return m_callback->GetTeamEnergyStorage(team); }
+	bool IsAllied(int firstAllyTeamId, int secondAllyTeamId) { return m_callback->IsAllied(firstAllyTeamId, secondAllyTeamId); }
+
+	int CreateGroup() { return m_callback->CreateGroup(); }
+	void EraseGroup(int groupId) { m_callback->EraseGroup(groupId); }
+	bool AddUnitToGroup(int unitId, int groupId) { return m_callback->AddUnitToGroup(unitId, groupId); }
+	bool RemoveUnitFromGroup(int unitId) { return m_callback->RemoveUnitFromGroup(unitId); }
+	int GetUnitGroup(int unitId) { return m_callback->GetUnitGroup(unitId); }
+	const std::vector<SCommandDescription>* GetGroupCommands(int unitId) { return m_callback->GetGroupCommands(unitId); }
+	int GiveGroupOrder(int unitId, Command* c) { return m_callback->GiveGroupOrder(unitId, c); }
+	int GiveOrder(int unitId, Command* c) { AAI_INSTRUMENTED_CALLBACK(GIVE_ORDER) return m_callback->GiveOrder(unitId, c); }
+	const std::vector<SCommandDescription>* GetUnitCommands(int unitId) { return m_callback->GetUnitCommands(unitId); }
+	const CCommandQueue* GetCurrentUnitCommands(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_CURRENT_UNIT_COMMANDS) return m_callback->GetCurrentUnitCommands(unitId); }
+
+	int GetMaxUnits() { return m_callback->GetMaxUnits(); }
+	int GetUnitAiHint(int unitId) { return m_callback->GetUnitAiHint(unitId); }
+	int GetUnitTeam(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_TEAM) return m_callback->GetUnitTeam(unitId); }
+	int GetUnitAllyTeam(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_ALLY_TEAM) return m_callback->GetUnitAllyTeam(unitId); }
+	float GetUnitHealth(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_HEALTH) return m_callback->GetUnitHealth(unitId); }
+	float GetUnitMaxHealth(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_MAX_HEALTH) return m_callback->GetUnitMaxHealth(unitId); }
+	float GetUnitSpeed(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_SPEED) return m_callback->GetUnitSpeed(unitId); }
+	float GetUnitPower(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_POWER) return m_callback->GetUnitPower(unitId); }
+	float GetUnitExperience(int unitId) { return m_callback->GetUnitExperience(unitId); }
+	float GetUnitMaxRange(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_MAX_RANGE) return m_callback->GetUnitMaxRange(unitId); }
+	bool IsUnitActivated(int unitId) { return m_callback->IsUnitActivated(unitId); }
+	bool UnitBeingBuilt(int unitId) { AAI_INSTRUMENTED_CALLBACK(UNIT_BEING_BUILT) return m_callback->UnitBeingBuilt(unitId); }
+	const UnitDef* GetUnitDef(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_DEF) return m_callback->GetUnitDef(unitId); }
+	float3 GetUnitPos(int unitId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_POS) return m_callback->GetUnitPos(unitId); }
+	float3 GetUnitVel(int unitId) { return m_callback->GetUnitVel(unitId); }
+	int GetBuildingFacing(int unitId) { return m_callback->GetBuildingFacing(unitId); }
+	bool IsUnitCloaked(int unitId) { return m_callback->IsUnitCloaked(unitId); }
+	bool IsUnitParalyzed(int unitId) { return m_callback->IsUnitParalyzed(unitId); }
+	bool IsUnitNeutral(int unitId) { return m_callback->IsUnitNeutral(unitId); }
+	bool GetUnitResourceInfo(int unitId, UnitResourceInfo* resourceInfo) { return m_callback->GetUnitResourceInfo(unitId, resourceInfo); }
+
+	const UnitDef* GetUnitDef(const char* unitName) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_DEF_BY_NAME) return m_callback->GetUnitDef(unitName); }
+	const UnitDef* GetUnitDefById(int unitDefId) { AAI_INSTRUMENTED_CALLBACK(GET_UNIT_DEF_BY_ID) return m_callback->GetUnitDefById(unitDefId); }
+
+	int InitPath(float3 start, float3 end, int pathType, float goalRadius = 8) { return m_callback->InitPath(start, end, pathType, goalRadius); }
+	float3 GetNextWaypoint(int pathId) { return m_callback->GetNextWaypoint(pathId); }
+	void FreePath(int pathId) { m_callback->FreePath(pathId); }
+	float GetPathLength(float3 start, float3 end, int pathType, float goalRadius = 8) { return m_callback->GetPathLength(start, end, pathType, goalRadius); }
+
+	int GetEnemyUnits(int* unitIds, int unitIds_max = -1) { AAI_INSTRUMENTED_CALLBACK(GET_ENEMY_UNITS) return m_callback->GetEnemyUnits(unitIds, unitIds_max); }
+	int GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max = -1) { AAI_INSTRUMENTED_CALLBACK(GET_ENEMY_UNITS_IN_RADAR_AND_LOS) return m_callback->GetEnemyUnitsInRadarAndLos(unitIds, unitIds_max); }
+	int GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) { AAI_INSTRUMENTED_CALLBACK(GET_ENEMY_UNITS) return m_callback->GetEnemyUnits(unitIds, pos, radius, unitIds_max); }
+	int GetFriendlyUnits(int* unitIds, int unitIds_max = -1) { AAI_INSTRUMENTED_CALLBACK(GET_FRIENDLY_UNITS) return m_callback->GetFriendlyUnits(unitIds, unitIds_max); }
+	int GetFriendlyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) { AAI_INSTRUMENTED_CALLBACK(GET_FRIENDLY_UNITS) return m_callback->GetFriendlyUnits(unitIds, pos, radius, unitIds_max); }
+	int GetNeutralUnits(int* unitIds, int unitIds_max = -1) { return m_callback->GetNeutralUnits(unitIds, unitIds_max); }
+	int GetNeutralUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) { return m_callback->GetNeutralUnits(unitIds, pos, radius, unitIds_max); }
+
+	int GetMapWidth() { return m_callback->GetMapWidth(); }
+	int GetMapHeight() { return m_callback->GetMapHeight(); }
+	const float* GetHeightMap() { return m_callback->GetHeightMap(); }
+	const float* GetCornersHeightMap() { return m_callback->GetCornersHeightMap(); }
+	float GetMinHeight() { return m_callback->GetMinHeight(); }
+	float GetMaxHeight() { return m_callback->GetMaxHeight(); }
+	const float* GetSlopeMap() { return m_callback->GetSlopeMap(); }
+	const unsigned short* GetLosMap() { return m_callback->GetLosMap(); }
+	int GetLosMapResolution() { return m_callback->GetLosMapResolution(); }
+	const unsigned short* GetRadarMap() { return m_callback->GetRadarMap(); }
+	const unsigned short* GetJammerMap() { return m_callback->GetJammerMap(); }
+	const unsigned char* GetMetalMap() { return m_callback->GetMetalMap(); }
+	int GetMapHash() { return m_callback->GetMapHash(); }
+	const char* GetMapName() { return m_callback->GetMapName(); }
+	const char* GetMapHumanName() { return m_callback->GetMapHumanName(); }
+	int GetModHash() { return m_callback->GetModHash(); }
+	const char* GetModName() { return m_callback->GetModName(); }
+	const char* GetModHumanName() { return m_callback->GetModHumanName(); }
+	const char* GetModShortName() { return m_callback->GetModShortName(); }
+	const char* GetModVersion() { return m_callback->GetModVersion(); }
+
+	float GetElevation(float x, float z) { AAI_INSTRUMENTED_CALLBACK(GET_ELEVATION) return m_callback->GetElevation(x, z); }
+	float GetMaxMetal() const { return m_callback->GetMaxMetal(); }
+	float GetExtractorRadius() const { return m_callback->GetExtractorRadius(); }
+	float GetMinWind() const { return m_callback->GetMinWind(); }
+	float GetMaxWind() const { return m_callback->GetMaxWind(); }
+	float GetCurWind() const { return m_callback->GetCurWind(); }
+	float GetTidalStrength() const { return m_callback->GetTidalStrength(); }
+	float GetGravity() const { return m_callback->GetGravity(); }
+
+	void LineDrawerStartPath(const float3& pos, const float* color) { m_callback->LineDrawerStartPath(pos, color); }
+	void LineDrawerFinishPath() { m_callback->LineDrawerFinishPath(); }
+	void LineDrawerDrawLine(const float3& endPos, const float* color) { m_callback->LineDrawerDrawLine(endPos, color); }
+	void LineDrawerDrawLineAndIcon(int cmdId, const float3& endPos, const float* color) { m_callback->LineDrawerDrawLineAndIcon(cmdId, endPos, color); }
+	void LineDrawerDrawIconAtLastPos(int cmdId) { m_callback->LineDrawerDrawIconAtLastPos(cmdId); }
+	void LineDrawerBreak(const float3& endPos, const float* color) { m_callback->LineDrawerBreak(endPos, color); }
+	void LineDrawerRestart() { m_callback->LineDrawerRestart(); }
+	void LineDrawerRestartSameColor() { m_callback->LineDrawerRestartSameColor(); }
+	int CreateSplineFigure(float3 pos1, float3 pos2, float3 pos3, float3 pos4, float width, int arrow, int lifeTime, int figureGroupId) { return m_callback->CreateSplineFigure(pos1, pos2, pos3, pos4, width, arrow, lifeTime, figureGroupId); }
+	int CreateLineFigure(float3 pos1, float3 pos2, float width, int arrow, int lifeTime, int figureGroupId) { return m_callback->CreateLineFigure(pos1, pos2, width, arrow, lifeTime, figureGroupId); }
+	void SetFigureColor(int figureGroupId, float red, float green, float blue, float alpha) { m_callback->SetFigureColor(figureGroupId, red, green, blue, alpha); }
+	void DeleteFigureGroup(int figureGroupId) { m_callback->DeleteFigureGroup(figureGroupId); }
+	void DrawUnit(const char* name, const float3& pos, float rotation, int lifeTime, int teamId, bool transparent, bool drawBorder, int facing = 0) { m_callback->DrawUnit(name, pos, rotation, lifeTime, teamId, transparent, drawBorder, facing); }
+
+	bool IsDebugDrawerEnabled() const { return m_callback->IsDebugDrawerEnabled(); }
+	void DebugDrawerAddGraphPoint(int p0, float p1, float p2) { m_callback->DebugDrawerAddGraphPoint(p0, p1, p2); }
+	void DebugDrawerDelGraphPoints(int p0, int p1) { m_callback->DebugDrawerDelGraphPoints(p0, p1); }
+	void DebugDrawerSetGraphPos(float p0, float p1) { m_callback->DebugDrawerSetGraphPos(p0, p1); }
+	void DebugDrawerSetGraphSize(float p0, float p1) { m_callback->DebugDrawerSetGraphSize(p0, p1); }
+	void DebugDrawerSetGraphLineColor(int p0, const float3& p1) { m_callback->DebugDrawerSetGraphLineColor(p0, p1); }
+	void DebugDrawerSetGraphLineLabel(int p0, const char* p1) { m_callback->DebugDrawerSetGraphLineLabel(p0, p1); }
+	int DebugDrawerAddOverlayTexture(const float* p0, int p1, int p2) { return m_callback->DebugDrawerAddOverlayTexture(p0, p1, p2); }
+	void DebugDrawerUpdateOverlayTexture(int p0, const float* p1, int p2, int p3, int p4, int p5) { m_callback->DebugDrawerUpdateOverlayTexture(p0, p1, p2, p3, p4, p5); }
+	void DebugDrawerDelOverlayTexture(int p0) { m_callback->DebugDrawerDelOverlayTexture(p0); }
+	void DebugDrawerSetOverlayTexturePos(int p0, float p1, float p2) { m_callback->DebugDrawerSetOverlayTexturePos(p0, p1, p2); }
+	void DebugDrawerSetOverlayTextureSize(int p0, float p1, float p2) { m_callback->DebugDrawerSetOverlayTextureSize(p0, p1, p2); }
+	void DebugDrawerSetOverlayTextureLabel(int p0, const char* p1) { m_callback->DebugDrawerSetOverlayTextureLabel(p0, p1); }
+
+	bool CanBuildAt(const UnitDef* unitDef, float3 pos, int facing = 0) { AAI_INSTRUMENTED_CALLBACK(CAN_BUILD_AT) return m_callback->CanBuildAt(unitDef, pos, facing); }
+	float3 ClosestBuildSite(const UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0) { AAI_INSTRUMENTED_CALLBACK(CLOSEST_BUILD_SITE) return m_callback->ClosestBuildSite(unitDef, pos, searchRadius, minDist, facing); }
+
+	bool GetProperty(int unitId, int property, void* dst) { return m_callback->GetProperty(unitId, property, dst); }
+	bool GetValue(int valueId, void* dst) { return m_callback->GetValue(valueId, dst); }
+	int HandleCommand(int commandId, void* data) { return m_callback->HandleCommand(commandId, data); }
+
+	int GetFileSize(const char* name) { return m_callback->GetFileSize(name); }
+	bool ReadFile(const char* name, void* buffer, int bufferLen) { return m_callback->ReadFile(name, buffer, bufferLen); }
+
+	int GetSelectedUnits(int* unitIds, int unitIds_max = -1) { return m_callback->GetSelectedUnits(unitIds, unitIds_max); }
+	float3 GetMousePos() { return m_callback->GetMousePos(); }
+	int GetMapPoints(PointMarker* pm, int pm_sizeMax, bool includeAllies) { return m_callback->GetMapPoints(pm, pm_sizeMax, includeAllies); }
+	int GetMapLines(LineMarker* lm, int lm_sizeMax, bool includeAllies) { return m_callback->GetMapLines(lm, lm_sizeMax, includeAllies); }
+
+	float GetMetal() { AAI_INSTRUMENTED_CALLBACK(GET_METAL) return m_callback->GetMetal(); }
+	float GetMetalIncome() { AAI_INSTRUMENTED_CALLBACK(GET_METAL_INCOME) return m_callback->GetMetalIncome(); }
+	float GetMetalUsage() { AAI_INSTRUMENTED_CALLBACK(GET_METAL_USAGE) return m_callback->GetMetalUsage(); }
+	float GetMetalStorage() { AAI_INSTRUMENTED_CALLBACK(GET_METAL_STORAGE) return m_callback->GetMetalStorage(); }
+	float GetEnergy() { AAI_INSTRUMENTED_CALLBACK(GET_ENERGY) return m_callback->GetEnergy(); }
+	float GetEnergyIncome() { AAI_INSTRUMENTED_CALLBACK(GET_ENERGY_INCOME) return m_callback->GetEnergyIncome(); }
+	float GetEnergyUsage() { AAI_INSTRUMENTED_CALLBACK(GET_ENERGY_USAGE) return m_callback->GetEnergyUsage(); }
+	float GetEnergyStorage() { AAI_INSTRUMENTED_CALLBACK(GET_ENERGY_STORAGE) return m_callback->GetEnergyStorage(); }
+
+	int GetFeatures(int* featureIds, int max) { AAI_INSTRUMENTED_CALLBACK(GET_FEATURES) return m_callback->GetFeatures(featureIds, max); }
+	int GetFeatures(int* featureIds, int max, const float3& pos, float radius) { AAI_INSTRUMENTED_CALLBACK(GET_FEATURES) return m_callback->GetFeatures(featureIds, max, pos, radius); }
+	const FeatureDef* GetFeatureDef(int featureId) { return m_callback->GetFeatureDef(featureId); }
+	const FeatureDef* GetFeatureDefById(int featureDefId) { return m_callback->GetFeatureDefById(featureDefId); }
+	float GetFeatureHealth(int featureId) { return m_callback->GetFeatureHealth(featureId); }
+	float GetFeatureReclaimLeft(int featureId) { return m_callback->GetFeatureReclaimLeft(featureId); }
+	float3 GetFeaturePos(int featureId) { AAI_INSTRUMENTED_CALLBACK(GET_FEATURE_POS) return m_callback->GetFeaturePos(featureId); }
+
+	int GetNumUnitDefs() { return m_callback->GetNumUnitDefs(); }
+	void GetUnitDefList(const UnitDef** list) { m_callback->GetUnitDefList(list); }
+	float GetUnitDefHeight(int def) { return m_callback->GetUnitDefHeight(def); }
+	float GetUnitDefRadius(int def) { return m_callback->GetUnitDefRadius(def); }
+
+	const WeaponDef* GetWeapon(const char* weaponName) { return m_callback->GetWeapon(weaponName); }
+	const WeaponDef* GetWeaponDefById(int weaponDefId) { return m_callback->GetWeaponDefById(weaponDefId); }
+
+	const float3* GetStartPos() { return m_callback->GetStartPos(); }
+
+	unsigned int GetCategoryFlag(const char* categoryName) { return m_callback->GetCategoryFlag(categoryName); }
+	unsigned int GetCategoriesFlag(const char* categoryNames) { return m_callback->GetCategoriesFlag(categoryNames); }
+	void GetCategoryName(int categoryFlag, char* name, int name_sizeMax) { m_callback->GetCategoryName(categoryFlag, name, name_sizeMax); }
+
+	const char* CallLuaRules(const char* inData, int inSize = -1) { return m_callback->CallLuaRules(inData, inSize); }
+	const char* CallLuaUI(const char* inData, int inSize = -1) { return m_callback->CallLuaUI(inData, inSize); }
+
+	std::map<std::string, std::string> GetMyInfo() { return m_callback->GetMyInfo(); }
+	std::map<std::string, std::string> GetMyOptionValues() { return m_callback->GetMyOptionValues(); }
+
+private:
+	struct CallStatistics
+	{
+		CallStatistics() : calls(0), time(0) {}
+
+		int64_t calls;
+
+		//! Total time in nanoseconds
+		int64_t time;
+	};
+
+	typedef std::array<CallStatistics, static_cast<int>(ECallbackFunction::NUMBER_OF_FUNCTIONS)> CallStatisticsOfFunctions;
+
+	//! @brief Adds a call of the given function (attributed to the currently active timer scope)
+	void AddCall(ECallbackFunction function, int64_t time);
+
+	//! @brief Returns the name of the given callback function
+	static const char* GetFunctionName(ECallbackFunction function);
+
+	//! The engine callback
+	IAICallback* m_callback;
+
+	//! Whether calls are counted/timed
+	bool m_profileCalls;
+
+	//! Statistics per calling subsystem (name of the timer scope, stored by address)
+	std::unordered_map<const char*, CallStatisticsOfFunctions> m_statisticsOfScope;
+
+	//! Scope of the last call and its statistics (consecutive calls typically originate from the same scope)
+	const char*                m_lastScope;
+	CallStatisticsOfFunctions* m_lastScopeStatistics;
+};
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "AAIConfig.h"
 #include "AAI.h"
+#include "AAILogger.h"
 #include "System/SafeCStrings.h"
 #include "System/StringUtil.h"
 
@@ -129,6 +130,7 @@ AAIConfig::AAIConfig() :
 	MAX_ASSISTANTS = 4;
 	MIN_ASSISTANCE_BUILDTIME = 15;
 	MAX_BASE_SIZE = 12;
+	MAX_AIR_TARGETS = 20;
 	SCOUT_SPEED = 95.0;
 	GROUND_ARTY_RANGE = 1000.0;
 	SEA_ARTY_RANGE = 1300.0;
@@ -167,6 +169,15 @@ AAIConfig::AAIConfig() :
 	MIN_FALLBACK_TURNRATE = 250.0f;
 
 	LEARN_RATE = 5;
+	MAX_WORKER_THREADS = 2;
+	TRACE_EXECUTION = false;
+	PROFILE_CALLBACKS = false;
+	RANDOM_SEED = 0;
+	FRAME_TIME_BUDGET = 1500;
+	MIN_CADENCE_FACTOR = 1.0f;
+	MAX_CADENCE_FACTOR = 4.0f;
+	LOG_LEVEL = static_cast<int>(ELogLevel::INFO);
+	LOG_CATEGORY_LEVELS.resize(static_cast<int>(ELogCategory::NUMBER_OF_CATEGORIES), -1);
 	CLIFF_SLOPE = 0.085f;
 	WATER_MAP_RATIO = 0.8f;
 	LAND_WATER_MAP_RATIO = 0.3f;
@@ -436,6 +447,31 @@ bool AAIConfig::LoadGeneralConfig(AAI* ai)
 			WATER_MAP_RATIO = ReadNextFloat(ai, file);
 		} else if(!strcmp(keyword, "LAND_WATER_MAP_RATIO")) {
 			LAND_WATER_MAP_RATIO = ReadNextFloat(ai, file);
+		} else if(!strcmp(keyword, "MAX_WORKER_THREADS")) {
+			MAX_WORKER_THREADS = std::max(ReadNextInteger(ai, file), 0);
+		} else if(!strcmp(keyword, "TRACE_EXECUTION")) {
+			TRACE_EXECUTION = (ReadNextInteger(ai, file) != 0);
+		} else if(!strcmp(keyword, "PROFILE_CALLBACKS")) {
+			PROFILE_CALLBACKS = (ReadNextInteger(ai, file) != 0);
+		} else if(!strcmp(keyword, "RANDOM_SEED")) {
+			RANDOM_SEED = ReadNextInteger(ai, file);
+		} else if(!strcmp(keyword, "FRAME_TIME_BUDGET")) {
+			FRAME_TIME_BUDGET = std::max(ReadNextInteger(ai, file), 1);
+		} else if(!strcmp(keyword, "MIN_CADENCE_FACTOR")) {
+			MIN_CADENCE_FACTOR = ReadNextFloat(ai, file);
+		} else if(!strcmp(keyword, "MAX_CADENCE_FACTOR")) {
+			MAX_CADENCE_FACTOR = ReadNextFloat(ai, file);
+		} else if(!strcmp(keyword, "LOG_LEVEL")) {
+			LOG_LEVEL = ReadNextInteger(ai, file);
+		} else if(!strcmp(keyword, "LOG_CATEGORY_LEVEL")) {
+			const std::string categoryName = ReadNextString(ai, file);
+			const ELogCategory category    = AAILogger::GetCategory(categoryName.c_str());
+			const int level                = ReadNextInteger(ai, file);
+
+			if(category != ELogCategory::NUMBER_OF_CATEGORIES)
+				LOG_CATEGORY_LEVELS[static_cast<int>(category)] = level;
+			else
+				ai->Log("ERROR: Unknown log category %s in general config file\n", categoryName.c_str());
 		}
 		else 
 		{
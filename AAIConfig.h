@@ -66,6 +66,7 @@ public:
 	int MAX_ASSISTANTS;
 	int MIN_ASSISTANCE_BUILDTIME;
 	int MAX_BASE_SIZE;
+	int MAX_AIR_TARGETS;
 	float SCOUT_SPEED;
 	float GROUND_ARTY_RANGE;
 	float SEA_ARTY_RANGE;
@@ -141,6 +142,31 @@ public:
 	// game specific
 	int   LEARN_RATE;
 
+	//! Maximum number of threads of the thread pool shared by all AAI instances
+	int   MAX_WORKER_THREADS;
+
+	//! Record execution timeline of all AAI instances and write it to AAI_trace.json (Chrome trace event format) at the end of the game
+	bool  TRACE_EXECUTION;
+
+	//! Count and time calls to the engine callback per calling subsystem (summary is written to the log file at the end of the game)
+	bool  PROFILE_CALLBACKS;
+
+	//! Seed of the random number generators of the AAI instances (combined with the team id); 0 = seed is determined from current time
+	int   RANDOM_SEED;
+
+	//! Target for the average time (in microseconds) spent by AAI per frame; the cadence of non-critical tasks is adapted to meet it
+	int   FRAME_TIME_BUDGET;
+
+	//! Bounds of the factor the periods of non-critical tasks are multiplied with (by default, periods are only stretched; < 1 allows more frequent updates if there is headroom)
+	float MIN_CADENCE_FACTOR;
+	float MAX_CADENCE_FACTOR;
+
+	//! Maximum level of messages written to the log file (0 = errors, 1 = warnings, 2 = info, 3 = verbose)
+	int   LOG_LEVEL;
+
+	//! Maximum level of logged messages per log category (-1 if LOG_LEVEL applies)
+	std::vector<int> LOG_CATEGORY_LEVELS;
+
 	/**
 	 * open a file in springs data directory
 	 * @param filename relative path of the file in the spring data dir
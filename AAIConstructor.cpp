@@ -107,6 +107,7 @@ void AAIConstructor::Update()
 			{
 				// give build order
 				Command c(-constructedUnitDefId.id);
+				ai->Execute()->DiscardStagedOrders(m_myUnitId);
 				ai->GetAICallback()->GiveOrder(m_myUnitId.id, &c);
 
 				m_constructedDefId = constructedUnitDefId.id;
@@ -128,6 +129,7 @@ void AAIConstructor::Update()
 					Command c(-constructedUnitDefId.id);
 					c.PushPos(buildSite.Position());
 
+					ai->Execute()->DiscardStagedOrders(m_myUnitId);
 					ai->GetAICallback()->GiveOrder(m_myUnitId.id, &c);
 					m_constructedDefId = constructedUnitDefId.id;
 					m_activity.SetActivity(EConstructorActivity::CONSTRUCTING); //! @todo Should be HEADING_TO_BUILDSITE
@@ -180,7 +182,7 @@ void AAIConstructor::Update()
 						// can this thing resurrect? If so, maybe we should raise the corpses instead of consuming them?
 						if(def->canResurrect)
 						{
-							if(rand()%2 == 1)
+							if(ai->Random().GetInteger(2) == 1)
 								c.id = CMD_RESURRECT;
 							else
 								c.id = CMD_RECLAIM;
@@ -316,7 +318,7 @@ void AAIConstructor::GiveReclaimOrder(UnitId unitId)
 	Command c(CMD_RECLAIM);
 	c.PushParam(unitId.id);
 	//ai->Getcb()->GiveOrder(this->unit_id, &c);
-	ai->Execute()->GiveOrder(&c, m_myUnitId.id, "Builder::GiveRelaimOrder");
+	ai->Execute()->GiveOrder(&c, m_myUnitId.id, "Builder::GiveRelaimOrder", EOrderPriority::NORMAL);
 }
 
 
@@ -347,6 +349,8 @@ void AAIConstructor::GiveConstructionOrder(UnitDefId building, const float3& pos
 		Command c(-m_constructedDefId.id);
 		c.PushPos(m_buildPos);
 
+		// staged orders (e.g. to stop assisting) must not override the build order
+		ai->Execute()->DiscardStagedOrders(m_myUnitId);
 		ai->GetAICallback()->GiveOrder(m_myUnitId.id, &c);
 
 		// increase number of active units of that type/category
@@ -366,7 +370,7 @@ void AAIConstructor::AssistConstruction(UnitId constructorUnitId, bool factory)
 	c.PushParam(constructorUnitId.id);
 
 	//ai->Getcb()->GiveOrder(unit_id, &c);
-	ai->Execute()->GiveOrder(&c, m_myUnitId.id, "Builder::Assist");
+	ai->Execute()->GiveOrder(&c, m_myUnitId.id, "Builder::Assist", EOrderPriority::NORMAL);
 
 	m_activity.SetActivity(EConstructorActivity::ASSISTING);
 	m_assistUnitId = UnitId(constructorUnitId.id);
@@ -391,6 +395,7 @@ void AAIConstructor::TakeOverConstruction(AAIBuildTask *build_task)
 	c.PushParam(build_task->m_unitId.id);
 
 	m_activity.SetActivity(EConstructorActivity::CONSTRUCTING);
+	ai->Execute()->DiscardStagedOrders(m_myUnitId);
 	ai->GetAICallback()->GiveOrder(m_myUnitId.id, &c);
 }
 
@@ -457,7 +462,7 @@ void AAIConstructor::StopAssisting()
 
 	Command c(CMD_STOP);
 	//ai->Getcb()->GiveOrder(unit_id, &c);
-	ai->Execute()->GiveOrder(&c, m_myUnitId.id, "Builder::StopAssisting");
+	ai->Execute()->GiveOrder(&c, m_myUnitId.id, "Builder::StopAssisting", EOrderPriority::NORMAL);
 }
 void AAIConstructor::RemoveAssitant(int unit_id)
 {
@@ -517,7 +522,7 @@ void AAIConstructor::CheckRetreatFromAttackBy(const AAIUnitCategory& attackedByC
 			c.PushParam(ai->GetAICallback()->GetElevation(retreatPos.x, retreatPos.z));
 			c.PushParam(retreatPos.z);
 
-			ai->Execute()->GiveOrder(&c, m_myUnitId.id, "BuilderRetreat");
+			ai->Execute()->GiveOrder(&c, m_myUnitId.id, "BuilderRetreat", EOrderPriority::HIGH);
 			//ai->Getcb()->GiveOrder(unit_id, &c);
 		}
 	}
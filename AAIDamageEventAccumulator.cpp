@@ -0,0 +1,188 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "AAIDamageEventAccumulator.h"
+#include "AAI.h"
+#include "AAIBrain.h"
+#include "AAIExecute.h"
+#include "AAIMap.h"
+#include "AAISector.h"
+#include "AAIUnitTable.h"
+#include "AAIConstructor.h"
+
+#include "LegacyCpp/UnitDef.h"
+using namespace springLegacyAI;
+
+AAIDamageEventAccumulator::AAIDamageEventAccumulator(AAI* ai) :
+	ai(ai)
+{
+}
+
+void AAIDamageEventAccumulator::ProcessEvents()
+{
+	if(m_events.empty())
+		return;
+
+	// units are usually hit several times by the same attacker within one frame - handle every pair of damaged unit/attacker once
+	std::sort(m_events.begin(), m_events.end(), [](const DamageEvent& lhs, const DamageEvent& rhs) {
+		return (lhs.damaged < rhs.damaged) || ( (lhs.damaged == rhs.damaged) && (lhs.attacker < rhs.attacker) );
+	});
+	m_events.erase( std::unique(m_events.begin(), m_events.end(), [](const DamageEvent& lhs, const DamageEvent& rhs) {
+		return (lhs.damaged == rhs.damaged) && (lhs.attacker == rhs.attacker);
+	}), m_events.end());
+
+	DetermineAttackerData();
+
+	auto event = m_events.begin();
+
+	while(event != m_events.end())
+	{
+		// events of the same damaged unit
+		const int damaged = event->damaged;
+		auto lastEvent = std::find_if(event, m_events.end(), [damaged](const DamageEvent& other) { return other.damaged != damaged; });
+
+		const UnitDef* damagedDef = ai->GetAICallback()->GetUnitDef(damaged);
+
+		if(damagedDef == nullptr)
+		{
+			event = lastEvent;
+			continue;
+		}
+
+		const UnitId           unitId(damaged);
+		const UnitDefId        unitDefId(damagedDef->id);
+		const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(unitDefId);
+
+		// the enemy with the longest range determines whether unit may keep its distance
+		const AttackerData* longestRangeEnemy(nullptr);
+		float               longestRange(0.0f);
+
+		// builders retreat unless only attacked by scouts (see AAIConstructor::CheckRetreatFromAttackBy())
+		bool            retreat(false);
+		AAIUnitCategory retreatFromCategory(EUnitCategory::UNKNOWN);
+
+		for( ; event != lastEvent; ++event)
+		{
+			// events are unique per attacker, i.e. commander reacts to every unit that attacked it within this frame
+			if(category.IsCommander())
+				ai->Brain()->DefendCommander(event->attacker);
+
+			const AttackerData& attacker = GetAttackerData(event->attacker);
+
+			if(attacker.known == false)
+			{
+				if(category.IsMobileConstructor())
+				{
+					retreat             = true;
+					retreatFromCategory = AAIUnitCategory(EUnitCategory::UNKNOWN);
+				}
+			}
+			else if(attacker.enemy) // ignore friendly fire
+			{
+				if(category.IsCombatUnit())
+				{
+					const float range = ai->s_buildTree.GetMaxRange(attacker.unitDefId);
+
+					if( (longestRangeEnemy == nullptr) || (range > longestRange) )
+					{
+						longestRangeEnemy = &attacker;
+						longestRange      = range;
+					}
+				}
+
+				const AAITargetType& enemyTargetType = ai->s_buildTree.GetTargetType(attacker.unitDefId);
+
+				// building has been attacked
+				if(category.IsBuilding())
+					AddDefenceRequest(unitId, enemyTargetType, attacker.position, 115);
+				// builder
+				else if(category.IsMobileConstructor())
+				{
+					AddDefenceRequest(unitId, enemyTargetType, attacker.position, 110);
+
+					const AAIUnitCategory& enemyCategory = ai->s_buildTree.GetUnitCategory(attacker.unitDefId);
+
+					if( (retreat == false) || retreatFromCategory.IsScout() )
+						retreatFromCategory = enemyCategory;
+					retreat = true;
+				}
+				// normal units
+				else if(enemyTargetType.IsAir() && (ai->s_buildTree.GetUnitType(unitDefId).CanFightTargetType(enemyTargetType) == false) )
+					AddDefenceRequest(unitId, enemyTargetType, attacker.position, 105);
+			}
+		}
+
+		if(longestRangeEnemy)
+			ai->Execute()->CheckKeepDistanceToEnemy(unitId, unitDefId, longestRangeEnemy->unitDefId);
+
+		if(retreat && ai->UnitTable()->units[damaged].cons)
+			ai->UnitTable()->units[damaged].cons->CheckRetreatFromAttackBy(retreatFromCategory);
+	}
+
+	for(const DefenceRequest& request : m_defenceRequests)
+		ai->Execute()->DefendUnitVS(request.unitId, request.targetType, request.attackerPosition, request.importance);
+
+	m_events.clear();
+	m_attackers.clear();
+	m_defenceRequests.clear();
+}
+
+void AAIDamageEventAccumulator::DetermineAttackerData()
+{
+	for(const DamageEvent& event : m_events)
+		m_attackers.push_back( AttackerData(event.attacker) );
+
+	std::sort(m_attackers.begin(), m_attackers.end(), [](const AttackerData& lhs, const AttackerData& rhs) { return lhs.unitId < rhs.unitId; });
+	m_attackers.erase( std::unique(m_attackers.begin(), m_attackers.end(), [](const AttackerData& lhs, const AttackerData& rhs) { return lhs.unitId == rhs.unitId; }), m_attackers.end());
+
+	IAICallback* callback = ai->GetAICallback();
+	const int myAllyTeam  = callback->GetMyAllyTeam();
+
+	for(AttackerData& attacker : m_attackers)
+	{
+		const UnitDef* attackerDef = callback->GetUnitDef(attacker.unitId);
+
+		if(attackerDef)
+		{
+			attacker.known     = true;
+			attacker.unitDefId = UnitDefId(attackerDef->id);
+			attacker.enemy     = (callback->GetUnitAllyTeam(attacker.unitId) != myAllyTeam);
+
+			if(attacker.enemy)
+				attacker.position = callback->GetUnitPos(attacker.unitId);
+		}
+	}
+}
+
+const AAIDamageEventAccumulator::AttackerData& AAIDamageEventAccumulator::GetAttackerData(int attacker) const
+{
+	return *std::lower_bound(m_attackers.begin(), m_attackers.end(), attacker, [](const AttackerData& data, int unitId) { return data.unitId < unitId; });
+}
+
+void AAIDamageEventAccumulator::AddDefenceRequest(UnitId unitId, const AAITargetType& targetType, const float3& attackerPosition, int importance)
+{
+	const AAISector* sector = ai->Map()->GetSectorOfPos(attackerPosition);
+
+	if(sector == nullptr)
+		return;
+
+	for(DefenceRequest& request : m_defenceRequests)
+	{
+		if( (request.sector == sector) && (request.targetType.GetArrayIndex() == targetType.GetArrayIndex()) )
+		{
+			if(importance > request.importance)
+				request = DefenceRequest{sector, targetType, unitId, attackerPosition, importance};
+			return;
+		}
+	}
+
+	m_defenceRequests.push_back( DefenceRequest{sector, targetType, unitId, attackerPosition, importance} );
+}
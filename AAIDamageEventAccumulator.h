@@ -0,0 +1,92 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_DAMAGE_EVENT_ACCUMULATOR_H
+#define AAI_DAMAGE_EVENT_ACCUMULATOR_H
+
+#include <vector>
+
+#include "aidef.h"
+#include "AAITypes.h"
+#include "AAIUnitTypes.h"
+
+class AAI;
+class AAISector;
+
+//! @brief Collects the damage events reported by the engine and reacts to them in a single pass per frame (instead of once per event):
+//!        every damaged unit is handled once (considering all of its attackers), the data of every attacker is queried once,
+//!        and support to defend against an attacker is requested once per threatened sector and target type.
+class AAIDamageEventAccumulator
+{
+public:
+	AAIDamageEventAccumulator(AAI* ai);
+
+	//! @brief Stores the damage event (processed with the next call of ProcessEvents())
+	void AddEvent(UnitId damaged, UnitId attacker) { m_events.push_back( DamageEvent{damaged.id, attacker.id} ); }
+
+	//! @brief Reacts to all damage events recorded since the last call (retreat/keep distance, request support) and clears them
+	void ProcessEvents();
+
+private:
+	struct DamageEvent
+	{
+		int damaged;
+		int attacker;
+	};
+
+	//! Data of an attacker (queried once per pass)
+	struct AttackerData
+	{
+		AttackerData(int unitId) : unitId(unitId), known(false), enemy(false) {}
+
+		int       unitId;
+
+		//! Whether the unit definition of the attacker is known
+		bool      known;
+
+		//! Whether the attacker belongs to an enemy ally team (only set for known attackers)
+		bool      enemy;
+
+		UnitDefId unitDefId;
+
+		float3    position;
+	};
+
+	//! Request to defend a unit within the given sector against attackers of the given target type
+	struct DefenceRequest
+	{
+		const AAISector* sector;
+		AAITargetType    targetType;
+		UnitId           unitId;
+		float3           attackerPosition;
+		int              importance;
+	};
+
+	//! @brief Queries the data of all attackers of the recorded events (m_events must be sorted and unique)
+	void DetermineAttackerData();
+
+	//! @brief Returns the data of the given attacker (must have been determined before)
+	const AttackerData& GetAttackerData(int attacker) const;
+
+	//! @brief Adds a request to defend the given unit (replaces existing request for the same sector/target type if importance is higher)
+	void AddDefenceRequest(UnitId unitId, const AAITargetType& targetType, const float3& attackerPosition, int importance);
+
+	//! Damage events recorded since last pass
+	std::vector<DamageEvent>    m_events;
+
+	//! Attackers of the current pass (sorted by unit id)
+	std::vector<AttackerData>   m_attackers;
+
+	//! Requests for support of the current pass
+	std::vector<DefenceRequest> m_defenceRequests;
+
+	AAI* ai;
+};
+
+#endif
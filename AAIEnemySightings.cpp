@@ -0,0 +1,172 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIEnemySightings.h"
+#include "AAI.h"
+#include "AAIMap.h"
+#include "AAIUnitTable.h"
+#include "AAIMemoryUsage.h"
+
+#include "LegacyCpp/UnitDef.h"
+using namespace springLegacyAI;
+
+AAIEnemySightings::AAIEnemySightings(AAI* ai, int maxUnits) :
+	m_sightings(maxUnits),
+	m_nextSynchronizationFrame(0),
+	ai(ai)
+{
+}
+
+size_t AAIEnemySightings::GetMemoryUsage() const
+{
+	return GetAllocatedMemory(m_sightings) + GetAllocatedMemory(m_visibleUnits);
+}
+
+void AAIEnemySightings::EnemyEnteredLOS(UnitId unitId)
+{
+	if(IsValid(unitId) == false)
+		return;
+
+	AAIEnemySighting& sighting = m_sightings[unitId.id];
+
+	const UnitDef* def = ai->GetAICallback()->GetUnitDef(unitId.id);
+
+	sighting.inLOS            = true;
+	sighting.lastSeenPosition = ai->GetAICallback()->GetUnitPos(unitId.id);
+	sighting.lastSeenFrame    = ai->GetAICallback()->GetCurrentFrame();
+
+	if(def)
+	{
+		sighting.unitDefId = UnitDefId(def->id);
+
+		if(ai->Map()->IsPositionWithinMap(sighting.lastSeenPosition))
+			ai->UnitTable()->CheckBombTarget(unitId, sighting.unitDefId, ai->s_buildTree.GetUnitCategory(sighting.unitDefId), sighting.lastSeenPosition);
+	}
+
+	UpdateVisibility(unitId);
+}
+
+void AAIEnemySightings::EnemyLeftLOS(UnitId unitId)
+{
+	if(IsValid(unitId))
+	{
+		m_sightings[unitId.id].inLOS = false;
+		UpdateVisibility(unitId);
+	}
+}
+
+void AAIEnemySightings::EnemyEnteredRadar(UnitId unitId)
+{
+	if(IsValid(unitId))
+	{
+		AAIEnemySighting& sighting = m_sightings[unitId.id];
+
+		sighting.inRadar          = true;
+		sighting.lastSeenPosition = ai->GetAICallback()->GetUnitPos(unitId.id);
+		sighting.lastSeenFrame    = ai->GetAICallback()->GetCurrentFrame();
+
+		UpdateVisibility(unitId);
+	}
+}
+
+void AAIEnemySightings::EnemyLeftRadar(UnitId unitId)
+{
+	if(IsValid(unitId))
+	{
+		m_sightings[unitId.id].inRadar = false;
+		UpdateVisibility(unitId);
+	}
+}
+
+void AAIEnemySightings::EnemyDestroyed(UnitId unitId)
+{
+	if(IsValid(unitId))
+	{
+		m_sightings[unitId.id].inLOS   = false;
+		m_sightings[unitId.id].inRadar = false;
+		UpdateVisibility(unitId);
+
+		m_sightings[unitId.id] = AAIEnemySighting();
+	}
+}
+
+void AAIEnemySightings::UpdateVisibility(UnitId unitId)
+{
+	AAIEnemySighting& sighting = m_sightings[unitId.id];
+
+	if(sighting.IsVisible() && (sighting.visibleUnitsIndex < 0))
+	{
+		sighting.visibleUnitsIndex = static_cast<int>(m_visibleUnits.size());
+		m_visibleUnits.push_back(unitId);
+	}
+	else if(!sighting.IsVisible() && (sighting.visibleUnitsIndex >= 0))
+	{
+		// move last unit of the list to the free slot
+		const UnitId lastUnitId = m_visibleUnits.back();
+		m_visibleUnits[sighting.visibleUnitsIndex] = lastUnitId;
+		m_sightings[lastUnitId.id].visibleUnitsIndex = sighting.visibleUnitsIndex;
+		m_visibleUnits.pop_back();
+
+		sighting.visibleUnitsIndex = -1;
+	}
+}
+
+bool AAIEnemySightings::Synchronize(int frame, bool force)
+{
+	if( (force == false) && (frame < m_nextSynchronizationFrame) )
+		return false;
+
+	m_nextSynchronizationFrame = frame + AAIConstants::enemySightingsSynchronizationInterval;
+
+	std::vector<int>& unitIds = ai->Map()->UnitsInLOS();
+	const int numberOfEnemyUnits = ai->GetAICallback()->GetEnemyUnitsInRadarAndLos(&unitIds.front());
+
+	// units currently visible according to the engine
+	std::vector<bool> visible(m_sightings.size(), false);
+
+	for(int i = 0; i < numberOfEnemyUnits; ++i)
+	{
+		const UnitId unitId(unitIds[i]);
+
+		if(IsValid(unitId) == false)
+			continue;
+
+		visible[unitId.id] = true;
+
+		const bool inLOS = (ai->GetAICallback()->GetUnitDef(unitId.id) != nullptr);
+		AAIEnemySighting& sighting = m_sightings[unitId.id];
+
+		if(inLOS)
+		{
+			// repair sightings whose unit definition could not be determined when entering LOS (e.g. stale data)
+			if( (sighting.inLOS == false) || (sighting.unitDefId.IsValid() == false) )
+				EnemyEnteredLOS(unitId);
+		}
+		else if(sighting.inLOS || (sighting.inRadar == false))
+		{
+			sighting.inLOS = false;
+			EnemyEnteredRadar(unitId);
+		}
+	}
+
+	// remove units that are no longer visible (iterate backwards as units are removed by swapping with last one)
+	for(int i = static_cast<int>(m_visibleUnits.size()) - 1; i >= 0; --i)
+	{
+		const UnitId unitId = m_visibleUnits[i];
+
+		if(visible[unitId.id] == false)
+		{
+			m_sightings[unitId.id].inLOS   = false;
+			m_sightings[unitId.id].inRadar = false;
+			UpdateVisibility(unitId);
+		}
+	}
+
+	return true;
+}
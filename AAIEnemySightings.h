@@ -0,0 +1,109 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_ENEMY_SIGHTINGS_H
+#define AAI_ENEMY_SIGHTINGS_H
+
+#include <vector>
+
+#include "aidef.h"
+#include "System/float3.h"
+
+class AAI;
+
+//! What is known about an enemy unit that is or has been within LOS/radar
+struct AAIEnemySighting
+{
+	AAIEnemySighting() : lastSeenPosition(ZeroVector), lastSeenFrame(-1), inLOS(false), inRadar(false), finished(false), visibleUnitsIndex(-1) {}
+
+	//! @brief Returns whether the unit is currently within LOS or radar
+	bool IsVisible() const { return inLOS || inRadar; }
+
+	//! Unit type (invalid if unit has never been within LOS)
+	UnitDefId unitDefId;
+
+	//! Position when the unit has been seen/updated the last time (with radar error if only detected by radar)
+	float3    lastSeenPosition;
+
+	//! Frame in which the unit has been seen/updated the last time (-1 if never)
+	int       lastSeenFrame;
+
+	bool      inLOS;
+	bool      inRadar;
+
+	//! Whether unit has been seen after its construction has been finished
+	bool      finished;
+
+	//! Index in the list of visible units (-1 if not visible)
+	int       visibleUnitsIndex;
+};
+
+//! @brief Table of the enemy units within LOS/radar (indexed by unit id) maintained by the EnemyEnter/LeaveLOS/Radar events.
+//!        The periodic update of the units in LOS only needs to refresh the units listed as visible. As a safeguard against
+//!        missed events (e.g. units that changed team), the table is synchronized with the engine at a low rate.
+class AAIEnemySightings
+{
+public:
+	AAIEnemySightings(AAI* ai, int maxUnits);
+
+	//! @brief Enemy unit has entered LOS: stores unit type and position; checks whether buildings shall be added to the bomb targets
+	void EnemyEnteredLOS(UnitId unitId);
+
+	void EnemyLeftLOS(UnitId unitId);
+
+	void EnemyEnteredRadar(UnitId unitId);
+
+	void EnemyLeftRadar(UnitId unitId);
+
+	//! @brief Discards the data of the given unit
+	void EnemyDestroyed(UnitId unitId);
+
+	//! @brief Adds visible units that are not yet listed and removes listed units that are no longer visible (expensive - queries all enemy
+	//!        units within LOS/radar); returns whether synchronization has been performed, i.e. it was due or forced.
+	bool Synchronize(int frame, bool force);
+
+	//! @brief Returns the ids of the enemy units currently within LOS or radar
+	const std::vector<UnitId>& GetVisibleUnits() const { return m_visibleUnits; }
+
+	//! @brief Returns the data of the given unit
+	const AAIEnemySighting& GetSighting(UnitId unitId) const { return m_sightings[unitId.id]; }
+
+	//! @brief Updates the position of the given unit
+	void UpdatePosition(UnitId unitId, const float3& position, int frame)
+	{
+		m_sightings[unitId.id].lastSeenPosition = position;
+		m_sightings[unitId.id].lastSeenFrame    = frame;
+	}
+
+	//! @brief Marks the construction of the given unit as finished
+	void SetFinished(UnitId unitId) { m_sightings[unitId.id].finished = true; }
+
+	//! @brief Returns the memory (in bytes) allocated by the table
+	size_t GetMemoryUsage() const;
+
+private:
+	//! @brief Returns whether the given unit id can be stored in the table
+	bool IsValid(UnitId unitId) const { return (unitId.id >= 0) && (unitId.id < static_cast<int>(m_sightings.size())); }
+
+	//! @brief Adds unit to/removes unit from the list of visible units according to its LOS/radar state
+	void UpdateVisibility(UnitId unitId);
+
+	//! Data of all units (indexed by unit id)
+	std::vector<AAIEnemySighting> m_sightings;
+
+	//! Ids of the units currently within LOS/radar
+	std::vector<UnitId>           m_visibleUnits;
+
+	//! Frame of the next synchronization with the engine
+	int                           m_nextSynchronizationFrame;
+
+	AAI* ai;
+};
+
+#endif
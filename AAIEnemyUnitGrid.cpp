@@ -0,0 +1,169 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+#include <utility>
+
+#include "AAIEnemyUnitGrid.h"
+#include "AAIMemoryUsage.h"
+
+AAIEnemyUnitGrid::AAIEnemyUnitGrid(float xMapSize, float zMapSize, float cellSize) :
+	m_cellSize(cellSize),
+	m_inverseCellSize(1.0f / cellSize),
+	m_xCells(std::max(static_cast<int>(xMapSize / cellSize + 0.999f), 1)),
+	m_zCells(std::max(static_cast<int>(zMapSize / cellSize + 0.999f), 1))
+{
+	m_cellStart.resize(m_xCells * m_zCells + 1, 0);
+}
+
+size_t AAIEnemyUnitGrid::GetMemoryUsage() const
+{
+	return GetAllocatedMemory(m_cellStart) + GetAllocatedMemory(m_units) + GetAllocatedMemory(m_addedUnits) + GetAllocatedMemory(m_cellOfAddedUnit);
+}
+
+void AAIEnemyUnitGrid::FinishUpdate()
+{
+	// counting sort of the added units by cell
+	std::fill(m_cellStart.begin(), m_cellStart.end(), 0);
+	m_cellOfAddedUnit.resize(m_addedUnits.size());
+
+	for(size_t i = 0; i < m_addedUnits.size(); ++i)
+	{
+		const int cell = GetCellX(m_addedUnits[i].position.x) + m_xCells * GetCellZ(m_addedUnits[i].position.z);
+		m_cellOfAddedUnit[i] = cell;
+		++m_cellStart[cell+1];
+	}
+
+	for(size_t cell = 1; cell < m_cellStart.size(); ++cell)
+		m_cellStart[cell] += m_cellStart[cell-1];
+
+	std::vector<int> nextIndexOfCell(m_cellStart.begin(), m_cellStart.end()-1);
+
+	m_units.clear();
+	m_units.resize(m_addedUnits.size(), AAIEnemyUnit(UnitId(), UnitDefId(), AAITargetType(), ZeroVector));
+
+	for(size_t i = 0; i < m_addedUnits.size(); ++i)
+		m_units[nextIndexOfCell[m_cellOfAddedUnit[i]]++] = m_addedUnits[i];
+
+	m_addedUnits.clear();
+}
+
+void AAIEnemyUnitGrid::GetUnitsInRadius(const float3& position, float radius, bool losOnly, std::vector<const AAIEnemyUnit*>& enemyUnits) const
+{
+	enemyUnits.clear();
+
+	const float squaredRadius = radius * radius;
+
+	const int xStart = GetCellX(position.x - radius);
+	const int xEnd   = GetCellX(position.x + radius);
+	const int zStart = GetCellZ(position.z - radius);
+	const int zEnd   = GetCellZ(position.z + radius);
+
+	for(int z = zStart; z <= zEnd; ++z)
+	{
+		for(int x = xStart; x <= xEnd; ++x)
+		{
+			const int cell = x + m_xCells * z;
+
+			for(int i = m_cellStart[cell]; i < m_cellStart[cell+1]; ++i)
+			{
+				if(Matches(m_units[i], losOnly) && (GetSquaredDistance(m_units[i].position, position) <= squaredRadius))
+					enemyUnits.push_back(&m_units[i]);
+			}
+		}
+	}
+}
+
+bool AAIEnemyUnitGrid::IsUnitInRadius(const float3& position, float radius, bool losOnly) const
+{
+	const float squaredRadius = radius * radius;
+
+	const int xStart = GetCellX(position.x - radius);
+	const int xEnd   = GetCellX(position.x + radius);
+	const int zStart = GetCellZ(position.z - radius);
+	const int zEnd   = GetCellZ(position.z + radius);
+
+	for(int z = zStart; z <= zEnd; ++z)
+	{
+		for(int x = xStart; x <= xEnd; ++x)
+		{
+			const int cell = x + m_xCells * z;
+
+			for(int i = m_cellStart[cell]; i < m_cellStart[cell+1]; ++i)
+			{
+				if(Matches(m_units[i], losOnly) && (GetSquaredDistance(m_units[i].position, position) <= squaredRadius))
+					return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void AAIEnemyUnitGrid::GetNearestUnits(const float3& position, int numberOfUnits, bool losOnly, std::vector<const AAIEnemyUnit*>& enemyUnits) const
+{
+	enemyUnits.clear();
+
+	if( (numberOfUnits <= 0) || m_units.empty() )
+		return;
+
+	// candidates (squared distance, unit) found so far
+	std::vector< std::pair<float, const AAIEnemyUnit*> > candidates;
+
+	const int xCenter  = GetCellX(position.x);
+	const int zCenter  = GetCellZ(position.z);
+	const int maxRing  = std::max(std::max(xCenter, m_xCells - 1 - xCenter), std::max(zCenter, m_zCells - 1 - zCenter));
+
+	// search rings of cells around the cell containing the position until no unit in the next ring can be closer than the found ones
+	for(int ring = 0; ring <= maxRing; ++ring)
+	{
+		for(int z = zCenter - ring; z <= zCenter + ring; ++z)
+		{
+			if( (z < 0) || (z >= m_zCells) )
+				continue;
+
+			// inner cells of the ring have been searched before
+			const bool borderRow = (z == zCenter - ring) || (z == zCenter + ring);
+			const int  xStep     = borderRow ? 1 : std::max(2 * ring, 1);
+
+			for(int x = xCenter - ring; x <= xCenter + ring; x += xStep)
+			{
+				if( (x < 0) || (x >= m_xCells) )
+					continue;
+
+				const int cell = x + m_xCells * z;
+
+				for(int i = m_cellStart[cell]; i < m_cellStart[cell+1]; ++i)
+				{
+					if(Matches(m_units[i], losOnly))
+						candidates.push_back( std::make_pair(GetSquaredDistance(m_units[i].position, position), &m_units[i]) );
+				}
+			}
+		}
+
+		if(static_cast<int>(candidates.size()) >= numberOfUnits)
+		{
+			// minimum distance of any position in the next ring to the given position
+			// (position may lie outside of the grid, i.e. outside of the searched cells)
+			const float distanceToNextRing = std::max(0.0f, std::min( std::min(position.x - static_cast<float>(xCenter - ring) * m_cellSize, static_cast<float>(xCenter + ring + 1) * m_cellSize - position.x),
+			                                                          std::min(position.z - static_cast<float>(zCenter - ring) * m_cellSize, static_cast<float>(zCenter + ring + 1) * m_cellSize - position.z) ) );
+
+			std::nth_element(candidates.begin(), candidates.begin() + (numberOfUnits-1), candidates.end());
+
+			if(candidates[numberOfUnits-1].first <= distanceToNextRing * distanceToNextRing)
+				break;
+		}
+	}
+
+	const int foundUnits = std::min(numberOfUnits, static_cast<int>(candidates.size()));
+	std::partial_sort(candidates.begin(), candidates.begin() + foundUnits, candidates.end());
+
+	for(int i = 0; i < foundUnits; ++i)
+		enemyUnits.push_back(candidates[i].second);
+}
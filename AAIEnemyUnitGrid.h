@@ -0,0 +1,109 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_ENEMY_UNIT_GRID_H
+#define AAI_ENEMY_UNIT_GRID_H
+
+#include <algorithm>
+#include <vector>
+
+#include "aidef.h"
+#include "AAIUnitTypes.h"
+#include "System/float3.h"
+
+//! An enemy unit within LOS or radar as stored in the enemy unit grid
+struct AAIEnemyUnit
+{
+	AAIEnemyUnit(UnitId unitId, UnitDefId unitDefId, const AAITargetType& targetType, const float3& position) :
+		unitId(unitId), unitDefId(unitDefId), targetType(targetType), position(position) {}
+
+	//! @brief Returns whether unit is within line of sight (unit type is unknown for units only detected by radar)
+	bool IsInLOS() const { return unitDefId.IsValid(); }
+
+	UnitId        unitId;
+
+	//! Unit type (invalid if unit is only on radar)
+	UnitDefId     unitDefId;
+
+	//! Target type (unknown if unit is only on radar)
+	AAITargetType targetType;
+
+	//! Position when the grid has been updated the last time
+	float3        position;
+};
+
+//! @brief Uniform grid storing the enemy units within LOS/radar to answer local queries (units within radius, nearest units) without calling
+//!        the engine. It is rebuilt with the data gathered during the update of the units in LOS (see AAIMap::UpdateEnemyUnitsInLOS()),
+//!        i.e. positions are those of the last update. Units are stored sorted by cell (cell i owns the units m_cellStart[i] to m_cellStart[i+1]-1).
+class AAIEnemyUnitGrid
+{
+public:
+	//! @brief Creates grid covering the map of the given size (in unit coordinates) with cells of the given size
+	AAIEnemyUnitGrid(float xMapSize, float zMapSize, float cellSize);
+
+	//! @brief Discards the units added since the last call of FinishUpdate() (units of the last update remain accessible)
+	void StartUpdate() { m_addedUnits.clear(); }
+
+	//! @brief Adds the given unit (positions outside of the map are assigned to the closest cell at the border)
+	void AddUnit(const AAIEnemyUnit& enemyUnit) { m_addedUnits.push_back(enemyUnit); }
+
+	//! @brief Replaces the stored units with the units added since the last call of StartUpdate()
+	void FinishUpdate();
+
+	//! @brief Returns the number of stored units
+	int GetNumberOfUnits() const { return static_cast<int>(m_units.size()); }
+
+	//! @brief Returns the memory (in bytes) allocated by the grid
+	size_t GetMemoryUsage() const;
+
+	//! @brief Returns the units within the given radius (2D distance) around the given position (optionally only units within LOS)
+	void GetUnitsInRadius(const float3& position, float radius, bool losOnly, std::vector<const AAIEnemyUnit*>& enemyUnits) const;
+
+	//! @brief Returns whether there is at least one unit within the given radius (2D distance) around the given position
+	bool IsUnitInRadius(const float3& position, float radius, bool losOnly) const;
+
+	//! @brief Returns the given number of units closest to the given position (sorted by ascending distance; fewer if not enough units stored)
+	void GetNearestUnits(const float3& position, int numberOfUnits, bool losOnly, std::vector<const AAIEnemyUnit*>& enemyUnits) const;
+
+private:
+	//! @brief Returns the index of the cell the given coordinate belongs to (clamped to the grid)
+	int GetCellX(float x) const { return std::max(0, std::min(static_cast<int>(x * m_inverseCellSize), m_xCells-1)); }
+	int GetCellZ(float z) const { return std::max(0, std::min(static_cast<int>(z * m_inverseCellSize), m_zCells-1)); }
+
+	//! @brief Returns whether the unit shall be considered in a query
+	static bool Matches(const AAIEnemyUnit& enemyUnit, bool losOnly) { return (losOnly == false) || enemyUnit.IsInLOS(); }
+
+	//! @brief Returns the squared 2D distance between the given positions
+	static float GetSquaredDistance(const float3& lhs, const float3& rhs)
+	{
+		const float dx = lhs.x - rhs.x;
+		const float dz = lhs.z - rhs.z;
+		return dx*dx + dz*dz;
+	}
+
+	float m_cellSize;
+	float m_inverseCellSize;
+
+	int   m_xCells;
+	int   m_zCells;
+
+	//! Index of the first unit of every cell in m_units (one additional entry marking the end of the last cell)
+	std::vector<int>          m_cellStart;
+
+	//! The units sorted by cell
+	std::vector<AAIEnemyUnit> m_units;
+
+	//! The units added in the current update
+	std::vector<AAIEnemyUnit> m_addedUnits;
+
+	//! Cell index of every added unit (buffer reused in every update)
+	std::vector<int>          m_cellOfAddedUnit;
+};
+
+#endif
@@ -18,6 +18,8 @@
 #include "AAIMap.h"
 #include "AAIGroup.h"
 #include "AAISector.h"
+#include "AAIIncrementalPlanner.h"
+#include "AAIMemoryUsage.h"
 
 #include "LegacyCpp/UnitDef.h"
 #include "LegacyCpp/CommandQueue.h"
@@ -28,6 +30,44 @@ using namespace springLegacyAI;
 float AAIExecute::current = 0.5f;
 float AAIExecute::learned = 2.5f;
 
+//! Selects a combat unit based on a (shared, immutable) candidate table and copies of the selection criteria
+class AAICombatUnitSelectionTask : public AAIPlanningTask
+{
+public:
+	AAICombatUnitSelectionTask(AAIExecute* execute, std::shared_ptr<const CombatUnitCandidateTable> candidates, const TargetTypeValues& combatPowerCriteria, 
+	                           const UnitSelectionCriteria& unitSelectionCriteria, const std::vector<float>& factoryUtilization, std::vector<float>&& randomValues) :
+		m_execute(execute),
+		m_candidates(candidates),
+		m_combatPowerCriteria(combatPowerCriteria),
+		m_unitSelectionCriteria(unitSelectionCriteria),
+		m_factoryUtilization(factoryUtilization),
+		m_randomValues(std::move(randomValues))
+	{
+	}
+
+	void Plan() override
+	{
+		m_selectedUnitDefId = AAIBuildTable::SelectCombatUnit(*m_candidates, m_combatPowerCriteria, m_unitSelectionCriteria, m_factoryUtilization, m_randomValues, m_weightedCombatPowers, m_ratingTable);
+	}
+
+	void Commit() override
+	{
+		if(m_selectedUnitDefId.IsValid())
+			m_execute->OrderCombatUnit(m_selectedUnitDefId);
+	}
+
+private:
+	AAIExecute*                                     m_execute;
+	std::shared_ptr<const CombatUnitCandidateTable> m_candidates;
+	TargetTypeValues                                m_combatPowerCriteria;
+	UnitSelectionCriteria                           m_unitSelectionCriteria;
+	std::vector<float>                              m_factoryUtilization;
+	std::vector<float>                              m_randomValues;
+	std::vector<float>                              m_weightedCombatPowers;
+	UnitTypeRatingTable                             m_ratingTable;
+	UnitDefId                                       m_selectedUnitDefId;
+};
+
 AAIExecute::AAIExecute(AAI *ai) :
 	m_constructionUrgency(AAIUnitCategory::numberOfUnitCategories, 0.0f),
 	m_constructionFunctions(AAIUnitCategory::numberOfUnitCategories, nullptr),
@@ -35,6 +75,7 @@ AAIExecute::AAIExecute(AAI *ai) :
 	m_nextDefenceVsTargetType(ETargetType::UNKNOWN),
 	m_unitProductionRate (1),
 	m_numberOfIssuedOrders(0),
+	m_orderStaging(ai, cfg->MAX_UNITS),
 	m_linkingBuildTaskToBuilderFailed(0u)
 {
 	this->ai = ai;
@@ -53,6 +94,11 @@ AAIExecute::~AAIExecute(void)
 {
 }
 
+size_t AAIExecute::GetMemoryUsage() const
+{
+	return GetAllocatedMemory(m_buildqueues) + GetAllocatedMemory(m_constructionUrgency) + GetAllocatedMemory(m_constructionFunctions) + m_orderStaging.GetMemoryUsage();
+}
+
 void AAIExecute::InitAI(UnitId commanderUnitId, UnitDefId commanderDefId)
 {
 	//debug
@@ -101,13 +147,13 @@ void AAIExecute::InitAI(UnitId commanderUnitId, UnitDefId commanderDefId)
 	CheckRessources();
 }
 
-void AAIExecute::MoveUnitTo(int unit, float3 *position)
+void AAIExecute::MoveUnitTo(int unit, float3 *position, EOrderPriority priority)
 {
 	Command c(CMD_MOVE);
 	c.PushPos(*position);
 
 	//ai->Getcb()->GiveOrder(unit, &c);
-	GiveOrder(&c, unit, "MoveUnitTo");
+	GiveOrder(&c, unit, "MoveUnitTo", priority);
 	ai->UnitTable()->SetUnitStatus(unit, MOVING);
 }
 
@@ -116,7 +162,7 @@ void AAIExecute::stopUnit(int unit)
 	Command c(CMD_STOP);
 
 	//ai->Getcb()->GiveOrder(unit, &c);
-	GiveOrder(&c, unit, "StopUnit");
+	GiveOrder(&c, unit, "StopUnit", EOrderPriority::NORMAL);
 	ai->UnitTable()->SetUnitStatus(unit, UNIT_IDLE);
 }
 
@@ -166,32 +212,43 @@ void AAIExecute::AddUnitToGroup(const UnitId& unitId, const UnitDefId& unitDefId
 void AAIExecute::BuildCombatUnitOfCategory(const AAIMovementType& moveType, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitSelectionCriteria, const std::vector<float>& factoryUtilization, bool urgent)
 {
 	// determine random float in [0:1]
-	const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+	const float randomValue = 0.01f * static_cast<float>(ai->Random().GetInteger(101));
 
 	// select unit independently from available constructor from time to time (to make sure AAI will order factories for advanced units as the game progresses)
 	const float contructorRequiredRate = moveType.IsAir() ? 0.5f : 0.85f;
 	const bool  constructorAvailable = (randomValue < contructorRequiredRate) && (ai->UnitTable()->activeFactories > 0);
 
-	const UnitDefId unitDefId = ai->BuildTable()->SelectCombatUnit(ai->GetSide(), moveType, combatPowerCriteria, unitSelectionCriteria, factoryUtilization, 6, constructorAvailable);
+	std::shared_ptr<const CombatUnitCandidateTable> candidates = ai->BuildTable()->GetCombatUnitCandidates(ai->GetSide(), moveType, constructorAvailable);
 
-	// Order construction of selected unit
-	if(unitDefId.IsValid())
-	{
-		const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(unitDefId);
-		const StatisticalData& costStatistics = ai->s_buildTree.GetUnitStatistics(ai->GetSide()).GetUnitCostStatistics(category);
+	if(candidates->GetNumberOfCandidates() == 0)
+		return;
 
-		int numberOfUnits(1);
+	// random part of the rating is determined here to keep the sequence of random numbers independent from the planning worker
+	std::vector<float> randomValues(candidates->GetNumberOfCandidates());
 
-		if(ai->s_buildTree.GetTotalCost(unitDefId) < cfg->MAX_COST_LIGHT_ASSAULT * costStatistics.GetMaxValue())
-			numberOfUnits = 3;
-		else if(ai->s_buildTree.GetTotalCost(unitDefId) < cfg->MAX_COST_MEDIUM_ASSAULT * costStatistics.GetMaxValue())
-			numberOfUnits = 2;
-		
-		if( ai->BuildTable()->units_dynamic[unitDefId.id].constructorsAvailable <= 0 )
-			ai->BuildTable()->RequestFactoryFor(unitDefId);
-		else
-			AddUnitToBuildqueue(unitDefId, numberOfUnits, BuildQueuePosition::END);
-	}
+	for(auto& value : randomValues)
+		value = 0.1f * static_cast<float>(ai->Random().GetInteger(6));
+
+	std::unique_ptr<AAIPlanningTask> planningTask(new AAICombatUnitSelectionTask(this, candidates, combatPowerCriteria, unitSelectionCriteria, factoryUtilization, std::move(randomValues)));
+	AAI::s_planningWorker.AddTask(ai, std::move(planningTask));
+}
+
+void AAIExecute::OrderCombatUnit(UnitDefId unitDefId)
+{
+	const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(unitDefId);
+	const StatisticalData& costStatistics = ai->s_buildTree.GetUnitStatistics(ai->GetSide()).GetUnitCostStatistics(category);
+
+	int numberOfUnits(1);
+
+	if(ai->s_buildTree.GetTotalCost(unitDefId) < cfg->MAX_COST_LIGHT_ASSAULT * costStatistics.GetMaxValue())
+		numberOfUnits = 3;
+	else if(ai->s_buildTree.GetTotalCost(unitDefId) < cfg->MAX_COST_MEDIUM_ASSAULT * costStatistics.GetMaxValue())
+		numberOfUnits = 2;
+	
+	if( ai->BuildTable()->units_dynamic[unitDefId.id].constructorsAvailable <= 0 )
+		ai->BuildTable()->RequestFactoryFor(unitDefId);
+	else
+		AddUnitToBuildqueue(unitDefId, numberOfUnits, BuildQueuePosition::END);
 }
 
 void AAIExecute::BuildScouts()
@@ -224,7 +281,7 @@ void AAIExecute::BuildScouts()
 			else
 			{
 				// sometimes prefer scouts with large los in late game
-				if(rand()%3 == 1)
+				if(ai->Random().GetInteger(3) == 1)
 				{
 					cost = 0.5f;
 					sightRange = 4.0f;
@@ -242,7 +299,7 @@ void AAIExecute::BuildScouts()
 		const uint32_t suitableMovementTypes = ai->Map()->GetSuitableMovementTypesForMap();
 
 		// request cloakable scouts from time to time
-		const float cloaked = (rand()%5 == 1) ? 1.0f : 0.25f;
+		const float cloaked = (ai->Random().GetInteger(5) == 1) ? 1.0f : 0.25f;
 		
 		const UnitDefId scoutId = ai->BuildTable()->SelectScout(ai->GetSide(), sightRange, cost, cloaked, suitableMovementTypes, 10, availableFactoryNeeded);
 
@@ -260,7 +317,7 @@ void AAIExecute::SendScoutToNewDest(int scout)
 	float3 nextScoutDestination = ai->Map()->GetNewScoutDest(UnitId(scout));
 
 	if(nextScoutDestination.x > 0.0f)
-		MoveUnitTo(scout, &nextScoutDestination);
+		MoveUnitTo(scout, &nextScoutDestination, EOrderPriority::LOW);
 }
 
 BuildSite AAIExecute::DetermineBuildsite(UnitId builder, UnitDefId buildingDefId) const
@@ -465,11 +522,11 @@ BuildOrderStatus AAIExecute::TryConstructionOf(UnitDefId building, const AAISect
 		else
 		{
 			if(ai->s_buildTree.GetMovementType(building).IsStaticLand() )
-				ai->Brain()->ExpandBase(EMapType::LAND);
+				ai->Brain()->RequestBaseExpansion(EMapType::LAND);
 			else
-				ai->Brain()->ExpandBase(EMapType::WATER);
+				ai->Brain()->RequestBaseExpansion(EMapType::WATER);
 
-			ai->Log("Base expanded when looking for buildsite for %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str());
+			ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "Base expansion requested when looking for buildsite for %s\n", ai->s_buildTree.GetUnitTypeProperties(building).m_name.c_str());
 			return BuildOrderStatus::NO_BUILDSITE_FOUND;
 		}
 	}
@@ -543,7 +600,7 @@ bool AAIExecute::BuildExtractor()
 			{
 				for(auto spot : sector->metalSpots)
 				{
-					if(!spot->occupied)
+					if(spot->IsOccupied() == false)
 					{
 						freeMetalSpotFound = true;
 
@@ -574,9 +631,12 @@ bool AAIExecute::BuildExtractor()
 	{
 		const AvailableMetalSpot& metalSpot = (extractorSpots.begin())->first;
 
+		// occupy spot before ordering the construction (as another AAI instance may have taken it in the meantime)
+		if(metalSpot.metalSpot->Occupy() == false)
+			return false;
+
 		// order mex construction for best spot
 		metalSpot.builder->GiveConstructionOrder(metalSpot.extractor, metalSpot.metalSpot->pos);
-		metalSpot.metalSpot->occupied = true;
 
 		AAISector* sector = ai->Map()->GetSectorOfPos(metalSpot.metalSpot->pos);
 
@@ -658,7 +718,7 @@ bool AAIExecute::BuildPowerPlant()
 	{
 		// probability of trying to build sea power plant first is related to current water ratio of the base
 		// determine random float in [0:1]
-		const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+		const float randomValue = 0.01f * static_cast<float>(ai->Random().GetInteger(101));
 
 		if( randomValue < ai->Brain()->GetBaseWaterRatio() )
 		{
@@ -839,8 +899,8 @@ bool AAIExecute::BuildMetalMaker()
 				}
 				else
 				{
-					ai->Brain()->ExpandBase(EMapType::LAND);
-					ai->Log("Base expanded by BuildMetalMaker()\n");
+					ai->Brain()->RequestBaseExpansion(EMapType::LAND);
+					ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "Base expansion requested by BuildMetalMaker()\n");
 				}
 			}
 		}
@@ -879,8 +939,8 @@ bool AAIExecute::BuildMetalMaker()
 				}
 				else
 				{
-					ai->Brain()->ExpandBase(EMapType::WATER);
-					ai->Log("Base expanded by BuildMetalMaker() (water sector)\n");
+					ai->Brain()->RequestBaseExpansion(EMapType::WATER);
+					ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "Base expansion requested by BuildMetalMaker() (water sector)\n");
 				}
 			}
 		}
@@ -916,7 +976,7 @@ bool AAIExecute::BuildStorage()
 
 	// probability of trying to build sea power plant first is related to current water ratio of the base
 	// determine random float in [0:1]
-	const float randomValue = 0.01f * static_cast<float>(std::rand()%101);
+	const float randomValue = 0.01f * static_cast<float>(ai->Random().GetInteger(101));
 
 	if( randomValue < ai->Brain()->GetBaseWaterRatio() )
 	{
@@ -1014,7 +1074,7 @@ bool AAIExecute::BuildAirBase()
 				else
 				{
 					ai->Getbrain()->ExpandBase(LAND_SECTOR);
-					ai->Log("Base expanded by BuildAirBase()\n");
+					ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "Base expanded by BuildAirBase()\n");
 				}
 			}
 		}
@@ -1054,7 +1114,7 @@ bool AAIExecute::BuildAirBase()
 				else
 				{
 					ai->Getbrain()->ExpandBase(WATER_SECTOR);
-					ai->Log("Base expanded by BuildAirBase() (water sector)\n");
+					ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "Base expanded by BuildAirBase() (water sector)\n");
 				}
 			}
 		}
@@ -1063,38 +1123,173 @@ bool AAIExecute::BuildAirBase()
 	return true;*/
 }
 
+//! @brief Returns the name of the planner for static defences in the given sector vs the given target type
+//!        (at most one planner per sector and target type is pending at the same time)
+static std::string GetStaticDefencePlannerName(const AAISector* sector, const AAITargetType& targetType)
+{
+	return "Static-Defence " + std::to_string(sector->x) + "," + std::to_string(sector->y) + " vs " + targetType.GetName();
+}
+
+//! Selects static defence and its buildsite in the given sector in several steps and orders its construction
+class AAIStaticDefencePlanner : public AAIIncrementalPlanner
+{
+public:
+	AAIStaticDefencePlanner(AAI* ai, AAISector* sector, const StaticDefenceSelectionCriteria& selectionCriteria, bool handleFailure) :
+		ai(ai),
+		m_name(GetStaticDefencePlannerName(sector, selectionCriteria.targetType)),
+		m_sector(sector),
+		m_selectionCriteria(selectionCriteria),
+		m_handleFailure(handleFailure),
+		m_currentTry(0),
+		m_searchStarted(false),
+		m_replanned(false),
+		m_status(BuildOrderStatus::BUILDING_INVALID)
+	{
+		// try land defences first, sea defences afterwards
+		if(sector->GetWaterTilesRatio() < 0.85f)
+			m_tries.push_back(false);
+
+		if(sector->GetWaterTilesRatio() > 0.15f)
+			m_tries.push_back(true);
+	}
+
+	bool Step() override
+	{
+		if(m_currentTry >= static_cast<int>(m_tries.size()))
+			return true;
+
+		if(m_searchStarted == false)
+		{
+			const UnitDefId selectedDefence = ai->BuildTable()->SelectStaticDefence(ai->GetSide(), m_selectionCriteria, m_tries[m_currentTry]);
+
+			if(selectedDefence.IsValid() == false)
+			{
+				ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::WARNINGS, "No static Defence found!\n");
+				m_status = BuildOrderStatus::BUILDING_INVALID;
+				++m_currentTry;
+				return (m_currentTry >= static_cast<int>(m_tries.size()));
+			}
+
+			ai->Map()->StartBuildsiteSearchForStaticDefence(m_search, selectedDefence, m_sector, m_selectionCriteria.targetType, m_selectionCriteria.terrain);
+			m_searchStarted = true;
+			return false;
+		}
+
+		return ai->Map()->ContinueBuildsiteSearchForStaticDefence(m_search, AAIConstants::plannerTilesPerStep);
+	}
+
+	bool Commit() override
+	{
+		if(m_currentTry >= static_cast<int>(m_tries.size()))
+			return Finish(m_status);
+
+		if(m_search.buildsite.IsValid() == false)
+			return TryNext(BuildOrderStatus::NO_BUILDSITE_FOUND);
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// check if construction is still desired/possible (situation may have changed since planning has been started)
+		//-----------------------------------------------------------------------------------------------------------------
+		if( (m_sector->GetNumberOfAlliedBuildings() > 2) || ai->Execute()->IsExpensiveStaticDefenceUnderConstruction(m_sector) )
+			return Finish(BuildOrderStatus::SUCCESSFUL);
+
+		if(ai->Map()->IsBuildsiteForStaticDefenceValid(m_search) == false)
+		{
+			// buildsite has been occupied in the meantime -> search again (once)
+			if(m_replanned == false)
+			{
+				m_replanned     = true;
+				m_searchStarted = false;
+				return false;
+			}
+
+			return TryNext(BuildOrderStatus::NO_BUILDSITE_FOUND);
+		}
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// order construction
+		//-----------------------------------------------------------------------------------------------------------------
+		const float3& buildsite = m_search.buildsite.Position();
+		const AvailableConstructor selectedConstructor = ai->UnitTable()->FindClosestBuilder(m_search.staticDefence, buildsite, ai->Brain()->IsCommanderAllowedForConstructionInSector(m_sector));
+
+		if(selectedConstructor.IsValid())
+		{
+			selectedConstructor.Constructor()->GiveConstructionOrder(m_search.staticDefence, buildsite);
+			ai->Map()->AddOrRemoveStaticDefence(buildsite, m_search.staticDefence, true);
+			return Finish(BuildOrderStatus::SUCCESSFUL);
+		}
+
+		ai->BuildTable()->RequestBuilderFor(m_search.staticDefence);
+		return TryNext(BuildOrderStatus::NO_BUILDER_AVAILABLE);
+	}
+
+	const char* GetName() const override { return m_name.c_str(); }
+
+private:
+	//! @brief Continues with the next try (if any left); returns true if planning is finished
+	bool TryNext(BuildOrderStatus status)
+	{
+		m_status        = status;
+		m_searchStarted = false;
+		m_replanned     = false;
+		++m_currentTry;
+
+		if(m_currentTry >= static_cast<int>(m_tries.size()))
+			return Finish(m_status);
+
+		return false;
+	}
+
+	bool Finish(BuildOrderStatus status)
+	{
+		if(m_handleFailure)
+			ai->Execute()->FinishedPlanningOfStaticDefence(m_sector, m_selectionCriteria.targetType, status);
+
+		return true;
+	}
+
+	AAI*                           ai;
+	std::string                    m_name;
+	AAISector*                     m_sector;
+	StaticDefenceSelectionCriteria m_selectionCriteria;
+
+	//! Whether a missing builder/buildsite shall be handled (i.e. construction retried later)
+	bool                           m_handleFailure;
+
+	//! Whether sea (true) or land (false) defences shall be tried
+	std::vector<bool>              m_tries;
+	int                            m_currentTry;
+	bool                           m_searchStarted;
+	bool                           m_replanned;
+	StaticDefenceBuildsiteSearch   m_search;
+	BuildOrderStatus               m_status;
+};
+
 bool AAIExecute::BuildDefences()
 {
 	if(    (ai->UnitTable()->GetNumberOfFutureUnitsOfCategory(EUnitCategory::STATIC_DEFENCE) > 2) 
 		|| (m_sectorToBuildNextDefence == nullptr) )
 		return true;
 
-	BuildOrderStatus status = BuildStationaryDefenceVS(m_nextDefenceVsTargetType, m_sectorToBuildNextDefence);
-
-	if(status == BuildOrderStatus::NO_BUILDER_AVAILABLE)
-		return false;
-	else if(status == BuildOrderStatus::NO_BUILDSITE_FOUND)
-		m_sectorToBuildNextDefence->FailedToConstructStaticDefence();
+	BuildStationaryDefenceVS(m_nextDefenceVsTargetType, m_sectorToBuildNextDefence, true);
 
 	m_sectorToBuildNextDefence = nullptr;
 
 	return true;
 }
 
-BuildOrderStatus AAIExecute::BuildStationaryDefenceVS(const AAITargetType& targetType, const AAISector *dest)
+void AAIExecute::BuildStationaryDefenceVS(const AAITargetType& targetType, AAISector *dest, bool handleFailure)
 {
 	// dont build in sectors already occupied by allies
 	if(dest->GetNumberOfAlliedBuildings() > 2)
-		return BuildOrderStatus::SUCCESSFUL;
+		return;
 
-	//-----------------------------------------------------------------------------------------------------------------
 	// dont start construction of further defences if expensive defences are already under construction in this sector
-	//-----------------------------------------------------------------------------------------------------------------
-	for(const auto task : ai->GetBuildTasks())
-	{
-		if(task->IsExpensiveUnitOfCategoryInSector(ai, EUnitCategory::STATIC_DEFENCE, dest) )
-			return BuildOrderStatus::SUCCESSFUL;
-	}
+	if(IsExpensiveStaticDefenceUnderConstruction(dest))
+		return;
+
+	// selection of a defence vs the given target type for this sector is already in progress
+	if(ai->IncrementalPlanners()->IsPlanning(GetStaticDefencePlannerName(dest, targetType)))
+		return;
 
 	//-----------------------------------------------------------------------------------------------------------------
 	// determine criteria for selection of static defence and its buildsite
@@ -1103,51 +1298,36 @@ BuildOrderStatus AAIExecute::BuildStationaryDefenceVS(const AAITargetType& targe
 	ai->Brain()->DetermineStaticDefenceSelectionCriteria(selectionCriteria, dest);
 
 	//-----------------------------------------------------------------------------------------------------------------
-	// try construction of static defence according to determined criteria
+	// selection of static defence & buildsite is spread over the next frames (construction is ordered afterwards)
 	//-----------------------------------------------------------------------------------------------------------------
-	BuildOrderStatus status(BuildOrderStatus::BUILDING_INVALID);
-
-	if(dest->GetWaterTilesRatio() < 0.85f)
-		status = BuildStaticDefence(dest, selectionCriteria, false);
+	ai->IncrementalPlanners()->AddPlanner( std::unique_ptr<AAIIncrementalPlanner>(new AAIStaticDefencePlanner(ai, dest, selectionCriteria, handleFailure)) );
+}
 
-	if( (dest->GetWaterTilesRatio() > 0.15f) && (status != BuildOrderStatus::SUCCESSFUL))
-		status = BuildStaticDefence(dest, selectionCriteria, true);
+bool AAIExecute::IsExpensiveStaticDefenceUnderConstruction(const AAISector* sector) const
+{
+	for(const auto task : ai->GetBuildTasks())
+	{
+		if(task->IsExpensiveUnitOfCategoryInSector(ai, EUnitCategory::STATIC_DEFENCE, sector) )
+			return true;
+	}
 
-	return status;
+	return false;
 }
 
-BuildOrderStatus AAIExecute::BuildStaticDefence(const AAISector* sector, const StaticDefenceSelectionCriteria& selectionCriteria, bool water) const
+void AAIExecute::FinishedPlanningOfStaticDefence(AAISector* sector, const AAITargetType& targetType, BuildOrderStatus status)
 {
-	const UnitDefId selectedDefence = ai->BuildTable()->SelectStaticDefence(ai->GetSide(), selectionCriteria, water);
-
-	if(selectedDefence.IsValid())
+	// if no builder available retry later
+	if(status == BuildOrderStatus::NO_BUILDER_AVAILABLE)
 	{
-		const float3 buildsite = ai->Map()->DetermineBuildsiteForStaticDefence(selectedDefence, sector, selectionCriteria.targetType, selectionCriteria.terrain);
+		const float urgencyOfStaticDefence = 0.03f + 1.0f / ( static_cast<float>(sector->GetNumberOfBuildings(EUnitCategory::STATIC_DEFENCE)) + 0.5f);
 
-		if(buildsite.x > 0.0f)
-		{
-			const AvailableConstructor selectedConstructor = ai->UnitTable()->FindClosestBuilder(selectedDefence, buildsite, ai->Brain()->IsCommanderAllowedForConstructionInSector(sector));
+		SetConstructionUrgencyIfHigher(EUnitCategory::STATIC_DEFENCE, urgencyOfStaticDefence);
 
-			if(selectedConstructor.IsValid())
-			{
-				selectedConstructor.Constructor()->GiveConstructionOrder(selectedDefence, buildsite);
-				ai->Map()->AddOrRemoveStaticDefence(buildsite, selectedDefence, true);
-				return BuildOrderStatus::SUCCESSFUL;
-			}
-			else
-			{
-				ai->BuildTable()->RequestBuilderFor(selectedDefence);
-				return BuildOrderStatus::NO_BUILDER_AVAILABLE;
-			}
-		}
-		else
-			return BuildOrderStatus::NO_BUILDSITE_FOUND;
-	}
-	else
-	{
-		ai->Log("No static Defence found!\n");
-		return BuildOrderStatus::BUILDING_INVALID;
+		m_sectorToBuildNextDefence = sector;
+		m_nextDefenceVsTargetType  = targetType;
 	}
+	else if(status == BuildOrderStatus::NO_BUILDSITE_FOUND)
+		sector->FailedToConstructStaticDefence();
 }
 
 bool AAIExecute::BuildArty()
@@ -1304,18 +1484,15 @@ bool AAIExecute::BuildStaticConstructor()
 		}
 
 		// no buildpos found in whole base -> expand base
-		bool expanded = false;
-
-		// no suitable buildsite found
 		if(isSeaFactory)
 		{
-			ai->Brain()->ExpandBase(EMapType::WATER, false);
-			ai->Log("Base expanded by BuildFactory() (water sector)\n");
+			ai->Brain()->RequestBaseExpansion(EMapType::WATER, false);
+			ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "Base expansion requested by BuildFactory() (water sector)\n");
 		}
 		else
 		{
-			expanded = ai->Brain()->ExpandBase(EMapType::LAND, false);
-			ai->Log("Base expanded by BuildFactory()\n");
+			ai->Brain()->RequestBaseExpansion(EMapType::LAND, false);
+			ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::INFO, "Base expansion requested by BuildFactory()\n");
 		}
 
 		return false;	
@@ -1529,7 +1706,7 @@ void AAIExecute::BuildStaticDefenceForExtractor(UnitId extractorId, UnitDefId ex
 					if(selectedConstructor.IsValid())
 						selectedConstructor.Constructor()->GiveConstructionOrder(defence, finalDefenceBuildPos);
 					else
-						ai->Log("No construction unit found to defend extractor %s!\n", ai->s_buildTree.GetUnitTypeProperties(defence).m_name.c_str());
+						ai->Log(ELogCategory::CONSTRUCTION, ELogLevel::WARNINGS, "No construction unit found to defend extractor %s!\n", ai->s_buildTree.GetUnitTypeProperties(defence).m_name.c_str());
 				}
 			}
 		}
@@ -1628,25 +1805,10 @@ void AAIExecute::CheckDefences()
 	}
 
 	if(first)
-	{
-		// if no builder available retry later
-		BuildOrderStatus status = BuildStationaryDefenceVS(targetType1, first);
-
-		if(status == BuildOrderStatus::NO_BUILDER_AVAILABLE)
-		{
-			const float urgencyOfStaticDefence = 0.03f + 1.0f / ( static_cast<float>(first->GetNumberOfBuildings(EUnitCategory::STATIC_DEFENCE)) + 0.5f);
-
-			SetConstructionUrgencyIfHigher(EUnitCategory::STATIC_DEFENCE, urgencyOfStaticDefence);
-
-			m_sectorToBuildNextDefence = first;
-			m_nextDefenceVsTargetType = targetType1;
-		}
-		else if(status == BuildOrderStatus::NO_BUILDSITE_FOUND)
-			first->FailedToConstructStaticDefence();
-	}
+		BuildStationaryDefenceVS(targetType1, first, true);
 
 	if(second)
-		BuildStationaryDefenceVS(targetType2, second);
+		BuildStationaryDefenceVS(targetType2, second, false);
 }
 
 void AAIExecute::CheckConstructionOfNanoTurret()
@@ -1734,7 +1896,7 @@ void AAIExecute::CheckExtractorUpgrade()
 	{
 		for(auto spot : sector->metalSpots)
 		{
-			if(spot->occupied == false)
+			if(spot->IsOccupied() == false)
 				return;
 		}
 	}
@@ -1765,6 +1927,7 @@ void AAIExecute::CheckExtractorUpgrade()
 	//-----------------------------------------------------------------------------------------------------------------
 	float maxExtractedMetalGain(0.0f);
 	AAIMetalSpot* selectedMetalSpot(nullptr);
+	UnitId        selectedExtractor;
 
 	for(int dist = 0; dist < 2; ++dist)
 	{
@@ -1773,22 +1936,26 @@ void AAIExecute::CheckExtractorUpgrade()
 			for(auto spot : sector->metalSpots)
 			{
 				// quit when finding empty spots
-				if(!spot->occupied && (sector->GetNumberOfEnemyBuildings() <= 0) && (sector->GetLostUnits() < 0.2f) )
+				if( (spot->IsOccupied() == false) && (sector->GetNumberOfEnemyBuildings() <= 0) && (sector->GetLostUnits() < 0.2f) )
 					return;
 
-				if(    spot->extractorDefId.IsValid() 
-				    && spot->extractorUnitId.IsValid()
-					&& ai->GetAICallback()->GetUnitTeam(spot->extractorUnitId.id) == ai->GetMyTeamId())	// only upgrade own extractors
+				const UnitId    extractorUnitId = spot->GetExtractorUnitId();
+				const UnitDefId extractorDefId  = spot->GetExtractorDefId();
+
+				if(    extractorDefId.IsValid() 
+				    && extractorUnitId.IsValid()
+					&& ai->GetAICallback()->GetUnitTeam(extractorUnitId.id) == ai->GetMyTeamId())	// only upgrade own extractors
 				{
-					const bool isLand = ai->s_buildTree.GetMovementType( spot->extractorDefId ).IsStaticLand();
+					const bool isLand = ai->s_buildTree.GetMovementType( extractorDefId ).IsStaticLand();
 
 					const float extractedMetalGain =  (isLand ? landExtractedMetal : seaExtractedMetal) 
-													- ai->s_buildTree.GetMaxRange( spot->extractorDefId );
+													- ai->s_buildTree.GetMaxRange( extractorDefId );
 
 					if( (extractedMetalGain > 0.0001f) && (extractedMetalGain > maxExtractedMetalGain) )
 					{
 						maxExtractedMetalGain = extractedMetalGain;
 						selectedMetalSpot     = spot;
+						selectedExtractor     = extractorUnitId;
 					}
 				}
 			}
@@ -1803,7 +1970,7 @@ void AAIExecute::CheckExtractorUpgrade()
 		AAIConstructor *builder = ai->UnitTable()->FindClosestAssistant(selectedMetalSpot->pos, 10, true);
 
 		if(builder)
-			builder->GiveReclaimOrder(selectedMetalSpot->extractorUnitId);
+			builder->GiveReclaimOrder(selectedExtractor);
 	}
 }
 
@@ -2278,7 +2445,7 @@ void AAIExecute::CheckKeepDistanceToEnemy(UnitId unit, UnitDefId unitDefId, Unit
 			c.PushParam(pos.z);
 
 			//ai->Getcb()->GiveOrder(unit_id, &c);
-			GiveOrder(&c, unit.id, "Fallback");
+			GiveOrder(&c, unit.id, "Fallback", EOrderPriority::HIGH);
 		}
 	}
 }
@@ -2292,15 +2459,18 @@ float3 AAIExecute::GetFallBackPos(const float3& pos, float maxFallbackDist) cons
 	assert(maxFallbackDist != 0.0f);
 
 	// get list of enemies within weapons range
-	const int numberOfEnemies = ai->GetAICallback()->GetEnemyUnits(&(ai->Map()->UnitsInLOS().front()), pos, maxFallbackDist);
+	ai->Map()->CheckUnitsInLOSUpdate();
+
+	std::vector<const AAIEnemyUnit*> enemyUnits;
+	ai->Map()->GetEnemyUnitGrid().GetUnitsInRadius(pos, maxFallbackDist, true, enemyUnits);
+
+	const int numberOfEnemies = static_cast<int>(enemyUnits.size());
 
 	if(numberOfEnemies > 0)
 	{
-		float3 enemy_pos;
-
-		for(int k = 0; k < numberOfEnemies; ++k)
+		for(const AAIEnemyUnit* enemyUnit : enemyUnits)
 		{
-			float3 enemy_pos = ai->GetAICallback()->GetUnitPos(ai->Map()->UnitsInLOS()[k]);
+			float3 enemy_pos = enemyUnit->position;
 
 			// get distance to enemy
 			float dx   = enemy_pos.x - pos.x;
@@ -2330,7 +2500,7 @@ float3 AAIExecute::GetFallBackPos(const float3& pos, float maxFallbackDist) cons
 	return fallbackPosition;
 }
 
-void AAIExecute::GiveOrder(Command *c, int unit, const char *owner)
+void AAIExecute::GiveOrder(Command *c, int unit, const char *owner, EOrderPriority priority)
 {
 	++m_numberOfIssuedOrders;
 
@@ -2339,5 +2509,23 @@ void AAIExecute::GiveOrder(Command *c, int unit, const char *owner)
 
 	ai->UnitTable()->units[unit].last_order = ai->GetAICallback()->GetCurrentFrame();
 
-	ai->GetAICallback()->GiveOrder(unit, c);
+	m_orderStaging.AddOrder(*c, UnitId(unit), priority);
+}
+
+void AAIExecute::GiveOrder(Command *c, const std::vector<UnitId>& units, const char *owner, EOrderPriority priority)
+{
+	m_numberOfIssuedOrders += static_cast<int>(units.size());
+
+	const int frame = ai->GetAICallback()->GetCurrentFrame();
+
+	for(const auto& unitId : units)
+		ai->UnitTable()->units[unitId.id].last_order = frame;
+
+	m_orderStaging.AddOrder(*c, units, priority);
+}
+
+void AAIExecute::LogOrderStatistics() const
+{
+	ai->Log("\nOrders given to units: %i\n", m_numberOfIssuedOrders);
+	m_orderStaging.LogStatistics();
 }
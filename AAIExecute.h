@@ -15,6 +15,7 @@
 #include "AAITypes.h"
 #include "AAIUnitTypes.h"
 #include "AAIBuildTable.h"
+#include "AAIOrderStaging.h"
 
 namespace springLegacyAI {
 	struct UnitDef;
@@ -47,19 +48,25 @@ struct AvailableMetalSpot
 
 class AAIExecute
 {
+	friend class AAIStaticDefencePlanner;
+	friend class AAICombatUnitSelectionTask;
+
 public:
 	AAIExecute(AAI* ai);
 	~AAIExecute(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the buildqueues, construction urgencies, and staged orders
+	size_t GetMemoryUsage() const;
+
 	//! @brief Determines starting sector, adds another sector to base and initializes buildqueues
 	void InitAI(UnitId commanderUnitId, UnitDefId commanderDefId);
 
-	void MoveUnitTo(int unit, float3 *position);
+	void MoveUnitTo(int unit, float3 *position, EOrderPriority priority);
 
 	//! @brief Add the given unit to an existing group (or create new one if necessary)
 	void AddUnitToGroup(const UnitId& unitId, const UnitDefId& unitDefId);
 
-	//! @brief Selects combat unit according to given criteria and tries to order its construction
+	//! @brief Starts planning task to select combat unit according to given criteria (construction is ordered when planning is finished)
 	void BuildCombatUnitOfCategory(const AAIMovementType& moveType, const TargetTypeValues& combatPowerCriteria, const UnitSelectionCriteria& unitSelectionCriteria, const std::vector<float>& factoryUtilization, bool urgent);
 
 	void BuildScouts();
@@ -137,8 +144,20 @@ public:
 			m_constructionUrgency[category.GetArrayIndex()] = urgency;
 	}
 
-	// debug
-	void GiveOrder(Command *c, int unit, const char *owner);
+	//! @brief Stages the given order for the given unit (passed to the engine with the next call of IssueStagedOrders())
+	void GiveOrder(Command *c, int unit, const char *owner, EOrderPriority priority);
+
+	//! @brief Stages the given order for the given units (passed to the engine together with the next call of IssueStagedOrders())
+	void GiveOrder(Command *c, const std::vector<UnitId>& units, const char *owner, EOrderPriority priority);
+
+	//! @brief Discards the staged orders of the given unit (must be called before orders are given to the unit directly via the callback)
+	void DiscardStagedOrders(UnitId unitId) { m_orderStaging.DiscardOrders(unitId); }
+
+	//! @brief Passes the staged orders to the engine (as long as budget of orders per frame is not exceeded)
+	void IssueStagedOrders() { m_orderStaging.IssueOrders(); }
+
+	//! @brief Writes the statistics of the given/issued orders to the log file
+	void LogOrderStatistics() const;
 
 private:
 	// custom relations
@@ -157,15 +176,21 @@ private:
 	float static learned;
 	float static current;
 
+	//! @brief Orders construction of the given combat unit (or requests a factory if none available) - called after planning task has selected the unit
+	void OrderCombatUnit(UnitDefId unitDefId);
+
 	//! @brief Calls construction fucntion for given category and resets urgency to 0.0f if construction order has been given
 	void TryConstruction(const AAIUnitCategory& category);
 
-	//! @brief Tries to build a defence building vs target type in the specified sector
-	//!        returns BUILDORDER_SUCCESSFUL if successful
-	BuildOrderStatus BuildStationaryDefenceVS(const AAITargetType& targetType, const AAISector *dest);
+	//! @brief Starts the planning of a defence building vs target type in the specified sector (construction is ordered once a buildsite
+	//!        has been found in the following frames); if handleFailure is set, a missing builder/buildsite is taken into account for later retries
+	void BuildStationaryDefenceVS(const AAITargetType& targetType, AAISector *dest, bool handleFailure);
 
-	//! @brief Tries to build a defence fitting to given criteria
-	BuildOrderStatus BuildStaticDefence(const AAISector* sector, const StaticDefenceSelectionCriteria& selectionCriteria, bool water) const;
+	//! @brief Called when planning of a static defence is finished: schedules a retry if no builder was available, or marks the failed attempt if no buildsite was found
+	void FinishedPlanningOfStaticDefence(AAISector* sector, const AAITargetType& targetType, BuildOrderStatus status);
+
+	//! @brief Returns true if an expensive static defence is currently under construction in the given sector
+	bool IsExpensiveStaticDefenceUnderConstruction(const AAISector* sector) const;
 
 	//! @brief Returns true if a construction unit was ordered to assist construction of a building of givn category
 	bool AssistConstructionOfCategory(const AAIUnitCategory& category);
@@ -231,9 +256,12 @@ private:
 	//! The number of units the AI tries to order in every unit production update step
 	int m_unitProductionRate;
 
-	//! The total number of issued orders (primarily for debug purposes)
+	//! The total number of orders given to units (primarily for debug purposes)
 	int m_numberOfIssuedOrders;
 
+	//! Orders given to units that have not been passed to the engine yet
+	AAIOrderStaging m_orderStaging;
+
 	//! Number of times a building was created but no suitable builder could be identfied (should be zero - just for debug purposes)
 	unsigned int m_linkingBuildTaskToBuilderFailed;
 
@@ -0,0 +1,57 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+
+#include "AAIFrameTimeGovernor.h"
+#include "aidef.h"
+
+AAIFrameTimeGovernor::AAIFrameTimeGovernor(int frameTimeBudget, float minCadenceFactor, float maxCadenceFactor) :
+	m_frameTimeBudget(std::max(frameTimeBudget, 1)),
+	m_minCadenceFactor(std::max(minCadenceFactor, 0.1f)),
+	m_maxCadenceFactor(std::max(maxCadenceFactor, m_minCadenceFactor)),
+	m_cadenceFactor(std::min(std::max(1.0f, m_minCadenceFactor), m_maxCadenceFactor)),
+	m_windowTime(0),
+	m_windowFrames(0),
+	m_averageFrameTime(0),
+	m_adjustments(0)
+{
+}
+
+bool AAIFrameTimeGovernor::AddFrameTime(int frameTime)
+{
+	m_windowTime += frameTime;
+	++m_windowFrames;
+
+	if(m_windowFrames < AAIConstants::governorMeasurementWindow)
+		return false;
+
+	// smooth over windows to avoid reacting to single expensive tasks that are executed once per window anyway
+	const int windowAverage = static_cast<int>(m_windowTime / static_cast<long long>(m_windowFrames));
+	m_averageFrameTime = (m_averageFrameTime + windowAverage) / 2;
+	m_windowTime   = 0;
+	m_windowFrames = 0;
+
+	const float load = static_cast<float>(m_averageFrameTime) / static_cast<float>(m_frameTimeBudget);
+	const float previousCadenceFactor = m_cadenceFactor;
+
+	// stretch proportional to the overload (aiming below the budget), tighten slowly (hysteresis between governorLowLoad and 1 to avoid oscillation)
+	if(load > 1.0f)
+		m_cadenceFactor = std::min(m_cadenceFactor * std::min(load / AAIConstants::governorTargetLoad, AAIConstants::governorMaxStretchingStep), m_maxCadenceFactor);
+	else if(load < AAIConstants::governorLowLoad)
+		m_cadenceFactor = std::max(m_cadenceFactor * AAIConstants::governorTighteningStep, m_minCadenceFactor);
+
+	if(m_cadenceFactor != previousCadenceFactor)
+	{
+		++m_adjustments;
+		return true;
+	}
+	else
+		return false;
+}
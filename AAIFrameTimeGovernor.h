@@ -0,0 +1,57 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_FRAME_TIME_GOVERNOR_H
+#define AAI_FRAME_TIME_GOVERNOR_H
+
+//! @brief Compares the time AAI spends per frame (averaged over a number of frames) with a given budget and determines a factor by which
+//!        the periods of non-critical tasks (e.g. scouting, rally points, upgrades) are stretched if AAI exceeds its budget or tightened
+//!        again if there is enough headroom. The factor is kept within the given bounds.
+class AAIFrameTimeGovernor
+{
+public:
+	AAIFrameTimeGovernor(int frameTimeBudget, float minCadenceFactor, float maxCadenceFactor);
+
+	//! @brief Adds the time (in microseconds) spent by AAI in the last frame; returns true if the cadence factor has been changed
+	bool AddFrameTime(int frameTime);
+
+	//! @brief Returns the factor the periods of non-critical tasks shall be multiplied with
+	float GetCadenceFactor() const { return m_cadenceFactor; }
+
+	//! @brief Returns the average time (in microseconds) per frame of the last completed measurement window
+	int GetAverageFrameTime() const { return m_averageFrameTime; }
+
+	//! @brief Returns the target for the time (in microseconds) spent per frame
+	int GetFrameTimeBudget() const { return m_frameTimeBudget; }
+
+	//! @brief Returns how often the cadence factor has been changed
+	int GetNumberOfAdjustments() const { return m_adjustments; }
+
+private:
+	//! Target for the average time (in microseconds) spent per frame
+	int   m_frameTimeBudget;
+
+	//! Bounds of the cadence factor
+	float m_minCadenceFactor;
+	float m_maxCadenceFactor;
+
+	//! Current factor for the periods of non-critical tasks
+	float m_cadenceFactor;
+
+	//! Time spent/number of frames in the current measurement window
+	long long m_windowTime;
+	int       m_windowFrames;
+
+	//! Smoothed average time per frame (in microseconds) of the last measurement windows
+	int   m_averageFrameTime;
+
+	int   m_adjustments;
+};
+
+#endif
@@ -20,6 +20,7 @@
 #include "AAIMap.h"
 #include "AAISector.h"
 #include "AAIBrain.h"
+#include "AAIMemoryUsage.h"
 
 
 #include "LegacyCpp/UnitDef.h"
@@ -27,6 +28,9 @@ using namespace springLegacyAI;
 
 
 AAIGroup::AAIGroup(AAI *ai, UnitDefId unitDefId, int continentId) :
+	m_groupPosition(ZeroVector),
+	m_groupRadius(0.0f),
+	m_groupPositionFrame(-1),
 	m_groupDefId(unitDefId),
 	m_targetPosition(ZeroVector),
 	m_targetSector(nullptr),
@@ -60,6 +64,9 @@ AAIGroup::AAIGroup(AAI *ai, UnitDefId unitDefId, int continentId) :
 			m_maxSize = cfg->MAX_GROUP_SIZE;
 	}
 
+	m_units.reserve(m_maxSize);
+	m_unitPositions.reserve(m_maxSize);
+
 	task_importance = 0;
 	task = GROUP_IDLE;
 
@@ -69,7 +76,7 @@ AAIGroup::AAIGroup(AAI *ai, UnitDefId unitDefId, int continentId) :
 	// get a rally point
 	GetNewRallyPoint();
 
-	ai->Log("Creating new group - max size: %i   unit type: %s   continent: %i\n", m_maxSize, ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str(), m_continentId);
+	ai->Log(ELogCategory::ATTACK, ELogLevel::INFO, "Creating new group - max size: %i   unit type: %s   continent: %i\n", m_maxSize, ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str(), m_continentId);
 }
 
 AAIGroup::~AAIGroup(void)
@@ -83,6 +90,11 @@ AAIGroup::~AAIGroup(void)
 	m_units.clear();
 }
 
+size_t AAIGroup::GetMemoryUsage() const
+{
+	return GetAllocatedMemory(m_units) + GetAllocatedMemory(m_unitPositions);
+}
+
 bool AAIGroup::AddUnit(UnitId unitId, UnitDefId unitDefId, int continentId)
 {
 	if(    (m_continentId == continentId) // for continent bound units: check if unit is on the same continent as the group
@@ -91,7 +103,9 @@ bool AAIGroup::AddUnit(UnitId unitId, UnitDefId unitDefId, int continentId)
 		&& (attack == nullptr)
 		&& (task != GROUP_ATTACKING) && (task != GROUP_BOMBING))
 	{
+		ai->UnitTable()->units[unitId.id].group_slot = static_cast<int>(m_units.size());
 		m_units.push_back(unitId);
+		m_groupPositionFrame = -1;
 
 		// send unit to rally point of the group
 		if(m_rallyPoint.x > 0.0f)
@@ -103,7 +117,7 @@ bool AAIGroup::AddUnit(UnitId unitId, UnitDefId unitDefId, int continentId)
 				c.SetOpts(c.GetOpts() | SHIFT_KEY);
 
 			//ai->Getcb()->GiveOrder(unit_id, &c);
-			ai->Execute()->GiveOrder(&c, unitId.id, "Group::AddUnit");
+			ai->Execute()->GiveOrder(&c, unitId.id, "Group::AddUnit", EOrderPriority::LOW);
 		}
 
 		return true;
@@ -114,71 +128,75 @@ bool AAIGroup::AddUnit(UnitId unitId, UnitDefId unitDefId, int continentId)
 
 bool AAIGroup::RemoveUnit(UnitId unitId, UnitId attackerUnitId)
 {
-	// look for unit with that id
-	for(auto unit = m_units.begin(); unit != m_units.end(); ++unit)
+	const int slot = ai->UnitTable()->units[unitId.id].group_slot;
+
+	if( (slot >= 0) && (slot < GetCurrentSize()) && (m_units[slot] == unitId) )
 	{
-		if( *unit == unitId)
-		{
-			const int newGroupSize = GetCurrentSize() - 1;
+		// move last unit to the slot of the removed one
+		const UnitId lastUnitId = m_units.back();
+		m_units[slot] = lastUnitId;
+		ai->UnitTable()->units[lastUnitId.id].group_slot = slot;
 
-			m_units.erase(unit);
+		m_units.pop_back();
+		ai->UnitTable()->units[unitId.id].group_slot = -1;
+		m_groupPositionFrame = -1;
 
-			if(newGroupSize == 0)
-			{
-				task   = GROUP_IDLE;
+		const int newGroupSize = GetCurrentSize();
 
-				if(attack)
-				{
-					attack->RemoveGroup(this);
-					attack = nullptr;		
-				}
+		if(newGroupSize == 0)
+		{
+			task   = GROUP_IDLE;
+
+			if(attack)
+			{
+				attack->RemoveGroup(this);
+				attack = nullptr;		
 			}
+		}
 
-			if(attackerUnitId.IsValid() && (newGroupSize > 0) )
+		if(attackerUnitId.IsValid() && (newGroupSize > 0) )
+		{
+			const UnitDefId attackerDefId = ai->GetUnitDefId(attackerUnitId);
+
+			if(attackerDefId.IsValid())
 			{
-				const UnitDefId attackerDefId = ai->GetUnitDefId(attackerUnitId);
+				const AAIUnitCategory&  category    = ai->s_buildTree.GetUnitCategory(attackerDefId);
+				const TargetTypeValues& combatPower = ai->s_buildTree.GetCombatPower(attackerDefId);
 
-				if(attackerDefId.IsValid())
+				if(     category.IsStaticDefence()
+					|| (category.IsGroundCombat() && (combatPower.GetValue(ETargetType::SURFACE) > cfg->MIN_AIR_SUPPORT_EFFICIENCY) )
+					|| (category.IsSeaCombat()    && (combatPower.GetValue(ETargetType::FLOATER) > cfg->MIN_AIR_SUPPORT_EFFICIENCY) )
+					|| (category.IsHoverCombat()  && (combatPower.GetValue(ETargetType::SURFACE) > cfg->MIN_AIR_SUPPORT_EFFICIENCY) ) )
 				{
-					const AAIUnitCategory&  category    = ai->s_buildTree.GetUnitCategory(attackerDefId);
-					const TargetTypeValues& combatPower = ai->s_buildTree.GetCombatPower(attackerDefId);
-
-					if(     category.IsStaticDefence()
-						|| (category.IsGroundCombat() && (combatPower.GetValue(ETargetType::SURFACE) > cfg->MIN_AIR_SUPPORT_EFFICIENCY) )
-						|| (category.IsSeaCombat()    && (combatPower.GetValue(ETargetType::FLOATER) > cfg->MIN_AIR_SUPPORT_EFFICIENCY) )
-						|| (category.IsHoverCombat()  && (combatPower.GetValue(ETargetType::SURFACE) > cfg->MIN_AIR_SUPPORT_EFFICIENCY) ) )
-					{
-						ai->AirForceMgr()->CheckTarget( attackerUnitId, category, ai->s_buildTree.GetHealth(attackerDefId));
-					}
+					ai->AirForceMgr()->CheckTarget( attackerUnitId, category, ai->s_buildTree.GetHealth(attackerDefId));
 				}
 			}
-
-			return true;
 		}
+
+		return true;
 	}
 
 	// unit not found
 	const UnitDefId unitDefId = ai->GetUnitDefId(unitId);
 
 	if(unitDefId.IsValid())
-		ai->Log("Error: Failed to remove unit %s from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
+		ai->Log(ELogCategory::GENERAL, ELogLevel::ERRORS, "Error: Failed to remove unit %s from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(unitDefId).m_name.c_str(), ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
 	else
-		ai->Log("Error: Failed to remove unit with unknown unit type from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
+		ai->Log(ELogCategory::GENERAL, ELogLevel::ERRORS, "Error: Failed to remove unit with unknown unit type from group of %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str() );
 	return false;
 }
 
-void AAIGroup::GiveOrderToGroup(Command *c, float importance, UnitTask task, const char *owner)
+void AAIGroup::GiveOrderToGroup(Command *c, float importance, UnitTask task, const char *owner, EOrderPriority priority)
 {
 	lastCommandFrame = ai->GetAICallback()->GetCurrentFrame();
 
 	task_importance = importance;
 
+	// staged as one order to ensure that all units of the group receive it within the same frame
+	ai->Execute()->GiveOrder(c, m_units, owner, priority);
+
 	for(auto unit = m_units.begin(); unit != m_units.end(); ++unit)
-	{
-		//ai->Getcb()->GiveOrder(i->x, c);
-		ai->Execute()->GiveOrder(c, (*unit).id, owner);
 		ai->UnitTable()->SetUnitStatus( (*unit).id, task);
-	}
 }
 
 void AAIGroup::Update()
@@ -243,23 +261,65 @@ const AAITargetType& AAIGroup::GetTargetType() const
 	return ai->s_buildTree.GetTargetType(m_groupDefId);
 }
 
-float3 AAIGroup::GetGroupPos() const
+void AAIGroup::UpdateGroupPosition() const
 {
-	if(!m_units.empty())
+	const int currentFrame = ai->GetAICallback()->GetCurrentFrame();
+
+	if(m_groupPositionFrame == currentFrame)
+		return;
+
+	m_groupPositionFrame = currentFrame;
+	m_groupRadius        = 0.0f;
+
+	if(m_units.empty())
 	{
-		std::list<UnitId>::const_iterator unit = std::prev(m_units.end());
-		return ai->GetAICallback()->GetUnitPos( (*unit).id );
+		m_groupPosition = ZeroVector;
+		return;
 	}
-	else
-		return ZeroVector;
+
+	// fetch position of every unit only once and determine center of group
+	m_unitPositions.clear();
+	float3 center(ZeroVector);
+
+	for(const auto& unitId : m_units)
+	{
+		m_unitPositions.push_back( ai->GetAICallback()->GetUnitPos(unitId.id) );
+		center += m_unitPositions.back();
+	}
+
+	center /= static_cast<float>(m_units.size());
+
+	float maxSquaredDist(0.0f);
+
+	for(const auto& position : m_unitPositions)
+	{
+		const float dx = position.x - center.x;
+		const float dy = position.z - center.z;
+		maxSquaredDist = std::max(maxSquaredDist, dx*dx + dy*dy);
+	}
+
+	m_groupPosition = center;
+	m_groupRadius   = fastmath::apxsqrt(maxSquaredDist);
+}
+
+float3 AAIGroup::GetGroupPos() const
+{
+	UpdateGroupPosition();
+	return m_groupPosition;
+}
+
+float AAIGroup::GetGroupRadius() const
+{
+	UpdateGroupPosition();
+	return m_groupRadius;
 }
 
 bool AAIGroup::IsEntireGroupAtRallyPoint() const
 {
-	const float3 position = GetGroupPos();
+	UpdateGroupPosition();
 
-	float dx = position.x - m_rallyPoint.x;
-	float dy = position.z - m_rallyPoint.z;
+	const float dx = m_groupPosition.x - m_rallyPoint.x;
+	const float dy = m_groupPosition.z - m_rallyPoint.z;
 
 	return (dx*dx+dy*dy) < AAIConstants::maxSquaredDistToRallyPoint;
 }
@@ -296,7 +356,7 @@ void AAIGroup::TargetUnitKilled()
 		Command c(CMD_MOVE);
 		c.PushPos(m_rallyPoint);
 
-		GiveOrderToGroup(&c, 10.0f, MOVING, "Group::TargetUnitKilled");
+		GiveOrderToGroup(&c, 10.0f, MOVING, "Group::TargetUnitKilled", EOrderPriority::NORMAL);
 	}
 }
 
@@ -308,7 +368,7 @@ void AAIGroup::AttackSector(const AAISector *sector, float importance)
 	c.PushPos(attackPosition);
 
 	// move group to that sector
-	GiveOrderToGroup(&c, importance + 8.0f, UNIT_ATTACKING, "Group::AttackSector");
+	GiveOrderToGroup(&c, importance + 8.0f, UNIT_ATTACKING, "Group::AttackSector", EOrderPriority::NORMAL);
 
 	m_targetPosition = attackPosition;
 	m_targetSector   = sector;
@@ -325,7 +385,7 @@ void AAIGroup::Defend(UnitId unitId, const float3& enemyPosition, int importance
 	{
 		cmd.PushPos(enemyPosition);
 
-		GiveOrderToGroup(&cmd, importance, DEFENDING, "Group::Defend");
+		GiveOrderToGroup(&cmd, importance, DEFENDING, "Group::Defend", EOrderPriority::HIGH);
 
 		m_targetPosition = enemyPosition;
 		m_targetSector   = ai->Map()->GetSectorOfPos(enemyPosition);
@@ -334,7 +394,7 @@ void AAIGroup::Defend(UnitId unitId, const float3& enemyPosition, int importance
 	{
 		cmd.PushParam(unitId.id);
 
-		GiveOrderToGroup(&cmd, importance, GUARDING, "Group::Defend");
+		GiveOrderToGroup(&cmd, importance, GUARDING, "Group::Defend", EOrderPriority::HIGH);
 
 		const float3 pos = ai->GetAICallback()->GetUnitPos(unitId.id);
 
@@ -352,7 +412,7 @@ void AAIGroup::Retreat(const float3& pos)
 	Command c(CMD_MOVE);
 	c.PushPos(pos);
 
-	GiveOrderToGroup(&c, 105, MOVING, "Group::Retreat");
+	GiveOrderToGroup(&c, 105, MOVING, "Group::Retreat", EOrderPriority::HIGH);
 
 	// set new dest sector
 	m_targetPosition = pos;
@@ -364,16 +424,7 @@ UnitId AAIGroup::GetRandomUnit() const
 	if(m_units.empty())
 		return UnitId();
 	else
-	{
-		const int selectedUnitId = rand()%static_cast<int>(m_units.size());
-
-		auto unit = m_units.begin();
-
-		for(int i = 0; i < selectedUnitId; ++i)
-			++unit;
-
-		return *unit;		
-	}
+		return m_units[ai->Random().GetInteger(static_cast<int>(m_units.size()))];
 }
 
 bool AAIGroup::SufficientAttackPower() const
@@ -435,7 +486,7 @@ void AAIGroup::UnitIdle(UnitId unitId, AAIAttackManager* attackManager)
 		Command c(CMD_MOVE);
 		c.PushPos(m_rallyPoint);
 
-		GiveOrderToGroup(&c, 100, MOVING, "Group::Idle_a");
+		GiveOrderToGroup(&c, 100, MOVING, "Group::Idle_a", EOrderPriority::LOW);
 
 		task = GROUP_IDLE;
 	}
@@ -451,7 +502,7 @@ void AAIGroup::UnitIdle(UnitId unitId, AAIAttackManager* attackManager)
 			// combat groups
 			if(ai->s_buildTree.GetUnitType(m_groupDefId).IsAssaultUnit() && attack->HasTargetBeenCleared() )
 			{
-				ai->Log("Combat group idle - checking for next sector to attack\n");
+				ai->Log(ELogCategory::ATTACK, ELogLevel::VERBOSE, "Combat group idle - checking for next sector to attack\n");
 				attackManager->AttackNextSectorOrAbort(attack);
 				return;
 			}
@@ -467,7 +518,7 @@ void AAIGroup::UnitIdle(UnitId unitId, AAIAttackManager* attackManager)
 						Command c(CMD_GUARD);
 						c.PushParam(guardedUnitId.id);
 
-						GiveOrderToGroup(&c, 110, GUARDING, "Group::Idle_b");
+						GiveOrderToGroup(&c, 110, GUARDING, "Group::Idle_b", EOrderPriority::NORMAL);
 					}
 				}
 				else
@@ -485,7 +536,7 @@ void AAIGroup::UnitIdle(UnitId unitId, AAIAttackManager* attackManager)
 				c.PushPos(attackPosition);
 
 				// move group to that sector
-				ai->Execute()->GiveOrder(&c, unitId.id, "Group::Idle_c");
+				ai->Execute()->GiveOrder(&c, unitId.id, "Group::Idle_c", EOrderPriority::NORMAL);
 				ai->UnitTable()->SetUnitStatus(unitId.id, UNIT_ATTACKING);
 			}
 		}
@@ -507,7 +558,7 @@ void AAIGroup::BombTarget(UnitId unitId, const float3& position)
 	Command c(CMD_ATTACK);
 	c.PushPos(position);
 
-	GiveOrderToGroup(&c, 110.0f, UNIT_ATTACKING, "Group::BombTarget");
+	GiveOrderToGroup(&c, 110.0f, UNIT_ATTACKING, "Group::BombTarget", EOrderPriority::NORMAL);
 
 	ai->UnitTable()->SetEnemyUnitAsTargetOfGroup(unitId, this);
 
@@ -519,7 +570,7 @@ void AAIGroup::DefendAirSpace(const float3& position)
 	Command c(CMD_PATROL);
 	c.PushPos(position);
 
-	GiveOrderToGroup(&c, 110.0f, UNIT_ATTACKING, "Group::DefendAirSpace");
+	GiveOrderToGroup(&c, 110.0f, UNIT_ATTACKING, "Group::DefendAirSpace", EOrderPriority::HIGH);
 
 	task = GROUP_PATROLING;
 }
@@ -529,7 +580,7 @@ void AAIGroup::AirRaidUnit(UnitId unitId)
 	Command c(CMD_ATTACK);
 	c.PushParam(unitId.id);
 
-	GiveOrderToGroup(&c, 110.0f, UNIT_ATTACKING, "Group::AirRaidUnit");
+	GiveOrderToGroup(&c, 110.0f, UNIT_ATTACKING, "Group::AirRaidUnit", EOrderPriority::NORMAL);
 
 	ai->UnitTable()->SetEnemyUnitAsTargetOfGroup(unitId, this);
 
@@ -594,11 +645,11 @@ void AAIGroup::GetNewRallyPoint()
 			Command c(CMD_MOVE);
 			c.PushPos(m_rallyPoint);
 
-			GiveOrderToGroup(&c, 90, HEADING_TO_RALLYPOINT, "Group::RallyPoint");
+			GiveOrderToGroup(&c, 90, HEADING_TO_RALLYPOINT, "Group::RallyPoint", EOrderPriority::LOW);
 		}
 	}
 	else
 	{
-		ai->Log("Failed to determine rally point for goup of unit type %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str());
+		ai->Log(ELogCategory::ATTACK, ELogLevel::WARNINGS, "Failed to determine rally point for goup of unit type %s!\n", ai->s_buildTree.GetUnitTypeProperties(m_groupDefId).m_name.c_str());
 	}
 }
@@ -15,6 +15,7 @@
 #include "aidef.h"
 #include "AAITypes.h"
 #include "AAIUnitTypes.h"
+#include "AAIOrderStaging.h"
 
 enum GroupTask {GROUP_IDLE, GROUP_ATTACKING, GROUP_DEFENDING, GROUP_PATROLING, GROUP_BOMBING, GROUP_RETREATING};
 
@@ -39,6 +40,9 @@ public:
 	AAIGroup(AAI *ai, UnitDefId unitDefId, int continentId);
 	~AAIGroup(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the group
+	size_t GetMemoryUsage() const;
+
 	//! @brief Tries to add the given unit to the group
 	bool AddUnit(UnitId unitId, UnitDefId unitDefId, int continentId);
 
@@ -48,7 +52,7 @@ public:
 	//! @brief Returns the number of units in the group
 	int GetCurrentSize() const { return static_cast<int>(m_units.size()); }
 
-	void GiveOrderToGroup(Command *c, float importance, UnitTask task, const char *owner);
+	void GiveOrderToGroup(Command *c, float importance, UnitTask task, const char *owner, EOrderPriority priority);
 
 	//! @brief Determines the position of an enemy building in the given sector and orders all units to attack it
 	void AttackSector(const AAISector *sector, float importance);
@@ -114,10 +118,13 @@ public:
 	//! @brief Returns the current target position where the units shall move
 	const float3& GetTargetPosition() const { return m_targetPosition; }
 
-	//! @brief Returns the position of the group (to save effort, only the position of the last unit added to the group)
+	//! @brief Returns the position of the group (center of all units of the group, updated at most once per frame)
 	float3 GetGroupPos() const;
 
-	//! @brief Returns true if most recently added unit is close to rally point
+	//! @brief Returns the radius of the circle around the group position that contains all units of the group
+	float GetGroupRadius() const;
+
+	//! @brief Returns true if center of group is close to rally point and no unit is lagging far behind
 	bool IsEntireGroupAtRallyPoint() const;
 
 	//! @brief Returns rating of the group to perform a task (e.g. defend) of given performance at given position 
@@ -137,14 +144,29 @@ private:
 	//! @brief Returns whether unit group is considered to be strong enough to attack
 	bool SufficientAttackPower() const;
 
+	//! @brief Recalculates center and radius of the group if they have not been determined in the current frame yet
+	void UpdateGroupPosition() const;
+
 	int lastCommandFrame;
 	Command lastCommand;
 
 	//! The maximum number of units the group may consist of
 	int m_maxSize;
 
-	//! The units that belong to this group
-	std::list<UnitId> m_units;
+	//! The units that belong to this group (index of each unit is stored in the unit table to allow removal in constant time)
+	std::vector<UnitId> m_units;
+
+	//! Center of the units of the group (determined in frame m_groupPositionFrame)
+	mutable float3 m_groupPosition;
+
+	//! Radius of the circle around m_groupPosition containing all units of the group
+	mutable float m_groupRadius;
+
+	//! Frame in which group position has been determined (-1 if outdated)
+	mutable int m_groupPositionFrame;
+
+	//! Buffer for the positions of the units (to avoid reallocation)
+	mutable std::vector<float3> m_unitPositions;
 
 	//! The type of units in this group
 	UnitDefId m_groupDefId;
@@ -0,0 +1,71 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <chrono>
+#include <utility>
+
+#include "AAIIncrementalPlanner.h"
+#include "AAI.h"
+
+AAIIncrementalPlanners::AAIIncrementalPlanners(AAI* ai, int frameBudget) :
+	m_frameBudget(frameBudget),
+	m_steps(0),
+	m_finishedPlanners(0),
+	m_droppedPlanners(0),
+	ai(ai)
+{
+}
+
+void AAIIncrementalPlanners::AddPlanner(std::unique_ptr<AAIIncrementalPlanner> planner)
+{
+	m_planners.emplace_back(std::move(planner));
+}
+
+bool AAIIncrementalPlanners::IsPlanning(const std::string& name) const
+{
+	for(const auto& planner : m_planners)
+	{
+		if(name == planner.planner->GetName())
+			return true;
+	}
+
+	return false;
+}
+
+void AAIIncrementalPlanners::Update()
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	while(m_planners.empty() == false)
+	{
+		++m_steps;
+
+		// planner may add further planners while committing -> take it out of the queue first
+		if(m_planners.front().planner->Step())
+		{
+			PendingPlanner pendingPlanner = std::move(m_planners.front());
+			m_planners.pop_front();
+
+			if(pendingPlanner.planner->Commit())
+				++m_finishedPlanners;
+			else if(++pendingPlanner.commitAttempts < AAIConstants::plannerMaxCommitAttempts)
+				m_planners.push_front(std::move(pendingPlanner));
+			else
+			{
+				++m_droppedPlanners;
+				ai->Log(ELogCategory::GENERAL, ELogLevel::WARNINGS, "Dropping planner %s after %i failed attempts to commit its result\n", pendingPlanner.planner->GetName(), pendingPlanner.commitAttempts);
+			}
+		}
+
+		const int elapsedTime = static_cast<int>( std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() );
+
+		if(elapsedTime >= m_frameBudget)
+			break;
+	}
+}
@@ -0,0 +1,95 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_INCREMENTAL_PLANNER_H
+#define AAI_INCREMENTAL_PLANNER_H
+
+#include <deque>
+#include <memory>
+#include <string>
+
+class AAI;
+
+//! @brief An incremental planner splits an expensive decision (e.g. selection of a buildsite) into small steps that are executed
+//!        over several frames by the main thread. As the game state may change between the steps, the result is revalidated
+//!        before the corresponding orders are issued.
+class AAIIncrementalPlanner
+{
+public:
+	virtual ~AAIIncrementalPlanner() {}
+
+	//! @brief Performs the next (bounded) step of the planning; returns true if planning is finished
+	virtual bool Step() = 0;
+
+	//! @brief Revalidates the result against the current game state and issues the corresponding orders;
+	//!        returns false if planning shall be resumed (e.g. result no longer valid but alternatives left)
+	virtual bool Commit() = 0;
+
+	//! @brief Returns the name of the planner (used to avoid multiple planners for the same decision and for logging)
+	virtual const char* GetName() const = 0;
+};
+
+//! @brief Executes the steps of the incremental planners of an AAI instance in the order they have been added while limiting the time spent per frame
+class AAIIncrementalPlanners
+{
+public:
+	AAIIncrementalPlanners(AAI* ai, int frameBudget);
+
+	//! @brief Adds the given planner (planning starts with the next update)
+	void AddPlanner(std::unique_ptr<AAIIncrementalPlanner> planner);
+
+	//! @brief Returns whether a planner with the given name is waiting to be finished
+	bool IsPlanning(const std::string& name) const;
+
+	//! @brief Executes steps of the pending planners until the time budget is exhausted (at least one step per call);
+	//!        planners whose result could not be committed after AAIConstants::plannerMaxCommitAttempts attempts are dropped
+	void Update();
+
+	//! @brief Returns the number of planners waiting to be finished
+	int GetNumberOfPendingPlanners() const { return static_cast<int>(m_planners.size()); }
+
+	//! @brief Returns the total number of executed steps
+	int GetNumberOfSteps() const { return m_steps; }
+
+	//! @brief Returns the total number of finished planners
+	int GetNumberOfFinishedPlanners() const { return m_finishedPlanners; }
+
+	//! @brief Returns the total number of planners dropped because their result could not be committed
+	int GetNumberOfDroppedPlanners() const { return m_droppedPlanners; }
+
+private:
+	struct PendingPlanner
+	{
+		PendingPlanner(std::unique_ptr<AAIIncrementalPlanner> planner) : planner(std::move(planner)), commitAttempts(0) {}
+
+		std::unique_ptr<AAIIncrementalPlanner> planner;
+
+		//! Number of failed attempts to commit the result of the planner
+		int                                    commitAttempts;
+	};
+
+	//! Pending planners (the first one is executed until finished)
+	std::deque<PendingPlanner> m_planners;
+
+	//! Target for the time (in microseconds) spent per update
+	int m_frameBudget;
+
+	//! Total number of executed steps
+	int m_steps;
+
+	//! Total number of finished planners
+	int m_finishedPlanners;
+
+	//! Total number of dropped planners
+	int m_droppedPlanners;
+
+	AAI* ai;
+};
+
+#endif
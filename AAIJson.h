@@ -0,0 +1,32 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_JSON_H
+#define AAI_JSON_H
+
+#include <cstdio>
+
+//! @brief Writes the given string as json string (with quotes, escaping special characters; control characters are omitted)
+inline void WriteJsonString(FILE* file, const char* string)
+{
+	fputc('"', file);
+
+	for(const char* character = string; *character != '\0'; ++character)
+	{
+		if( (*character == '"') || (*character == '\\') )
+			fputc('\\', file);
+
+		if(static_cast<unsigned char>(*character) >= 0x20)
+			fputc(*character, file);
+	}
+
+	fputc('"', file);
+}
+
+#endif
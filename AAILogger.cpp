@@ -0,0 +1,186 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAILogger.h"
+#include "aidef.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+
+static_assert( (AAIConstants::logBufferRecords & (AAIConstants::logBufferRecords - 1)) == 0, "Number of log records must be a power of two");
+
+AAILogger::AAILogger(const char* filename) :
+	m_file(fopen(filename, "w")),
+	m_records(new LogRecord[AAIConstants::logBufferRecords]),
+	m_recordIndexMask(AAIConstants::logBufferRecords - 1),
+	m_addPosition(0),
+	m_writePosition(0),
+	m_droppedMessages(0),
+	m_totalDroppedMessages(0),
+	m_levels(static_cast<int>(ELogCategory::NUMBER_OF_CATEGORIES), static_cast<int>(ELogLevel::INFO)),
+	m_stop(false)
+{
+	for(int record = 0; record < AAIConstants::logBufferRecords; ++record)
+		m_records[record].sequence.store(record, std::memory_order_relaxed);
+
+	if(m_file)
+		m_thread = std::thread(&AAILogger::Run, this);
+}
+
+AAILogger::~AAILogger()
+{
+	if(m_thread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+
+		m_wakeUp.notify_one();
+		m_thread.join();
+	}
+
+	if(m_file)
+		fclose(m_file);
+}
+
+ELogCategory AAILogger::GetCategory(const char* name)
+{
+	static const char* const categoryNames[] = {"GENERAL", "CONSTRUCTION", "BUILD_TABLE", "ATTACK", "MAP"};
+
+	for(int category = 0; category < static_cast<int>(ELogCategory::NUMBER_OF_CATEGORIES); ++category)
+	{
+		if(strcmp(name, categoryNames[category]) == 0)
+			return static_cast<ELogCategory>(category);
+	}
+
+	return ELogCategory::NUMBER_OF_CATEGORIES;
+}
+
+void AAILogger::Write(ELogCategory category, ELogLevel level, const char* format, va_list args)
+{
+	if( (m_file == nullptr) || (IsEnabled(category, level) == false) )
+		return;
+
+	char message[maxMessageLength];
+	const int length = std::min(vsnprintf(message, maxMessageLength, format, args), maxMessageLength - 1);
+
+	if( (length > 0) && (AddRecords(message, length) == false) )
+		m_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool AAILogger::AddRecords(const char* text, int length)
+{
+	static_assert(maxMessageLength <= AAIConstants::logBufferRecords * recordTextSize, "Log buffer must be able to hold a message of maximum length");
+
+	// messages exceeding the size of a record are split into consecutive records
+	const size_t numberOfRecords = static_cast<size_t>( (length + recordTextSize - 1) / recordTextSize );
+
+	// bounded multi producer queue: a record may be used if its sequence number equals the position, i.e. it has been written to file;
+	// the writer thread releases the records in order, thus all records needed for the message are free if the last one is
+	size_t position = m_addPosition.load(std::memory_order_relaxed);
+
+	while(true)
+	{
+		const size_t lastPosition = position + numberOfRecords - 1;
+
+		const size_t sequence = m_records[lastPosition & m_recordIndexMask].sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(lastPosition);
+
+		if(difference == 0)
+		{
+			if(m_addPosition.compare_exchange_weak(position, position + numberOfRecords, std::memory_order_relaxed))
+				break;
+		}
+		else if(difference < 0)
+			return false; // record has not been written to file yet, i.e. buffer is full
+		else
+			position = m_addPosition.load(std::memory_order_relaxed);
+	}
+
+	for(size_t i = 0; i < numberOfRecords; ++i)
+	{
+		LogRecord& record = m_records[(position + i) & m_recordIndexMask];
+
+		const int start = static_cast<int>(i) * recordTextSize;
+		record.numberOfRecords = static_cast<int>(numberOfRecords - i);
+		record.length = std::min(length - start, recordTextSize);
+		memcpy(record.text, text + start, record.length);
+
+		// mark record as ready to be written
+		record.sequence.store(position + i + 1, std::memory_order_release);
+	}
+
+	return true;
+}
+
+void AAILogger::WriteRecords()
+{
+	bool recordsWritten(false);
+
+	while(true)
+	{
+		const LogRecord& firstRecord = m_records[m_writePosition & m_recordIndexMask];
+
+		if(firstRecord.sequence.load(std::memory_order_acquire) != m_writePosition + 1)
+			break;
+
+		// only write complete messages (records of a message are marked as ready in order)
+		const size_t numberOfRecords = static_cast<size_t>(firstRecord.numberOfRecords);
+		const size_t lastPosition    = m_writePosition + numberOfRecords - 1;
+
+		if(m_records[lastPosition & m_recordIndexMask].sequence.load(std::memory_order_acquire) != lastPosition + 1)
+			break;
+
+		for(size_t i = 0; i < numberOfRecords; ++i)
+		{
+			LogRecord& record = m_records[m_writePosition & m_recordIndexMask];
+
+			if(fwrite(record.text, 1, record.length, m_file) != static_cast<size_t>(record.length)) //write to stderr if write to file failed
+				fwrite(record.text, 1, record.length, stderr);
+
+			// release record for reuse in the next round through the buffer
+			record.sequence.store(m_writePosition + AAIConstants::logBufferRecords, std::memory_order_release);
+			++m_writePosition;
+		}
+
+		recordsWritten = true;
+	}
+
+	const int droppedMessages = m_droppedMessages.exchange(0, std::memory_order_relaxed);
+
+	if(droppedMessages > 0)
+	{
+		m_totalDroppedMessages.fetch_add(droppedMessages, std::memory_order_relaxed);
+		fprintf(m_file, "[%i log messages dropped - log buffer full]\n", droppedMessages);
+		recordsWritten = true;
+	}
+
+	if(recordsWritten)
+		fflush(m_file);
+}
+
+void AAILogger::Run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while(m_stop == false)
+	{
+		lock.unlock();
+		WriteRecords();
+		lock.lock();
+
+		m_wakeUp.wait_for(lock, std::chrono::milliseconds(AAIConstants::logWriterInterval), [this]() { return m_stop; });
+	}
+
+	lock.unlock();
+	WriteRecords();
+}
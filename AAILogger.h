@@ -0,0 +1,138 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_LOGGER_H
+#define AAI_LOGGER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! Severity of a log message; messages are written if their level does not exceed the level set for their category
+enum class ELogLevel : int
+{
+	ERRORS   = 0, //!< Errors (e.g. inconsistent data, config errors)
+	WARNINGS = 1, //!< Unexpected situations (e.g. no suitable buildsite/builder found)
+	INFO     = 2, //!< General information (default for all messages not assigned to a level)
+	VERBOSE  = 3  //!< Detailed information about decisions
+};
+
+//! Category of a log message (used to set the levels of logged messages per category)
+enum class ELogCategory : int
+{
+	GENERAL              = 0,
+	CONSTRUCTION         = 1,
+	BUILD_TABLE          = 2,
+	ATTACK               = 3,
+	MAP                  = 4,
+	NUMBER_OF_CATEGORIES = 5
+};
+
+//! @brief Writes the log messages of an AAI instance to file without blocking the calling thread: messages are copied into a
+//!        lock-free ring buffer and written to file by a background thread. If the buffer is full, messages are dropped (and the number
+//!        of dropped messages is written to the log instead). Messages longer than one record are split into consecutive records that
+//!        are reserved at once, i.e. a message is either written completely or dropped and not interleaved with other messages.
+class AAILogger
+{
+public:
+	//! @brief Opens the given file and starts the writer thread
+	AAILogger(const char* filename);
+
+	//! @brief Writes all remaining messages, stops the writer thread and closes the file
+	~AAILogger();
+
+	//! @brief Returns whether the log file could be opened
+	bool IsOpen() const { return (m_file != nullptr); }
+
+	//! @brief Sets the maximum level of messages of the given category that shall be logged
+	void SetLevel(ELogCategory category, ELogLevel level) { m_levels[static_cast<int>(category)] = static_cast<int>(level); }
+
+	//! @brief Returns whether messages of given category and level shall be logged
+	bool IsEnabled(ELogCategory category, ELogLevel level) const { return static_cast<int>(level) <= m_levels[static_cast<int>(category)]; }
+
+	//! @brief Formats and adds the given message to the buffer (if enabled for the given category and level)
+	void Write(ELogCategory category, ELogLevel level, const char* format, va_list args);
+
+	//! @brief Returns the number of messages that have been dropped because the buffer was full
+	int GetNumberOfDroppedMessages() const { return m_totalDroppedMessages.load(std::memory_order_relaxed) + m_droppedMessages.load(std::memory_order_relaxed); }
+
+	//! @brief Returns the category with the given name (as used in the general config file), NUMBER_OF_CATEGORIES if unknown
+	static ELogCategory GetCategory(const char* name);
+
+	//! Maximum length of a message (longer messages are truncated)
+	static constexpr int maxMessageLength = 4096;
+
+private:
+	//! Maximum length of the text stored in one record
+	static constexpr int recordTextSize = 240;
+
+	//! A part of a log message
+	struct LogRecord
+	{
+		//! Sequence number used to synchronize writing threads and the writer thread (see AddRecords()/WriteRecords())
+		std::atomic<size_t> sequence;
+
+		//! Number of records of the message starting with this record
+		int                 numberOfRecords;
+
+		int                 length;
+
+		char                text[recordTextSize];
+	};
+
+	//! @brief Copies the given text into the next free records (as many as needed); returns false if the buffer does not have enough free records
+	bool AddRecords(const char* text, int length);
+
+	//! @brief Writes all completely added messages to file (called by the writer thread only)
+	void WriteRecords();
+
+	//! @brief Main loop of the writer thread
+	void Run();
+
+	//! The log file
+	FILE*                        m_file;
+
+	//! The ring buffer (size is a power of two)
+	std::unique_ptr<LogRecord[]> m_records;
+
+	//! Number of records - 1 (to determine index from position)
+	const size_t                 m_recordIndexMask;
+
+	//! Position of the next record to be added
+	std::atomic<size_t>          m_addPosition;
+
+	//! Position of the next record to be written (accessed by writer thread only)
+	size_t                       m_writePosition;
+
+	//! Number of messages dropped since the last pass of the writer thread
+	std::atomic<int>             m_droppedMessages;
+
+	//! Number of messages dropped before the last pass of the writer thread
+	std::atomic<int>             m_totalDroppedMessages;
+
+	//! Maximum level of logged messages per category
+	std::vector<int>             m_levels;
+
+	//! The writer thread
+	std::thread                  m_thread;
+
+	//! Used to wake up the writer thread when it shall stop
+	std::mutex                   m_mutex;
+	std::condition_variable      m_wakeUp;
+
+	//! Flag whether writer thread shall stop
+	bool                         m_stop;
+};
+
+#endif
@@ -14,6 +14,8 @@
 #include "AAIConfig.h"
 #include "AAISector.h"
 #include "AAIUnitTable.h"
+#include "AAITrace.h"
+#include "AAIEnemySightings.h"
 
 #include "System/SafeUtil.h"
 #include "LegacyCpp/UnitDef.h"
@@ -50,11 +52,10 @@ float AAIMap::s_landTilesRatio;
 float AAIMap::s_waterTilesRatio;
 
 AAIContinentMap               AAIMap::s_continentMap;
-AAIDefenceMaps                AAIMap::s_defenceMaps;
+std::map<int, AAIDefenceMaps> AAIMap::s_defenceMapsOfAllyTeams;
 AAIMapType                    AAIMap::s_mapType;
 AAITeamSectorMap              AAIMap::s_teamSectorMap;
-std::vector<BuildMapTileType> AAIMap::s_buildmap;
-std::vector<int>              AAIMap::blockmap;
+AAIBuildMap                   AAIMap::s_buildmap;
 std::vector<float>            AAIMap::plateau_map;
 
 std::vector<AAIContinent>     AAIMap::s_continents;
@@ -65,8 +66,14 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 	ai(ai),
 	m_unitsInLOS(cfg->MAX_UNITS, 0),
 	m_scoutedEnemyUnitsMap(xMapSize, yMapSize, losMapResolution),
+	m_enemyUnitGrid(static_cast<float>(xMapSize * SQUARE_SIZE), static_cast<float>(yMapSize * SQUARE_SIZE), AAIConstants::enemyUnitGridCellSize),
+	m_scoutedEnemyBuildings(0),
+	m_nextSectorToUpdate(0),
+	m_sectorsPerSlice(1),
 	m_centerOfEnemyBase(xMapSize/2 , yMapSize/2),
-	m_lastLOSUpdateInFrame(0)
+	m_lastLOSUpdateInFrame(0),
+	m_sectorAttackDataSnapshotFrame(-1),
+	m_defenceMaps(nullptr)
 {
 	// all static vars are only initialized by the first AAI instance
 	if(ai->GetAAIInstance() == 1)
@@ -96,14 +103,11 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 		xSectorSize = xSectorSizeMap * SQUARE_SIZE;
 		ySectorSize = ySectorSizeMap * SQUARE_SIZE;
 
-		s_buildmap.resize(xMapSize*yMapSize);
-		blockmap.resize(xMapSize*yMapSize, 0);
+		s_buildmap.Init(xMapSize, yMapSize);
 		plateau_map.resize(xMapSize/4*xMapSize/4, 0.0f);
 
 		s_teamSectorMap.Init(xSectors, ySectors);
 
-		s_defenceMaps.Init(xMapSize, yMapSize);
-
 		s_continentMap.Init(xMapSize, yMapSize);
 
 		InitContinents();
@@ -111,6 +115,12 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 		ReadMapCacheFile();
 	}
 
+	// defence maps are shared by all AAI instances of the same ally team
+	m_defenceMaps = &s_defenceMapsOfAllyTeams[ai->GetAICallback()->GetMyAllyTeam()];
+
+	if(m_defenceMaps->IsInitialized() == false)
+		m_defenceMaps->Init(xMapSize, yMapSize);
+
 	ai->Log("Map size: %i x %i    LOS map size: %i x %i  (los res: %i)\n", xMapSize, yMapSize, xLOSMapSize, yLOSMapSize, losMapResolution);
 
 	m_sector.resize(xSectors, std::vector<AAISector>(ySectors));
@@ -136,6 +146,11 @@ AAIMap::AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution) :
 	// for scouting
 	m_buildingsOnContinent.resize(s_continents.size(), 0);
 
+	const int numberOfSectors = xSectors * ySectors;
+	m_continentsOfScoutedUnitsInSector.resize(numberOfSectors);
+	m_scoutingDataOutdated = std::vector< std::atomic<bool> >(numberOfSectors);
+	m_sectorsPerSlice = std::max( (numberOfSectors + AAIConstants::sectorUpdateSlices - 1) / AAIConstants::sectorUpdateSlices, 1);
+
 	// for log file
 	ai->Log("Map: %s\n",ai->GetAICallback()->GetMapName());
 	ai->Log("Maptype: %s\n", s_mapType.GetName().c_str());
@@ -196,14 +211,47 @@ AAIMap::~AAIMap(void)
 
 		fclose(file);
 
-		s_buildmap.clear();
-		blockmap.clear();
+		s_buildmap.Clear();
 		plateau_map.clear();
+		s_defenceMapsOfAllyTeams.clear();
 	}
 
 	m_unitsInLOS.clear();
 }
 
+size_t AAIMap::GetMemoryUsage() const
+{
+	size_t memoryUsage = GetAllocatedMemory(m_sector);
+
+	for(const auto& sectorColumn : m_sector)
+	{
+		for(const auto& sector : sectorColumn)
+			memoryUsage += sector.GetMemoryUsage();
+	}
+
+	memoryUsage += GetAllocatedMemory(m_unitsInLOS) + m_scoutedEnemyUnitsMap.GetMemoryUsage() + m_enemyUnitGrid.GetMemoryUsage();
+	memoryUsage += GetAllocatedMemory(m_buildingsOnContinent) + GetAllocatedMemory(m_continentsOfScoutedUnitsInSector) + GetAllocatedMemory(m_scoutingDataOutdated);
+
+	if(m_sectorAttackDataSnapshot)
+		memoryUsage += GetAllocatedMemory(*m_sectorAttackDataSnapshot);
+
+	return memoryUsage;
+}
+
+size_t AAIMap::GetSharedMemoryUsage()
+{
+	size_t memoryUsage = s_buildmap.GetMemoryUsage() + s_continentMap.GetMemoryUsage() + s_teamSectorMap.GetMemoryUsage();
+
+	memoryUsage += GetAllocatedMemory(plateau_map);
+
+	memoryUsage += GetAllocatedMemory(metal_spots) + GetAllocatedMemory(s_continents) + GetAllocatedMemory(s_defenceMapsOfAllyTeams);
+
+	for(const auto& defenceMaps : s_defenceMapsOfAllyTeams)
+		memoryUsage += defenceMaps.second.GetMemoryUsage();
+
+	return memoryUsage;
+}
+
 void AAIMap::ReadMapCacheFile()
 {
 	// try to read cache file
@@ -258,8 +306,7 @@ void AAIMap::ReadMapCacheFile()
 					unsigned int value;
 					fscanf(file, "%u", &value);
 
-					const int cell = x + y * xMapSize;
-					s_buildmap[cell].m_tileType = static_cast<uint8_t>(value);
+					s_buildmap.SetTileType(x, y, BuildMapTileType(static_cast<uint8_t>(value)) );
 				}
 			}
 
@@ -284,14 +331,14 @@ void AAIMap::ReadMapCacheFile()
 			}
 
 			// load metal spots
-			AAIMetalSpot spot;
+			float3 spotPosition;
+			float  spotAmount;
 			fscanf(file, "%i ", &temp);
 
 			for(int i = 0; i < temp; ++i)
 			{
-				fscanf(file, "%f %f %f %f ", &(spot.pos.x), &(spot.pos.y), &(spot.pos.z), &(spot.amount));
-				spot.occupied = false;
-				metal_spots.push_back(spot);
+				fscanf(file, "%f %f %f %f ", &(spotPosition.x), &(spotPosition.y), &(spotPosition.z), &spotAmount);
+				metal_spots.emplace_back(spotPosition, spotAmount);
 			}
 
 			fscanf(file, "%i %i ", &s_metalSpotsOnLand, &s_metalSpotsInSea);
@@ -338,8 +385,7 @@ void AAIMap::ReadMapCacheFile()
 		{
 			for(int x = 0; x < xMapSize; ++x)
 			{
-				const int cell = x + y * xMapSize;
-				fprintf(file, "%u ", s_buildmap[cell].m_tileType);
+				fprintf(file, "%u ", s_buildmap.GetTileType(x, y).m_tileType);
 			}
 			fprintf(file, "\n");
 		}
@@ -653,26 +699,7 @@ void AAIMap::ChangeBuildMapOccupation(int xPos, int yPos, int xSize, int ySize,
 	const int xEnd = std::min(xPos + xSize, xMapSize);
 	const int yEnd = std::min(yPos + ySize, yMapSize);
 
-	for(int y = yPos; y < yEnd; ++y)
-	{
-		for(int x = xPos; x < xEnd; ++x)
-		{
-			if(occupy)
-				s_buildmap[x+y*xMapSize].OccupyTile();
-			else
-				s_buildmap[x+y*xMapSize].FreeTile();
-
-			// debug
-			/*if(x%2 == 0 && y%2 == 0)
-			{
-				const springLegacyAI::UnitDef* unitDef = ai->GetAICallback()->GetUnitDef("armmine1");
-				float3 myPos;
-				ConvertMapPosToUnitPos(MapPos(x,y), myPos, ai->s_buildTree.GetFootprint(unitDef->id) ); 
-				myPos.y = ai->GetAICallback()->GetElevation(myPos.x, myPos.z);
-				ai->GetAICallback()->DrawUnit("armmine1", myPos, 0.0f, 2000, ai->GetAICallback()->GetMyAllyTeam(), true, true);
-			}*/
-		}
-	}
+	s_buildmap.ChangeOccupation(xPos, yPos, xEnd, yEnd, occupy);
 }
 
 BuildSite AAIMap::DetermineRandomBuildsite(UnitDefId unitDefId, int xStart, int xEnd, int yStart, int yEnd, int tries) const
@@ -688,10 +715,10 @@ BuildSite AAIMap::DetermineRandomBuildsite(UnitDefId unitDefId, int xStart, int
 		MapPos mapPos(xStart, yStart);
 
 		if( randomXRange > 0)
-			mapPos.x += rand()%randomXRange;
+			mapPos.x += ai->Random().GetInteger(randomXRange);
 
 		if( randomYRange > 0)
-			mapPos.y += rand()%randomYRange;
+			mapPos.y += ai->Random().GetInteger(randomYRange);
 
 		// check if buildmap allows construction
 		if(CanBuildAt(mapPos, footprint))
@@ -820,7 +847,7 @@ BuildSite AAIMap::DetermineElevatedBuildsite(UnitDefId buildingDefId, int xStart
 					elevatedTerrainFactor = 0.5f * (1.0f + 0.01f * std::max(-100.0f, std::min( plateau_map[plateauMapCellIndex], 100.0f)));
 				}
 
-				const float rating = 0.05f * (float)(rand()%20) + 5.0f * edgeDistanceFactor + 3.0 * elevatedTerrainFactor;
+				const float rating = 0.05f * (float)(ai->Random().GetInteger(20)) + 5.0f * edgeDistanceFactor + 3.0 * elevatedTerrainFactor;
 
 				if(rating > bestBuildSite.GetRating())
 				{
@@ -842,109 +869,105 @@ BuildSite AAIMap::DetermineElevatedBuildsite(UnitDefId buildingDefId, int xStart
 	return bestBuildSite;
 }
 
-float3 AAIMap::DetermineBuildsiteForStaticDefence(UnitDefId staticDefence, const AAISector* sector, const AAITargetType& targetType, float terrainModifier) const
+void AAIMap::StartBuildsiteSearchForStaticDefence(StaticDefenceBuildsiteSearch& search, UnitDefId staticDefence, const AAISector* sector, const AAITargetType& targetType, float terrainModifier) const
 {
-	const springLegacyAI::UnitDef *def = &ai->BuildTable()->GetUnitDef(staticDefence.id);
+	search = StaticDefenceBuildsiteSearch();
 
-	const int           range     = static_cast<int>(ai->s_buildTree.GetMaxRange(staticDefence)) / SQUARE_SIZE;
-	const UnitFootprint footprint = DetermineRequiredFreeBuildspace(staticDefence);
+	search.staticDefence   = staticDefence;
+	search.targetType      = targetType;
+	search.terrainModifier = terrainModifier;
+	search.range           = static_cast<int>(ai->s_buildTree.GetMaxRange(staticDefence)) / SQUARE_SIZE;
+	search.footprint       = DetermineRequiredFreeBuildspace(staticDefence);
 
 	//-----------------------------------------------------------------------------------------------------------------
 	// determine search horizontal and vertical search range
 	//-----------------------------------------------------------------------------------------------------------------
-	const int xStart =  sector->x    * xSectorSizeMap;
-	const int xEnd   = (sector->x+1) * xSectorSizeMap;
-	const int yStart =  sector->y    * ySectorSizeMap;
-	const int yEnd   = (sector->y+1) * ySectorSizeMap;
+	search.xStart = sector->x * xSectorSizeMap;
+	search.yStart = sector->y * ySectorSizeMap;
+	search.xTiles = (xSectorSizeMap + 3) / 4;
+	search.yTiles = (ySectorSizeMap + 3) / 4;
 
 	//-----------------------------------------------------------------------------------------------------------------
 	// determine distances to center of base of tiles to be checked and statistcis (for calculation of rating later)
 	//-----------------------------------------------------------------------------------------------------------------
-	const int numberOfTilesToBeChecked = (1+(xEnd-xStart)/4) * (1+(yEnd-yStart)/4);
-	std::vector<float> distancesToBaseCenter(numberOfTilesToBeChecked);
-	StatisticalData distanceStatistics;
+	search.distancesToBaseCenter.resize(search.xTiles * search.yTiles);
 
-	int index(0);
 	const MapPos& baseCenter = ai->Brain()->GetCenterOfBase();
 
-	for(int yPos = yStart; yPos < yEnd; yPos += 4)
+	for(int tile = 0; tile < search.xTiles * search.yTiles; ++tile)
 	{
-		for(int xPos = xStart; xPos < xEnd; xPos += 4)
-		{
-			const int dx = xPos - baseCenter.x;
-			const int dy = yPos - baseCenter.y;
-			const float squaredDist = static_cast<float>(dx*dx + dy*dy);
-
-			distancesToBaseCenter[index] = squaredDist;
-			distanceStatistics.AddValue(squaredDist);
+		const int dx = search.xStart + 4 * (tile % search.xTiles) - baseCenter.x;
+		const int dy = search.yStart + 4 * (tile / search.xTiles) - baseCenter.y;
+		const float squaredDist = static_cast<float>(dx*dx + dy*dy);
 
-			++index;
-		}
+		search.distancesToBaseCenter[tile] = squaredDist;
+		search.distanceStatistics.AddValue(squaredDist);
 	}
 
-	distanceStatistics.Finalize();
+	search.distanceStatistics.Finalize();
+}
+
+bool AAIMap::ContinueBuildsiteSearchForStaticDefence(StaticDefenceBuildsiteSearch& search, int maxTiles) const
+{
+	const springLegacyAI::UnitDef *def = &ai->BuildTable()->GetUnitDef(search.staticDefence.id);
+
+	const int numberOfTiles = static_cast<int>(search.distancesToBaseCenter.size());
+	const int lastTile      = std::min(search.nextTile + maxTiles, numberOfTiles);
 
 	//-----------------------------------------------------------------------------------------------------------------
-	// find highest rated positon with search range
+	// find highest rated positon within the next tiles
 	//-----------------------------------------------------------------------------------------------------------------
-	float3 buildsite(ZeroVector);
-	float highestRating(0.0f);
-	index = 0;
-
-	/*FILE* file(nullptr);
-	const std::string filename = cfg->GetFileName(ai->GetAICallback(), "AAIDebug.txt", "", "", true);
-	file = fopen(filename.c_str(), "w+");
-	fprintf(file, "Base center: %i, %i\n", baseCenter.x, baseCenter.y);
-	fprintf(file, "Defence Map: Defence value / distance value / terrain value\n");*/
-	
-	for(int yPos = yStart; yPos < yEnd; yPos += 4)
+	for( ; search.nextTile < lastTile; ++search.nextTile)
 	{
-		for(int xPos = xStart; xPos < xEnd; xPos += 4)
+		const int xPos = search.xStart + 4 * (search.nextTile % search.xTiles);
+		const int yPos = search.yStart + 4 * (search.nextTile / search.xTiles);
+		const MapPos mapPos(xPos, yPos);
+
+		if(CanBuildAt(mapPos, search.footprint))
 		{
-			const MapPos mapPos(xPos, yPos);
+			// criterion 1: how well is tile already covered by existing static defences
+			const float defenceValue = 2.5f * AAIConstants::maxCombatPower / (1.0f + 0.35f * m_defenceMaps->GetValue(mapPos, search.targetType) );
 
-			if(CanBuildAt(mapPos, footprint))
-			{
-				// criterion 1: how well is tile already covered by existing static defences
-				const float defenceValue = 2.5f * AAIConstants::maxCombatPower / (1.0f + 0.35f * s_defenceMaps.GetValue(mapPos, targetType) );
+			// criterion 2: distance to center of base (prefer static defences closer to base)
+			const float distanceValue = 0.75f * AAIConstants::maxCombatPower * search.distanceStatistics.GetNormalizedDeviationFromMax(search.distancesToBaseCenter[search.nextTile]);
 
-				// criterion 2: distance to center of base (prefer static defences closer to base)
-				const float distanceValue = 0.75f * AAIConstants::maxCombatPower * distanceStatistics.GetNormalizedDeviationFromMax(distancesToBaseCenter[index]);
+			// criterion 3: terrain (prefer defences on high ground, avoid defences close to walls of canyons/valleys)
+			const int cell = (xPos/4 + (xMapSize/4) * yPos/4);
+			const float terrainValue = std::min(AAIConstants::maxCombatPower, search.terrainModifier * plateau_map[cell]);
 
-				// criterion 3: terrain (prefer defences on high ground, avoid defences close to walls of canyons/valleys)
-				const int cell = (xPos/4 + (xMapSize/4) * yPos/4);
-				const float terrainValue = std::min(AAIConstants::maxCombatPower, terrainModifier * plateau_map[cell]);
+			float rating = defenceValue + distanceValue + terrainValue + 0.2f * (float)(ai->Random().GetInteger(10));
 
-				float rating = defenceValue + distanceValue + terrainValue + 0.2f * (float)(rand()%10);
+			// determine minimum distance from buildpos to the edges of the map
+			const int edge_distance = GetEdgeDistance(xPos, yPos);
 
-				// determine minimum distance from buildpos to the edges of the map
-				const int edge_distance = GetEdgeDistance(xPos, yPos);
+			// prevent aai from building defences too close to the edges of the map
+			if( edge_distance < search.range)
+				rating *= (1.0f - (search.range - edge_distance) / search.range);
 
-				// prevent aai from building defences too close to the edges of the map
-				if( edge_distance < range)
-					rating *= (1.0f - (range - edge_distance) / range);
+			if(rating > search.buildsite.GetRating())
+			{
+				float3 possibleBuildsite;
+				ConvertMapPosToUnitPos(mapPos, possibleBuildsite, search.footprint);
+				ConvertPositionToFinalBuildsite(possibleBuildsite, search.footprint);
 
-				if(rating > highestRating)
+				if(ai->GetAICallback()->CanBuildAt(def, possibleBuildsite))
 				{
-					float3 possibleBuildsite;
-					ConvertMapPosToUnitPos(mapPos, possibleBuildsite, footprint);
-					ConvertPositionToFinalBuildsite(possibleBuildsite, footprint);
-
-					if(ai->GetAICallback()->CanBuildAt(def, possibleBuildsite))
-					{
-						buildsite = possibleBuildsite;
-						highestRating = rating;
-					}
+					search.buildsite.SetBuildSite(possibleBuildsite, rating);
+					search.buildsiteMapPos = mapPos;
 				}
 			}
-
-			++index;
 		}
 	}
 
-	//fclose(file);
+	return (search.nextTile >= numberOfTiles);
+}
 
-	return buildsite;
+bool AAIMap::IsBuildsiteForStaticDefenceValid(const StaticDefenceBuildsiteSearch& search) const
+{
+	if( (search.buildsite.IsValid() == false) || (CanBuildAt(search.buildsiteMapPos, search.footprint) == false) )
+		return false;
+
+	return ai->GetAICallback()->CanBuildAt(&ai->BuildTable()->GetUnitDef(search.staticDefence.id), search.buildsite.Position());
 }
 
 BuildSite AAIMap::CheckConstructionAt(const UnitFootprint& footprint, const springLegacyAI::UnitDef* unitDef, const MapPos& mapPos) const
@@ -979,7 +1002,7 @@ bool AAIMap::CanBuildAt(const MapPos& mapPos, const UnitFootprint& footprint) co
 			for(int x = mapPos.x; x < mapPos.x+footprint.xSize; ++x)
 			{
 				// all squares must be valid
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(footprint.invalidTileTypes))
+				if(s_buildmap.IsTileTypeSet(x, y, footprint.invalidTileTypes))
 					return false;
 			}
 		}
@@ -999,7 +1022,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 		{
 			if(y >= yMapSize)
 			{
-				ai->Log("ERROR: y = %i index out of range when checking horizontal rows", y);
+				ai->Log(ELogCategory::MAP, ELogLevel::ERRORS, "ERROR: y = %i index out of range when checking horizontal rows", y);
 				return;
 			}
 
@@ -1009,7 +1032,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			for(int x = xPos+xSize; x < xPos+xSize+cfg->MAX_XROW; ++x)
 			{
 				// abort when first non occupied tile is found
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					xRight = x;
 					break;
@@ -1022,7 +1045,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			int xLeft(-1);
 			for(int x = xPos-1; x >= xPos - cfg->MAX_XROW; --x)
 			{
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					xLeft = x;
 					break;
@@ -1067,7 +1090,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 		{
 			if(x >= xMapSize)
 			{
-				ai->Log("ERROR: x = %i index out of range when checking vertical rows", x);
+				ai->Log(ELogCategory::MAP, ELogLevel::ERRORS, "ERROR: x = %i index out of range when checking vertical rows", x);
 				return;
 			}
 
@@ -1076,7 +1099,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			int yBottom(-1);
 			for(int y = yPos+ySize; y < yPos+ySize+cfg->MAX_YROW; ++y)
 			{
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					yBottom = y;
 					break;
@@ -1089,7 +1112,7 @@ void AAIMap::CheckRows(int xPos, int yPos, int xSize, int ySize, bool add)
 			int yTop(-1);
 			for(int y = yPos-1; y >= yPos - cfg->MAX_YROW; --y)
 			{
-				if(s_buildmap[x+y*xMapSize].IsTileTypeSet(nonOccupiedTile))
+				if(s_buildmap.IsTileTypeSet(x, y, nonOccupiedTile))
 				{
 					yTop = y;
 					break;
@@ -1135,45 +1158,7 @@ void AAIMap::BlockTiles(int xPos, int yPos, int width, int height, bool block)
 	const int xEnd   = std::min(xPos + width, xMapSize);
 	const int yEnd   = std::min(yPos + height, yMapSize);
 
-	for(int y = yStart; y < yEnd; ++y)
-	{
-		for(int x = xStart; x < xEnd; ++x)
-		{
-			const int tileIndex = x + xMapSize*y;
-
-			if(block)	// block cells
-			{
-				// if no building ordered that cell to be blocked, update buildmap
-				// (only if space is not already occupied by a building)
-				if( (blockmap[tileIndex] == 0) && (s_buildmap[tileIndex].IsTileTypeSet(EBuildMapTileType::FREE)) )
-					s_buildmap[tileIndex].BlockTile();	
-
-				++blockmap[tileIndex];
-			}
-			else
-			{
-				if(blockmap[tileIndex] > 0)
-				{
-					--blockmap[tileIndex];
-
-					// if cell is not blocked anymore, mark cell on buildmap as empty (only if it has been marked bloked
-					//					- if it is not marked as blocked its occupied by another building or unpassable)
-					if(blockmap[tileIndex] == 0 && s_buildmap[tileIndex].IsTileTypeSet(EBuildMapTileType::BLOCKED_SPACE))
-						s_buildmap[tileIndex].FreeTile();	
-				}
-			}
-
-			// debug
-			/*if(x%2 == 0 && y%2 == 0)
-			{
-				const springLegacyAI::UnitDef* unitDef = ai->GetAICallback()->GetUnitDef("armmine1");
-				float3 myPos;
-				ConvertMapPosToUnitPos(MapPos(x,y), myPos, ai->s_buildTree.GetFootprint(unitDef->id) ); 
-				myPos.y = ai->GetAICallback()->GetElevation(myPos.x, myPos.z);
-				ai->GetAICallback()->DrawUnit("armmine1", myPos, 0.0f, 2000, ai->GetAICallback()->GetMyAllyTeam(), true, true);
-			}*/
-		}
-	}
+	s_buildmap.ChangeBlocking(xStart, yStart, xEnd, yEnd, block);
 }
 
 bool AAIMap::InitBuilding(const UnitDef *def, const float3& position)
@@ -1248,7 +1233,7 @@ int AAIMap::GetCliffyCells(int xPos, int yPos, int xSize, int ySize) const
 	{
 		for(int x = xPos; x < xPos + xSize; ++x)
 		{
-			if(s_buildmap[x+y*xMapSize].IsTileTypeSet(EBuildMapTileType::CLIFF))
+			if(s_buildmap.IsTileTypeSet(x, y, EBuildMapTileType::CLIFF))
 				++cliffs;
 		}
 	}
@@ -1271,16 +1256,16 @@ void AAIMap::AnalyseMap()
 	{
 		for(int x = 0; x < xMapSize; ++x)
 		{
-			s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::FREE);
+			s_buildmap.SetTileType(x, y, EBuildMapTileType::FREE);
 
 			// determine tile type (land or water)
 			if(height_map[x + y * xMapSize] < 0.0f)
 			{
-				s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::WATER);
+				s_buildmap.SetTileType(x, y, EBuildMapTileType::WATER);
 				++waterCells;
 			}
 			else
-				s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::LAND);
+				s_buildmap.SetTileType(x, y, EBuildMapTileType::LAND);
 
 			// determine slope to detect cliffs
 			if( (x < xMapSize - 4) && (y < yMapSize - 4) )
@@ -1289,19 +1274,19 @@ void AAIMap::AnalyseMap()
 
 				// check x-direction
 				if( (xSlope > cfg->CLIFF_SLOPE) || (-xSlope > cfg->CLIFF_SLOPE) )
-					s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::CLIFF);
+					s_buildmap.SetTileType(x, y, EBuildMapTileType::CLIFF);
 				else	// check y-direction
 				{
 					const float ySlope = (height_map[y * xMapSize + x] - height_map[(y+4) * xMapSize + x])/64.0f;
 
 					if(ySlope > cfg->CLIFF_SLOPE || -ySlope > cfg->CLIFF_SLOPE)
-						s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::CLIFF);
+						s_buildmap.SetTileType(x, y, EBuildMapTileType::CLIFF);
 					else
-						s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::FLAT);
+						s_buildmap.SetTileType(x, y, EBuildMapTileType::FLAT);
 				}
 			}
 			else
-				s_buildmap[x+y*xMapSize].SetTileType(EBuildMapTileType::FLAT);
+				s_buildmap.SetTileType(x, y, EBuildMapTileType::FLAT);
 		}
 	}
 
@@ -1327,7 +1312,7 @@ void AAIMap::AnalyseMap()
 					if(diff > 0.0f)
 					{
 						//! @todo Investigate the reason for this check
-						if(s_buildmap[4 * (i + j * xMapSize)].IsTileTypeNotSet(EBuildMapTileType::CLIFF) )
+						if(s_buildmap.IsTileTypeNotSet(4 * i, 4 * j, EBuildMapTileType::CLIFF) )
 							plateau_map[i + j * xPlateauMapSize] += diff;
 					}
 					else
@@ -1381,7 +1366,6 @@ void AAIMap::DetectMetalSpots()
 	int coordx = 0, coordy = 0;
 //	float AverageMetal;
 
-	AAIMetalSpot temp;
 	float3 pos;
 
 	int MinMetalForSpot = 30; // from 0-255, the minimum percentage of metal a spot needs to have
@@ -1464,9 +1448,8 @@ void AAIMap::DetectMetalSpots()
 
 			pos.y = ai->GetAICallback()->GetElevation(pos.x, pos.z);
 
-			temp.amount = TempMetal * ai->GetAICallback()->GetMaxMetal() * MaxMetal / 255.0f;
-			temp.occupied = false;
-			temp.pos = pos;
+			const float  spotAmount = TempMetal * ai->GetAICallback()->GetMaxMetal() * MaxMetal / 255.0f;
+			const float3 spotPosition(pos);
 
 			//if(ai->Getcb()->CanBuildAt(def, pos))
 			//{
@@ -1478,7 +1461,7 @@ void AAIMap::DetectMetalSpots()
 				{
 					if(CanBuildAt(mapPos, largestExtractorFootprint))
 					{
-						metal_spots.push_back(temp);
+						metal_spots.emplace_back(spotPosition, spotAmount);
 						++SpotsFound;
 
 						ChangeBuildMapOccupation(mapPos.x-2, mapPos.y-2, largestExtractorFootprint.xSize+2, largestExtractorFootprint.ySize+2, true);
@@ -1555,7 +1538,6 @@ void AAIMap::CheckUnitsInLOSUpdate(bool forceUpdate)
 	{
 		UpdateEnemyUnitsInLOS();
 		UpdateFriendlyUnitsInLos();
-		UpdateEnemyScoutingData();
 		m_lastLOSUpdateInFrame = currentFrame;
 	}
 }
@@ -1569,19 +1551,24 @@ void AAIMap::UpdateEnemyUnitsInLOS()
 
 	const int frame = ai->GetAICallback()->GetCurrentFrame();
 
-	int cellIndex(0);
-	for(int y = 0; y < yLOSMapSize; ++y)
-	{
-		for(int x = 0; x < xLOSMapSize; ++x)
+	// rows of los map are processed in parallel (every los cell corresponds to different tiles of the scout map)
+	AAI::s_threadPool.ParallelFor(0, yLOSMapSize, 16, [this, losMap, frame](int yStart, int yEnd) {
+		int cellIndex = yStart * xLOSMapSize;
+
+		for(int y = yStart; y < yEnd; ++y)
 		{
-			if(losMap[cellIndex] > 0)
+			for(int x = 0; x < xLOSMapSize; ++x)
 			{
-				m_scoutedEnemyUnitsMap.ResetTiles(x, y, frame);
-			}
+				if(losMap[cellIndex] > 0)
+				{
+					m_scoutedEnemyUnitsMap.ResetTiles(x, y, frame);
+					SetScoutingDataOutdated(x * losMapResolution, y * losMapResolution, (x+1) * losMapResolution - 1, (y+1) * losMapResolution - 1);
+				}
 
-			++cellIndex;
+				++cellIndex;
+			}
 		}
-	}
+	});
 
 	for(int y = 0; y < ySectors; ++y)
 	{
@@ -1589,32 +1576,51 @@ void AAIMap::UpdateEnemyUnitsInLOS()
 			m_sector[x][y].m_enemyUnitsDetectedBySensor = 0;
 	}
 
-	// update enemy units
+	// update enemy units (tracked via the enemy enter/leave LOS/radar events, only synchronized with the engine at a low rate)
+	AAIEnemySightings* enemySightings = ai->EnemySightings();
+	{
+		AAI_TRACE_SCOPE("AAIEnemySightings::Synchronize")
+		enemySightings->Synchronize(frame, false);
+	}
+
 	MobileTargetTypeValues spottedEnemyCombatUnitsByTargetType;
-	const int numberOfEnemyUnits = ai->GetAICallback()->GetEnemyUnitsInRadarAndLos(&(m_unitsInLOS.front()));
 
-	for(int i = 0; i < numberOfEnemyUnits; ++i)
+	m_enemyUnitGrid.StartUpdate();
+
+	for(const UnitId& unitId : enemySightings->GetVisibleUnits())
 	{
-		const float3                   pos = ai->GetAICallback()->GetUnitPos(m_unitsInLOS[i]);
-		const springLegacyAI::UnitDef* def = ai->GetAICallback()->GetUnitDef(m_unitsInLOS[i]);
+		const float3 pos = ai->GetAICallback()->GetUnitPos(unitId.id);
+		enemySightings->UpdatePosition(unitId, pos, frame);
 
-		if(def) // unit is within los
+		const AAIEnemySighting& sighting = enemySightings->GetSighting(unitId);
+
+		if(sighting.inLOS && sighting.unitDefId.IsValid())
 		{
+			const UnitDefId defId = sighting.unitDefId;
+
+			m_enemyUnitGrid.AddUnit( AAIEnemyUnit(unitId, defId, ai->s_buildTree.GetTargetType(defId), pos) );
+
 			ScoutMapTile tile = m_scoutedEnemyUnitsMap.GetScoutMapTile(pos);
 
 			// make sure unit is within the map (e.g. no aircraft that has flown outside of the map)
 			if(tile.IsValid())
 			{
-				const UnitDefId defId(def->id);
 				const AAIUnitCategory& category = ai->s_buildTree.GetUnitCategory(defId);
 
-				// add (finished) buildings/combat units to scout map
+				// add (finished) buildings/combat units to scout map (bomb targets are checked when unit enters LOS)
 				if( category.IsBuilding() || category.IsCombatUnit() )
 				{
-					if(ai->GetAICallback()->UnitBeingBuilt(m_unitsInLOS[i]) == false)
+					// construction state only needs to be checked until unit has been seen finished
+					if( (sighting.finished == false) && (ai->GetAICallback()->UnitBeingBuilt(unitId.id) == false) )
+						enemySightings->SetFinished(unitId);
+
+					if(sighting.finished)
+					{
 						m_scoutedEnemyUnitsMap.AddEnemyUnit(defId, tile);
 
-					ai->UnitTable()->CheckBombTarget(UnitId(m_unitsInLOS[i]), defId, category, pos);
+						const MapPos tilePos = m_scoutedEnemyUnitsMap.GetBuildMapPos(tile);
+						SetScoutingDataOutdated(tilePos.x, tilePos.y, tilePos.x, tilePos.y);
+					}
 				}
 
 				if(category.IsCombatUnit())
@@ -1626,6 +1632,8 @@ void AAIMap::UpdateEnemyUnitsInLOS()
 		}
 		else // unit on radar only
 		{
+			m_enemyUnitGrid.AddUnit( AAIEnemyUnit(unitId, UnitDefId(), AAITargetType(), pos) );
+
 			AAISector* sector = GetSectorOfPos(pos);
 
 			if(sector)
@@ -1633,6 +1641,8 @@ void AAIMap::UpdateEnemyUnitsInLOS()
 		}
 	}
 
+	m_enemyUnitGrid.FinishUpdate();
+
 	ai->Brain()->UpdateMaxCombatUnitsSpotted(spottedEnemyCombatUnitsByTargetType);
 }
 
@@ -1644,7 +1654,11 @@ void AAIMap::UpdateFriendlyUnitsInLos()
 			m_sector[x][y].ResetLocalCombatPower();
 	}
 
-	const int numberOfFriendlyUnits = ai->GetAICallback()->GetFriendlyUnits(&(m_unitsInLOS.front()));
+	int numberOfFriendlyUnits(0);
+	{
+		AAI_TRACE_SCOPE("IAICallback::GetFriendlyUnits")
+		numberOfFriendlyUnits = ai->GetAICallback()->GetFriendlyUnits(&(m_unitsInLOS.front()));
+	}
 
 	for(int i = 0; i < numberOfFriendlyUnits; ++i)
 	{
@@ -1665,21 +1679,78 @@ void AAIMap::UpdateFriendlyUnitsInLos()
 	}
 }
 
-void AAIMap::UpdateEnemyScoutingData()
+void AAIMap::SetScoutingDataOutdated(int xStart, int yStart, int xEnd, int yEnd)
+{
+	// tiles beyond the last sector (if map size is not a multiple of the sector size) are not assigned to any sector
+	const int xFirstSector = std::min(xStart / xSectorSizeMap, xSectors-1);
+	const int xLastSector  = std::min(xEnd   / xSectorSizeMap, xSectors-1);
+	const int yFirstSector = std::min(yStart / ySectorSizeMap, ySectors-1);
+	const int yLastSector  = std::min(yEnd   / ySectorSizeMap, ySectors-1);
+
+	for(int y = yFirstSector; y <= yLastSector; ++y)
+	{
+		for(int x = xFirstSector; x <= xLastSector; ++x)
+			m_scoutingDataOutdated[x + y * xSectors].store(true, std::memory_order_relaxed);
+	}
+}
+
+void AAIMap::UpdateEnemyScoutingDataOfSector(int x, int y, int currentFrame)
 {
-	std::fill(m_buildingsOnContinent.begin(), m_buildingsOnContinent.end(), 0);
+	AAISector& sector = m_sector[x][y];
+	std::vector<int>& continentsOfScoutedUnits = m_continentsOfScoutedUnitsInSector[x + y * xSectors];
+
+	// remove previous data of the sector from the totals
+	const int previousEnemyBuildings = sector.GetNumberOfEnemyBuildings();
+	m_scoutedEnemyBuildings -= previousEnemyBuildings;
+	m_sectorLocationOfEnemyBuildings.x -= previousEnemyBuildings * x;
+	m_sectorLocationOfEnemyBuildings.y -= previousEnemyBuildings * y;
+
+	for(const int continentId : continentsOfScoutedUnits)
+		--m_buildingsOnContinent[continentId];
+
+	continentsOfScoutedUnits.clear();
+
+	sector.ResetScoutedEnemiesData();
+	m_scoutedEnemyUnitsMap.UpdateSectorWithScoutedUnits(&sector, continentsOfScoutedUnits, currentFrame);
+
+	// add current data
+	const int enemyBuildings = sector.GetNumberOfEnemyBuildings();
+	m_scoutedEnemyBuildings += enemyBuildings;
+	m_sectorLocationOfEnemyBuildings.x += enemyBuildings * x;
+	m_sectorLocationOfEnemyBuildings.y += enemyBuildings * y;
+
+	for(const int continentId : continentsOfScoutedUnits)
+		++m_buildingsOnContinent[continentId];
+
+	m_scoutingDataOutdated[x + y * xSectors].store(false, std::memory_order_relaxed);
+}
+
+void AAIMap::UpdateSectorSlice()
+{
+	const int currentFrame    = ai->GetAICallback()->GetCurrentFrame();
+	const int numberOfSectors = xSectors * ySectors;
+
+	for(int i = 0; i < m_sectorsPerSlice; ++i)
+	{
+		const int x = m_nextSectorToUpdate % xSectors;
+		const int y = m_nextSectorToUpdate / xSectors;
+
+		// weight of scouted mobile units depends on the time since they have been seen, i.e. data of these sectors changes even if not scouted
+		if( m_scoutingDataOutdated[m_nextSectorToUpdate].load(std::memory_order_relaxed) || m_sector[x][y].HasScoutedMobileEnemies() )
+			UpdateEnemyScoutingDataOfSector(x, y, currentFrame);
+
+		m_nextSectorToUpdate = (m_nextSectorToUpdate + 1) % numberOfSectors;
+	}
+}
 
+void AAIMap::UpdateEnemyScoutingData()
+{
 	const int currentFrame = ai->GetAICallback()->GetCurrentFrame();
-	
-	// map of known enemy buildings has been updated -> update sector data
+
 	for(int y = 0; y < ySectors; ++y)
 	{
 		for(int x = 0; x < xSectors; ++x)
-		{
-			m_sector[x][y].ResetScoutedEnemiesData();
-
-			m_scoutedEnemyUnitsMap.UpdateSectorWithScoutedUnits(&m_sector[x][y], m_buildingsOnContinent, currentFrame);
-		}
+			UpdateEnemyScoutingDataOfSector(x, y, currentFrame);
 	}
 }
 
@@ -1752,7 +1823,7 @@ float3 AAIMap::DeterminePositionOfEnemyBuildingInSector(int xStart, int xEnd, in
 		}
 	}
 
-	ai->Log("Error: Could not find position of enemy building in sector (%i, %i) despite enemy buildings in sector!\n", xStart/xSectorSizeMap, yStart/ySectorSizeMap);
+	ai->Log(ELogCategory::MAP, ELogLevel::ERRORS, "Error: Could not find position of enemy building in sector (%i, %i) despite enemy buildings in sector!\n", xStart/xSectorSizeMap, yStart/ySectorSizeMap);
 
 	float3 selectedPosition;
 	selectedPosition.x = static_cast<float>(xStart * SQUARE_SIZE);
@@ -1763,31 +1834,21 @@ float3 AAIMap::DeterminePositionOfEnemyBuildingInSector(int xStart, int xEnd, in
 
 void AAIMap::UpdateSectors()
 {
-	int scoutedEnemyBuildings(0);
-	MapPos sectorLocationOfEnemyBuidlings(0, 0);
-
 	for(int x = 0; x < xSectors; ++x)
 	{
 		for(int y = 0; y < ySectors; ++y)
 		{
-			m_sector[x][y].DecreaseLostUnits();
-
-			const int enemyBuildings = m_sector[x][y].GetNumberOfEnemyBuildings();
-			if(enemyBuildings > 0)
-			{
-				scoutedEnemyBuildings += enemyBuildings;
-
-				sectorLocationOfEnemyBuidlings.x += enemyBuildings * x;
-				sectorLocationOfEnemyBuidlings.y += enemyBuildings * y;
-			}
+			if(m_sector[x][y].GetLostUnits() > 0.0f)
+				m_sector[x][y].DecreaseLostUnits();
 		}
 	}
 
-	if(scoutedEnemyBuildings > 0)
+	// number/location of scouted enemy buildings is kept up to date by the updates of the scouting data of the sectors
+	if(m_scoutedEnemyBuildings > 0)
 	{
-		m_centerOfEnemyBase.x =   static_cast<float>(xSectorSizeMap * sectorLocationOfEnemyBuidlings.x) / static_cast<float>(scoutedEnemyBuildings) 
+		m_centerOfEnemyBase.x =   static_cast<float>(xSectorSizeMap * m_sectorLocationOfEnemyBuildings.x) / static_cast<float>(m_scoutedEnemyBuildings) 
 								+ static_cast<float>(xSectorSizeMap/2);
-		m_centerOfEnemyBase.y =   static_cast<float>(ySectorSizeMap * sectorLocationOfEnemyBuidlings.y) / static_cast<float>(scoutedEnemyBuildings) 
+		m_centerOfEnemyBase.y =   static_cast<float>(ySectorSizeMap * m_sectorLocationOfEnemyBuildings.y) / static_cast<float>(m_scoutedEnemyBuildings) 
 								+ static_cast<float>(ySectorSizeMap/2);
 	}
 
@@ -1922,24 +1983,51 @@ const AAISector* AAIMap::DetermineSectorToContinueAttack(const AAISector *curren
 	return selectedSector;
 }
 
-const AAISector* AAIMap::DetermineSectorToAttack(const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType) const
+std::shared_ptr<const std::vector<SectorAttackData>> AAIMap::GetSectorAttackDataSnapshot() const
+{
+	// sector data may change anytime within a frame -> only reuse snapshot within the same frame
+	const int frame = ai->GetAICallback()->GetCurrentFrame();
+
+	if( !m_sectorAttackDataSnapshot || (m_sectorAttackDataSnapshotFrame != frame) )
+	{
+		std::shared_ptr< std::vector<SectorAttackData> > snapshot = std::make_shared< std::vector<SectorAttackData> >();
+		snapshot->reserve(xSectors * ySectors);
+
+		for(int x = 0; x < xSectors; ++x)
+		{
+			for(int y = 0; y < ySectors; ++y)
+				snapshot->push_back( m_sector[x][y].GetAttackData() );
+		}
+
+		// snapshots handed out before remain unchanged (they are released by their last user)
+		m_sectorAttackDataSnapshot      = snapshot;
+		m_sectorAttackDataSnapshotFrame = frame;
+	}
+
+	return m_sectorAttackDataSnapshot;
+}
+
+const AAISector* AAIMap::DetermineSectorToAttack(const std::vector<SectorAttackData>& sectorData, const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType)
 {
-	const float maxLostUnits = GetMaximumNumberOfLostUnits();
+	float maxLostUnits(0.0f);
+
+	for(const auto& sector : sectorData)
+	{
+		if(sector.lostUnits > maxLostUnits)
+			maxLostUnits = sector.lostUnits;
+	}
 
 	float highestRating(0.0f);
 	const AAISector* selectedSector = nullptr;
 
-	for(int x = 0; x < xSectors; ++x)
+	for(const auto& sector : sectorData)
 	{
-		for(int y = 0; y < ySectors; ++y)
-		{
-			const float rating = m_sector[x][y].GetAttackRating(globalCombatPower, continentCombatPower, assaultGroupsOfType, maxLostUnits);
+		const float rating = AAISector::GetAttackRating(sector, globalCombatPower, continentCombatPower, assaultGroupsOfType, maxLostUnits);
 
-			if(rating > highestRating)
-			{
-				selectedSector = &m_sector[x][y];
-				highestRating  = rating;
-			}
+		if(rating > highestRating)
+		{
+			selectedSector = sector.sector;
+			highestRating  = rating;
 		}
 	}
 
@@ -1987,9 +2075,9 @@ void AAIMap::AddOrRemoveStaticDefence(const float3& position, UnitDefId defence,
 {
 	// (un-)block area close to static defence
 	const TargetTypeValues blockValues(100.0f);
-	s_defenceMaps.ModifyTiles(position, 120.0f, ai->s_buildTree.GetFootprint(defence), blockValues, addDefence);
+	m_defenceMaps->ModifyTiles(position, 120.0f, ai->s_buildTree.GetFootprint(defence), blockValues, addDefence);
 
-	s_defenceMaps.ModifyTiles(position, ai->s_buildTree.GetMaxRange(defence), ai->s_buildTree.GetFootprint(defence), ai->s_buildTree.GetCombatPower(defence), addDefence);
+	m_defenceMaps->ModifyTiles(position, ai->s_buildTree.GetMaxRange(defence), ai->s_buildTree.GetFootprint(defence), ai->s_buildTree.GetCombatPower(defence), addDefence);
 
 	/*if(ai->GetAAIInstance() == 1)
 	{
@@ -2000,7 +2088,7 @@ void AAIMap::AddOrRemoveStaticDefence(const float3& position, UnitDefId defence,
 		{
 			for(int x = 0; x < xMapSize; ++x)
 			{
-				const float value = s_defenceMaps.GetValue(MapPos(x,y), ETargetType::SURFACE);
+				const float value = m_defenceMaps->GetValue(MapPos(x,y), ETargetType::SURFACE);
 
 				fprintf(file, "%3.1f ", value);
 			}
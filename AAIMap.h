@@ -16,11 +16,16 @@
 #include "AAIMapTypes.h"
 #include "AAIUnitTypes.h"
 #include "AAISector.h"
+#include "AAIEnemyUnitGrid.h"
+#include "AAIUnitStatistics.h"
 #include "System/float3.h"
 
 #include <vector>
 #include <list>
 #include <string>
+#include <memory>
+#include <map>
+#include <atomic>
 using namespace std;
 
 class AAI;
@@ -30,6 +35,43 @@ namespace springLegacyAI {
 }
 using namespace springLegacyAI;
 
+//! State of the search for the buildsite of a static defence (performed in several steps, see AAIMap::ContinueBuildsiteSearchForStaticDefence())
+struct StaticDefenceBuildsiteSearch
+{
+	StaticDefenceBuildsiteSearch() : terrainModifier(0.0f), range(0), xStart(0), yStart(0), xTiles(0), yTiles(0), nextTile(0) {}
+
+	//! The static defence for which a buildsite is searched
+	UnitDefId          staticDefence;
+
+	//! Target type against which the static defence shall be effective
+	AAITargetType      targetType;
+
+	//! How important placement on elevated ground is
+	float              terrainModifier;
+
+	UnitFootprint      footprint;
+
+	//! Range of the static defence (in map tiles)
+	int                range;
+
+	//! First map tile and number of tiles (in x and y direction) to be checked (every 4th tile is checked)
+	int                xStart, yStart, xTiles, yTiles;
+
+	//! Squared distances of the tiles to be checked to the center of the base
+	std::vector<float> distancesToBaseCenter;
+
+	StatisticalData    distanceStatistics;
+
+	//! Index of the next tile to be checked
+	int                nextTile;
+
+	//! Highest rated buildsite found so far
+	BuildSite          buildsite;
+
+	//! Map position of the highest rated buildsite found so far
+	MapPos             buildsiteMapPos;
+};
+
 class AAIMap
 {
 	friend AAIScoutedUnitsMap;
@@ -38,6 +80,12 @@ public:
 	AAIMap(AAI *ai, int xMapSize, int yMapSize, int losMapResolution);
 	~AAIMap(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the map data of this AAI instance (sectors, scouted units, LOS data)
+	size_t GetMemoryUsage() const;
+
+	//! @brief Returns the memory (in bytes) allocated by the map data shared by all AAI instances (build map, continents, defence maps, ...)
+	static size_t GetSharedMemoryUsage();
+
 	//! @brief Returns the map type
 	const AAIMapType& GetMapType() const { return s_mapType; }
 
@@ -47,6 +95,9 @@ public:
 	//! @brief Return the buffer storing unit ids of all units that are currently within line of sight
 	std::vector<int>& UnitsInLOS() { return m_unitsInLOS; }
 
+	//! @brief Returns the enemy units within LOS/radar as of the last update of the units in LOS (see CheckUnitsInLOSUpdate())
+	const AAIEnemyUnitGrid& GetEnemyUnitGrid() const { return m_enemyUnitGrid; }
+
 	//! @brief Returns the approximated map coordinates of the center of the enemy base (determined based on scouted enemy buildings)
 	const MapPos& GetCenterOfEnemyBase() const { return m_centerOfEnemyBase; }
 
@@ -107,8 +158,14 @@ public:
 	//! @brief Searches for a buildsite that is preferably elevated with respect to its surroundings and not close to the map edges
 	BuildSite DetermineElevatedBuildsite(UnitDefId buildingDefId, int xStart, int xEnd, int yStart, int yEnd, float range) const;
 
-	//! @brief Determines the most suitable buidliste for the given static defence in the given sector (returns ZeroVector if no buildsite found)
-	float3 DetermineBuildsiteForStaticDefence(UnitDefId staticDefence, const AAISector* sector, const AAITargetType& targetType, float terrainModifier) const;
+	//! @brief Initializes the search for the most suitable buildsite for the given static defence in the given sector
+	void StartBuildsiteSearchForStaticDefence(StaticDefenceBuildsiteSearch& search, UnitDefId staticDefence, const AAISector* sector, const AAITargetType& targetType, float terrainModifier) const;
+
+	//! @brief Rates the next (up to) given number of tiles; returns true if all tiles have been checked (i.e. search.buildsite is the result)
+	bool ContinueBuildsiteSearchForStaticDefence(StaticDefenceBuildsiteSearch& search, int maxTiles) const;
+
+	//! @brief Returns whether construction of the static defence is (still) possible at the buildsite found by the given search
+	bool IsBuildsiteForStaticDefenceValid(const StaticDefenceBuildsiteSearch& search) const;
 
 	//! @brief Updates buildmap & defence map (for static defences) and building data of target sector 
 	//!        Return true if building will be placed at a valid position, i.e. inside sectors
@@ -138,6 +195,14 @@ public:
 	//! @brief Decreases the lost units and updates the the "center of gravity" of the enemy base(s)
 	void UpdateSectors();
 
+	//! @brief Updates the scouting data (enemy buildings/combat power) of the next slice of sectors (round-robin, i.e. every sector is updated
+	//!        once per AAIConstants::sectorUpdateSlices calls); sectors whose scout map tiles have not changed since their last update
+	//!        (i.e. not within LOS) and that do not contain scouted mobile units (whose weight decreases over time) are skipped.
+	void UpdateSectorSlice();
+
+	//! @brief Updates the scouting data of all sectors at once (regardless of whether they have changed)
+	void UpdateEnemyScoutingData();
+
 	//! @brief Checks for new neighbours (and removes old ones if necessary)
 	void UpdateNeighbouringSectors(std::vector< std::list<AAISector*> >& sectorsInDistToBase);
 
@@ -150,8 +215,11 @@ public:
 	//! @brief Returns a sector to proceed with attack (nullptr if none found)
 	const AAISector* DetermineSectorToContinueAttack(const AAISector *currentSector, const MobileTargetTypeValues& targetTypeOfUnits, AAIMovementType moveTypeOfUnits) const;
 
-	//! @brief Returns the sector which is the highest rated attack target (or nullptr if none found)
-	const AAISector* DetermineSectorToAttack(const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType) const;
+	//! @brief Returns a snapshot of the attack related data of all sectors; the snapshot is never modified and may be shared with planning tasks (a new one is created if data may have changed)
+	std::shared_ptr<const std::vector<SectorAttackData>> GetSectorAttackDataSnapshot() const;
+
+	//! @brief Returns the sector which is the highest rated attack target (or nullptr if none found), thread safe as only the given sector data is accessed
+	static const AAISector* DetermineSectorToAttack(const std::vector<SectorAttackData>& sectorData, const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType);
 
 	//! The sectors of the map
 	std::vector< std::vector<AAISector> > m_sector;
@@ -193,7 +261,7 @@ public:
 	static AAITeamSectorMap s_teamSectorMap;
 
 	//! The buildmap stores the type/occupation status of every cell;
-	static std::vector<BuildMapTileType> s_buildmap;
+	static AAIBuildMap s_buildmap;
 
 	static constexpr int ignoreContinentID = -1;
 
@@ -204,8 +272,11 @@ private:
 	//! @brief Updates own/allied buildings/units on the map (in each sector)
 	void UpdateFriendlyUnitsInLos();
 
-	//! @brief Updates enemy buildings/enemy combat power in sectors based on scout map entris updated by UpdateEnemyUnitsInLOS()
-	void UpdateEnemyScoutingData();
+	//! @brief Updates enemy buildings/enemy combat power of the given sector based on scout map entries updated by UpdateEnemyUnitsInLOS()
+	void UpdateEnemyScoutingDataOfSector(int x, int y, int currentFrame);
+
+	//! @brief Marks the scouting data of the sector(s) containing the given rectangle (in build map coordinates) as outdated
+	void SetScoutingDataOutdated(int xStart, int yStart, int xEnd, int yEnd);
 
 	//! @brief Helper function to check if the given building may be constructed at the given map position
 	BuildSite CheckConstructionAt(const UnitFootprint& footprint, const springLegacyAI::UnitDef* unitDef, const MapPos& mapPos) const;
@@ -283,21 +354,48 @@ private:
 	//! Stores the defId of the building or combat unit placed on that cell (0 if none), same resolution as los map
 	AAIScoutedUnitsMap m_scoutedEnemyUnitsMap;
 
+	//! Enemy units within LOS/radar for local queries (updated together with the scouted enemy units map)
+	AAIEnemyUnitGrid   m_enemyUnitGrid;
+
 	//! The number of scouted enemy units on the given continent
 	std::vector<int>   m_buildingsOnContinent;
 
+	//! The continent ids of the scouted enemy units of every sector (index x + y * xSectors) as of the last update of the sector
+	std::vector< std::vector<int> > m_continentsOfScoutedUnitsInSector;
+
+	//! Whether scout map tiles of the sector (index x + y * xSectors) have been updated since the last update of its scouting data
+	//! (set by multiple threads during the LOS update)
+	std::vector< std::atomic<bool> > m_scoutingDataOutdated;
+
+	//! Total number of scouted enemy buildings and sum of their sector coordinates (to determine the center of the enemy base)
+	int                m_scoutedEnemyBuildings;
+	MapPos             m_sectorLocationOfEnemyBuildings;
+
+	//! Index of the sector to be updated next by UpdateSectorSlice() and number of sectors per slice
+	int                m_nextSectorToUpdate;
+	int                m_sectorsPerSlice;
+
 	//! Approximate center of enemy base in build map coordinates (not reliable if enemy buldings are spread over map)
 	MapPos             m_centerOfEnemyBase;
 
 	//! The frame in which the last update of the units in LOS has been performed
 	int                m_lastLOSUpdateInFrame;
 
+	//! Last snapshot of the attack related data of all sectors (see GetSectorAttackDataSnapshot())
+	mutable std::shared_ptr<const std::vector<SectorAttackData>> m_sectorAttackDataSnapshot;
+
+	//! The frame in which m_sectorAttackDataSnapshot has been created
+	mutable int        m_sectorAttackDataSnapshotFrame;
+
+	//! The defence maps of the ally team of this AAI instance (shared with allied AAI instances)
+	AAIDefenceMaps*    m_defenceMaps;
+
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 	// static (shared with other ai players)
 	///////////////////////////////////////////////////////////////////////////////////////////////////////////////
 
-	//! The defence maps (storing combat power by static defences vs the different mobile target types)
-	static AAIDefenceMaps s_defenceMaps;
+	//! The defence maps of every ally team (storing combat power by static defences vs the different mobile target types)
+	static std::map<int, AAIDefenceMaps> s_defenceMapsOfAllyTeams;
 
 	//! Stores the id of the continent every tiles belongs to and additional information about continents
 	static AAIContinentMap s_continentMap;
@@ -313,7 +411,6 @@ private:
 	static int xDefMapSize, yDefMapSize;		// x and y size of the defence maps (1/4 resolution of map)
 	static std::list<AAIMetalSpot> metal_spots;
 
-	static std::vector<int>   blockmap;		// number of buildings which ordered a cell to blocked
 	static std::vector<float> plateau_map;	// positive values indicate plateaus, same resolution as continent map 1/4 of resolution of blockmap/buildmap
 	static std::vector<int>   ship_movement_map;	// movement maps for different categories, 1/4 of resolution of blockmap/buildmap
 	static std::vector<int>   kbot_movement_map;
@@ -11,11 +11,33 @@
 #include "AAIConfig.h"
 #include "AAIMap.h"
 
+void AAITeamSectorMap::Init(int xSectors, int ySectors)
+{
+	m_xSectors        = xSectors;
+	m_numberOfSectors = xSectors*ySectors;
+	m_teamMap.reset(new std::atomic<int>[xSectors*ySectors]);
+
+	for(int sector = 0; sector < xSectors*ySectors; ++sector)
+		m_teamMap[sector].store(sectorUnoccupied);
+}
+
+bool AAITeamSectorMap::TryToOccupySector(int x, int y, int team)
+{
+	int expectedTeam(sectorUnoccupied);
+	return m_teamMap[x + y * m_xSectors].compare_exchange_strong(expectedTeam, team, std::memory_order_acq_rel);
+}
+
 void AAIDefenceMaps::Init(int xMapSize, int yMapSize)
 { 
 	m_xDefenceMapSize = xMapSize/defenceMapResolution;
 	m_yDefenceMapSize = yMapSize/defenceMapResolution;
-	m_defenceMaps.resize(AAITargetType::numberOfMobileTargetTypes, std::vector<float>(m_xDefenceMapSize*m_yDefenceMapSize, 0.0f) );
+	m_numberOfTiles   = m_xDefenceMapSize*m_yDefenceMapSize;
+
+	const int totalNumberOfTiles = AAITargetType::numberOfMobileTargetTypes * m_numberOfTiles;
+	m_defenceMaps.reset(new std::atomic<float>[totalNumberOfTiles]);
+
+	for(int tile = 0; tile < totalNumberOfTiles; ++tile)
+		m_defenceMaps[tile].store(0.0f);
 }
 
 void AAIDefenceMaps::ModifyTiles(const float3& position, float maxWeaponRange, const UnitFootprint& footprint, const TargetTypeValues& combatPower, bool addValues)
@@ -49,24 +71,161 @@ void AAIDefenceMaps::ModifyTiles(const float3& position, float maxWeaponRange, c
 
 void AAIDefenceMaps::AddDefence(int tile, const TargetTypeValues& combatPower)
 {
-	m_defenceMaps[AAITargetType::surfaceIndex][tile]   += combatPower.GetValue(ETargetType::SURFACE);
-	m_defenceMaps[AAITargetType::airIndex][tile]       += combatPower.GetValue(ETargetType::AIR);
-	m_defenceMaps[AAITargetType::floaterIndex][tile]   += combatPower.GetValue(ETargetType::FLOATER);
-	m_defenceMaps[AAITargetType::submergedIndex][tile] += combatPower.GetValue(ETargetType::SUBMERGED);
+	AddValue(AAITargetType::surfaceIndex,   tile, combatPower.GetValue(ETargetType::SURFACE),   false);
+	AddValue(AAITargetType::airIndex,       tile, combatPower.GetValue(ETargetType::AIR),       false);
+	AddValue(AAITargetType::floaterIndex,   tile, combatPower.GetValue(ETargetType::FLOATER),   false);
+	AddValue(AAITargetType::submergedIndex, tile, combatPower.GetValue(ETargetType::SUBMERGED), false);
 }
 
 void AAIDefenceMaps::RemoveDefence(int tile, const TargetTypeValues& combatPower)
 {
-	m_defenceMaps[AAITargetType::surfaceIndex][tile]   -= combatPower.GetValue(ETargetType::SURFACE);
-	m_defenceMaps[AAITargetType::airIndex][tile]       -= combatPower.GetValue(ETargetType::AIR);
-	m_defenceMaps[AAITargetType::floaterIndex][tile]   -= combatPower.GetValue(ETargetType::FLOATER);
-	m_defenceMaps[AAITargetType::submergedIndex][tile] -= combatPower.GetValue(ETargetType::SUBMERGED);
+	AddValue(AAITargetType::surfaceIndex,   tile, -combatPower.GetValue(ETargetType::SURFACE),   true);
+	AddValue(AAITargetType::airIndex,       tile, -combatPower.GetValue(ETargetType::AIR),       true);
+	AddValue(AAITargetType::floaterIndex,   tile, -combatPower.GetValue(ETargetType::FLOATER),   true);
+	AddValue(AAITargetType::submergedIndex, tile, -combatPower.GetValue(ETargetType::SUBMERGED), true);
+}
+
+void AAIDefenceMaps::AddValue(int targetTypeIndex, int tile, float value, bool limitToPositiveValues)
+{
+	std::atomic<float>& tileValue = m_defenceMaps[targetTypeIndex * m_numberOfTiles + tile];
+
+	float currentValue = tileValue.load(std::memory_order_relaxed);
+	float newValue;
+
+	do
+	{
+		newValue = currentValue + value;
+
+		if(limitToPositiveValues && (newValue < 0.0f))
+			newValue = 0.0f;
+	}
+	while(tileValue.compare_exchange_weak(currentValue, newValue, std::memory_order_relaxed) == false);
+}
+
+void AAIBuildMap::Init(int xMapSize, int yMapSize)
+{
+	m_xMapSize = xMapSize;
+
+	const int numberOfTiles = xMapSize * yMapSize;
+
+	m_terrain.assign(numberOfTiles, static_cast<uint8_t>(EBuildMapTileType::NOT_SET));
+	m_blockingCounters.assign(numberOfTiles, 0);
+
+	m_occupation.reset(new std::atomic<uint8_t>[numberOfTiles]);
+
+	for(int tile = 0; tile < numberOfTiles; ++tile)
+		m_occupation[tile].store(static_cast<uint8_t>(EBuildMapTileType::NOT_SET));
+
+	m_rowLocks.reset(new std::mutex[(yMapSize + rowsPerLock - 1) / rowsPerLock]);
+}
+
+void AAIBuildMap::Clear()
+{
+	m_terrain.clear();
+	m_blockingCounters.clear();
+	m_occupation.reset();
+	m_rowLocks.reset();
+	m_xMapSize = 0;
+}
+
+size_t AAIBuildMap::GetMemoryUsage() const
+{
+	const size_t numberOfTiles = m_terrain.size();
+	const size_t numberOfRows  = (m_xMapSize > 0) ? numberOfTiles / static_cast<size_t>(m_xMapSize) : 0;
+
+	return GetAllocatedMemory(m_terrain) + GetAllocatedMemory(m_blockingCounters) + numberOfTiles * sizeof(std::atomic<uint8_t>) 
+	     + ((numberOfRows + rowsPerLock - 1) / rowsPerLock) * sizeof(std::mutex);
+}
+
+void AAIBuildMap::SetTileType(int x, int y, BuildMapTileType tileType)
+{
+	const int tileIndex = x + y * m_xMapSize;
+
+	m_terrain[tileIndex] |= (tileType.m_tileType & terrainTileTypes);
+	m_occupation[tileIndex].fetch_or(tileType.m_tileType & ~terrainTileTypes);
+}
+
+void AAIBuildMap::ChangeOccupation(int xStart, int yStart, int xEnd, int yEnd, bool occupy)
+{
+	if( (xStart >= xEnd) || (yStart >= yEnd) )
+		return;
+
+	const uint8_t free     = static_cast<uint8_t>(EBuildMapTileType::FREE);
+	const uint8_t occupied = static_cast<uint8_t>(EBuildMapTileType::OCCUPIED);
+	const uint8_t blocked  = static_cast<uint8_t>(EBuildMapTileType::BLOCKED_SPACE);
 
-	for(int targetTypeIndex = 0; targetTypeIndex < AAITargetType::numberOfMobileTargetTypes; ++targetTypeIndex)
+	LockRows(yStart, yEnd);
+
+	for(int y = yStart; y < yEnd; ++y)
 	{
-		if(m_defenceMaps[targetTypeIndex][tile] < 0.0f)
-			m_defenceMaps[targetTypeIndex][tile] = 0.0f;
+		for(int x = xStart; x < xEnd; ++x)
+		{
+			std::atomic<uint8_t>& occupation = m_occupation[x + y * m_xMapSize];
+
+			// occupation status is only changed while holding the lock of the stripe, thus no read-modify-write races possible
+			if(occupy)
+				occupation.store( (occupation.load(std::memory_order_relaxed) & ~free) | occupied, std::memory_order_relaxed);
+			else
+				occupation.store( (occupation.load(std::memory_order_relaxed) & ~(occupied | blocked)) | free, std::memory_order_relaxed);
+		}
 	}
+
+	UnlockRows(yStart, yEnd);
+}
+
+void AAIBuildMap::ChangeBlocking(int xStart, int yStart, int xEnd, int yEnd, bool block)
+{
+	if( (xStart >= xEnd) || (yStart >= yEnd) )
+		return;
+
+	const uint8_t free     = static_cast<uint8_t>(EBuildMapTileType::FREE);
+	const uint8_t occupied = static_cast<uint8_t>(EBuildMapTileType::OCCUPIED);
+	const uint8_t blocked  = static_cast<uint8_t>(EBuildMapTileType::BLOCKED_SPACE);
+
+	LockRows(yStart, yEnd);
+
+	for(int y = yStart; y < yEnd; ++y)
+	{
+		for(int x = xStart; x < xEnd; ++x)
+		{
+			const int tileIndex = x + y * m_xMapSize;
+			std::atomic<uint8_t>& occupation = m_occupation[tileIndex];
+			const uint8_t currentOccupation  = occupation.load(std::memory_order_relaxed);
+
+			if(block)
+			{
+				// if no building ordered that cell to be blocked, update buildmap
+				// (only if space is not already occupied by a building)
+				if( (m_blockingCounters[tileIndex] == 0) && (currentOccupation & free) )
+					occupation.store( (currentOccupation & ~free) | blocked, std::memory_order_relaxed);
+
+				++m_blockingCounters[tileIndex];
+			}
+			else if(m_blockingCounters[tileIndex] > 0)
+			{
+				--m_blockingCounters[tileIndex];
+
+				// if cell is not blocked anymore, mark cell on buildmap as empty (only if it has been marked bloked
+				//					- if it is not marked as blocked its occupied by another building or unpassable)
+				if( (m_blockingCounters[tileIndex] == 0) && (currentOccupation & blocked) )
+					occupation.store( (currentOccupation & ~(occupied | blocked)) | free, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	UnlockRows(yStart, yEnd);
+}
+
+void AAIBuildMap::LockRows(int yStart, int yEnd)
+{
+	for(int stripe = yStart / rowsPerLock; stripe <= (yEnd - 1) / rowsPerLock; ++stripe)
+		m_rowLocks[stripe].lock();
+}
+
+void AAIBuildMap::UnlockRows(int yStart, int yEnd)
+{
+	for(int stripe = (yEnd - 1) / rowsPerLock; stripe >= yStart / rowsPerLock; --stripe)
+		m_rowLocks[stripe].unlock();
 }
 
 AAIScoutedUnitsMap::AAIScoutedUnitsMap(int xMapSize, int yMapSize, int losMapResolution) :
@@ -96,7 +255,7 @@ void AAIScoutedUnitsMap::ResetTiles(int xLosMap, int yLosMap, int frame)
 	}
 }
 
-void AAIScoutedUnitsMap::UpdateSectorWithScoutedUnits(AAISector *sector, std::vector<int>& buildingsOnContinent, int currentFrame)
+void AAIScoutedUnitsMap::UpdateSectorWithScoutedUnits(AAISector *sector, std::vector<int>& continentsOfScoutedUnits, int currentFrame)
 {
 	const int xStart = (sector->x * AAIMap::xSectorSizeMap) / scoutMapResolution;
 	const int yStart = (sector->y * AAIMap::ySectorSizeMap) / scoutMapResolution;
@@ -115,9 +274,7 @@ void AAIScoutedUnitsMap::UpdateSectorWithScoutedUnits(AAISector *sector, std::ve
 			{
 				sector->AddScoutedEnemyUnit(unitDefId, currentFrame - m_lastUpdateInFrameMap[tileIndex]);
 
-				const int continentId = AAIMap::s_continentMap.GetContinentID( MapPos((xStart+x)*scoutMapResolution, (yStart+y)*scoutMapResolution) );
-				
-				++buildingsOnContinent[continentId];
+				continentsOfScoutedUnits.push_back( AAIMap::s_continentMap.GetContinentID( MapPos((xStart+x)*scoutMapResolution, (yStart+y)*scoutMapResolution) ) );
 			}
 			
 			++tileIndex;
@@ -13,7 +13,11 @@
 #include "AAIUnitTypes.h"
 #include "AAISector.h"
 #include "AAIMapRelatedTypes.h"
+#include "AAIMemoryUsage.h"
 #include <vector>
+#include <atomic>
+#include <memory>
+#include <mutex>
 
 //! The map storing which sector has been taken (as base) by which AAI team. Used to avoid that multiple AAI instances expand 
 //! into the same sector or build defences in the sector of an allied player.
@@ -23,29 +27,38 @@ public:
 	AAITeamSectorMap() {}
 	
 	//! @brief Initializes all sectors as unoccupied
-	void Init(int xSectors, int ySectors) { m_teamMap.resize(xSectors, std::vector<int>(ySectors, sectorUnoccupied) ); }
+	void Init(int xSectors, int ySectors);
 
 	//! Returns whether sector has been occupied by any AAI player (allied, enemy, or own instance)
-	bool IsSectorOccupied(int x, int y)            const { return (m_teamMap[x][y] != sectorUnoccupied); }
+	bool IsSectorOccupied(int x, int y)            const { return (GetTeam(x, y) != sectorUnoccupied); }
 
 	//! @brief Returns true is sector is occupied by given team
-	bool IsOccupiedByTeam(int x, int y, int team) const { return (m_teamMap[x][y] == team); }
+	bool IsOccupiedByTeam(int x, int y, int team) const { return (GetTeam(x, y) == team); }
 
 	//! @brief Returns true if sector is occupied by a team other than the given one
-	bool IsOccupiedByOtherTeam(int x, int y, int team) const { return (m_teamMap[x][y] != team) && (m_teamMap[x][y] != sectorUnoccupied);}
+	bool IsOccupiedByOtherTeam(int x, int y, int team) const { const int occupyingTeam = GetTeam(x, y); return (occupyingTeam != team) && (occupyingTeam != sectorUnoccupied);}
 
 	//! @brief Returns the team that currently occupied the given sector
-	int GetTeam(int x, int y) const { return m_teamMap[x][y]; }
+	int GetTeam(int x, int y) const { return m_teamMap[x + y * m_xSectors].load(std::memory_order_acquire); }
 
-	//! @brief Set sector as occupied by given (ally) team
-	void SetSectorAsOccupiedByTeam(int x, int y, int team) { m_teamMap[x][y] = team; }
+	//! @brief Sets sector as occupied by given team if it is not occupied yet, returns false if sector has already been occupied (by any team)
+	bool TryToOccupySector(int x, int y, int team);
 
 	//! @brief Set sector as unoccupied
-	void SetSectorAsUnoccupied(int x, int y) { m_teamMap[x][y] = sectorUnoccupied; }
+	void SetSectorAsUnoccupied(int x, int y) { m_teamMap[x + y * m_xSectors].store(sectorUnoccupied, std::memory_order_release); }
+
+	//! @brief Returns the memory (in bytes) allocated by the map
+	size_t GetMemoryUsage() const { return static_cast<size_t>(m_numberOfSectors) * sizeof(std::atomic<int>); }
 
 private:
-	//! Stores the number of ai player which has taken that sector (-1 if none)
-	std::vector< std::vector<int> > m_teamMap;	
+	//! Stores the number of ai player which has taken that sector (-1 if none); atomic as it is accessed by all AAI instances
+	std::unique_ptr< std::atomic<int>[] > m_teamMap;
+
+	//! Number of sectors in x direction
+	int m_xSectors = 0;
+
+	//! Total number of sectors
+	int m_numberOfSectors = 0;
 
 	//! Valuefor unoccupied sector
 	static constexpr int sectorUnoccupied = -1;
@@ -58,17 +71,23 @@ public:
 	//! @brief Initializes all sectors as unoccupied
 	void Init(int xMapSize, int yMapSize);
 
+	//! @brief Returns whether defence maps have already been initialized
+	bool IsInitialized() const { return (m_numberOfTiles > 0); }
+
 	//! @brief Return the defence map value of a given map position
 	float GetValue(MapPos mapPosition, const AAITargetType& targetType) const 
 	{
 		const int tileIndex = mapPosition.x/defenceMapResolution + m_xDefenceMapSize * (mapPosition.y/defenceMapResolution);
-		return m_defenceMaps[targetType.GetArrayIndex()][tileIndex];
+		return m_defenceMaps[targetType.GetArrayIndex() * m_numberOfTiles + tileIndex].load(std::memory_order_relaxed);
 	}
 
 	//! @brief Modifies tiles within range of given position by combat power values
 	//!        Used to add or remove defences
 	void ModifyTiles(const float3& position, float maxWeaponRange, const UnitFootprint& footprint, const TargetTypeValues& combatPower, bool addValues);
 
+	//! @brief Returns the memory (in bytes) allocated by the maps
+	size_t GetMemoryUsage() const { return static_cast<size_t>(AAITargetType::numberOfMobileTargetTypes * m_numberOfTiles) * sizeof(std::atomic<float>); }
+
 private:
 	//! @brief Adds combat power values to given tile
 	void AddDefence(int tile, const TargetTypeValues& combatPower);
@@ -76,19 +95,91 @@ private:
 	//! @brief Removes combat power values to given tile
 	void RemoveDefence(int tile, const TargetTypeValues& combatPower);
 
-	//! The maps itself
-	std::vector< std::vector<float> > m_defenceMaps;
+	//! @brief Adds the given value to the given tile (lock free as maps may be modified by several allied AAI instances at the same time)
+	void AddValue(int targetTypeIndex, int tile, float value, bool limitToPositiveValues);
+
+	//! The maps itself (one map per mobile target type stored consecutively)
+	std::unique_ptr< std::atomic<float>[] > m_defenceMaps;
 
 	//! Horizontal size of the defence map
-	int m_xDefenceMapSize;
+	int m_xDefenceMapSize = 0;
 	
 	//! Vertical size of the defence map
-	int m_yDefenceMapSize;
+	int m_yDefenceMapSize = 0;
+
+	//! Number of tiles of a single defence map
+	int m_numberOfTiles = 0;
 
 	//! Lower resolution factor with respect to map resolution
 	static constexpr int defenceMapResolution = 4;
 };
 
+//! The build map stores the terrain type and the occupation status of every map tile. It is shared by all AAI instances:
+//! The terrain layer is immutable after map analysis, the occupation layer can be queried lock free whereas changes
+//! (which comprise multiple tiles and the blocking counters) are serialized per horizontal stripe of the map.
+class AAIBuildMap
+{
+public:
+	//! @brief Initializes all tiles (terrain type and occupation not set)
+	void Init(int xMapSize, int yMapSize);
+
+	//! @brief Frees the memory of the build map
+	void Clear();
+
+	//! @brief Returns the type (terrain and occupation status) of the given tile
+	BuildMapTileType GetTileType(int x, int y) const 
+	{
+		const int tileIndex = x + y * m_xMapSize;
+		return BuildMapTileType( static_cast<uint8_t>(m_terrain[tileIndex] | m_occupation[tileIndex].load(std::memory_order_relaxed)) );
+	}
+
+	//! @brief Returns true if any of the given tile types is set for the given tile
+	bool IsTileTypeSet(int x, int y, BuildMapTileType tileType) const { return GetTileType(x, y).IsTileTypeSet(tileType); }
+
+	//! @brief Returns true if none of the given tile types is set for the given tile
+	bool IsTileTypeNotSet(int x, int y, BuildMapTileType tileType) const { return GetTileType(x, y).IsTileTypeNotSet(tileType); }
+
+	//! @brief Adds the given tile type(s) - only to be called during map analysis (i.e. before build map is accessed by other AAI instances)
+	void SetTileType(int x, int y, BuildMapTileType tileType);
+
+	//! @brief Marks the tiles within the given rectangle (end excluded) as occupied/free
+	void ChangeOccupation(int xStart, int yStart, int xEnd, int yEnd, bool occupy);
+
+	//! @brief Increases/decreases the blocking counters of the tiles within the given rectangle (end excluded). Free tiles
+	//!        are blocked when blocking is requested the first time, blocked tiles are freed when no more blocking is requested.
+	void ChangeBlocking(int xStart, int yStart, int xEnd, int yEnd, bool block);
+
+	//! @brief Returns the memory (in bytes) allocated by the build map
+	size_t GetMemoryUsage() const;
+
+private:
+	//! @brief Locks/unlocks the stripes covering the given rows (locked in ascending order to avoid dead locks)
+	void LockRows(int yStart, int yEnd);
+	void UnlockRows(int yStart, int yEnd);
+
+	//! Terrain type (land, water, flat, cliff) of every tile
+	std::vector<uint8_t> m_terrain;
+
+	//! Occupation status (free, occupied, blocked) of every tile 
+	std::unique_ptr< std::atomic<uint8_t>[] > m_occupation;
+
+	//! Number of buildings which requested a tile to be blocked (only accessed while holding the lock of the corresponding stripe)
+	std::vector<int> m_blockingCounters;
+
+	//! Locks for the horizontal stripes of the map
+	std::unique_ptr<std::mutex[]> m_rowLocks;
+
+	//! Horizontal size of the build map
+	int m_xMapSize = 0;
+
+	//! Number of rows that are covered by a single lock
+	static constexpr int rowsPerLock = 32;
+
+	//! Tile types that describe the terrain
+	static constexpr uint8_t terrainTileTypes = static_cast<uint8_t>(EBuildMapTileType::LAND) | static_cast<uint8_t>(EBuildMapTileType::WATER) 
+											  | static_cast<uint8_t>(EBuildMapTileType::FLAT) | static_cast<uint8_t>(EBuildMapTileType::CLIFF);
+};
+
 //! This type is used to access a specific tile of a scout map
 class ScoutMapTile
 {
@@ -138,8 +229,14 @@ public:
 			return ScoutMapTile(-1);	
 	}
 
-	//! @brief Updates the scouted units within the given sector
-	void UpdateSectorWithScoutedUnits(AAISector *sector, std::vector<int>& buildingsOnContinent, int currentFrame);
+	//! @brief Returns the position (in build map coordinates) of the given tile
+	MapPos GetBuildMapPos(ScoutMapTile tile) const { return MapPos( (tile.m_tileIndex % m_xScoutMapSize) * scoutMapResolution, (tile.m_tileIndex / m_xScoutMapSize) * scoutMapResolution); }
+
+	//! @brief Updates the scouted units within the given sector; the continent id of every scouted unit is added to the given list
+	void UpdateSectorWithScoutedUnits(AAISector *sector, std::vector<int>& continentsOfScoutedUnits, int currentFrame);
+
+	//! @brief Returns the memory (in bytes) allocated by the map
+	size_t GetMemoryUsage() const { return GetAllocatedMemory(m_scoutedUnitsMap) + GetAllocatedMemory(m_lastUpdateInFrameMap); }
 
 private:
 	//! Horizontal size of the scouted units map
@@ -186,6 +283,9 @@ public:
 	//! @brief Determines the continents, i.e. which parts of the map are connected
 	void DetectContinents(std::vector<AAIContinent>& continents, const float *heightMap, const int xMapSize, const int yMapSize);
 
+	//! @brief Returns the memory (in bytes) allocated by the continent map
+	size_t GetMemoryUsage() const { return GetAllocatedMemory(m_continentMap); }
+
 private:
 	//! @brief Helper function for detection of continents - checks if a given tile belongs to a continent and sets values accordingly
 	void CheckIfTileBelongsToLandContinent(int continentMapTileIndex, float tileHeight, std::vector<AAIContinent>& continents, int continentId, std::vector<int>* nextEdgeCells);
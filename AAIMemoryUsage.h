@@ -0,0 +1,152 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_MEMORY_USAGE_H
+#define AAI_MEMORY_USAGE_H
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+//! Estimated overhead (in bytes) of a node of a std::list (pointers to previous and next node)
+static constexpr size_t listNodeOverhead = 2 * sizeof(void*);
+
+//! Estimated overhead (in bytes) of a node of a std::set/std::map (pointers to parent and children, color)
+static constexpr size_t treeNodeOverhead = 4 * sizeof(void*);
+
+//! @brief Functions to determine the heap memory (in bytes) allocated by the elements of standard containers (including the memory
+//!        allocated by the elements if they are containers themselves). The memory of the container object itself is not included (it
+//!        is part of the object it belongs to); the overhead of the allocator is estimated.
+template<typename Type> size_t GetAllocatedMemory(const Type& value);
+template<typename Type> size_t GetAllocatedMemory(const std::vector<Type>& container);
+template<typename Type> size_t GetAllocatedMemory(const std::list<Type>& container);
+template<typename Type> size_t GetAllocatedMemory(const std::set<Type>& container);
+template<typename Key, typename Type> size_t GetAllocatedMemory(const std::map<Key, Type>& container);
+template<typename Type, size_t Size> size_t GetAllocatedMemory(const std::array<Type, Size>& container);
+inline size_t GetAllocatedMemory(const std::string& value);
+
+//! @brief Returns the heap memory allocated by the elements of the given range (skips elements that cannot allocate memory)
+template<typename Container>
+size_t GetAllocatedMemoryOfElements(const Container& container)
+{
+	size_t allocatedMemory(0);
+
+	if(std::is_trivially_copyable<typename Container::value_type>::value == false)
+	{
+		for(const auto& element : container)
+			allocatedMemory += GetAllocatedMemory(element);
+	}
+
+	return allocatedMemory;
+}
+
+//! Fallback for types that do not allocate memory (or whose memory is accounted for elsewhere)
+template<typename Type> size_t GetAllocatedMemory(const Type& /*value*/) { return 0; }
+
+template<typename Type> size_t GetAllocatedMemory(const std::vector<Type>& container)
+{
+	return container.capacity() * sizeof(Type) + GetAllocatedMemoryOfElements(container);
+}
+
+template<typename Type> size_t GetAllocatedMemory(const std::list<Type>& container)
+{
+	return container.size() * (sizeof(Type) + listNodeOverhead) + GetAllocatedMemoryOfElements(container);
+}
+
+template<typename Type> size_t GetAllocatedMemory(const std::set<Type>& container)
+{
+	return container.size() * (sizeof(Type) + treeNodeOverhead) + GetAllocatedMemoryOfElements(container);
+}
+
+template<typename Key, typename Type> size_t GetAllocatedMemory(const std::map<Key, Type>& container)
+{
+	size_t allocatedMemory = container.size() * (sizeof(Key) + sizeof(Type) + treeNodeOverhead);
+
+	for(const auto& element : container)
+		allocatedMemory += GetAllocatedMemory(element.second);
+
+	return allocatedMemory;
+}
+
+template<typename Type, size_t Size> size_t GetAllocatedMemory(const std::array<Type, Size>& container)
+{
+	return GetAllocatedMemoryOfElements(container);
+}
+
+inline size_t GetAllocatedMemory(const std::string& value)
+{
+	// short strings are stored within the string object (small string optimization), i.e. their data lies within the object itself
+	const char* object = reinterpret_cast<const char*>(&value);
+	const std::less<const char*> isBefore;
+	const bool storedInObject = (isBefore(value.data(), object) == false) && isBefore(value.data(), object + sizeof(std::string));
+
+	return storedInObject ? 0 : (value.capacity() + 1);
+}
+
+//! @brief Collects the memory used by the different subsystems of an AAI instance. Memory shared by all AAI instances (e.g. build tree,
+//!        build map) is listed separately as it is only allocated once per process.
+class AAIMemoryReport
+{
+public:
+	struct Entry
+	{
+		Entry(const char* subsystem, size_t bytes, bool shared) : subsystem(subsystem), bytes(bytes), shared(shared) {}
+
+		//! Name of the subsystem
+		const char* subsystem;
+
+		//! Memory used by the subsystem (in bytes)
+		size_t      bytes;
+
+		//! Whether the memory is shared by all AAI instances
+		bool        shared;
+	};
+
+	//! @brief Adds the memory used by the given subsystem
+	void Add(const char* subsystem, size_t bytes, bool shared = false) { m_entries.push_back(Entry(subsystem, bytes, shared)); }
+
+	//! @brief Returns the memory used by the subsystems of the AAI instance (shared = false) or shared by all AAI instances (shared = true)
+	size_t GetTotalMemory(bool shared) const
+	{
+		size_t totalMemory(0);
+
+		for(const auto& entry : m_entries)
+		{
+			if(entry.shared == shared)
+				totalMemory += entry.bytes;
+		}
+
+		return totalMemory;
+	}
+
+	//! @brief Returns the memory used by the given subsystem (0 if not listed)
+	size_t GetMemory(const std::string& subsystem) const
+	{
+		for(const auto& entry : m_entries)
+		{
+			if(subsystem == entry.subsystem)
+				return entry.bytes;
+		}
+
+		return 0;
+	}
+
+	const std::vector<Entry>& GetEntries() const { return m_entries; }
+
+private:
+	std::vector<Entry> m_entries;
+};
+
+#endif
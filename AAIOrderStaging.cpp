@@ -0,0 +1,176 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+
+#include "AAIOrderStaging.h"
+#include "AAI.h"
+#include "AAITrace.h"
+#include "AAIMemoryUsage.h"
+
+#include "LegacyCpp/CommandQueue.h"
+using namespace springLegacyAI;
+
+AAIOrderStaging::AAIOrderStaging(AAI* ai, int maxUnits) :
+	m_firstValidSequenceNumber(maxUnits, 0),
+	m_nextSequenceNumber(0),
+	m_issuedOrders(0),
+	m_replacedOrders(0),
+	m_duplicateOrders(0),
+	m_deferredOrders(0),
+	m_framesBudgetExhausted(0),
+	ai(ai)
+{
+}
+
+size_t AAIOrderStaging::GetMemoryUsage() const
+{
+	size_t memoryUsage = GetAllocatedMemory(m_stagedOrders) + GetAllocatedMemory(m_firstValidSequenceNumber);
+
+	for(const auto& stagedOrder : m_stagedOrders)
+		memoryUsage += GetAllocatedMemory(stagedOrder.unitIds);
+
+	return memoryUsage;
+}
+
+void AAIOrderStaging::AddOrder(const Command& command, UnitId unitId, EOrderPriority priority)
+{
+	StagedOrder& stagedOrder = StageOrder(command, priority);
+	AddUnit(stagedOrder, unitId.id);
+}
+
+void AAIOrderStaging::AddOrder(const Command& command, const std::vector<UnitId>& unitIds, EOrderPriority priority)
+{
+	StagedOrder& stagedOrder = StageOrder(command, priority);
+	stagedOrder.unitIds.reserve(unitIds.size());
+
+	for(const auto& unitId : unitIds)
+		AddUnit(stagedOrder, unitId.id);
+}
+
+void AAIOrderStaging::DiscardOrders(UnitId unitId)
+{
+	if( (unitId.id >= 0) && (unitId.id < static_cast<int>(m_firstValidSequenceNumber.size())) )
+		m_firstValidSequenceNumber[unitId.id] = m_nextSequenceNumber;
+}
+
+AAIOrderStaging::StagedOrder& AAIOrderStaging::StageOrder(const Command& command, EOrderPriority priority)
+{
+	m_stagedOrders.push_back( StagedOrder(command, priority, m_nextSequenceNumber) );
+	++m_nextSequenceNumber;
+
+	return m_stagedOrders.back();
+}
+
+void AAIOrderStaging::AddUnit(StagedOrder& stagedOrder, int unitId)
+{
+	if( (unitId < 0) || (unitId >= static_cast<int>(m_firstValidSequenceNumber.size())) )
+		return;
+
+	// an order that is not queued overrides all orders given to the unit before
+	if( (stagedOrder.command.GetOpts() & SHIFT_KEY) == 0)
+		m_firstValidSequenceNumber[unitId] = stagedOrder.sequenceNumber;
+
+	stagedOrder.unitIds.push_back(unitId);
+}
+
+int AAIOrderStaging::IssueOrders()
+{
+	if(m_stagedOrders.empty())
+		return 0;
+
+	// highest priority first, orders with same priority in the order they have been staged
+	std::sort(m_stagedOrders.begin(), m_stagedOrders.end(), [](const StagedOrder& lhs, const StagedOrder& rhs) {
+		return (lhs.priority != rhs.priority) ? (lhs.priority > rhs.priority) : (lhs.sequenceNumber < rhs.sequenceNumber);
+	});
+
+	int issuedOrders(0);
+	size_t order(0);
+
+	for( ; order < m_stagedOrders.size(); ++order)
+	{
+		StagedOrder& stagedOrder = m_stagedOrders[order];
+
+		// skip units that received another order in the meantime
+		const auto replaced = std::remove_if(stagedOrder.unitIds.begin(), stagedOrder.unitIds.end(), [&](int unitId) { return (IsPending(stagedOrder, unitId) == false); } );
+		m_replacedOrders += static_cast<int>( std::distance(replaced, stagedOrder.unitIds.end()) );
+		stagedOrder.unitIds.erase(replaced, stagedOrder.unitIds.end());
+
+		// orders to groups are not split (a single group order exceeding the budget is issued if it is the first one in this frame)
+		const int numberOfUnits = static_cast<int>(stagedOrder.unitIds.size());
+
+		if( (issuedOrders > 0) && (issuedOrders + numberOfUnits > AAIConstants::maxOrdersPerFrame) )
+			break;
+
+		for(const int unitId : stagedOrder.unitIds)
+		{
+			if(IsCurrentCommand(stagedOrder.command, unitId))
+				++m_duplicateOrders;
+			else
+			{
+				AAI_TRACE_SCOPE("IAICallback::GiveOrder")
+				ai->GetAICallback()->GiveOrder(unitId, &stagedOrder.command);
+				++issuedOrders;
+			}
+		}
+	}
+
+	// remaining orders are kept for the next frame
+	if(order < m_stagedOrders.size())
+	{
+		++m_framesBudgetExhausted;
+
+		for(size_t deferredOrder = order; deferredOrder < m_stagedOrders.size(); ++deferredOrder)
+			m_deferredOrders += static_cast<int>(m_stagedOrders[deferredOrder].unitIds.size());
+	}
+
+	m_stagedOrders.erase(m_stagedOrders.begin(), m_stagedOrders.begin() + order);
+
+	m_issuedOrders += issuedOrders;
+	return issuedOrders;
+}
+
+bool AAIOrderStaging::IsCurrentCommand(const Command& command, int unitId) const
+{
+	// queued orders never match the current command
+	if(command.GetOpts() & SHIFT_KEY)
+		return false;
+
+	const CCommandQueue* commands = ai->GetAICallback()->GetCurrentUnitCommands(unitId);
+
+	if(commands == nullptr)
+		return false;
+
+	if(command.GetID() == CMD_STOP)
+		return commands->empty();
+
+	// an order replaces the whole command queue, i.e. it is only identical if the unit has exactly this command
+	if(commands->size() != 1)
+		return false;
+
+	const Command& currentCommand = commands->front();
+
+	if( (currentCommand.GetID() != command.GetID()) || (currentCommand.GetNumParams() != command.GetNumParams()) )
+		return false;
+
+	for(size_t param = 0; param < command.GetNumParams(); ++param)
+	{
+		if(std::fabs(currentCommand.GetParam(param) - command.GetParam(param)) > AAIConstants::maxOrderParameterDeviation)
+			return false;
+	}
+
+	return true;
+}
+
+void AAIOrderStaging::LogStatistics() const
+{
+	ai->Log("\nOrders - issued / replaced before issued / identical to current command / deferrals (frames with exhausted budget):\n");
+	ai->Log("%i / %i / %i / %i (%i)\n", m_issuedOrders, m_replacedOrders, m_duplicateOrders, m_deferredOrders, m_framesBudgetExhausted);
+}
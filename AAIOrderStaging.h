@@ -0,0 +1,116 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_ORDER_STAGING_H
+#define AAI_ORDER_STAGING_H
+
+#include <vector>
+
+#include "Sim/Units/CommandAI/Command.h"
+#include "aidef.h"
+
+class AAI;
+
+//! Priority of an order; if the budget of orders per frame is exceeded, orders of higher priority are given first
+enum class EOrderPriority : int
+{
+	LOW    = 0, //!< Scouting, sending units to rally points
+	NORMAL = 1, //!< Attacking, construction related orders (assisting, reclaiming)
+	HIGH   = 2  //!< Retreating, keeping distance to enemies, defending
+};
+
+//! @brief Collects the orders given to units within a frame and passes them to the engine once per frame:
+//!        - a (not queued) order replaces the orders staged for the same unit before
+//!        - orders identical to the current command of the unit are dropped
+//!        - orders given to a group are kept together (i.e. issued within the same frame)
+//!        - at most AAIConstants::maxOrdersPerFrame orders are issued per frame, remaining orders are deferred by priority
+//!        Queued (shift) orders keep their position relative to other orders for the same unit only if they do not have a higher priority.
+class AAIOrderStaging
+{
+public:
+	AAIOrderStaging(AAI* ai, int maxUnits);
+
+	//! @brief Stages the given order for the given unit
+	void AddOrder(const Command& command, UnitId unitId, EOrderPriority priority);
+
+	//! @brief Stages the given order for the given units (e.g. all units of a group)
+	void AddOrder(const Command& command, const std::vector<UnitId>& unitIds, EOrderPriority priority);
+
+	//! @brief Discards all orders staged for the given unit (e.g. because it has been destroyed or received an order directly)
+	void DiscardOrders(UnitId unitId);
+
+	//! @brief Passes staged orders (highest priority and oldest first) to the engine until the budget of orders per frame is reached;
+	//!        returns the number of issued orders
+	int IssueOrders();
+
+	//! @brief Returns the number of orders that have been passed to the engine so far
+	int GetNumberOfIssuedOrders() const { return m_issuedOrders; }
+
+	//! @brief Writes the statistics (issued/dropped/deferred orders) to the log file
+	void LogStatistics() const;
+
+	//! @brief Returns the memory (in bytes) allocated by the staged orders
+	size_t GetMemoryUsage() const;
+
+private:
+	//! An order for one or more units
+	struct StagedOrder
+	{
+		StagedOrder(const Command& command, EOrderPriority priority, int sequenceNumber) : command(command), priority(priority), sequenceNumber(sequenceNumber) {}
+
+		Command          command;
+
+		std::vector<int> unitIds;
+
+		EOrderPriority   priority;
+
+		//! Increasing number in the order of staging
+		int              sequenceNumber;
+	};
+
+	//! @brief Adds a new staged order and returns it
+	StagedOrder& StageOrder(const Command& command, EOrderPriority priority);
+
+	//! @brief Marks staged orders of the given unit as replaced (unless new order is queued) and adds the unit to the given order
+	void AddUnit(StagedOrder& stagedOrder, int unitId);
+
+	//! @brief Returns whether the given staged order shall still be given to the given unit
+	bool IsPending(const StagedOrder& stagedOrder, int unitId) const { return stagedOrder.sequenceNumber >= m_firstValidSequenceNumber[unitId]; }
+
+	//! @brief Returns whether the given command equals the current (and only) command of the given unit
+	bool IsCurrentCommand(const Command& command, int unitId) const;
+
+	//! Orders that have not been passed to the engine yet
+	std::vector<StagedOrder> m_stagedOrders;
+
+	//! Staged orders with a lower sequence number have been replaced/discarded (for each unit)
+	std::vector<int>         m_firstValidSequenceNumber;
+
+	//! Sequence number of the next staged order
+	int                      m_nextSequenceNumber;
+
+	//! Number of orders passed to the engine
+	int                      m_issuedOrders;
+
+	//! Number of orders dropped because an order for the same unit has been staged afterwards (or the unit has been destroyed)
+	int                      m_replacedOrders;
+
+	//! Number of orders dropped because they matched the current command of the unit
+	int                      m_duplicateOrders;
+
+	//! Number of times an order has been deferred to the next frame because the budget had been exhausted
+	int                      m_deferredOrders;
+
+	//! Number of frames the budget of orders has been exhausted
+	int                      m_framesBudgetExhausted;
+
+	AAI* ai;
+};
+
+#endif
@@ -0,0 +1,244 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+
+#include "AAIPerformanceMonitor.h"
+#include "AAIJson.h"
+
+thread_local const char* AAIPerformanceMonitor::s_activeScope = nullptr;
+
+int AAILatencyHistogram::GetBucketIndex(uint32_t latency)
+{
+	if(latency < static_cast<uint32_t>(subBuckets))
+		return static_cast<int>(latency);
+
+	// position of highest bit
+	int magnitude(subBucketBits);
+	while( (latency >> (magnitude + 1)) != 0 )
+		++magnitude;
+
+	const int subBucket = static_cast<int>(latency >> (magnitude - subBucketBits)) & (subBuckets - 1);
+
+	return subBuckets + (magnitude - subBucketBits) * subBuckets + subBucket;
+}
+
+int AAILatencyHistogram::GetBucketUpperBound(int bucketIndex)
+{
+	if(bucketIndex < subBuckets)
+		return bucketIndex;
+
+	const int     magnitude  = (bucketIndex - subBuckets) / subBuckets + subBucketBits;
+	const int64_t subBucket  = (bucketIndex - subBuckets) % subBuckets;
+	const int64_t lowerBound = (subBuckets + subBucket) << (magnitude - subBucketBits);
+	const int64_t width      = int64_t(1) << (magnitude - subBucketBits);
+
+	return static_cast<int>( std::min<int64_t>(lowerBound + width - 1, INT32_MAX) );
+}
+
+void AAILatencyHistogram::Add(int latency)
+{
+	latency = std::max(latency, 0);
+
+	++m_counts[GetBucketIndex(static_cast<uint32_t>(latency))];
+	++m_count;
+	m_total += latency;
+	m_max = std::max(m_max, latency);
+}
+
+int AAILatencyHistogram::GetPercentile(float ratio) const
+{
+	if(m_count == 0)
+		return 0;
+
+	const int requiredCount = std::max(static_cast<int>(ratio * static_cast<float>(m_count) + 0.5f), 1);
+	int count(0);
+
+	for(int bucket = 0; bucket < numberOfBuckets; ++bucket)
+	{
+		count += m_counts[bucket];
+
+		if(count >= requiredCount)
+			return std::min(GetBucketUpperBound(bucket), m_max);
+	}
+
+	return m_max;
+}
+
+AAIPerformanceMonitor::AAIPerformanceMonitor(const std::string& filename) :
+	m_filename(filename),
+	m_nestingDepth(0),
+	m_currentFrameTime(0),
+	m_lastFrameTime(0),
+	m_currentFrame(0),
+	m_currentGamePhase(0),
+	m_nextDumpFrame(AAIConstants::performanceDumpInterval)
+{
+	m_spikes.reserve(AAIConstants::maxRecordedPerformanceSpikes);
+}
+
+AAIPerformanceMonitor::TimerStatistics& AAIPerformanceMonitor::GetTimerStatistics(const char* label, std::vector<TimerStatistics>& statistics, std::unordered_map<const char*, size_t>& statisticsIndex)
+{
+	const auto index = statisticsIndex.find(label);
+
+	if(index != statisticsIndex.end())
+		return statistics[index->second];
+
+	// same label may be passed from different addresses (e.g. string literals in different translation units)
+	for(size_t i = 0; i < statistics.size(); ++i)
+	{
+		if(statistics[i].label == label)
+		{
+			statisticsIndex[label] = i;
+			return statistics[i];
+		}
+	}
+
+	statisticsIndex[label] = statistics.size();
+	statistics.push_back( TimerStatistics(label) );
+	return statistics.back();
+}
+
+void AAIPerformanceMonitor::AddTaskDelay(const char* taskName, int delay)
+{
+	GetTimerStatistics(taskName, m_taskDelayStatistics, m_taskDelayStatisticsIndex).histogramOfGamePhase[m_currentGamePhase].Add(delay);
+}
+
+void AAIPerformanceMonitor::AddSample(const char* label, int latency, bool topLevel)
+{
+	GetTimerStatistics(label, m_timerStatistics, m_timerStatisticsIndex).histogramOfGamePhase[m_currentGamePhase].Add(latency);
+
+	m_currentFrameSamples.push_back( TimerSample{label, latency, topLevel} );
+
+	if(topLevel)
+		m_currentFrameTime += latency;
+}
+
+void AAIPerformanceMonitor::FinishFrame()
+{
+	m_lastFrameTime = m_currentFrameTime;
+
+	if(m_currentFrameSamples.empty())
+		return;
+
+	m_frameHistograms[m_currentGamePhase].Add(m_currentFrameTime);
+
+	if(m_currentFrameTime > AAIConstants::performanceSpikeThreshold)
+	{
+		// keep the longest spikes: replace the shortest recorded one if limit has been reached
+		if(m_spikes.size() < static_cast<size_t>(AAIConstants::maxRecordedPerformanceSpikes))
+			m_spikes.push_back( FrameSpike{m_currentFrame, m_currentFrameTime, m_currentFrameSamples} );
+		else
+		{
+			auto shortestSpike = std::min_element(m_spikes.begin(), m_spikes.end(), [](const FrameSpike& lhs, const FrameSpike& rhs) { return lhs.totalTime < rhs.totalTime; });
+
+			if(shortestSpike->totalTime < m_currentFrameTime)
+				*shortestSpike = FrameSpike{m_currentFrame, m_currentFrameTime, m_currentFrameSamples};
+		}
+	}
+
+	m_currentFrameSamples.clear();
+	m_currentFrameTime = 0;
+}
+
+void AAIPerformanceMonitor::StartFrame(int frame)
+{
+	FinishFrame();
+
+	m_currentFrame     = frame;
+	m_currentGamePhase = GamePhase(frame).GetArrayIndex();
+
+	if(frame >= m_nextDumpFrame)
+	{
+		WriteToFile();
+		m_nextDumpFrame = frame + AAIConstants::performanceDumpInterval;
+	}
+}
+
+void AAIPerformanceMonitor::WriteHistograms(FILE* file, const std::array<AAILatencyHistogram, GamePhase::numberOfGamePhases>& histograms)
+{
+	fprintf(file, "[");
+
+	bool first(true);
+	for(GamePhase gamePhase(0); !gamePhase.End(); gamePhase.Next())
+	{
+		const AAILatencyHistogram& histogram = histograms[gamePhase.GetArrayIndex()];
+
+		fprintf(file, "%s{\"phase\": ", first ? "" : ", ");
+		WriteJsonString(file, gamePhase.GetName().c_str());
+		fprintf(file, ", \"count\": %i, \"total\": %lld, \"p50\": %i, \"p90\": %i, \"p99\": %i, \"max\": %i}", histogram.GetCount(), histogram.GetTotal(),
+		        histogram.GetPercentile(0.5f), histogram.GetPercentile(0.9f), histogram.GetPercentile(0.99f), histogram.GetMax());
+		first = false;
+	}
+
+	fprintf(file, "]");
+}
+
+void AAIPerformanceMonitor::WriteTimerStatistics(FILE* file, const std::vector<TimerStatistics>& statistics)
+{
+	fprintf(file, "{");
+	for(size_t i = 0; i < statistics.size(); ++i)
+	{
+		fprintf(file, "%s\n    ", (i > 0) ? "," : "");
+		WriteJsonString(file, statistics[i].label.c_str());
+		fprintf(file, ": ");
+		WriteHistograms(file, statistics[i].histogramOfGamePhase);
+	}
+	fprintf(file, "\n  }");
+}
+
+bool AAIPerformanceMonitor::WriteToFile() const
+{
+	FILE* file = fopen(m_filename.c_str(), "w");
+
+	if(file == nullptr)
+		return false;
+
+	fprintf(file, "{\n  \"frame\": %i,\n  \"unit\": \"us\",\n  \"spikeThreshold\": %i,\n", m_currentFrame, AAIConstants::performanceSpikeThreshold);
+
+	fprintf(file, "  \"frames\": ");
+	WriteHistograms(file, m_frameHistograms);
+
+	fprintf(file, ",\n  \"timers\": ");
+	WriteTimerStatistics(file, m_timerStatistics);
+
+	// delays are given in frames (not microseconds)
+	fprintf(file, ",\n  \"taskDelays\": ");
+	WriteTimerStatistics(file, m_taskDelayStatistics);
+
+	fprintf(file, ",\n  \"spikes\": [");
+
+	std::vector<const FrameSpike*> spikes;
+	for(const auto& spike : m_spikes)
+		spikes.push_back(&spike);
+
+	std::sort(spikes.begin(), spikes.end(), [](const FrameSpike* lhs, const FrameSpike* rhs) { return lhs->frame < rhs->frame; });
+
+	for(size_t i = 0; i < spikes.size(); ++i)
+	{
+		fprintf(file, "%s\n    {\"frame\": %i, \"time\": %i, \"timers\": [", (i > 0) ? "," : "", spikes[i]->frame, spikes[i]->totalTime);
+
+		for(size_t j = 0; j < spikes[i]->samples.size(); ++j)
+		{
+			const TimerSample& sample = spikes[i]->samples[j];
+
+			fprintf(file, "%s{\"label\": ", (j > 0) ? ", " : "");
+			WriteJsonString(file, sample.label);
+			fprintf(file, ", \"time\": %i, \"nested\": %s}", sample.latency, sample.topLevel ? "false" : "true");
+		}
+
+		fprintf(file, "]}");
+	}
+
+	fprintf(file, "\n  ]\n}\n");
+	fclose(file);
+
+	return true;
+}
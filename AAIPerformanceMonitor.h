@@ -0,0 +1,201 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_PERFORMANCE_MONITOR_H
+#define AAI_PERFORMANCE_MONITOR_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "aidef.h"
+
+//! @brief Histogram of latencies (in microseconds) with logarithmic buckets that are linearly subdivided (similar to HDR histograms),
+//!        i.e. the relative error of the reported percentiles is below 1/subBuckets regardless of the magnitude of the values.
+class AAILatencyHistogram
+{
+public:
+	AAILatencyHistogram() : m_counts{}, m_count(0), m_total(0), m_max(0) {}
+
+	//! @brief Adds the given latency (in microseconds)
+	void Add(int latency);
+
+	//! @brief Returns the latency below which the given ratio (0 - 1) of the samples lie (upper bound of the respective bucket)
+	int GetPercentile(float ratio) const;
+
+	int       GetCount() const { return m_count; }
+	long long GetTotal() const { return m_total; }
+	int       GetMax()   const { return m_max; }
+
+private:
+	//! @brief Returns the index of the bucket for the given latency
+	static int GetBucketIndex(uint32_t latency);
+
+	//! @brief Returns the highest latency belonging to the given bucket
+	static int GetBucketUpperBound(int bucketIndex);
+
+	//! Number of linear sub buckets per power of two (as a power of two)
+	static constexpr int subBucketBits = 4;
+	static constexpr int subBuckets    = 1 << subBucketBits;
+
+	//! Values below subBuckets have their own bucket, each following power of two is split into subBuckets buckets
+	static constexpr int numberOfBuckets = subBuckets + (32 - subBucketBits) * subBuckets;
+
+	std::array<int, numberOfBuckets> m_counts;
+
+	int       m_count;
+	long long m_total;
+	int       m_max;
+};
+
+//! @brief Collects latency histograms per timer label and game phase, detects frames in which AAI spent more time than a given threshold
+//!        (recording which timers fired in that frame) and periodically writes the statistics to a json file. Additionally, the delays of the
+//!        scheduled tasks (i.e. how many frames they have been executed later than planned) are collected.
+//!        Not thread safe - timers must only be used in the thread calling the AI interface.
+class AAIPerformanceMonitor
+{
+public:
+	//! @brief The statistics are written to the given file
+	AAIPerformanceMonitor(const std::string& filename);
+
+	//! @brief Marks the begin of a new frame (evaluates the previous frame and dumps statistics if due)
+	void StartFrame(int frame);
+
+	//! @brief Adds a sample for the given label (must remain valid as long as the monitor exists); topLevel = not nested in another timer
+	void AddSample(const char* label, int latency, bool topLevel);
+
+	//! @brief Adds the number of frames the execution of the given scheduled task has been delayed (name must remain valid as long as the monitor exists)
+	void AddTaskDelay(const char* taskName, int delay);
+
+	//! @brief Writes the statistics to the file; returns false if file could not be opened
+	bool WriteToFile() const;
+
+	//! @brief Returns the time (in microseconds) spent in top level timers in the previous frame (i.e. the one finished by the last call of StartFrame())
+	int GetLastFrameTime() const { return m_lastFrameTime; }
+
+	//! @brief Returns the label of the innermost running timer of the calling thread (nullptr if none)
+	static const char* GetActiveScope() { return s_activeScope; }
+
+private:
+	friend class AAIScopedPerformanceTimer;
+
+	//! Label of the innermost running timer of the thread
+	static thread_local const char* s_activeScope;
+
+	struct TimerStatistics
+	{
+		TimerStatistics(const char* label) : label(label) {}
+
+		std::string label;
+
+		std::array<AAILatencyHistogram, GamePhase::numberOfGamePhases> histogramOfGamePhase;
+	};
+
+	struct TimerSample
+	{
+		const char* label;
+		int         latency;
+		bool        topLevel;
+	};
+
+	struct FrameSpike
+	{
+		int                      frame;
+		int                      totalTime;
+		std::vector<TimerSample> samples;
+	};
+
+	//! @brief Returns the statistics for the given label (created if not existing yet)
+	static TimerStatistics& GetTimerStatistics(const char* label, std::vector<TimerStatistics>& statistics, std::unordered_map<const char*, size_t>& statisticsIndex);
+
+	//! @brief Writes the histograms of the given statistics as json object (one entry per label)
+	static void WriteTimerStatistics(FILE* file, const std::vector<TimerStatistics>& statistics);
+
+	//! @brief Updates frame histogram and spikes with the data of the current frame
+	void FinishFrame();
+
+	//! @brief Writes the histograms as json array (one entry per game phase)
+	static void WriteHistograms(FILE* file, const std::array<AAILatencyHistogram, GamePhase::numberOfGamePhases>& histograms);
+
+	std::string m_filename;
+
+	//! Number of currently running timers (incremented/decremented by scoped timers to detect nested timers)
+	int m_nestingDepth;
+
+	//! Statistics of all timers (index to statistics stored in lookup table by address of label for fast access)
+	std::vector<TimerStatistics>                 m_timerStatistics;
+	std::unordered_map<const char*, size_t>      m_timerStatisticsIndex;
+
+	//! Distribution of the delays (in frames) of the executions of the scheduled tasks (see AAITaskScheduler)
+	std::vector<TimerStatistics>                 m_taskDelayStatistics;
+	std::unordered_map<const char*, size_t>      m_taskDelayStatisticsIndex;
+
+	//! Distribution of time spent per frame
+	std::array<AAILatencyHistogram, GamePhase::numberOfGamePhases> m_frameHistograms;
+
+	//! The longest frames exceeding the spike threshold
+	std::vector<FrameSpike> m_spikes;
+
+	//! Samples recorded in the current frame
+	std::vector<TimerSample> m_currentFrameSamples;
+
+	//! Time spent in top level timers in the current frame
+	int m_currentFrameTime;
+
+	//! Time spent in top level timers in the previous frame
+	int m_lastFrameTime;
+
+	int m_currentFrame;
+
+	int m_currentGamePhase;
+
+	int m_nextDumpFrame;
+};
+
+//! @brief Measures the time until it goes out of scope and adds it to the given performance monitor (no-op if monitor is nullptr);
+//!        the label is the active scope of the thread as long as the timer exists
+class AAIScopedPerformanceTimer
+{
+public:
+	AAIScopedPerformanceTimer(const char* label, AAIPerformanceMonitor* monitor) :
+		m_label(label),
+		m_previousScope(AAIPerformanceMonitor::s_activeScope),
+		m_monitor(monitor),
+		m_start(std::chrono::steady_clock::now())
+	{
+		AAIPerformanceMonitor::s_activeScope = label;
+
+		if(m_monitor)
+			++m_monitor->m_nestingDepth;
+	}
+
+	~AAIScopedPerformanceTimer()
+	{
+		AAIPerformanceMonitor::s_activeScope = m_previousScope;
+
+		if(m_monitor)
+		{
+			const int latency = static_cast<int>( std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_start).count() );
+			--m_monitor->m_nestingDepth;
+			m_monitor->AddSample(m_label, latency, (m_monitor->m_nestingDepth == 0));
+		}
+	}
+
+private:
+	const char*                           m_label;
+	const char*                           m_previousScope;
+	AAIPerformanceMonitor*                m_monitor;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+#endif
@@ -0,0 +1,119 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIPlanningWorker.h"
+#include "AAITrace.h"
+
+#include <algorithm>
+#include <iterator>
+
+AAIPlanningWorker::AAIPlanningWorker() :
+	m_currentOwner(nullptr),
+	m_stop(false)
+{
+}
+
+AAIPlanningWorker::~AAIPlanningWorker()
+{
+	Stop();
+}
+
+void AAIPlanningWorker::Start()
+{
+	if(m_thread.joinable())
+		return;
+
+	m_stop   = false;
+	m_thread = std::thread(&AAIPlanningWorker::Run, this);
+}
+
+void AAIPlanningWorker::Stop()
+{
+	if(m_thread.joinable() == false)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+
+	m_condition.notify_all();
+	m_thread.join();
+
+	m_pendingTasks.clear();
+	m_finishedTasks.clear();
+}
+
+void AAIPlanningWorker::AddTask(const AAI* owner, std::unique_ptr<AAIPlanningTask> task)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pendingTasks.push_back( PlanningTask{owner, std::move(task)} );
+	}
+
+	m_condition.notify_all();
+}
+
+void AAIPlanningWorker::CommitFinishedTasks(const AAI* owner)
+{
+	std::vector<PlanningTask> tasksToCommit;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		auto firstOtherTask = std::stable_partition(m_finishedTasks.begin(), m_finishedTasks.end(), [owner](const PlanningTask& task) { return task.owner != owner; });
+
+		std::move(firstOtherTask, m_finishedTasks.end(), std::back_inserter(tasksToCommit));
+		m_finishedTasks.erase(firstOtherTask, m_finishedTasks.end());
+	}
+
+	// commit without holding the lock as new tasks may be added 
+	for(auto& task : tasksToCommit)
+		task.task->Commit();
+}
+
+void AAIPlanningWorker::RemoveTasks(const AAI* owner)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_pendingTasks.erase( std::remove_if(m_pendingTasks.begin(), m_pendingTasks.end(), [owner](const PlanningTask& task) { return task.owner == owner; }), m_pendingTasks.end() );
+
+	m_condition.wait(lock, [this, owner]() { return m_currentOwner != owner; });
+
+	m_finishedTasks.erase( std::remove_if(m_finishedTasks.begin(), m_finishedTasks.end(), [owner](const PlanningTask& task) { return task.owner == owner; }), m_finishedTasks.end() );
+}
+
+void AAIPlanningWorker::Run()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while(true)
+	{
+		m_condition.wait(lock, [this]() { return m_stop || !m_pendingTasks.empty(); });
+
+		if(m_stop)
+			break;
+
+		PlanningTask planningTask = std::move(m_pendingTasks.front());
+		m_pendingTasks.pop_front();
+		m_currentOwner = planningTask.owner;
+
+		lock.unlock();
+		{
+			AAI_TRACE_SCOPE("Planning-Task")
+			planningTask.task->Plan();
+		}
+		lock.lock();
+
+		m_currentOwner = nullptr;
+		m_finishedTasks.push_back( std::move(planningTask) );
+
+		m_condition.notify_all();
+	}
+}
@@ -0,0 +1,90 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_PLANNING_WORKER_H
+#define AAI_PLANNING_WORKER_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class AAI;
+
+//! @brief A planning task is executed in two steps: planning by the worker thread (based on copies/snapshots of the required data),
+//!        and validation/execution of the result (e.g. giving orders) by the main thread in the next update of the AAI instance that created it.
+class AAIPlanningTask
+{
+public:
+	virtual ~AAIPlanningTask() {}
+
+	//! @brief Performs the planning - called by the worker thread, thus only data owned by the task (e.g. snapshots) may be accessed
+	virtual void Plan() = 0;
+
+	//! @brief Validates the result of the planning (game state may have changed in the meantime) and issues the corresponding orders - called by the main thread
+	virtual void Commit() = 0;
+};
+
+//! @brief Executes planning tasks of all AAI instances in a background thread (shared by all AAI instances of the process)
+class AAIPlanningWorker
+{
+public:
+	AAIPlanningWorker();
+	~AAIPlanningWorker();
+
+	//! @brief Starts the worker thread (if not already running)
+	void Start();
+
+	//! @brief Stops the worker thread; tasks that have not been finished yet are discarded
+	void Stop();
+
+	//! @brief Adds a task that shall be executed for the given AAI instance
+	void AddTask(const AAI* owner, std::unique_ptr<AAIPlanningTask> task);
+
+	//! @brief Commits the results of all finished tasks of the given AAI instance (must be called from the main thread)
+	void CommitFinishedTasks(const AAI* owner);
+
+	//! @brief Discards all tasks of the given AAI instance (waits until a task of the instance that is currently executed is finished)
+	void RemoveTasks(const AAI* owner);
+
+private:
+	struct PlanningTask
+	{
+		const AAI*                       owner;
+		std::unique_ptr<AAIPlanningTask> task;
+	};
+
+	//! @brief Main loop of the worker thread
+	void Run();
+
+	//! The worker thread
+	std::thread              m_thread;
+
+	//! Protects all following members
+	std::mutex               m_mutex;
+
+	//! Signals new tasks/stop request to the worker thread, and finished tasks to threads waiting in RemoveTasks()
+	std::condition_variable  m_condition;
+
+	//! Tasks waiting to be executed
+	std::deque<PlanningTask> m_pendingTasks;
+
+	//! Tasks waiting to be committed
+	std::vector<PlanningTask> m_finishedTasks;
+
+	//! The owner of the task that is currently executed by the worker thread (nullptr if none)
+	const AAI*               m_currentOwner;
+
+	//! Flag whether worker thread shall stop
+	bool                     m_stop;
+};
+
+#endif
@@ -0,0 +1,87 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_RANDOM_H
+#define AAI_RANDOM_H
+
+#include <cstdint>
+
+//! @brief Pseudo random number generator (xoshiro128**) owned by every AAI instance; replaces rand() to make the decisions of an
+//!        instance reproducible for a given seed (and independent of other instances/libraries using rand() in the same process).
+class AAIRandom
+{
+public:
+	AAIRandom(uint32_t seed = 0) { SetSeed(seed); }
+
+	//! @brief Initializes the state of the generator from the given seed
+	void SetSeed(uint32_t seed)
+	{
+		m_seed = seed;
+
+		// expand seed to state with splitmix64 (as recommended by the authors of xoshiro)
+		uint64_t splitMixState = seed;
+
+		for(int i = 0; i < 4; i += 2)
+		{
+			const uint64_t value = SplitMix64(splitMixState);
+			m_state[i]   = static_cast<uint32_t>(value);
+			m_state[i+1] = static_cast<uint32_t>(value >> 32);
+		}
+	}
+
+	//! @brief Returns the seed the generator has been initialized with
+	uint32_t GetSeed() const { return m_seed; }
+
+	//! @brief Returns the next random number
+	uint32_t Next()
+	{
+		const uint32_t result = RotateLeft(m_state[1] * 5u, 7) * 9u;
+		const uint32_t t      = m_state[1] << 9;
+
+		m_state[2] ^= m_state[0];
+		m_state[3] ^= m_state[1];
+		m_state[1] ^= m_state[2];
+		m_state[0] ^= m_state[3];
+		m_state[2] ^= t;
+		m_state[3]  = RotateLeft(m_state[3], 11);
+
+		return result;
+	}
+
+	//! @brief Returns a random integer in [0, upperBound) (0 if upperBound <= 0) - replaces rand()%upperBound
+	int GetInteger(int upperBound)
+	{
+		if(upperBound <= 0)
+			return 0;
+
+		return static_cast<int>( (static_cast<uint64_t>(Next()) * static_cast<uint64_t>(upperBound)) >> 32 );
+	}
+
+	//! @brief Returns a random float in [0, 1)
+	float GetFloat() { return static_cast<float>(Next() >> 8) * (1.0f / 16777216.0f); }
+
+private:
+	static uint32_t RotateLeft(uint32_t value, int bits) { return (value << bits) | (value >> (32 - bits)); }
+
+	static uint64_t SplitMix64(uint64_t& state)
+	{
+		uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	//! State of the generator
+	uint32_t m_state[4];
+
+	//! Seed the generator has been initialized with
+	uint32_t m_seed;
+};
+
+#endif
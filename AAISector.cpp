@@ -13,6 +13,7 @@
 #include "AAIBrain.h"
 #include "AAIConfig.h"
 #include "AAIMap.h"
+#include "AAIMemoryUsage.h"
 
 #include "LegacyCpp/IGlobalAICallback.h"
 #include "LegacyCpp/UnitDef.h"
@@ -32,6 +33,11 @@ AAISector::~AAISector(void)
 	m_ownBuildingsOfCategory.clear();
 }
 
+size_t AAISector::GetMemoryUsage() const
+{
+	return GetAllocatedMemory(metalSpots) + GetAllocatedMemory(m_ownBuildingsOfCategory);
+}
+
 void AAISector::Init(AAI *ai, int x, int y)
 {
 	this->ai = ai;
@@ -57,7 +63,7 @@ void AAISector::Init(AAI *ai, int x, int y)
 	m_alliedBuildings = 0;
 	m_failedAttemptsToConstructStaticDefence = 0;
 
-	importance_this_game = 1.0f + (rand()%5)/20.0f;
+	importance_this_game = 1.0f + (ai->Random().GetInteger(5))/20.0f;
 
 	m_ownBuildingsOfCategory.resize(AAIUnitCategory::numberOfUnitCategories, 0);
 }
@@ -69,13 +75,13 @@ void AAISector::LoadDataFromFile(FILE* file)
 		fscanf(file, "%f %f %f", &m_flatTilesRatio, &m_waterTilesRatio, &importance_learned);
 			
 		if(importance_learned < 1.0f)
-			importance_learned += (rand()%5)/20.0f;
+			importance_learned += (ai->Random().GetInteger(5))/20.0f;
 
 		m_attacksByTargetTypeInPreviousGames.LoadFromFile(file);
 	}
 	else // no learning data available -> init with default data
 	{
-		importance_learned = 1.0f + (rand()%5)/20.0f;
+		importance_learned = 1.0f + (ai->Random().GetInteger(5))/20.0f;
 		m_flatTilesRatio  = DetermineFlatRatio();
 		m_waterTilesRatio = DetermineWaterRatio();
 	}
@@ -107,7 +113,7 @@ bool AAISector::AddToBase(bool addToBase)
 	if(addToBase)
 	{
 		// check if already occupied (may happen if two coms start in same sector)
-		if(AAIMap::s_teamSectorMap.IsSectorOccupied(x,y))
+		if(AAIMap::s_teamSectorMap.TryToOccupySector(x, y, ai->GetMyTeamId()) == false)
 		{
 			ai->Log("\nTeam %i could not add sector %i,%i to base, already occupied by ally team %i!\n\n",ai->GetAICallback()->GetMyAllyTeam(), x, y, AAIMap::s_teamSectorMap.GetTeam(x, y));
 			return false;
@@ -117,8 +123,6 @@ bool AAISector::AddToBase(bool addToBase)
 
 		importance_this_game = std::min(importance_this_game + 1.0f, AAIConstants::maxSectorImportance);
 
-		AAIMap::s_teamSectorMap.SetSectorAsOccupiedByTeam(x, y, ai->GetMyTeamId());
-
 		return true;
 	}
 	else	// remove from base
@@ -211,11 +215,8 @@ void AAISector::AddExtractor(UnitId unitId, UnitDefId unitDefId, float3 pos)
 	for(auto spot : metalSpots)
 	{
 		// only check occupied spots
-		if(spot->occupied && spot->DoesSpotBelongToPosition(pos))
-		{
-			spot->extractorUnitId = unitId;
-			spot->extractorDefId  = unitDefId;
-		}
+		if(spot->IsOccupied() && spot->DoesSpotBelongToPosition(pos))
+			spot->SetExtractor(unitId, unitDefId);
 	}
 }
 
@@ -227,7 +228,7 @@ void AAISector::FreeMetalSpot(float3 pos, UnitDefId extractorDefId)
 	for(auto spot : metalSpots)
 	{
 		// only check occupied spots
-		if(spot->occupied && spot->DoesSpotBelongToPosition(pos) )
+		if(spot->IsOccupied() && spot->DoesSpotBelongToPosition(pos) )
 		{
 			spot->SetUnoccupied();
 
@@ -243,7 +244,7 @@ void AAISector::UpdateFreeMetalSpots()
 
 	for(auto spot = metalSpots.begin(); spot != metalSpots.end(); ++spot)
 	{
-		if((*spot)->occupied == false)
+		if((*spot)->IsOccupied() == false)
 		{
 			m_freeMetalSpots = true;
 			return;
@@ -354,23 +355,39 @@ float AAISector::GetAttackRating(const AAISector* currentSector, bool landSector
 }
 
 
-float AAISector::GetAttackRating(const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType, float maxLostUnits) const
+SectorAttackData AAISector::GetAttackData() const
+{
+	SectorAttackData sectorData;
+
+	sectorData.sector         = this;
+	sectorData.continentId    = m_continentId;
+	sectorData.distanceToBase = m_distanceToBase;
+	sectorData.enemyBuildings = GetNumberOfEnemyBuildings();
+	sectorData.lostUnits      = GetLostUnits();
+
+	for(const auto& targetType : AAITargetType::m_mobileTargetTypes)
+		sectorData.enemyCombatPower.SetValueForTargetType(targetType, GetEnemyCombatPower(targetType));
+
+	return sectorData;
+}
+
+float AAISector::GetAttackRating(const SectorAttackData& sectorData, const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType, float maxLostUnits)
 {
 	float rating(0.0f);
 
-	if( (m_distanceToBase > 0) && (GetNumberOfEnemyBuildings() > 0))
+	if( (sectorData.distanceToBase > 0) && (sectorData.enemyBuildings > 0))
 	{
-		const float myAttackPower     =   globalCombatPower[AAITargetType::staticIndex] + continentCombatPower[m_continentId][AAITargetType::staticIndex];
-		const float enemyDefencePower =   assaultGroupsOfType.GetValueOfTargetType(ETargetType::SURFACE)   * GetEnemyCombatPower(ETargetType::SURFACE)
-										+ assaultGroupsOfType.GetValueOfTargetType(ETargetType::FLOATER)   * GetEnemyCombatPower(ETargetType::FLOATER)
-										+ assaultGroupsOfType.GetValueOfTargetType(ETargetType::SUBMERGED) * GetEnemyCombatPower(ETargetType::SUBMERGED);
+		const float myAttackPower     =   globalCombatPower[AAITargetType::staticIndex] + continentCombatPower[sectorData.continentId][AAITargetType::staticIndex];
+		const float enemyDefencePower =   assaultGroupsOfType.GetValueOfTargetType(ETargetType::SURFACE)   * sectorData.enemyCombatPower.GetValueOfTargetType(ETargetType::SURFACE)
+										+ assaultGroupsOfType.GetValueOfTargetType(ETargetType::FLOATER)   * sectorData.enemyCombatPower.GetValueOfTargetType(ETargetType::FLOATER)
+										+ assaultGroupsOfType.GetValueOfTargetType(ETargetType::SUBMERGED) * sectorData.enemyCombatPower.GetValueOfTargetType(ETargetType::SUBMERGED);
 
-		const float lostUnitsFactor = (maxLostUnits > 1.0f) ? (2.0f - (GetLostUnits() / maxLostUnits) ) : 1.0f;
+		const float lostUnitsFactor = (maxLostUnits > 1.0f) ? (2.0f - (sectorData.lostUnits / maxLostUnits) ) : 1.0f;
 
-		const float enemyBuildings = static_cast<float>(GetNumberOfEnemyBuildings());
+		const float enemyBuildings = static_cast<float>(sectorData.enemyBuildings);
 
 		// prefer sectors with many buildings, few lost units and low defence power/short distance to own base
-		rating = lostUnitsFactor * (2.0f + enemyBuildings) * myAttackPower / ( (1.5f + enemyDefencePower) * static_cast<float>(1 + 2 * m_distanceToBase) );
+		rating = lostUnitsFactor * (2.0f + enemyBuildings) * myAttackPower / ( (1.5f + enemyDefencePower) * static_cast<float>(1 + 2 * sectorData.distanceToBase) );
 	}
 
 	return rating;			
@@ -599,7 +616,7 @@ float AAISector::DetermineWaterRatio() const
 	{
 		for(int xPos = x * AAIMap::xSectorSizeMap; xPos < (x+1) * AAIMap::xSectorSizeMap; ++xPos)
 		{
-			if(AAIMap::s_buildmap[xPos + yPos * AAIMap::xMapSize].IsTileTypeSet(EBuildMapTileType::WATER))
+			if(AAIMap::s_buildmap.IsTileTypeSet(xPos, yPos, EBuildMapTileType::WATER))
 				++waterCells;
 		}
 	}
@@ -689,8 +706,8 @@ float3 AAISector::DetermineUnitMovePos(AAIMovementType moveType, int continentId
 	for(int i = 0; i < 6; ++i)
 	{
 		float3 position;
-		position.x = xPosStart + static_cast<float>(AAIMap::xSectorSize) * (0.1f + 0.08f * (float)(rand()%11) );
-		position.z = yPosStart + static_cast<float>(AAIMap::ySectorSize) * (0.1f + 0.08f * (float)(rand()%11) );
+		position.x = xPosStart + static_cast<float>(AAIMap::xSectorSize) * (0.1f + 0.08f * (float)(ai->Random().GetInteger(11)) );
+		position.z = yPosStart + static_cast<float>(AAIMap::ySectorSize) * (0.1f + 0.08f * (float)(ai->Random().GetInteger(11)) );
 
 		if(IsValidMovePos(position, forbiddenMapTileTypes, continentId))
 		{
@@ -724,7 +741,7 @@ bool AAISector::IsValidMovePos(const float3& pos, BuildMapTileType forbiddenMapT
 	const int x = (int) (pos.x / SQUARE_SIZE);
 	const int y = (int) (pos.z / SQUARE_SIZE);
 
-	if(AAIMap::s_buildmap[x + y * AAIMap::xMapSize].IsTileTypeNotSet(forbiddenMapTileTypes))
+	if(AAIMap::s_buildmap.IsTileTypeNotSet(x, y, forbiddenMapTileTypes))
 	{
 		if( (continentId == AAIMap::ignoreContinentID) || (AAIMap::GetContinentID(pos) == continentId) )
 			return true;
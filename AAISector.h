@@ -24,6 +24,7 @@ class AAIUnitTable;
 class AAIMap;
 class BuildMapTileType;
 class AAIMetalSpot;
+class AAISector;
 
 namespace springLegacyAI {
 	struct UnitDef;
@@ -38,6 +39,21 @@ struct DefenceCoverage
 	float defence;
 };
 
+//! Copy of the data of a sector needed to rate it as target of an attack (allows planning of attacks outside of the main thread)
+struct SectorAttackData
+{
+	//! The sector (must not be accessed outside of the main thread)
+	const AAISector*       sector;
+
+	int                    continentId;
+	int                    distanceToBase;
+	int                    enemyBuildings;
+	float                  lostUnits;
+
+	//! Total (mobile + static) combat power of spotted enemy units vs the mobile target types
+	MobileTargetTypeValues enemyCombatPower;
+};
+
 
 class AAISector
 {
@@ -47,6 +63,9 @@ public:
 	AAISector();
 	~AAISector(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the sector (metal spot list and building counters)
+	size_t GetMemoryUsage() const;
+
 	//! @brief Adds a metal spot to the list of metal spots in the sector
 	void AddMetalSpot(AAIMetalSpot *spot);
 
@@ -100,6 +119,17 @@ public:
 	//! @brief Updates enemy combat power and counters
 	void AddScoutedEnemyUnit(UnitDefId enemyDefId, int framesSinceLastUpdate);
 
+	//! @brief Returns whether scouted mobile enemy combat units are located in this sector (their weight decreases with the time since they have been seen)
+	bool HasScoutedMobileEnemies() const
+	{
+		for(const auto& targetType : AAITargetType::m_mobileTargetTypes)
+		{
+			if(m_enemyCombatUnits.GetValue(targetType) > 0.0f)
+				return true;
+		}
+		return false;
+	}
+
 	//! @brief Return the total number of enemy combat units
 	float GetTotalEnemyCombatUnits() const { return m_enemyCombatUnits.CalcuateSum(); };
 
@@ -200,8 +230,11 @@ public:
 	//! @brief Returns the rating of this sector as destination to attack (0.0f if no suitable target)
 	float GetAttackRating(const AAISector* currentSector, bool landSectorSelectable, bool waterSectorSelectable, const MobileTargetTypeValues& targetTypeOfUnits) const;
 
-	//! @brief Returns the rating of this sector as destination to attack (0.0f if no suitable target)
-	float GetAttackRating(const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType, float maxLostUnits) const;
+	//! @brief Returns the data needed to rate this sector as destination to attack
+	SectorAttackData GetAttackData() const;
+
+	//! @brief Returns the rating of the sector with the given data as destination to attack (0.0f if no suitable target)
+	static float GetAttackRating(const SectorAttackData& sectorData, const std::vector<float>& globalCombatPower, const std::vector< std::vector<float> >& continentCombatPower, const MobileTargetTypeValues& assaultGroupsOfType, float maxLostUnits);
 
 	//! @brief Returns rating as next destination for scout of given movement type
 	float GetRatingAsNextScoutDestination(const AAIMovementType& scoutMoveType, const float3& currentPositionOfScout);
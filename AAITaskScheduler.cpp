@@ -0,0 +1,132 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAITaskScheduler.h"
+#include "AAI.h"
+#include "AAIPerformanceMonitor.h"
+#include "AAITrace.h"
+
+#include "CUtils/SimpleProfiler.h"
+
+#include <chrono>
+
+AAITaskScheduler::AAITaskScheduler(AAI* ai, int frameBudget) :
+	m_frameBudget(frameBudget),
+	m_cadenceFactor(1.0f),
+	ai(ai)
+{
+}
+
+void AAITaskScheduler::AddTask(const char* name, std::function<void()> task, int period, int offset, int priority, int budget, bool adaptiveCadence)
+{
+	m_tasks.push_back( ScheduledTask(name, task, period, offset, priority, budget, adaptiveCadence) );
+	m_dueTasks.reserve(m_tasks.size());
+}
+
+bool AAITaskScheduler::IsExecutedBefore(const ScheduledTask* first, const ScheduledTask* second)
+{
+	if(first->priority != second->priority)
+		return first->priority > second->priority;
+	else
+		return first->nextFrame < second->nextFrame;
+}
+
+int AAITaskScheduler::GetCurrentPeriod(const ScheduledTask& task) const
+{
+	if(task.adaptiveCadence)
+		return std::max(static_cast<int>(static_cast<float>(task.period) * m_cadenceFactor + 0.5f), 1);
+	else
+		return task.period;
+}
+
+void AAITaskScheduler::Update(int frame, Profiler* profiler, AAIPerformanceMonitor* performanceMonitor)
+{
+	m_dueTasks.clear();
+
+	for(auto& task : m_tasks)
+	{
+		if(task.nextFrame <= frame)
+			m_dueTasks.push_back(&task);
+	}
+
+	if(m_dueTasks.empty())
+		return;
+
+	std::sort(m_dueTasks.begin(), m_dueTasks.end(), IsExecutedBefore);
+
+	int usedBudget(0);
+
+	for(auto task : m_dueTasks)
+	{
+		const int delay = frame - task->nextFrame;
+
+		// defer task if it does not fit into remaining budget (at least one task is executed per frame to ensure progress)
+		if(     (usedBudget > 0) 
+		     && (usedBudget + static_cast<int>(task->estimatedCost) > m_frameBudget)
+			 && (delay < task->maxDeferral) )
+		{
+			++task->deferrals;
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+
+		{
+			SCOPED_TIMER(task->name, profiler)
+			AAIScopedPerformanceTimer performanceTimer(task->name, performanceMonitor);
+			AAI_TRACE_SCOPE(task->name)
+			task->task();
+		}
+
+		const int cost = static_cast<int>( std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() );
+
+		usedBudget += cost;
+
+		task->estimatedCost = 0.75f * task->estimatedCost + 0.25f * static_cast<float>(cost);
+
+		++task->executions;
+		task->totalCost  += cost;
+		task->maxCost     = std::max(task->maxCost, cost);
+		task->totalDelay += delay;
+		task->maxDelay    = std::max(task->maxDelay, delay);
+
+		if(performanceMonitor)
+			performanceMonitor->AddTaskDelay(task->name, delay);
+
+		if(cost > task->budget)
+			++task->budgetExceeded;
+
+		// keep phase of task unless it has been delayed for more than a whole period
+		task->nextFrame = std::max(task->nextFrame + GetCurrentPeriod(*task), frame + 1);
+	}
+}
+
+void AAITaskScheduler::LogStatistics() const
+{
+	ai->Log("\nScheduled tasks - executions, avg/max execution time (in microseconds), budget exceeded, deferrals, avg/max delay (in frames):\n");
+
+	for(const auto& task : m_tasks)
+	{
+		const float executions = static_cast<float>( std::max(task.executions, 1) );
+
+		ai->Log("%-30s: %i  %.0f / %i  %i  %i  %.2f / %i\n", task.name, task.executions, static_cast<float>(task.totalCost) / executions, task.maxCost, 
+		                                                     task.budgetExceeded, task.deferrals, static_cast<float>(task.totalDelay) / executions, task.maxDelay);
+	}
+}
+
+std::vector<AAITaskScheduler::TaskStatistics> AAITaskScheduler::GetStatistics() const
+{
+	std::vector<TaskStatistics> statistics;
+	statistics.reserve(m_tasks.size());
+
+	for(const auto& task : m_tasks)
+		statistics.push_back( TaskStatistics{task.name, task.executions, task.totalCost, task.maxCost, task.deferrals} );
+
+	return statistics;
+}
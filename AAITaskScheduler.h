@@ -0,0 +1,128 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_TASK_SCHEDULER_H
+#define AAI_TASK_SCHEDULER_H
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+class AAI;
+class Profiler;
+class AAIPerformanceMonitor;
+
+//! @brief Executes periodic tasks (e.g. checking for new construction orders) while keeping the time spent per frame below a target.
+//!        Due tasks are executed in the order of their priority; tasks that do not fit into the budget of the current frame are deferred
+//!        to the following frame(s) (but not longer than a quarter of their period). The periods of adaptive (i.e. non-critical) tasks are
+//!        multiplied with a cadence factor (set according to the CPU headroom of AAI, see AAIFrameTimeGovernor).
+class AAITaskScheduler
+{
+public:
+	//! Execution statistics of a task
+	struct TaskStatistics
+	{
+		const char* name;
+		int         executions;
+		long long   totalCost;
+		int         maxCost;
+		int         deferrals;
+	};
+
+	AAITaskScheduler(AAI* ai, int frameBudget);
+
+	//! @brief Adds a task that shall be executed every period frames (first time in frame offset); budget is the expected execution time in microseconds.
+	//!        Name must remain valid as long as the scheduler exists (it is used as part name for the profiler).
+	//!        The period of adaptive tasks is stretched/tightened according to the cadence factor.
+	void AddTask(const char* name, std::function<void()> task, int period, int offset, int priority, int budget, bool adaptiveCadence = false);
+
+	//! @brief Sets the factor the periods of adaptive tasks are multiplied with (takes effect when the tasks are rescheduled after their next execution)
+	void SetCadenceFactor(float cadenceFactor) { m_cadenceFactor = cadenceFactor; }
+
+	//! @brief Returns the factor the periods of adaptive tasks are multiplied with
+	float GetCadenceFactor() const { return m_cadenceFactor; }
+
+	//! @brief Executes the due tasks (as long as the frame budget permits)
+	void Update(int frame, Profiler* profiler, AAIPerformanceMonitor* performanceMonitor);
+
+	//! @brief Writes cost and lateness of every task to the log file
+	void LogStatistics() const;
+
+	//! @brief Returns the execution statistics of all tasks (execution times in microseconds)
+	std::vector<TaskStatistics> GetStatistics() const;
+
+private:
+	struct ScheduledTask
+	{
+		ScheduledTask(const char* name, std::function<void()> task, int period, int offset, int priority, int budget, bool adaptiveCadence) :
+			name(name), task(task), period(period), maxDeferral(std::max(period/4, 1)), priority(priority), budget(budget), adaptiveCadence(adaptiveCadence), 
+			nextFrame(offset), estimatedCost(static_cast<float>(budget)), executions(0), totalCost(0), maxCost(0), budgetExceeded(0), 
+			deferrals(0), totalDelay(0), maxDelay(0) {}
+
+		//! Name of the task (used for profiling/logging)
+		const char*           name;
+
+		//! The function to be executed
+		std::function<void()> task;
+
+		//! Number of frames between two executions
+		int                   period;
+
+		//! Maximum number of frames the execution may be deferred; task is executed regardless of the frame budget afterwards
+		int                   maxDeferral;
+
+		//! Tasks with higher priority are executed first
+		int                   priority;
+
+		//! Expected execution time in microseconds
+		int                   budget;
+
+		//! Whether the period is multiplied with the cadence factor (non-critical tasks)
+		bool                  adaptiveCadence;
+
+		//! The frame in which the task shall be executed next
+		int                   nextFrame;
+
+		//! Smoothed execution time of the last executions (used to decide whether task fits into the budget of the current frame)
+		float                 estimatedCost;
+
+		//! Statistics: number of executions, total/max execution time in microseconds, how often budget of task was exceeded
+		int                   executions;
+		long long             totalCost;
+		int                   maxCost;
+		int                   budgetExceeded;
+
+		//! Statistics: number of times the task has been deferred, total/max number of frames the executions have been delayed
+		int                   deferrals;
+		long long             totalDelay;
+		int                   maxDelay;
+	};
+
+	//! @brief Returns true if the first task shall be executed before the second one (higher priority first, longer delayed first if same priority)
+	static bool IsExecutedBefore(const ScheduledTask* first, const ScheduledTask* second);
+
+	//! @brief Returns the number of frames until the next execution of the given task (taking the cadence factor into account for adaptive tasks)
+	int GetCurrentPeriod(const ScheduledTask& task) const;
+
+	//! The scheduled tasks
+	std::vector<ScheduledTask> m_tasks;
+
+	//! Buffer for the tasks that are due in the current frame
+	std::vector<ScheduledTask*> m_dueTasks;
+
+	//! Target for the time (in microseconds) spent per frame
+	int m_frameBudget;
+
+	//! Factor the periods of adaptive tasks are multiplied with
+	float m_cadenceFactor;
+
+	AAI* ai;
+};
+
+#endif
@@ -0,0 +1,209 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIThreadPool.h"
+#include "AAITrace.h"
+
+#include <algorithm>
+
+thread_local int AAIThreadPool::s_workerIndex = -1;
+
+AAIThreadPool::AAIThreadPool() :
+	m_queuedTasks(0),
+	m_nextQueue(0),
+	m_stop(false)
+{
+}
+
+AAIThreadPool::~AAIThreadPool()
+{
+	Stop();
+}
+
+void AAIThreadPool::Start(int numberOfThreads)
+{
+	if(m_threads.empty() == false)
+		return;
+
+	m_stop = false;
+
+	for(int i = 0; i < numberOfThreads; ++i)
+		m_queues.push_back( std::unique_ptr<WorkQueue>(new WorkQueue()) );
+
+	for(int i = 0; i < numberOfThreads; ++i)
+		m_threads.push_back( std::thread(&AAIThreadPool::Run, this, i) );
+}
+
+void AAIThreadPool::Stop()
+{
+	if(m_threads.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_stop = true;
+	}
+
+	m_wakeUp.notify_all();
+
+	for(auto& thread : m_threads)
+		thread.join();
+
+	m_threads.clear();
+	m_queues.clear();
+	m_queuedTasks = 0;
+}
+
+void AAIThreadPool::Submit(std::function<void()> task)
+{
+	if(m_threads.empty())
+	{
+		task();
+		return;
+	}
+
+	// workers add tasks to their own queue (likely to be executed by the same thread), other threads distribute them evenly
+	const int queueIndex = (s_workerIndex >= 0) ? s_workerIndex : static_cast<int>(m_nextQueue++ % m_queues.size());
+
+	{
+		std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+		m_queues[queueIndex]->tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		++m_queuedTasks;
+	}
+
+	m_wakeUp.notify_one();
+}
+
+bool AAIThreadPool::PopTask(int workerIndex, std::function<void()>& task)
+{
+	const int numberOfQueues = static_cast<int>(m_queues.size());
+
+	if(workerIndex >= 0)
+	{
+		WorkQueue& queue = *m_queues[workerIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if(queue.tasks.empty() == false)
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+			--m_queuedTasks;
+			return true;
+		}
+	}
+
+	const int start = (workerIndex >= 0) ? workerIndex + 1 : 0;
+
+	for(int i = 0; i < numberOfQueues; ++i)
+	{
+		WorkQueue& queue = *m_queues[(start + i) % numberOfQueues];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+
+		if(queue.tasks.empty() == false)
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+			--m_queuedTasks;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool AAIThreadPool::TryExecuteTask()
+{
+	if(m_threads.empty())
+		return false;
+
+	std::function<void()> task;
+
+	if(PopTask(s_workerIndex, task))
+	{
+		AAI_TRACE_SCOPE("ThreadPool-Task")
+		task();
+		return true;
+	}
+
+	return false;
+}
+
+void AAIThreadPool::ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body)
+{
+	grainSize = std::max(grainSize, 1);
+
+	if( m_threads.empty() || (end - begin <= grainSize) )
+	{
+		if(begin < end)
+			body(begin, end);
+		return;
+	}
+
+	AAITaskGroup taskGroup(*this);
+
+	// submit all but the first range, the calling thread processes the first one itself
+	for(int first = begin + grainSize; first < end; first += grainSize)
+	{
+		const int last = std::min(first + grainSize, end);
+		taskGroup.Run([&body, first, last]() { body(first, last); });
+	}
+
+	body(begin, std::min(begin + grainSize, end));
+
+	taskGroup.Wait();
+}
+
+void AAIThreadPool::Run(int workerIndex)
+{
+	s_workerIndex = workerIndex;
+
+	std::function<void()> task;
+
+	while(true)
+	{
+		if(PopTask(workerIndex, task))
+		{
+			{
+				AAI_TRACE_SCOPE("ThreadPool-Task")
+				task();
+			}
+			task = nullptr;
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_wakeUp.wait(lock, [this]() { return m_stop || (m_queuedTasks > 0); });
+
+		if(m_stop)
+			break;
+	}
+}
+
+void AAITaskGroup::Run(std::function<void()> task)
+{
+	++m_openTasks;
+
+	m_threadPool.Submit([this, task]() {
+		task();
+		--m_openTasks;
+	});
+}
+
+void AAITaskGroup::Wait()
+{
+	while(m_openTasks > 0)
+	{
+		if(m_threadPool.TryExecuteTask() == false)
+			std::this_thread::yield();
+	}
+}
@@ -0,0 +1,106 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_THREAD_POOL_H
+#define AAI_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! @brief A pool of worker threads shared by all AAI instances of the process. Every worker has its own queue of tasks; idle workers 
+//!        steal tasks from the queues of other workers. Threads waiting for tasks to be finished (ParallelFor(), AAITaskGroup::Wait()) help
+//!        executing tasks, thus nested parallel work does not block. Without worker threads all tasks are executed in the calling thread.
+class AAIThreadPool
+{
+public:
+	AAIThreadPool();
+	~AAIThreadPool();
+
+	//! @brief Starts the given number of worker threads (if not already running)
+	void Start(int numberOfThreads);
+
+	//! @brief Stops all worker threads (all submitted tasks must have been finished before)
+	void Stop();
+
+	//! @brief Returns the number of worker threads
+	int GetNumberOfThreads() const { return static_cast<int>(m_threads.size()); }
+
+	//! @brief Adds the given task (executed immediately in the calling thread if there are no worker threads)
+	void Submit(std::function<void()> task);
+
+	//! @brief Executes one pending task in the calling thread (if any), returns whether a task has been executed
+	bool TryExecuteTask();
+
+	//! @brief Calls body(first, last) for consecutive ranges [first, last) of at most grainSize elements covering [begin, end) and returns when all have been processed
+	void ParallelFor(int begin, int end, int grainSize, const std::function<void(int, int)>& body);
+
+private:
+	struct WorkQueue
+	{
+		std::mutex                        mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	//! @brief Main loop of the worker thread with the given index
+	void Run(int workerIndex);
+
+	//! @brief Takes the next task from the queue of the given worker (newest task first) or steals one from another queue (oldest task first)
+	bool PopTask(int workerIndex, std::function<void()>& task);
+
+	//! The worker threads
+	std::vector<std::thread>                 m_threads;
+
+	//! One queue per worker thread
+	std::vector< std::unique_ptr<WorkQueue> > m_queues;
+
+	//! Used to let idle workers sleep until new tasks are submitted
+	std::mutex                               m_sleepMutex;
+	std::condition_variable                  m_wakeUp;
+
+	//! Number of submitted tasks not yet taken from the queues
+	std::atomic<int>                         m_queuedTasks;
+
+	//! Queue to which the next task submitted by a thread not belonging to the pool is added
+	std::atomic<unsigned int>                m_nextQueue;
+
+	//! Flag whether worker threads shall stop
+	std::atomic<bool>                        m_stop;
+
+	//! Index of the worker if the current thread belongs to the pool (-1 otherwise)
+	static thread_local int                  s_workerIndex;
+};
+
+//! @brief A group of tasks that can be waited for; dependencies between tasks are expressed by waiting for a (nested) group within a task
+class AAITaskGroup
+{
+public:
+	AAITaskGroup(AAIThreadPool& threadPool) : m_threadPool(threadPool), m_openTasks(0) {}
+
+	~AAITaskGroup() { Wait(); }
+
+	//! @brief Adds the given task to the group
+	void Run(std::function<void()> task);
+
+	//! @brief Returns after all tasks of the group have been finished (calling thread executes pending tasks in the meantime)
+	void Wait();
+
+private:
+	AAIThreadPool&   m_threadPool;
+
+	//! Number of tasks of the group that have not been finished yet
+	std::atomic<int> m_openTasks;
+};
+
+#endif
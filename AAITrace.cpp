@@ -0,0 +1,91 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <cstdio>
+
+#include "AAITrace.h"
+#include "AAIJson.h"
+
+std::atomic<bool> AAITrace::s_enabled(false);
+
+const std::chrono::steady_clock::time_point AAITrace::s_startTime = std::chrono::steady_clock::now();
+
+std::mutex AAITrace::s_buffersMutex;
+
+std::vector< std::unique_ptr<AAITrace::ThreadBuffer> > AAITrace::s_buffers;
+
+int64_t AAITrace::GetTimestamp()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_startTime).count();
+}
+
+AAITrace::ThreadBuffer* AAITrace::GetThreadBuffer()
+{
+	thread_local ThreadBuffer* buffer(nullptr);
+
+	if(buffer == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(s_buffersMutex);
+		s_buffers.emplace_back(new ThreadBuffer(static_cast<int>(s_buffers.size())));
+		buffer = s_buffers.back().get();
+	}
+
+	return buffer;
+}
+
+void AAITrace::AddEvent(const char* name, int64_t start, int64_t duration)
+{
+	ThreadBuffer* buffer = GetThreadBuffer();
+
+	// only the owning thread writes to the buffer
+	const uint64_t index = buffer->writtenEvents.load(std::memory_order_relaxed);
+	buffer->events[index % bufferSize] = TraceEvent{name, start, duration};
+	buffer->writtenEvents.store(index + 1, std::memory_order_release);
+}
+
+bool AAITrace::WriteToFile(const std::string& filename)
+{
+	std::lock_guard<std::mutex> lock(s_buffersMutex);
+
+	FILE* file = fopen(filename.c_str(), "w");
+
+	if(file == nullptr)
+		return false;
+
+	fprintf(file, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	bool first(true);
+
+	for(auto& buffer : s_buffers)
+	{
+		fprintf(file, "%s{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %i, \"args\": {\"name\": \"AAI thread %i\"}}",
+		        first ? "" : ",\n", buffer->threadIndex, buffer->threadIndex);
+		first = false;
+
+		const uint64_t writtenEvents = buffer->writtenEvents.load(std::memory_order_acquire);
+		const uint64_t firstEvent    = (writtenEvents > bufferSize) ? (writtenEvents - bufferSize) : 0;
+
+		for(uint64_t index = firstEvent; index < writtenEvents; ++index)
+		{
+			const TraceEvent& event = buffer->events[index % bufferSize];
+
+			fprintf(file, ",\n{\"name\": ");
+			WriteJsonString(file, event.name);
+			fprintf(file, ", \"ph\": \"X\", \"pid\": 1, \"tid\": %i, \"ts\": %lld, \"dur\": %lld}", buffer->threadIndex,
+			        static_cast<long long>(event.start), static_cast<long long>(event.duration));
+		}
+
+		buffer->writtenEvents.store(0, std::memory_order_relaxed);
+	}
+
+	fprintf(file, "\n]}\n");
+	fclose(file);
+
+	return true;
+}
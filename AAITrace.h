@@ -0,0 +1,98 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_TRACE_H
+#define AAI_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//! @brief Records the execution timeline (one event per traced scope with start time and duration) of all threads for later inspection
+//!        in chrome://tracing or Perfetto. Every thread writes to its own ring buffer (no locking while recording; if a buffer is full,
+//!        the oldest events are overwritten). Tracing is disabled by default (enabled via TRACE_EXECUTION in the general config).
+class AAITrace
+{
+public:
+	//! @brief Enables/disables recording of events
+	static void Enable(bool enable) { s_enabled.store(enable, std::memory_order_relaxed); }
+
+	//! @brief Returns whether events are currently recorded
+	static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+	//! @brief Returns the current time in microseconds since start of the trace
+	static int64_t GetTimestamp();
+
+	//! @brief Records a scope with the given name (must remain valid until trace has been written), start time and duration (in microseconds)
+	static void AddEvent(const char* name, int64_t start, int64_t duration);
+
+	//! @brief Writes the recorded events of all threads in the Chrome trace event format and clears the buffers;
+	//!        must only be called when no other thread is recording (e.g. after the worker threads have been stopped)
+	static bool WriteToFile(const std::string& filename);
+
+private:
+	struct TraceEvent
+	{
+		const char* name;
+		int64_t     start;
+		int64_t     duration;
+	};
+
+	struct ThreadBuffer
+	{
+		ThreadBuffer(int threadIndex) : events(bufferSize), writtenEvents(0), threadIndex(threadIndex) {}
+
+		std::vector<TraceEvent> events;
+
+		//! Total number of events written by the thread (index in ring buffer = writtenEvents % bufferSize)
+		std::atomic<uint64_t>   writtenEvents;
+
+		int                     threadIndex;
+	};
+
+	//! @brief Returns the buffer of the calling thread (created on first call)
+	static ThreadBuffer* GetThreadBuffer();
+
+	//! Number of events stored per thread
+	static constexpr size_t bufferSize = 1 << 16;
+
+	static std::atomic<bool> s_enabled;
+
+	//! Reference point for timestamps
+	static const std::chrono::steady_clock::time_point s_startTime;
+
+	//! Buffers of all threads that recorded events (kept after threads have terminated until trace has been written)
+	static std::mutex                                 s_buffersMutex;
+	static std::vector< std::unique_ptr<ThreadBuffer> > s_buffers;
+};
+
+//! @brief Records the time from construction to destruction as a trace event (if tracing is enabled)
+class AAITraceScope
+{
+public:
+	AAITraceScope(const char* name) : m_name(name), m_start(AAITrace::IsEnabled() ? AAITrace::GetTimestamp() : -1) {}
+
+	~AAITraceScope()
+	{
+		if(m_start >= 0)
+			AAITrace::AddEvent(m_name, m_start, AAITrace::GetTimestamp() - m_start);
+	}
+
+private:
+	const char* m_name;
+	int64_t     m_start;
+};
+
+#define AAI_TRACE_SCOPE(name) AAITraceScope aaiTraceScopeFromMacro(name);
+
+#endif
@@ -0,0 +1,140 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIUnitQueryCache.h"
+#include "AAI.h"
+
+AAIUnitQueryCache::AAIUnitQueryCache(IAICallback* callback, int maxUnits, bool profileCalls) :
+	AAICallbackProxy(callback, profileCalls),
+	m_units(maxUnits),
+	m_currentStamp(1u)
+{
+}
+
+AAIUnitQueryCache::CachedUnitData* AAIUnitQueryCache::GetEntry(int unitId, ECachedUnitQuery query, bool& hit)
+{
+	CachedUnitData* entry(nullptr);
+	hit = false;
+
+	if( (unitId >= 0) && (unitId < static_cast<int>(m_units.size())) )
+	{
+		entry = &m_units[unitId];
+
+		if(entry->stamp != m_currentStamp)
+		{
+			entry->stamp        = m_currentStamp;
+			entry->validQueries = 0u;
+		}
+		else
+			hit = (entry->validQueries & GetQueryBit(query)) != 0u;
+	}
+
+	QueryStatistics& statistics = m_statistics[static_cast<int>(query)];
+
+	if(hit)
+		++statistics.hits;
+	else
+		++statistics.misses;
+
+	return entry;
+}
+
+float3 AAIUnitQueryCache::GetUnitPos(int unitId)
+{
+	bool hit;
+	CachedUnitData* entry = GetEntry(unitId, ECachedUnitQuery::POSITION, hit);
+
+	if(hit)
+		return entry->position;
+
+	const float3 position = AAICallbackProxy::GetUnitPos(unitId);
+
+	if(entry)
+	{
+		entry->position      = position;
+		entry->validQueries |= GetQueryBit(ECachedUnitQuery::POSITION);
+	}
+
+	return position;
+}
+
+const UnitDef* AAIUnitQueryCache::GetUnitDef(int unitId)
+{
+	bool hit;
+	CachedUnitData* entry = GetEntry(unitId, ECachedUnitQuery::UNIT_DEF, hit);
+
+	if(hit)
+		return entry->unitDef;
+
+	const UnitDef* unitDef = AAICallbackProxy::GetUnitDef(unitId);
+
+	if(entry)
+	{
+		entry->unitDef       = unitDef;
+		entry->validQueries |= GetQueryBit(ECachedUnitQuery::UNIT_DEF);
+	}
+
+	return unitDef;
+}
+
+int AAIUnitQueryCache::GetUnitTeam(int unitId)
+{
+	bool hit;
+	CachedUnitData* entry = GetEntry(unitId, ECachedUnitQuery::TEAM, hit);
+
+	if(hit)
+		return entry->team;
+
+	const int team = AAICallbackProxy::GetUnitTeam(unitId);
+
+	if(entry)
+	{
+		entry->team          = team;
+		entry->validQueries |= GetQueryBit(ECachedUnitQuery::TEAM);
+	}
+
+	return team;
+}
+
+bool AAIUnitQueryCache::UnitBeingBuilt(int unitId)
+{
+	bool hit;
+	CachedUnitData* entry = GetEntry(unitId, ECachedUnitQuery::BEING_BUILT, hit);
+
+	if(hit)
+		return entry->beingBuilt;
+
+	const bool beingBuilt = AAICallbackProxy::UnitBeingBuilt(unitId);
+
+	if(entry)
+	{
+		entry->beingBuilt    = beingBuilt;
+		entry->validQueries |= GetQueryBit(ECachedUnitQuery::BEING_BUILT);
+	}
+
+	return beingBuilt;
+}
+
+void AAIUnitQueryCache::LogStatistics(AAI* ai) const
+{
+	static const char* const queryNames[] = { "GetUnitPos", "GetUnitDef", "GetUnitTeam", "UnitBeingBuilt" };
+
+	ai->Log("\nUnit query cache - query: hits / misses (hit rate):\n");
+
+	for(int query = 0; query < static_cast<int>(ECachedUnitQuery::NUMBER_OF_QUERIES); ++query)
+	{
+		const QueryStatistics& statistics = m_statistics[query];
+		const int64_t          calls      = statistics.hits + statistics.misses;
+
+		ai->Log("%-16s: %10lld / %10lld (%5.1f%%)\n", queryNames[query], static_cast<long long>(statistics.hits), static_cast<long long>(statistics.misses),
+		        (calls > 0) ? 100.0 * static_cast<double>(statistics.hits) / static_cast<double>(calls) : 0.0);
+	}
+
+	AAICallbackProxy::LogStatistics(ai);
+}
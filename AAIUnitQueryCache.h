@@ -0,0 +1,105 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_UNIT_QUERY_CACHE_H
+#define AAI_UNIT_QUERY_CACHE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "AAICallbackProxy.h"
+
+//! The unit queries answered by the unit query cache
+enum class ECachedUnitQuery : int
+{
+	POSITION,
+	UNIT_DEF,
+	TEAM,
+	BEING_BUILT,
+	NUMBER_OF_QUERIES
+};
+
+//! @brief Callback proxy that memorizes position, unit definition, team and construction state of units for the current frame. The engine
+//!        is only queried the first time the data of a unit is requested within a frame (all other calls are forwarded to the engine callback).
+//!        Data is stored in an array indexed by unit id; an entry is valid if its frame stamp matches the current one, i.e. the whole
+//!        cache is reset by incrementing the stamp at the begin of a frame.
+//!        Events reported after the update of a frame may thus see data up to one frame old - unit dependent events (e.g. unit created/finished)
+//!        have to invalidate the data of the respective unit. This also applies to enemy units entering/leaving LOS or radar as the
+//!        engine only reports the unit definition of enemy units within LOS.
+class AAIUnitQueryCache : public AAICallbackProxy
+{
+public:
+	AAIUnitQueryCache(IAICallback* callback, int maxUnits, bool profileCalls);
+
+	//! @brief Marks the begin of a new frame (discards all cached data)
+	void StartFrame() { ++m_currentStamp; }
+
+	//! @brief Discards the cached data of the given unit (to be called if team, state or visibility of the unit has changed or its id has been reused)
+	void InvalidateUnit(int unitId)
+	{
+		if( (unitId >= 0) && (unitId < static_cast<int>(m_units.size())) )
+			m_units[unitId].stamp = 0u;
+	}
+
+	//! @brief Writes the hit rates of the cache (and the statistics of the callback proxy if profiling is enabled) to the log file
+	void LogStatistics(AAI* ai) const;
+
+	float3 GetUnitPos(int unitId) override;
+
+	const UnitDef* GetUnitDef(int unitId) override;
+
+	int GetUnitTeam(int unitId) override;
+
+	bool UnitBeingBuilt(int unitId) override;
+
+	// bring the remaining overloads of the base class into scope
+	using AAICallbackProxy::GetUnitDef;
+
+private:
+	struct CachedUnitData
+	{
+		CachedUnitData() : stamp(0u), validQueries(0u), unitDef(nullptr), team(-1), beingBuilt(false) {}
+
+		//! Data is only valid if stamp is equal to current stamp of the cache
+		uint32_t       stamp;
+
+		//! Bitmask which of the queries have been cached (bit i corresponds to ECachedUnitQuery i)
+		uint32_t       validQueries;
+
+		float3         position;
+		const UnitDef* unitDef;
+		int            team;
+		bool           beingBuilt;
+	};
+
+	struct QueryStatistics
+	{
+		QueryStatistics() : hits(0), misses(0) {}
+
+		int64_t hits;
+		int64_t misses;
+	};
+
+	//! @brief Returns the entry of the given unit (nullptr if unit id is out of range), outdated entries are reset; hit is set to
+	//!        whether the result of the given query is already stored in the entry (hit/miss statistics are updated accordingly)
+	CachedUnitData* GetEntry(int unitId, ECachedUnitQuery query, bool& hit);
+
+	//! @brief Returns the bit of the given query in the valid queries bitmask
+	static uint32_t GetQueryBit(ECachedUnitQuery query) { return 1u << static_cast<int>(query); }
+
+	//! Cached data of every unit (indexed by unit id)
+	std::vector<CachedUnitData> m_units;
+
+	//! Stamp of the current frame (starts with 1 as entries are initialized/invalidated with 0)
+	uint32_t m_currentStamp;
+
+	QueryStatistics m_statistics[static_cast<int>(ECachedUnitQuery::NUMBER_OF_QUERIES)];
+};
+
+#endif
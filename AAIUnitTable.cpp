@@ -17,6 +17,7 @@
 #include "AAIMap.h"
 #include "AAIGroup.h"
 #include "AAIConstructor.h"
+#include "AAIMemoryUsage.h"
 
 #include "LegacyCpp/UnitDef.h"
 using namespace springLegacyAI;
@@ -36,6 +37,7 @@ AAIUnitTable::AAIUnitTable(AAI *ai)
 		units[i].cons = nullptr;
 		units[i].status = UNIT_KILLED;
 		units[i].last_order = 0;
+		units[i].group_slot = -1;
 	}
 
 	m_activeUnitsOfCategory.resize(AAIUnitCategory::numberOfUnitCategories, 0);
@@ -58,6 +60,18 @@ AAIUnitTable::~AAIUnitTable(void)
 	m_requestedUnitsOfCategory.clear();
 }
 
+size_t AAIUnitTable::GetMemoryUsage() const
+{
+	size_t memoryUsage = GetAllocatedMemory(units) + m_constructors.size() * sizeof(AAIConstructor);
+
+	memoryUsage += GetAllocatedMemory(m_activeUnitsOfCategory) + GetAllocatedMemory(m_underConstructionUnitsOfCategory) + GetAllocatedMemory(m_requestedUnitsOfCategory);
+
+	for(const std::set<int>* unitSet : {&metal_makers, &jammers, &scouts, &extractors, &power_plants, &stationary_arty})
+		memoryUsage += GetAllocatedMemory(*unitSet);
+
+	return memoryUsage + GetAllocatedMemory(m_constructors) + GetAllocatedMemory(m_staticSensors);
+}
+
 
 bool AAIUnitTable::AddUnit(int unit_id, int def_id, AAIGroup *group, AAIConstructor *cons)
 {
@@ -84,11 +98,12 @@ bool AAIUnitTable::AddUnit(int unit_id, int def_id, AAIGroup *group, AAIConstruc
 		units[unit_id].group  = group;
 		units[unit_id].cons   = cons;
 		units[unit_id].status = UNIT_IDLE;
+		units[unit_id].group_slot = -1;
 		return true;
 	}
 	else
 	{
-		ai->Log("ERROR: AAIUnitTable::AddUnit() index %i out of range", unit_id);
+		ai->Log(ELogCategory::GENERAL, ELogLevel::ERRORS, "ERROR: AAIUnitTable::AddUnit() index %i out of range", unit_id);
 		return false;
 	}
 }
@@ -101,10 +116,11 @@ void AAIUnitTable::RemoveUnit(int unit_id)
 		units[unit_id].group = 0;
 		units[unit_id].cons = nullptr;
 		units[unit_id].status = UNIT_KILLED;
+		units[unit_id].group_slot = -1;
 	}
 	else
 	{
-		ai->Log("ERROR: AAIUnitTable::RemoveUnit() index %i out of range", unit_id);
+		ai->Log(ELogCategory::GENERAL, ELogLevel::ERRORS, "ERROR: AAIUnitTable::RemoveUnit() index %i out of range", unit_id);
 	}
 }
 
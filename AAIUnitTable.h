@@ -51,6 +51,9 @@ public:
 	AAIUnitTable(AAI *ai);
 	~AAIUnitTable(void);
 
+	//! @brief Returns the memory (in bytes) allocated by the unit table (including the constructors)
+	size_t GetMemoryUsage() const;
+
 	//! @brief Returns the number of active (i.e. not under construction anymore) units of the given category
 	int GetNumberOfActiveUnitsOfCategory(const AAIUnitCategory& category)            const { return m_activeUnitsOfCategory[category.GetArrayIndex()]; };
 
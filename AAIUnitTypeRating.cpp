@@ -0,0 +1,87 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIUnitTypeRating.h"
+#include "AAIMemoryUsage.h"
+
+#include <algorithm>
+
+UnitTypeRatingTable::UnitTypeRatingTable(int numberOfFeatures) :
+	m_numberOfFeatures( std::min(numberOfFeatures, maxNumberOfUnitTypeFeatures) )
+{
+}
+
+void UnitTypeRatingTable::Reset(int numberOfFeatures)
+{
+	m_numberOfFeatures = std::min(numberOfFeatures, maxNumberOfUnitTypeFeatures);
+
+	m_unitDefIds.clear();
+	m_selectable.clear();
+
+	for(auto& values : m_features)
+		values.clear();
+}
+
+size_t UnitTypeRatingTable::GetMemoryUsage() const
+{
+	size_t memoryUsage = GetAllocatedMemory(m_unitDefIds) + GetAllocatedMemory(m_selectable) + GetAllocatedMemory(m_ratings);
+
+	for(const auto& values : m_features)
+		memoryUsage += GetAllocatedMemory(values);
+
+	return memoryUsage;
+}
+
+void UnitTypeRatingTable::AddCandidate(UnitDefId unitDefId, const UnitTypeFeatures& features, bool selectable)
+{
+	m_unitDefIds.push_back(unitDefId);
+	m_selectable.push_back(selectable ? 1.0f : 0.0f);
+
+	for(int feature = 0; feature < m_numberOfFeatures; ++feature)
+		m_features[feature].push_back(features[feature]);
+}
+
+UnitDefId UnitTypeRatingTable::SelectHighestRatedCandidate(const UnitTypeFeatures& weights)
+{
+	const int numberOfCandidates = GetNumberOfCandidates();
+
+	m_ratings.assign(numberOfCandidates, 0.0f);
+
+	// accumulate weighted features one after another (same order of summation as rating every candidate separately)
+	float* const ratings = m_ratings.data();
+
+	for(int feature = 0; feature < m_numberOfFeatures; ++feature)
+	{
+		const float        weight = weights[feature];
+		const float* const values = m_features[feature].data();
+
+		for(int i = 0; i < numberOfCandidates; ++i)
+			ratings[i] += weight * values[i];
+	}
+
+	const float* const selectable = m_selectable.data();
+
+	for(int i = 0; i < numberOfCandidates; ++i)
+		ratings[i] *= selectable[i];
+
+	// determine candidate with highest rating (first one if several candidates share the highest rating)
+	int   selectedCandidate(-1);
+	float highestRating(0.0f);
+
+	for(int i = 0; i < numberOfCandidates; ++i)
+	{
+		if(ratings[i] > highestRating)
+		{
+			highestRating     = ratings[i];
+			selectedCandidate = i;
+		}
+	}
+
+	return (selectedCandidate >= 0) ? m_unitDefIds[selectedCandidate] : UnitDefId();
+}
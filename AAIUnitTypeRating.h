@@ -0,0 +1,64 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_UNIT_TYPE_RATING_H
+#define AAI_UNIT_TYPE_RATING_H
+
+#include <array>
+#include <vector>
+#include "aidef.h"
+
+//! The maximum number of features that may be used to rate unit types
+static constexpr int maxNumberOfUnitTypeFeatures = 8;
+
+//! Feature values of one unit type or weights of the features (unused entries must be zero)
+typedef std::array<float, maxNumberOfUnitTypeFeatures> UnitTypeFeatures;
+
+//! @brief Rates unit types by a weighted sum of their features (e.g. normalized cost, range, combat power) and selects the highest rated one.
+//!        Features are stored per feature in contiguous arrays (structure of arrays) to allow the compiler to vectorize the calculation of the ratings.
+//!        A table should be reused for subsequent selections (see Reset()) to avoid reallocation of its buffers.
+class UnitTypeRatingTable
+{
+public:
+	//! @brief Creates an empty table; numberOfFeatures is the number of features used for rating
+	explicit UnitTypeRatingTable(int numberOfFeatures = 0);
+
+	//! @brief Removes all candidates (allocated memory is kept) and sets the number of features used for the next selection
+	void Reset(int numberOfFeatures);
+
+	//! @brief Returns the memory (in bytes) allocated by the buffers of the table
+	size_t GetMemoryUsage() const;
+
+	//! @brief Adds a unit type with the given features; candidates that are not selectable are not rated
+	void AddCandidate(UnitDefId unitDefId, const UnitTypeFeatures& features, bool selectable = true);
+
+	//! @brief Returns the number of candidates
+	int GetNumberOfCandidates() const { return static_cast<int>(m_unitDefIds.size()); }
+
+	//! @brief Returns the selectable candidate with the highest rating, i.e. weighted sum of its features (invalid unitDefId if no candidate rated above 0)
+	UnitDefId SelectHighestRatedCandidate(const UnitTypeFeatures& weights);
+
+private:
+	//! Number of features used in the current selection
+	int                                                       m_numberOfFeatures;
+
+	//! The candidates
+	std::vector<UnitDefId>                                    m_unitDefIds;
+
+	//! The values of every feature for all candidates
+	std::array<std::vector<float>, maxNumberOfUnitTypeFeatures> m_features;
+
+	//! 1.0 for selectable candidates, 0.0 otherwise
+	std::vector<float>                                        m_selectable;
+
+	//! Buffer for the ratings of the candidates
+	std::vector<float>                                        m_ratings;
+};
+
+#endif
@@ -12,6 +12,7 @@
 
 #include "System/float3.h"
 #include "Sim/Misc/GlobalConstants.h"
+#include <atomic>
 #include <vector>
 #include <string>
 
@@ -86,9 +87,75 @@ public:
 	//! The minimum number of frames between two updates of the units in current LOS (to avoid too heavy CPU load)
 	static constexpr int   minFramesBetweenLOSUpdates = 10;
 
+	//! Number of slices the sectors are divided into for the update of their scouting data (one slice is updated per call of AAIMap::UpdateSectorSlice())
+	static constexpr int   sectorUpdateSlices = 9;
+
+	//! Number of frames between the updates of two slices of sectors (i.e. all sectors are updated every sectorUpdateSlices * sectorSliceUpdateInterval frames)
+	static constexpr int   sectorSliceUpdateInterval = 5;
+
+	//! Number of frames between two synchronizations of the enemy units within LOS/radar (tracked via events) with the engine
+	static constexpr int   enemySightingsSynchronizationInterval = 900;
+
+	//! Size of the cells (in unit coordinates) of the grid storing the enemy units within LOS/radar
+	static constexpr float enemyUnitGridCellSize = 512.0f;
+
+	//! Maximum number of orders given to units per frame (unless a single group order exceeds it); remaining orders are deferred to the next frame(s)
+	static constexpr int   maxOrdersPerFrame = 32;
+
+	//! Maximum deviation of the parameters (e.g. coordinates) of an order from the current command of a unit to be considered identical
+	static constexpr float maxOrderParameterDeviation = 0.5f;
+
 	//! Number of data points used to calculate smoothed energy/metal income/surplus 
 	static constexpr int   incomeSamplePoints = 16;
 
+	//! Target for the time (in microseconds) spent on scheduled tasks per frame; due tasks exceeding it are deferred to the next frame(s)
+	static constexpr int   scheduledTasksFrameBudget = 3000;
+
+	//! Number of frames over which the time spent by AAI is averaged before the frame time governor adapts the cadence of non-critical tasks
+	static constexpr int   governorMeasurementWindow = 30;
+
+	//! Ratio of average time per frame to budget below which the frame time governor tightens the cadence of non-critical tasks again
+	static constexpr float governorLowLoad = 0.6f;
+
+	//! Ratio of average time per frame to budget the frame time governor aims at when stretching the cadence of non-critical tasks
+	static constexpr float governorTargetLoad = 0.8f;
+
+	//! Factor applied to the cadence factor per adjustment if there is enough headroom
+	static constexpr float governorTighteningStep = 0.8f;
+
+	//! Maximum factor applied to the cadence factor per adjustment if the budget is exceeded
+	static constexpr float governorMaxStretchingStep = 2.0f;
+
+	//! Target for the time (in microseconds) spent on incremental planners per frame (at least one step is performed per frame)
+	static constexpr int   plannerFrameBudget = 500;
+
+	//! Maximum number of attempts to commit the result of an incremental planner (planner is dropped afterwards)
+	static constexpr int   plannerMaxCommitAttempts = 4;
+
+	//! Number of map tiles rated per step of the buildsite search for static defences
+	static constexpr int   plannerTilesPerStep = 64;
+
+	//! Number of sectors checked per step of the selection of a sector to expand the base
+	static constexpr int   plannerSectorsPerStep = 8;
+
+	//! Number of frames between two reports of the memory used by the subsystems of an AAI instance
+	static constexpr int   memoryReportInterval = 9000;
+
+	//! Number of records of the log buffer (must be a power of two); messages are dropped if the buffer is full
+	static constexpr int   logBufferRecords = 4096;
+
+	//! Time (in milliseconds) between two passes of the log writer thread
+	static constexpr int   logWriterInterval = 20;
+
+	//! Frames in which AAI spends more time (in microseconds) are recorded as spikes by the performance monitor
+	static constexpr int   performanceSpikeThreshold = 15000;
+
+	//! Maximum number of spikes (the longest ones) kept by the performance monitor
+	static constexpr int   maxRecordedPerformanceSpikes = 32;
+
+	//! Number of frames between two dumps of the performance statistics to file
+	static constexpr int   performanceDumpInterval = 1800;
+
 	//! Urgency of bombing run
 	static constexpr float bombingRunUrgency = 100.0f;
 
@@ -155,29 +222,49 @@ public:
 	int id;
 };
 
-//! This class stores the information required for placing/upgrading metal extractors
+//! This class stores the information required for placing/upgrading metal extractors; metal spots are shared by all AAI instances,
+//! thus occupation and extractor are stored atomically
 class AAIMetalSpot
 {
 public:
 	AAIMetalSpot(const float3& _pos, float _amount):
 		pos(_pos),
-		occupied(false),
-		amount(_amount)
+		amount(_amount),
+		m_occupied(false),
+		m_extractorUnitId(UnitId().id),
+		m_extractorDefId(UnitDefId().id)
 	{}
 
-	AAIMetalSpot():
-		pos(ZeroVector),
-		occupied(false),
-		amount(0.0f)
-	{}
+	//! @brief Returns whether the spot is currently occupied by any AAI player
+	bool IsOccupied() const { return m_occupied.load(std::memory_order_acquire); }
+
+	//! @brief Marks the spot as occupied; returns false if it is already occupied (e.g. by another AAI instance in the meantime)
+	bool Occupy()
+	{
+		bool occupied(false);
+		return m_occupied.compare_exchange_strong(occupied, true, std::memory_order_acq_rel);
+	}
 
 	void SetUnoccupied()
 	{
-		occupied = false;
-		extractorUnitId.Invalidate();
-		extractorDefId.Invalidate();
+		m_extractorUnitId.store(UnitId().id, std::memory_order_relaxed);
+		m_extractorDefId.store(UnitDefId().id, std::memory_order_relaxed);
+		m_occupied.store(false, std::memory_order_release);
+	}
+
+	//! @brief Sets the extractor occupying the spot
+	void SetExtractor(UnitId unitId, UnitDefId unitDefId)
+	{
+		m_extractorUnitId.store(unitId.id, std::memory_order_release);
+		m_extractorDefId.store(unitDefId.id, std::memory_order_release);
 	}
 
+	//! @brief Returns the unit id of the extractor occupying the spot (invalid if none)
+	UnitId GetExtractorUnitId() const { return UnitId(m_extractorUnitId.load(std::memory_order_acquire)); }
+
+	//! @brief Returns the unit type of the extractor occupying the spot (invalid if none)
+	UnitDefId GetExtractorDefId() const { return UnitDefId(m_extractorDefId.load(std::memory_order_acquire)); }
+
 	//! @brief Returns whether spot belong to given map position
 	bool DoesSpotBelongToPosition(const float3& position) const
 	{
@@ -187,17 +274,18 @@ public:
 	//! The position of the metal spot in the map
 	float3    pos;
 
+	//! The ammount of metal that can be extracted from the spot
+	float     amount;
+
+private:
 	//! Flag whether the spot is currently occupied by any AAI player
-	bool      occupied;
+	std::atomic<bool> m_occupied;
 
 	//! UnitId of the extractor occupying the spot
-	UnitId    extractorUnitId;
+	std::atomic<int>  m_extractorUnitId;
 
 	//! UnitDefId of the extractor occupying the spot
-	UnitDefId extractorDefId;
-
-	//! The ammount of metal that can be extracted from the spot
-	float     amount;
+	std::atomic<int>  m_extractorDefId;
 };
 
 //! @brief This class encapsulates the determination of the current game phase (ranging from start to late game) 
@@ -298,6 +386,8 @@ struct AAIUnit
 	AAIConstructor *cons;
 	UnitTask status;
 	int last_order;
+	//! Index of the unit within the units of its group (-1 if unit does not belong to any group)
+	int group_slot;
 };
 
 #endif
@@ -0,0 +1,179 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <cstdio>
+#include <cstring>
+#include <sys/stat.h>
+
+#include "AAIBenchCallback.h"
+
+std::map<int, AAIBenchWorld*> AAIBenchCallback::s_worlds;
+
+AAIBenchCallback::AAIBenchCallback(AAIBenchWorld* world, const std::string& dataDirectory, const std::string& outputDirectory, int skirmishAIId) :
+	m_world(world),
+	m_skirmishAIId(skirmishAIId),
+	m_team( (skirmishAIId == 0) ? AAIBenchWorld::ownTeam : AAIBenchWorld::enemyTeam + skirmishAIId),
+	m_dataDirectory(dataDirectory),
+	m_outputDirectory(outputDirectory),
+	m_orders(0)
+{
+	s_worlds[skirmishAIId] = world;
+
+	std::memset(&m_skirmishAICallback, 0, sizeof(m_skirmishAICallback));
+	m_skirmishAICallback.Map_getLosMap                 = &AAIBenchCallback::GetLosMapOfSkirmishAI;
+	m_skirmishAICallback.SkirmishAI_Info_getValueByKey = &AAIBenchCallback::GetInfoValueOfSkirmishAI;
+}
+
+int AAIBenchCallback::GetLosMapOfSkirmishAI(int skirmishAIId, int* losValues, int losValues_sizeMax)
+{
+	return s_worlds.at(skirmishAIId)->GetLosMap(losValues, losValues_sizeMax);
+}
+
+const char* AAIBenchCallback::GetInfoValueOfSkirmishAI(int skirmishAIId, const char* key)
+{
+	if(std::strcmp(key, SKIRMISH_AI_PROPERTY_VERSION) == 0)
+		return "bench";
+
+	return "";
+}
+
+void AAIBenchCallback::SendTextMsg(const char* text, int zone)
+{
+	std::printf("[AAI] %s\n", text);
+}
+
+int AAIBenchCallback::GiveOrder(int unitId, Command* c)
+{
+	if( (c == nullptr) || (m_world->GetUnit(unitId) == nullptr) )
+		return -1;
+
+	++m_orders;
+	m_world->GiveOrder(unitId, *c);
+	return 0;
+}
+
+int AAIBenchCallback::GetUnitTeam(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+
+	if(unit == nullptr)
+		return -1;
+
+	return (unit->team == AAIBenchWorld::ownTeam) ? m_team : unit->team;
+}
+
+float AAIBenchCallback::GetUnitHealth(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? unit->health : 0.0f;
+}
+
+float AAIBenchCallback::GetUnitMaxHealth(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? unit->def->health : 0.0f;
+}
+
+float AAIBenchCallback::GetUnitSpeed(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? unit->def->speed : 0.0f;
+}
+
+float AAIBenchCallback::GetUnitPower(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? unit->def->power : 0.0f;
+}
+
+float AAIBenchCallback::GetUnitMaxRange(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? AAIBenchWorld::GetMaxRange(unit->def) : 0.0f;
+}
+
+bool AAIBenchCallback::UnitBeingBuilt(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? (unit->remainingBuildFrames > 0) : false;
+}
+
+const UnitDef* AAIBenchCallback::GetUnitDef(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? unit->def : nullptr;
+}
+
+float3 AAIBenchCallback::GetUnitPos(int unitId)
+{
+	const BenchUnit* unit = m_world->GetUnit(unitId);
+	return unit ? unit->pos : ZeroVector;
+}
+
+void AAIBenchCallback::GetUnitDefList(const UnitDef** list)
+{
+	for(int id = 1; id <= m_world->GetNumberOfUnitDefs(); ++id)
+		list[id-1] = m_world->GetUnitDefById(id);
+}
+
+std::string JoinPath(const std::string& directory, const std::string& filename)
+{
+	if(directory.empty() || (directory.back() == '/') )
+		return directory + filename;
+	else
+		return directory + '/' + filename;
+}
+
+//! @brief Creates all missing directories of the given path (everything up to the last '/')
+static void CreateDirectories(const std::string& path)
+{
+	for(size_t pos = path.find('/', 1); pos != std::string::npos; pos = path.find('/', pos+1))
+		mkdir(path.substr(0, pos).c_str(), 0755);
+}
+
+bool AAIBenchCallback::GetValue(int valueId, void* dst)
+{
+	// buffer size used by engine and AAI for file names
+	const size_t bufferSize = 2048;
+	char* filename = static_cast<char*>(dst);
+
+	switch(valueId)
+	{
+		case AIVAL_LOCATE_FILE_R:
+		{
+			// look in the fixture directory first, then in the data directory of AAI
+			const std::string searchPaths[] = { JoinPath(m_dataDirectory, filename), JoinPath("data", filename) };
+
+			for(const std::string& path : searchPaths)
+			{
+				FILE* file = std::fopen(path.c_str(), "r");
+
+				if(file)
+				{
+					std::fclose(file);
+					std::snprintf(filename, bufferSize, "%s", path.c_str());
+					return true;
+				}
+			}
+			return false;
+		}
+		case AIVAL_LOCATE_FILE_W:
+		{
+			const std::string path = JoinPath(m_outputDirectory, filename);
+			CreateDirectories(path);
+			std::snprintf(filename, bufferSize, "%s", path.c_str());
+			return true;
+		}
+		case AIVAL_UNITLIMIT:
+			*static_cast<int*>(dst) = AAIBenchWorld::maxUnits;
+			return true;
+		default:
+			return false;
+	}
+}
@@ -0,0 +1,266 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_CALLBACK_H
+#define AAI_BENCH_CALLBACK_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ExternalAI/Interface/SSkirmishAICallback.h"
+#include "LegacyCpp/IAICallback.h"
+#include "LegacyCpp/IGlobalAICallback.h"
+
+#include "AAIBenchWorld.h"
+
+//! @brief Stand-in for the engine side of the legacy C++ AI interface: answers the queries of the AI with data of the synthetic
+//!        world and forwards orders to it. Functionality not needed by AAI (drawing, pathing, lua, ...) is implemented as no-op.
+//!        The method set follows the legacy IAICallback interface of Spring 104/105 and needs to be adapted if the interface changes.
+class AAIBenchCallback : public IAICallback
+{
+public:
+	//! @brief Several instances (of AAI playing in their own worlds) may run concurrently; each needs its own skirmish AI id. The
+	//!        first instance plays as the own team of the world, further ones are given team ids after the one of the enemy team.
+	AAIBenchCallback(AAIBenchWorld* world, const std::string& dataDirectory, const std::string& outputDirectory, int skirmishAIId = 0);
+
+	//! @brief Returns the C callback (only those functions AAI accesses directly are set)
+	const SSkirmishAICallback* GetSkirmishAICallback() const { return &m_skirmishAICallback; }
+
+	//! @brief Returns the number of orders the AI has given
+	int GetNumberOfOrders() const { return m_orders; }
+
+	void SendTextMsg(const char* text, int zone) override;
+	void SetLastMsgPos(const float3& pos) override {}
+	void AddNotification(const float3& pos, const float3& color, float alpha) override {}
+	bool SendResources(float mAmount, float eAmount, int receivingTeam) override { return false; }
+	int SendUnits(const std::vector<int>& unitIDs, int receivingTeam) override { return 0; }
+	bool PosInCamera(const float3& pos, float radius) override { return false; }
+
+	int GetCurrentFrame() override { return m_world->GetCurrentFrame(); }
+	int GetMySkirmishAIId() override { return m_skirmishAIId; }
+	int GetMyTeam() override { return m_team; }
+	int GetMyAllyTeam() override { return m_team; }
+	int GetPlayerTeam(int player) override { return -1; }
+	int GetTeams() override { return 2; }
+	const char* GetTeamSide(int team) override { return ""; }
+	int GetTeamAllyTeam(int team) override { return team; }
+	float GetTeamMetalCurrent(int team) override { return (team == m_team) ? GetMetal() : 0.0f; }
+	float GetTeamMetalIncome(int team) override { return (team == m_team) ? GetMetalIncome() : 0.0f; }
+	float GetTeamMetalUsage(int team) override { return (team == m_team) ? GetMetalUsage() : 0.0f; }
+	float GetTeamMetalStorage(int team) override { return (team == m_team) ? GetMetalStorage() : 0.0f; }
+	float GetTeamEnergyCurrent(int team) override { return (team == m_team) ? GetEnergy() : 0.0f; }
+	float GetTeamEnergyIncome(int team) override { return (team == m_team) ? GetEnergyIncome() : 0.0f; }
+	float GetTeamEnergyUsage(int team) override { return (team == m_team) ? GetEnergyUsage() : 0.0f; }
+	float GetTeamEnergyStorage(int team) override { return (team == m_team) ? GetEnergyStorage() : 0.0f; }
+	bool IsAllied(int firstAllyTeamId, int secondAllyTeamId) override { return (firstAllyTeamId == secondAllyTeamId); }
+
+	int CreateGroup() override { return -1; }
+	void EraseGroup(int groupId) override {}
+	bool AddUnitToGroup(int unitId, int groupId) override { return false; }
+	bool RemoveUnitFromGroup(int unitId) override { return false; }
+	int GetUnitGroup(int unitId) override { return -1; }
+	const std::vector<SCommandDescription>* GetGroupCommands(int unitId) override { return &m_noCommandDescriptions; }
+	int GiveGroupOrder(int unitId, Command* c) override { return -1; }
+	int GiveOrder(int unitId, Command* c) override;
+	const std::vector<SCommandDescription>* GetUnitCommands(int unitId) override { return &m_noCommandDescriptions; }
+	const CCommandQueue* GetCurrentUnitCommands(int unitId) override { return m_world->GetUnitCommands(unitId); }
+
+	int GetMaxUnits() override { return AAIBenchWorld::maxUnits; }
+	int GetUnitAiHint(int unitId) override { return 0; }
+	int GetUnitTeam(int unitId) override;
+	int GetUnitAllyTeam(int unitId) override { return GetUnitTeam(unitId); }
+	float GetUnitHealth(int unitId) override;
+	float GetUnitMaxHealth(int unitId) override;
+	float GetUnitSpeed(int unitId) override;
+	float GetUnitPower(int unitId) override;
+	float GetUnitExperience(int unitId) override { return 0.0f; }
+	float GetUnitMaxRange(int unitId) override;
+	bool IsUnitActivated(int unitId) override { return true; }
+	bool UnitBeingBuilt(int unitId) override;
+	const UnitDef* GetUnitDef(int unitId) override;
+	float3 GetUnitPos(int unitId) override;
+	float3 GetUnitVel(int unitId) override { return ZeroVector; }
+	int GetBuildingFacing(int unitId) override { return 0; }
+	bool IsUnitCloaked(int unitId) override { return false; }
+	bool IsUnitParalyzed(int unitId) override { return false; }
+	bool IsUnitNeutral(int unitId) override { return false; }
+	bool GetUnitResourceInfo(int unitId, UnitResourceInfo* resourceInfo) override { return false; }
+
+	const UnitDef* GetUnitDef(const char* unitName) override { return m_world->GetUnitDefByName(unitName); }
+	const UnitDef* GetUnitDefById(int unitDefId) override { return m_world->GetUnitDefById(unitDefId); }
+
+	int InitPath(float3 start, float3 end, int pathType, float goalRadius = 8) override { return 0; }
+	float3 GetNextWaypoint(int pathId) override { return float3(-1.0f, 0.0f, 0.0f); }
+	void FreePath(int pathId) override {}
+	float GetPathLength(float3 start, float3 end, int pathType, float goalRadius = 8) override { return start.distance2D(end); }
+
+	int GetEnemyUnits(int* unitIds, int unitIds_max = -1) override { return m_world->GetEnemyUnitsInLOS(unitIds, unitIds_max); }
+	int GetEnemyUnitsInRadarAndLos(int* unitIds, int unitIds_max = -1) override { return m_world->GetEnemyUnitsInLOS(unitIds, unitIds_max); }
+	int GetEnemyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) override { return m_world->GetEnemyUnitsInLOS(unitIds, unitIds_max, &pos, radius); }
+	int GetFriendlyUnits(int* unitIds, int unitIds_max = -1) override { return m_world->GetOwnUnits(unitIds, unitIds_max); }
+	int GetFriendlyUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) override { return m_world->GetOwnUnits(unitIds, unitIds_max, &pos, radius); }
+	int GetNeutralUnits(int* unitIds, int unitIds_max = -1) override { return 0; }
+	int GetNeutralUnits(int* unitIds, const float3& pos, float radius, int unitIds_max = -1) override { return 0; }
+
+	int GetMapWidth() override { return m_world->GetMapWidth(); }
+	int GetMapHeight() override { return m_world->GetMapHeight(); }
+	const float* GetHeightMap() override { return m_world->GetHeightMap(); }
+	const float* GetCornersHeightMap() override { return m_world->GetHeightMap(); }
+	float GetMinHeight() override { return -100.0f; }
+	float GetMaxHeight() override { return 500.0f; }
+	const float* GetSlopeMap() override { return nullptr; }
+	const unsigned short* GetLosMap() override { return nullptr; }
+	int GetLosMapResolution() override { return AAIBenchWorld::losMapResolution * AAIBenchWorld::losMapResolution; }
+	const unsigned short* GetRadarMap() override { return nullptr; }
+	const unsigned short* GetJammerMap() override { return nullptr; }
+	const unsigned char* GetMetalMap() override { return m_world->GetMetalMap(); }
+	int GetMapHash() override { return static_cast<int>(m_world->GetMapHash()); }
+	const char* GetMapName() override { return m_world->GetMapName(); }
+	const char* GetMapHumanName() override { return "AAI Bench Map"; }
+	int GetModHash() override { return 0x42; }
+	const char* GetModName() override { return "aaibench"; }
+	const char* GetModHumanName() override { return "aaibench"; }
+	const char* GetModShortName() override { return "aaibench"; }
+	const char* GetModVersion() override { return "1.0"; }
+
+	float GetElevation(float x, float z) override { return m_world->GetElevation(x, z); }
+	float GetMaxMetal() const override { return 2.0f; }
+	float GetExtractorRadius() const override { return 32.0f; }
+	float GetMinWind() const override { return 5.0f; }
+	float GetMaxWind() const override { return 20.0f; }
+	float GetCurWind() const override { return 12.0f; }
+	float GetTidalStrength() const override { return 15.0f; }
+	float GetGravity() const override { return 120.0f; }
+
+	void LineDrawerStartPath(const float3& pos, const float* color) override {}
+	void LineDrawerFinishPath() override {}
+	void LineDrawerDrawLine(const float3& endPos, const float* color) override {}
+	void LineDrawerDrawLineAndIcon(int cmdId, const float3& endPos, const float* color) override {}
+	void LineDrawerDrawIconAtLastPos(int cmdId) override {}
+	void LineDrawerBreak(const float3& endPos, const float* color) override {}
+	void LineDrawerRestart() override {}
+	void LineDrawerRestartSameColor() override {}
+	int CreateSplineFigure(float3 pos1, float3 pos2, float3 pos3, float3 pos4, float width, int arrow, int lifeTime, int figureGroupId) override { return 0; }
+	int CreateLineFigure(float3 pos1, float3 pos2, float width, int arrow, int lifeTime, int figureGroupId) override { return 0; }
+	void SetFigureColor(int figureGroupId, float red, float green, float blue, float alpha) override {}
+	void DeleteFigureGroup(int figureGroupId) override {}
+	void DrawUnit(const char* name, const float3& pos, float rotation, int lifeTime, int teamId, bool transparent, bool drawBorder, int facing = 0) override {}
+
+	bool IsDebugDrawerEnabled() const override { return false; }
+	void DebugDrawerAddGraphPoint(int, float, float) override {}
+	void DebugDrawerDelGraphPoints(int, int) override {}
+	void DebugDrawerSetGraphPos(float, float) override {}
+	void DebugDrawerSetGraphSize(float, float) override {}
+	void DebugDrawerSetGraphLineColor(int, const float3&) override {}
+	void DebugDrawerSetGraphLineLabel(int, const char*) override {}
+	int DebugDrawerAddOverlayTexture(const float*, int, int) override { return 0; }
+	void DebugDrawerUpdateOverlayTexture(int, const float*, int, int, int, int) override {}
+	void DebugDrawerDelOverlayTexture(int) override {}
+	void DebugDrawerSetOverlayTexturePos(int, float, float) override {}
+	void DebugDrawerSetOverlayTextureSize(int, float, float) override {}
+	void DebugDrawerSetOverlayTextureLabel(int, const char*) override {}
+
+	bool CanBuildAt(const UnitDef* unitDef, float3 pos, int facing = 0) override { return m_world->CanBuildAt(unitDef, pos); }
+	float3 ClosestBuildSite(const UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0) override { return m_world->ClosestBuildSite(unitDef, pos, searchRadius, minDist); }
+
+	bool GetProperty(int unitId, int property, void* dst) override { return false; }
+	bool GetValue(int valueId, void* dst) override;
+	int HandleCommand(int commandId, void* data) override { return 0; }
+
+	int GetFileSize(const char* name) override { return -1; }
+	bool ReadFile(const char* name, void* buffer, int bufferLen) override { return false; }
+
+	int GetSelectedUnits(int* unitIds, int unitIds_max = -1) override { return 0; }
+	float3 GetMousePos() override { return ZeroVector; }
+	int GetMapPoints(PointMarker* pm, int pm_sizeMax, bool includeAllies) override { return 0; }
+	int GetMapLines(LineMarker* lm, int lm_sizeMax, bool includeAllies) override { return 0; }
+
+	float GetMetal() override { return m_world->GetMetal(); }
+	float GetMetalIncome() override { return m_world->GetMetalIncome(); }
+	float GetMetalUsage() override { return m_world->GetMetalUsage(); }
+	float GetMetalStorage() override { return m_world->GetMetalStorage(); }
+	float GetEnergy() override { return m_world->GetEnergy(); }
+	float GetEnergyIncome() override { return m_world->GetEnergyIncome(); }
+	float GetEnergyUsage() override { return m_world->GetEnergyUsage(); }
+	float GetEnergyStorage() override { return m_world->GetEnergyStorage(); }
+
+	int GetFeatures(int* featureIds, int max) override { return 0; }
+	int GetFeatures(int* featureIds, int max, const float3& pos, float radius) override { return 0; }
+	const FeatureDef* GetFeatureDef(int featureId) override { return nullptr; }
+	const FeatureDef* GetFeatureDefById(int featureDefId) override { return nullptr; }
+	float GetFeatureHealth(int featureId) override { return 0.0f; }
+	float GetFeatureReclaimLeft(int featureId) override { return 0.0f; }
+	float3 GetFeaturePos(int featureId) override { return ZeroVector; }
+
+	int GetNumUnitDefs() override { return m_world->GetNumberOfUnitDefs(); }
+	void GetUnitDefList(const UnitDef** list) override;
+	float GetUnitDefHeight(int def) override { return 20.0f; }
+	float GetUnitDefRadius(int def) override { return 20.0f; }
+
+	const WeaponDef* GetWeapon(const char* weaponName) override { return nullptr; }
+	const WeaponDef* GetWeaponDefById(int weaponDefId) override { return nullptr; }
+
+	const float3* GetStartPos() override { return nullptr; }
+
+	unsigned int GetCategoryFlag(const char* categoryName) override { return 0; }
+	unsigned int GetCategoriesFlag(const char* categoryNames) override { return 0; }
+	void GetCategoryName(int categoryFlag, char* name, int name_sizeMax) override { if(name_sizeMax > 0) name[0] = '\0'; }
+
+	const char* CallLuaRules(const char* inData, int inSize = -1) override { return nullptr; }
+	const char* CallLuaUI(const char* inData, int inSize = -1) override { return nullptr; }
+
+	std::map<std::string, std::string> GetMyInfo() override { return std::map<std::string, std::string>(); }
+	std::map<std::string, std::string> GetMyOptionValues() override { return std::map<std::string, std::string>(); }
+
+private:
+	//! @brief Implementation of the C callback to access the LOS map
+	static int GetLosMapOfSkirmishAI(int skirmishAIId, int* losValues, int losValues_sizeMax);
+
+	//! @brief Implementation of the C callback to get AI info (e.g. the version)
+	static const char* GetInfoValueOfSkirmishAI(int skirmishAIId, const char* key);
+
+	AAIBenchWorld* m_world;
+
+	int m_skirmishAIId;
+
+	//! Team of the AI (units of the own team of the world are reported as units of this team)
+	int m_team;
+
+	//! Files are read from this directory (config files) and written to the output directory (log, learning files)
+	std::string m_dataDirectory;
+	std::string m_outputDirectory;
+
+	SSkirmishAICallback m_skirmishAICallback;
+
+	std::vector<SCommandDescription> m_noCommandDescriptions;
+
+	int m_orders;
+
+	//! The worlds accessed by the C callback functions (for every skirmish AI id)
+	static std::map<int, AAIBenchWorld*> s_worlds;
+};
+
+//! Stand-in for the global callback the engine passes to IGlobalAI::InitAI()
+class AAIBenchGlobalCallback : public IGlobalAICallback
+{
+public:
+	AAIBenchGlobalCallback(AAIBenchCallback* callback) : m_callback(callback) {}
+
+	IAICheats*   GetCheatInterface() override { return nullptr; }
+	IAICallback* GetAICallback() override { return m_callback; }
+
+private:
+	AAIBenchCallback* m_callback;
+};
+
+//! @brief Returns the path of the given file in the given directory (a separator is inserted if the directory does not end with one)
+std::string JoinPath(const std::string& directory, const std::string& filename);
+
+#endif
@@ -0,0 +1,126 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIBenchEnemyQueries.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "AAIEnemyUnitGrid.h"
+
+#include "AAIBenchCallback.h"
+#include "AAIBenchWorld.h"
+
+//! Radius of the queries (typical weapon range used for fall back positions)
+static constexpr float queryRadius = 600.0f;
+
+//! Number of units determined by the nearest neighbour queries
+static constexpr int nearestUnits = 8;
+
+void RunEnemyQueryBenchmark(AAIBenchWorld& world, AAIBenchCallback& callback, int numberOfEnemies, int numberOfQueries, unsigned int seed)
+{
+	const int spawnedEnemies = world.SpawnEnemyUnitsInLOS(numberOfEnemies);
+
+	const float xMapSize = static_cast<float>(world.GetMapWidth()  * SQUARE_SIZE);
+	const float zMapSize = static_cast<float>(world.GetMapHeight() * SQUARE_SIZE);
+
+	std::mt19937 randomNumberGenerator(seed);
+	std::uniform_real_distribution<float> randomX(0.0f, xMapSize);
+	std::uniform_real_distribution<float> randomZ(0.0f, zMapSize);
+
+	std::vector<float3> queryPositions;
+	queryPositions.reserve(numberOfQueries);
+
+	for(int i = 0; i < numberOfQueries; ++i)
+		queryPositions.push_back( float3(randomX(randomNumberGenerator), 0.0f, randomZ(randomNumberGenerator)) );
+
+	std::vector<int> unitIds(AAIBenchWorld::maxUnits);
+
+	// callback path (as formerly used by AAIExecute::GetFallBackPos()): one call to get the units in range, one call per unit to get its position
+	long long callbackCalls(0);
+	long long callbackUnits(0);
+	float3    callbackChecksum(ZeroVector);
+
+	const auto callbackStart = std::chrono::steady_clock::now();
+
+	for(const float3& position : queryPositions)
+	{
+		const int numberOfUnits = callback.GetEnemyUnits(&unitIds[0], position, queryRadius);
+		++callbackCalls;
+
+		for(int i = 0; i < numberOfUnits; ++i)
+			callbackChecksum += callback.GetUnitPos(unitIds[i]);
+
+		callbackCalls += numberOfUnits;
+		callbackUnits += numberOfUnits;
+	}
+
+	const double callbackTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - callbackStart).count();
+
+	// build grid from the data gathered by the LOS update (unit ids, positions and unit types are queried there anyway)
+	AAIEnemyUnitGrid grid(xMapSize, zMapSize, AAIConstants::enemyUnitGridCellSize);
+
+	const int numberOfVisibleUnits = callback.GetEnemyUnitsInRadarAndLos(&unitIds[0]);
+
+	std::vector<AAIEnemyUnit> visibleUnits;
+	for(int i = 0; i < numberOfVisibleUnits; ++i)
+	{
+		const UnitDef* def = callback.GetUnitDef(unitIds[i]);
+		visibleUnits.push_back( AAIEnemyUnit(UnitId(unitIds[i]), UnitDefId(def ? def->id : 0), AAITargetType(), callback.GetUnitPos(unitIds[i])) );
+	}
+
+	const auto buildStart = std::chrono::steady_clock::now();
+
+	grid.StartUpdate();
+	for(const AAIEnemyUnit& enemyUnit : visibleUnits)
+		grid.AddUnit(enemyUnit);
+	grid.FinishUpdate();
+
+	const double buildTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - buildStart).count();
+
+	// grid path
+	std::vector<const AAIEnemyUnit*> enemyUnits;
+	long long gridUnits(0);
+	float3    gridChecksum(ZeroVector);
+
+	const auto gridStart = std::chrono::steady_clock::now();
+
+	for(const float3& position : queryPositions)
+	{
+		grid.GetUnitsInRadius(position, queryRadius, true, enemyUnits);
+
+		for(const AAIEnemyUnit* enemyUnit : enemyUnits)
+			gridChecksum += enemyUnit->position;
+
+		gridUnits += static_cast<long long>(enemyUnits.size());
+	}
+
+	const double gridTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - gridStart).count();
+
+	const auto nearestStart = std::chrono::steady_clock::now();
+
+	for(const float3& position : queryPositions)
+		grid.GetNearestUnits(position, nearestUnits, true, enemyUnits);
+
+	const double nearestTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - nearestStart).count();
+
+	const double queries = static_cast<double>(std::max(numberOfQueries, 1));
+
+	std::printf("\nEnemy unit queries: %i enemy units within LOS, %i queries with radius %.0f\n", spawnedEnemies, numberOfQueries, queryRadius);
+	std::printf("%-34s %14s %14s %16s\n", "Method", "total (ms)", "avg (us)", "callback calls");
+	std::printf("%-34s %14.2f %14.3f %16lld\n", "GetEnemyUnits() + GetUnitPos()", 0.001 * callbackTime, callbackTime / queries, callbackCalls);
+	std::printf("%-34s %14.2f %14.3f %16i\n", "AAIEnemyUnitGrid radius query", 0.001 * gridTime, gridTime / queries, 0);
+	std::printf("%-34s %14.2f %14.3f %16i\n", "AAIEnemyUnitGrid nearest units", 0.001 * nearestTime, nearestTime / queries, 0);
+	std::printf("Grid rebuild: %.1f us for %i units; units found: %lld (callback) / %lld (grid), sum of x coordinates %.0f / %.0f\n", buildTime,
+	            grid.GetNumberOfUnits(), callbackUnits, gridUnits, callbackChecksum.x, gridChecksum.x);
+	std::printf("(Callback calls are direct calls into the benchmark world; in the engine every call crosses the AI interface)\n");
+}
@@ -0,0 +1,21 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_ENEMY_QUERIES_H
+#define AAI_BENCH_ENEMY_QUERIES_H
+
+class AAIBenchWorld;
+class AAIBenchCallback;
+
+//! @brief Compares local queries for enemy units (units within radius around random positions) answered via the engine callback
+//!        (GetEnemyUnits() and GetUnitPos() for every returned unit) with the ones answered by AAIEnemyUnitGrid.
+//!        Spawns the given number of enemy units within LOS and prints the results to stdout.
+void RunEnemyQueryBenchmark(AAIBenchWorld& world, AAIBenchCallback& callback, int numberOfEnemies, int numberOfQueries, unsigned int seed);
+
+#endif
@@ -0,0 +1,141 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIBenchGovernor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "aidef.h"
+#include "AAIFrameTimeGovernor.h"
+#include "AAITaskScheduler.h"
+
+#include "CUtils/SimpleProfiler.h"
+
+//! Number of frames of the windows the average time per frame is evaluated for
+static constexpr int evaluationWindow = 90;
+
+//! Factor the cost of the non-critical tasks is multiplied with during the load spike
+static constexpr int loadSpikeFactor = 8;
+
+//! Time per frame spent on the synthetic tasks in the different phases (in microseconds)
+struct GovernorBenchResult
+{
+	double averageBeforeSpike;
+	double averageDuringSpike;
+	double averageAfterSpike;
+
+	//! Highest average time per frame of the evaluation windows during the spike (after the governor had time to adapt)
+	double maxWindowDuringSpike;
+
+	float  maxCadenceFactor;
+};
+
+//! @brief Busy waits for the given time (in microseconds) to simulate a task with the given cost
+static void Work(int microseconds)
+{
+	const auto end = std::chrono::steady_clock::now() + std::chrono::microseconds(microseconds);
+
+	while(std::chrono::steady_clock::now() < end)
+	{
+	}
+}
+
+static GovernorBenchResult RunScheduler(int frames, int frameTimeBudget, bool useGovernor)
+{
+	Profiler profiler("governor-bench");
+
+	int costFactor(1);
+
+	// synthetic tasks with a total cost of about 30% of the budget per frame without load spike (15% critical, 15% non-critical);
+	// during the load spike, the non-critical tasks alone need more than the budget at their default cadence
+	AAITaskScheduler scheduler(nullptr, AAIConstants::scheduledTasksFrameBudget);
+	scheduler.AddTask("Critical-1",        [&]() { Work(frameTimeBudget / 2); },               5,  0, 10, frameTimeBudget);
+	scheduler.AddTask("Critical-2",        [&]() { Work(frameTimeBudget); },                  20,  7,  8, frameTimeBudget);
+	scheduler.AddTask("Adaptive-Scouting", [&]() { Work(costFactor * frameTimeBudget / 5); },  4,  1,  9, frameTimeBudget, true);
+	scheduler.AddTask("Adaptive-Sectors",  [&]() { Work(costFactor * frameTimeBudget / 3); },  6,  2,  5, frameTimeBudget, true);
+	scheduler.AddTask("Adaptive-Upgrades", [&]() { Work(costFactor * frameTimeBudget / 2); }, 10,  3,  2, frameTimeBudget, true);
+
+	AAIFrameTimeGovernor governor(frameTimeBudget, 1.0f, 8.0f);
+
+	const int spikeStart = frames / 3;
+	const int spikeEnd   = 2 * frames / 3;
+
+	// governor needs a few measurement windows to adapt (and stretched tasks are rescheduled after their next execution only)
+	const int settledFrame = spikeStart + std::min(10 * AAIConstants::governorMeasurementWindow, (spikeEnd - spikeStart) / 2);
+
+	std::vector<double> frameTimes;
+	frameTimes.reserve(frames);
+
+	GovernorBenchResult result{0.0, 0.0, 0.0, 0.0, 1.0f};
+	double windowTime(0.0);
+
+	for(int frame = 0; frame < frames; ++frame)
+	{
+		costFactor = ( (frame >= spikeStart) && (frame < spikeEnd) ) ? loadSpikeFactor : 1;
+
+		const auto start = std::chrono::steady_clock::now();
+		scheduler.Update(frame, &profiler, nullptr);
+		const double frameTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+		frameTimes.push_back(frameTime);
+
+		if(useGovernor && governor.AddFrameTime(static_cast<int>(frameTime)))
+		{
+			scheduler.SetCadenceFactor(governor.GetCadenceFactor());
+			result.maxCadenceFactor = std::max(result.maxCadenceFactor, governor.GetCadenceFactor());
+		}
+
+		// evaluate windows starting after the governor has settled
+		if( (frame >= settledFrame) && (frame < spikeEnd) )
+		{
+			windowTime += frameTime;
+
+			if( (frame - settledFrame) % evaluationWindow == evaluationWindow - 1)
+			{
+				result.maxWindowDuringSpike = std::max(result.maxWindowDuringSpike, windowTime / static_cast<double>(evaluationWindow));
+				windowTime = 0.0;
+			}
+		}
+	}
+
+	auto average = [&](int first, int last) {
+		double total(0.0);
+		for(int frame = first; frame < last; ++frame)
+			total += frameTimes[frame];
+		return total / static_cast<double>(std::max(last - first, 1));
+	};
+
+	result.averageBeforeSpike = average(0, spikeStart);
+	result.averageDuringSpike = average(spikeStart, spikeEnd);
+	result.averageAfterSpike  = average(spikeEnd, frames);
+
+	return result;
+}
+
+bool RunGovernorBenchmark(int frames, int frameTimeBudget)
+{
+	const GovernorBenchResult fixedCadence    = RunScheduler(frames, frameTimeBudget, false);
+	const GovernorBenchResult adaptiveCadence = RunScheduler(frames, frameTimeBudget, true);
+
+	const bool budgetRespected = (adaptiveCadence.maxWindowDuringSpike <= static_cast<double>(frameTimeBudget));
+
+	std::printf("\nFrame time governor: %i frames, budget %i us per frame, cost of non-critical tasks x%i during frames %i - %i\n",
+	            frames, frameTimeBudget, loadSpikeFactor, frames / 3, 2 * frames / 3);
+	std::printf("%-20s %16s %16s %16s %18s %12s\n", "Cadence", "before (us)", "spike (us)", "after (us)", "max window (us)", "max factor");
+	std::printf("%-20s %16.0f %16.0f %16.0f %18.0f %12.2f\n", "fixed", fixedCadence.averageBeforeSpike, fixedCadence.averageDuringSpike,
+	            fixedCadence.averageAfterSpike, fixedCadence.maxWindowDuringSpike, fixedCadence.maxCadenceFactor);
+	std::printf("%-20s %16.0f %16.0f %16.0f %18.0f %12.2f\n", "governed", adaptiveCadence.averageBeforeSpike, adaptiveCadence.averageDuringSpike,
+	            adaptiveCadence.averageAfterSpike, adaptiveCadence.maxWindowDuringSpike, adaptiveCadence.maxCadenceFactor);
+	std::printf("Budget respected with governor (windows of %i frames after adaption): %s\n", evaluationWindow, budgetRespected ? "yes" : "NO");
+
+	return budgetRespected;
+}
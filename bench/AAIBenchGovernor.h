@@ -0,0 +1,20 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_GOVERNOR_H
+#define AAI_BENCH_GOVERNOR_H
+
+//! @brief Runs a task scheduler with synthetic tasks (busy waiting; critical ones with fixed and non-critical ones with adaptive cadence)
+//!        for the given number of frames, once without and once with AAIFrameTimeGovernor. During the middle third of the frames, the
+//!        cost of the non-critical tasks is raised (load spike) such that the average time per frame exceeds the given budget (in microseconds)
+//!        unless their cadence is stretched. Prints the average time per frame per phase to stdout; returns whether the governor kept
+//!        the average time per frame within the budget after it had time to adapt.
+bool RunGovernorBenchmark(int frames, int frameTimeBudget);
+
+#endif
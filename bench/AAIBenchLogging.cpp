@@ -0,0 +1,132 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIBenchLogging.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "AAILogger.h"
+
+//! Time per frame at game speed (in microseconds)
+static constexpr int frameInterval = 33333;
+
+//! @brief Writes the message directly to file (as formerly done by AAI::Log())
+static void LogSynchronously(FILE* file, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	vfprintf(file, format, args);
+	va_end(args);
+}
+
+//! @brief Writes the message via the logger
+static void LogAsynchronously(AAILogger* logger, const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	logger->Write(ELogCategory::BUILD_TABLE, ELogLevel::VERBOSE, format, args);
+	va_end(args);
+}
+
+//! @brief Logs the given number of messages per frame with the given function, returns the sorted times per frame (in microseconds)
+template<typename LogFunction>
+static std::vector<double> MeasureFrames(int frames, int messagesPerFrame, LogFunction logFunction)
+{
+	std::vector<double> frameTimes;
+	frameTimes.reserve(frames);
+
+	auto nextFrame = std::chrono::steady_clock::now();
+
+	for(int frame = 0; frame < frames; ++frame)
+	{
+		const auto frameStart = std::chrono::steady_clock::now();
+
+		for(int message = 0; message < messagesPerFrame; ++message)
+			logFunction(frame, message);
+
+		frameTimes.push_back( std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - frameStart).count() );
+
+		nextFrame += std::chrono::microseconds(frameInterval);
+		std::this_thread::sleep_until(nextFrame);
+	}
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+	return frameTimes;
+}
+
+static void PrintFrameTimes(const char* method, const std::vector<double>& sortedFrameTimes)
+{
+	double totalTime(0.0);
+	for(const double frameTime : sortedFrameTimes)
+		totalTime += frameTime;
+
+	const size_t frames = sortedFrameTimes.size();
+
+	std::printf("%-24s %12.1f %12.1f %12.1f %12.1f\n", method, totalTime / static_cast<double>(std::max(frames, static_cast<size_t>(1))),
+	            frames ? sortedFrameTimes[frames / 2] : 0.0, frames ? sortedFrameTimes[std::min(frames * 99 / 100, frames - 1)] : 0.0,
+	            frames ? sortedFrameTimes.back() : 0.0);
+}
+
+void RunLoggingBenchmark(const std::string& directory, int frames, int messagesPerFrame)
+{
+	const std::string synchronousFilename  = directory + "/aai_bench_log_sync.txt";
+	const std::string asynchronousFilename = directory + "/aai_bench_log_async.txt";
+
+	// messages similar to the verbose messages of the build table/construction
+	const auto message = [](int frame, int message) -> const char* { return ((frame + message) % 2) ? "ARM_PEEWEE" : "CORE_AK"; };
+
+	FILE* file = fopen(synchronousFilename.c_str(), "w");
+
+	if(file == nullptr)
+	{
+		std::printf("Failed to open %s\n", synchronousFilename.c_str());
+		return;
+	}
+
+	const std::vector<double> synchronousFrameTimes = MeasureFrames(frames, messagesPerFrame, [&](int frame, int number) {
+		LogSynchronously(file, "RequestFactoryFor(%s) requested %s (frame %i, message %i, rating %f)\n", message(frame, number), "ARM_LAB", frame, number, 0.01f * number);
+	});
+
+	const auto synchronousCloseStart = std::chrono::steady_clock::now();
+	fclose(file);
+	const double synchronousCloseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - synchronousCloseStart).count();
+
+	AAILogger* logger = new AAILogger(asynchronousFilename.c_str());
+
+	if(logger->IsOpen() == false)
+	{
+		std::printf("Failed to open %s\n", asynchronousFilename.c_str());
+		delete logger;
+		return;
+	}
+
+	logger->SetLevel(ELogCategory::BUILD_TABLE, ELogLevel::VERBOSE);
+
+	const std::vector<double> asynchronousFrameTimes = MeasureFrames(frames, messagesPerFrame, [&](int frame, int number) {
+		LogAsynchronously(logger, "RequestFactoryFor(%s) requested %s (frame %i, message %i, rating %f)\n", message(frame, number), "ARM_LAB", frame, number, 0.01f * number);
+	});
+
+	const int droppedMessages = logger->GetNumberOfDroppedMessages();
+
+	const auto asynchronousCloseStart = std::chrono::steady_clock::now();
+	delete logger;
+	const double asynchronousCloseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - asynchronousCloseStart).count();
+
+	std::printf("\nLogging: %i frames at game speed, %i messages per frame, log files in %s\n", frames, messagesPerFrame, directory.c_str());
+	std::printf("%-24s %12s %12s %12s %12s\n", "Time per frame (us)", "avg", "p50", "p99", "max");
+	PrintFrameTimes("vfprintf (synchronous)", synchronousFrameTimes);
+	PrintFrameTimes("AAILogger", asynchronousFrameTimes);
+	std::printf("Closing log file: %.1f ms (synchronous) / %.1f ms (AAILogger, incl. writing remaining messages); dropped messages: %i\n",
+	            synchronousCloseTime, asynchronousCloseTime, droppedMessages);
+}
@@ -0,0 +1,21 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_LOGGING_H
+#define AAI_BENCH_LOGGING_H
+
+#include <string>
+
+//! @brief Compares the time per frame spent on logging the given number of messages per frame when writing them synchronously to file
+//!        (vfprintf, as formerly done by AAI::Log()) with the one when using AAILogger. Frames are paced at game speed (30 frames per second)
+//!        to give the writer thread realistic time to catch up. The log files are written to the given directory (which should be located
+//!        on the drive to be tested, e.g. an HDD); results are printed to stdout.
+void RunLoggingBenchmark(const std::string& directory, int frames, int messagesPerFrame);
+
+#endif
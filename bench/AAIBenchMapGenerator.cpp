@@ -0,0 +1,233 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+
+#include "AAIBenchMapGenerator.h"
+#include "AAIConfig.h"
+
+std::string BenchMapParameters::GetDescription() const
+{
+	char description[128];
+	std::snprintf(description, sizeof(description), "%ix%i water %.2f roughness %.2f plateaus %i cliffs %.2f %s", xSize, ySize, waterRatio, roughness,
+	              plateauLevels, cliffSteepness, (metalType == EBenchMetalType::SPOTS) ? "spots" : "uniform");
+	return std::string(description);
+}
+
+AAIBenchMapGenerator::AAIBenchMapGenerator(const BenchMapParameters& parameters, unsigned int seed) :
+	m_parameters(parameters),
+	m_seed(seed)
+{
+	m_parameters.xSize         = std::max(BenchMapParameters::minSize, std::min(m_parameters.xSize, BenchMapParameters::maxSize));
+	m_parameters.ySize         = std::max(BenchMapParameters::minSize, std::min(m_parameters.ySize, BenchMapParameters::maxSize));
+	m_parameters.waterRatio    = std::max(0.0f, std::min(m_parameters.waterRatio, 0.95f));
+	m_parameters.roughness     = std::max(0.0f, std::min(m_parameters.roughness, 1.0f));
+	m_parameters.cliffSteepness = std::max(0.0f, std::min(m_parameters.cliffSteepness, 1.0f));
+	m_parameters.plateauLevels = std::max(m_parameters.plateauLevels, 0);
+}
+
+float AAIBenchMapGenerator::GetLatticeValue(int x, int y, unsigned int octave) const
+{
+	// integer hash (based on the finalizer of MurmurHash3)
+	uint32_t hash = m_seed ^ (static_cast<uint32_t>(x) * 0x8da6b343u) ^ (static_cast<uint32_t>(y) * 0xd8163841u) ^ (octave * 0xcb1ab31fu);
+	hash ^= hash >> 16;
+	hash *= 0x85ebca6bu;
+	hash ^= hash >> 13;
+	hash *= 0xc2b2ae35u;
+	hash ^= hash >> 16;
+
+	return static_cast<float>(hash & 0xffffffu) / static_cast<float>(0xffffffu);
+}
+
+float AAIBenchMapGenerator::GetValueNoise(float x, float y, unsigned int octave) const
+{
+	const int   x0 = static_cast<int>(std::floor(x));
+	const int   y0 = static_cast<int>(std::floor(y));
+	const float dx = x - static_cast<float>(x0);
+	const float dy = y - static_cast<float>(y0);
+
+	// smoothstep to avoid visible lattice artifacts
+	const float sx = dx * dx * (3.0f - 2.0f * dx);
+	const float sy = dy * dy * (3.0f - 2.0f * dy);
+
+	const float v00 = GetLatticeValue(x0,   y0,   octave);
+	const float v10 = GetLatticeValue(x0+1, y0,   octave);
+	const float v01 = GetLatticeValue(x0,   y0+1, octave);
+	const float v11 = GetLatticeValue(x0+1, y0+1, octave);
+
+	const float v0 = v00 + sx * (v10 - v00);
+	const float v1 = v01 + sx * (v11 - v01);
+	return v0 + sy * (v1 - v0);
+}
+
+float AAIBenchMapGenerator::GetFractalNoise(float x, float y) const
+{
+	// size of the largest features in map tiles (independent of map size, i.e. larger maps feature more hills/valleys)
+	const float baseWavelength = 384.0f;
+	const int   octaves        = 6;
+	const float persistence    = 0.3f + 0.4f * m_parameters.roughness;
+
+	float noise(0.0f), amplitude(1.0f), totalAmplitude(0.0f), frequency(1.0f / baseWavelength);
+
+	for(int octave = 0; octave < octaves; ++octave)
+	{
+		noise          += amplitude * GetValueNoise(x * frequency, y * frequency, static_cast<unsigned int>(octave));
+		totalAmplitude += amplitude;
+		amplitude      *= persistence;
+		frequency      *= 2.0f;
+	}
+
+	return noise / totalAmplitude;
+}
+
+float AAIBenchMapGenerator::ApplyPlateaus(float height) const
+{
+	if(m_parameters.plateauLevels <= 0)
+		return height;
+
+	const float levels = static_cast<float>(m_parameters.plateauLevels);
+	const float scaled = std::min(height, 0.9999f) * levels;
+	const float level  = std::floor(scaled);
+	const float fraction = scaled - level;
+
+	// flat plateau for the first part of each level, slope to the next level in the remaining part
+	const float steepness = m_parameters.cliffSteepness;
+	float slope(0.0f);
+
+	if(steepness < 1.0f)
+		slope = std::max(0.0f, std::min((fraction - steepness) / (1.0f - steepness), 1.0f));
+
+	return (level + slope) / levels;
+}
+
+void AAIBenchMapGenerator::GenerateHeightMap(std::vector<float>& heightMap) const
+{
+	const int xTiles = m_parameters.GetXTiles();
+	const int yTiles = m_parameters.GetYTiles();
+
+	heightMap.resize(xTiles * yTiles);
+
+	for(int y = 0; y < yTiles; ++y)
+	{
+		for(int x = 0; x < xTiles; ++x)
+			heightMap[x + y * xTiles] = GetFractalNoise(static_cast<float>(x), static_cast<float>(y));
+	}
+
+	// normalize to [0,1]
+	const auto  minMax    = std::minmax_element(heightMap.begin(), heightMap.end());
+	const float minHeight = *minMax.first;
+	const float range     = std::max(*minMax.second - minHeight, 0.0001f);
+
+	for(auto& height : heightMap)
+		height = (height - minHeight) / range;
+
+	// determine water level so that the requested ratio of tiles lies below it
+	float waterLevel(0.0f);
+
+	if(m_parameters.waterRatio > 0.0f)
+	{
+		std::vector<float> sortedHeights(heightMap);
+		const size_t waterLevelIndex = std::min(static_cast<size_t>(m_parameters.waterRatio * static_cast<float>(sortedHeights.size())), sortedHeights.size() - 1);
+		std::nth_element(sortedHeights.begin(), sortedHeights.begin() + waterLevelIndex, sortedHeights.end());
+		waterLevel = sortedHeights[waterLevelIndex];
+	}
+
+	// land is scaled to [0, maxHeight] (terraced if requested), water to [-maxDepth, 0)
+	const float maxDepth = 0.25f * m_parameters.maxHeight;
+
+	for(auto& height : heightMap)
+	{
+		if(height < waterLevel)
+			height = - 1.0f - maxDepth * (waterLevel - height) / waterLevel;
+		else
+			height = m_parameters.maxHeight * ApplyPlateaus( (height - waterLevel) / std::max(1.0f - waterLevel, 0.0001f) );
+	}
+}
+
+void AAIBenchMapGenerator::GenerateMetalMap(const std::vector<float>& heightMap, std::vector<unsigned char>& metalMap) const
+{
+	const int xTiles = m_parameters.GetXTiles();
+	const int xMetalMapSize = xTiles / 2;
+	const int yMetalMapSize = m_parameters.GetYTiles() / 2;
+
+	metalMap.assign(xMetalMapSize * yMetalMapSize, 0);
+
+	if(m_parameters.metalType == EBenchMetalType::UNIFORM)
+	{
+		// low amount of metal everywhere with slight variations
+		for(int y = 0; y < yMetalMapSize; ++y)
+		{
+			for(int x = 0; x < xMetalMapSize; ++x)
+				metalMap[x + y * xMetalMapSize] = static_cast<unsigned char>(40.0f + 20.0f * GetLatticeValue(x, y, 100u));
+		}
+		return;
+	}
+
+	// use separate random number generator to keep metal spots independent of heightmap parameters
+	std::mt19937 randomNumberGenerator(m_seed ^ 0x5bd1e995u);
+
+	const int margin = 4;
+	std::uniform_int_distribution<int> randomX(margin, xMetalMapSize - margin - 1);
+	std::uniform_int_distribution<int> randomY(margin, yMetalMapSize - margin - 1);
+	std::uniform_int_distribution<int> randomOffset(-6, 6);
+
+	// same criterion as AAIMap::AnalyseMap() (config is created here as the map is generated before AAI is initialized)
+	AAIConfig::Init();
+	const float maxSlope = AAIConfig::GetConfig()->CLIFF_SLOPE;
+
+	auto isSuitable = [&](int xSpot, int ySpot) -> bool
+	{
+		if( (xSpot < margin) || (xSpot >= xMetalMapSize - margin) || (ySpot < margin) || (ySpot >= yMetalMapSize - margin) )
+			return false;
+
+		const int   tile   = 2 * xSpot + 2 * ySpot * xTiles;
+		const float height = heightMap[tile];
+
+		return    (std::fabs(height - heightMap[tile + 4])          / 64.0f < maxSlope)
+		       && (std::fabs(height - heightMap[tile + 4 * xTiles]) / 64.0f < maxSlope);
+	};
+
+	const int spotsPerCluster = std::max(m_parameters.spotsPerCluster, 1);
+	int placedSpots(0);
+
+	while(placedSpots < m_parameters.metalSpots)
+	{
+		const int xCluster = randomX(randomNumberGenerator);
+		const int yCluster = randomY(randomNumberGenerator);
+
+		for(int spot = 0; (spot < spotsPerCluster) && (placedSpots < m_parameters.metalSpots); ++spot)
+		{
+			// try to find a suitable spot close to the center of the cluster
+			for(int attempt = 0; attempt < 10; ++attempt)
+			{
+				const int xSpot = xCluster + randomOffset(randomNumberGenerator);
+				const int ySpot = yCluster + randomOffset(randomNumberGenerator);
+
+				if(isSuitable(xSpot, ySpot) || (attempt == 9))
+				{
+					const int xStart = std::max(xSpot - 1, 0), xEnd = std::min(xSpot + 1, xMetalMapSize - 1);
+					const int yStart = std::max(ySpot - 1, 0), yEnd = std::min(ySpot + 1, yMetalMapSize - 1);
+
+					for(int y = yStart; y <= yEnd; ++y)
+					{
+						for(int x = xStart; x <= xEnd; ++x)
+							metalMap[x + y * xMetalMapSize] = 255;
+					}
+					break;
+				}
+			}
+
+			++placedSpots;
+		}
+	}
+}
@@ -0,0 +1,100 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_MAP_GENERATOR_H
+#define AAI_BENCH_MAP_GENERATOR_H
+
+#include <string>
+#include <vector>
+
+//! How metal is distributed on the map
+enum class EBenchMetalType : int
+{
+	SPOTS,    //!< Metal spots placed in clusters (typical map)
+	UNIFORM   //!< Low amount of metal everywhere ("metal map")
+};
+
+//! Parameters of a procedurally generated map
+struct BenchMapParameters
+{
+	//! Size of the map in Spring map units (1 map unit = 64 map tiles = 512 unit coordinates), supported range 8 - 64
+	int   xSize = 8;
+	int   ySize = 8;
+
+	//! Ratio of the map covered by water (0 = no water)
+	float waterRatio = 0.1f;
+
+	//! Roughness of the fractal heightmap (0 = smooth large scale hills, 1 = rugged terrain)
+	float roughness = 0.5f;
+
+	//! Maximum height difference of the terrain
+	float maxHeight = 400.0f;
+
+	//! Number of height levels the land is terraced into (0 = no plateaus)
+	int   plateauLevels = 0;
+
+	//! Steepness of the slopes between plateaus (0 = smooth ramps, 1 = vertical cliffs); only used if plateauLevels > 0
+	float cliffSteepness = 0.8f;
+
+	//! Distribution of metal
+	EBenchMetalType metalType = EBenchMetalType::SPOTS;
+
+	//! Number of metal spots (only used for EBenchMetalType::SPOTS)
+	int   metalSpots = 40;
+
+	//! Number of metal spots per cluster (only used for EBenchMetalType::SPOTS)
+	int   spotsPerCluster = 3;
+
+	//! @brief Returns the number of map tiles in x/y-direction
+	int GetXTiles() const { return xSize * tilesPerMapUnit; }
+	int GetYTiles() const { return ySize * tilesPerMapUnit; }
+
+	//! @brief Returns a short description (e.g. "16x16 water 0.10 plateaus 3 spots") used to label benchmark results
+	std::string GetDescription() const;
+
+	//! Number of map tiles per Spring map unit
+	static constexpr int tilesPerMapUnit = 64;
+
+	//! Supported range of map sizes (in Spring map units)
+	static constexpr int minSize =  8;
+	static constexpr int maxSize = 64;
+};
+
+//! @brief Deterministic procedural generator of height- and metal maps (same parameters and seed always result in the same map)
+//!        in the format the engine provides to the AI: heightmap with one value per map tile, metal map with half the resolution.
+class AAIBenchMapGenerator
+{
+public:
+	AAIBenchMapGenerator(const BenchMapParameters& parameters, unsigned int seed);
+
+	//! @brief Generates the heightmap (xTiles * yTiles values, water below 0)
+	void GenerateHeightMap(std::vector<float>& heightMap) const;
+
+	//! @brief Generates the metal map (xTiles/2 * yTiles/2 values); the heightmap is used to avoid placing metal spots on cliffs
+	void GenerateMetalMap(const std::vector<float>& heightMap, std::vector<unsigned char>& metalMap) const;
+
+private:
+	//! @brief Returns fractal noise (sum of several octaves of value noise) in the range [0,1] for the given tile
+	float GetFractalNoise(float x, float y) const;
+
+	//! @brief Returns smoothly interpolated value noise in the range [0,1] for the given position and octave
+	float GetValueNoise(float x, float y, unsigned int octave) const;
+
+	//! @brief Returns a pseudo random value in [0,1] for the given lattice point (independent of the order of evaluation)
+	float GetLatticeValue(int x, int y, unsigned int octave) const;
+
+	//! @brief Returns the height after applying the terraces to the given (normalized) height
+	float ApplyPlateaus(float height) const;
+
+	BenchMapParameters m_parameters;
+
+	unsigned int m_seed;
+};
+
+#endif
@@ -0,0 +1,34 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIBenchMemory.h"
+
+#include <cstdio>
+
+#include "AAI.h"
+#include "AAIMemoryUsage.h"
+
+bool CheckMemoryUsage(const AAI* ai, int maxInstanceMemory)
+{
+	AAIMemoryReport report;
+	ai->DetermineMemoryUsage(report);
+
+	std::printf("\n%-30s %14s\n", "Subsystem", "memory (kB)");
+
+	for(const auto& entry : report.GetEntries())
+		std::printf("%-30s %14.1f\n", entry.subsystem, static_cast<double>(entry.bytes) / 1024.0);
+
+	const double instanceMemory = static_cast<double>(report.GetTotalMemory(false)) / 1024.0;
+	const bool   passed         = (instanceMemory <= static_cast<double>(maxInstanceMemory));
+
+	std::printf("Memory used by AAI instance: %.1f kB (limit %i kB) - %s; shared by all instances: %.1f kB\n", instanceMemory, maxInstanceMemory,
+	            passed ? "passed" : "FAILED", static_cast<double>(report.GetTotalMemory(true)) / 1024.0);
+
+	return passed;
+}
@@ -0,0 +1,19 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_MEMORY_H
+#define AAI_BENCH_MEMORY_H
+
+class AAI;
+
+//! @brief Prints the memory used by the subsystems of the given AAI instance (see AAI::DetermineMemoryUsage()) to stdout; returns whether
+//!        the memory used by the instance (i.e. without the data shared by all AAI instances) does not exceed the given limit (in kB).
+bool CheckMemoryUsage(const AAI* ai, int maxInstanceMemory);
+
+#endif
@@ -0,0 +1,117 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIBenchSectors.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#include "AAI.h"
+#include "AAIMap.h"
+
+//! Scouting data of all sectors and the data derived from it
+struct SectorScoutingData
+{
+	std::vector<int>   enemyBuildings;
+	std::vector<float> enemyCombatUnits;
+	std::vector<float> enemyCombatPower;
+	int                enemyBuildingsOnLand;
+	int                enemyBuildingsOnSea;
+	MapPos             centerOfEnemyBase;
+};
+
+static SectorScoutingData GetSectorScoutingData(AAIMap* map)
+{
+	SectorScoutingData data;
+
+	for(int y = 0; y < AAIMap::ySectors; ++y)
+	{
+		for(int x = 0; x < AAIMap::xSectors; ++x)
+		{
+			const AAISector& sector = map->m_sector[x][y];
+
+			data.enemyBuildings.push_back(sector.GetNumberOfEnemyBuildings());
+			data.enemyCombatUnits.push_back(sector.GetNumberOfEnemyCombatUnits(ETargetType::STATIC));
+
+			for(const auto& targetType : AAITargetType::m_mobileTargetTypes)
+			{
+				data.enemyCombatUnits.push_back(sector.GetNumberOfEnemyCombatUnits(targetType));
+				data.enemyCombatPower.push_back(sector.GetEnemyCombatPower(targetType));
+			}
+		}
+	}
+
+	map->DetermineSpottedEnemyBuildingsOnContinentType(data.enemyBuildingsOnLand, data.enemyBuildingsOnSea);
+
+	map->UpdateSectors();
+	data.centerOfEnemyBase = map->GetCenterOfEnemyBase();
+
+	return data;
+}
+
+template<typename T>
+static int CountDifferences(const std::vector<T>& lhs, const std::vector<T>& rhs)
+{
+	int differences(0);
+
+	for(size_t i = 0; i < lhs.size(); ++i)
+	{
+		if(lhs[i] != rhs[i])
+			++differences;
+	}
+
+	return differences;
+}
+
+bool CheckSectorSliceUpdate(AAI* ai)
+{
+	AAIMap* map = ai->Map();
+
+	if(map == nullptr)
+	{
+		std::printf("\nSector update check: AAI has not been initialized\n");
+		return false;
+	}
+
+	// complete a pass of the sliced update (all calls in the same frame, i.e. decrease of weight of mobile units does not differ)
+	const auto sliceStart = std::chrono::steady_clock::now();
+
+	for(int slice = 0; slice < AAIConstants::sectorUpdateSlices; ++slice)
+		map->UpdateSectorSlice();
+
+	const double sliceTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sliceStart).count();
+
+	const SectorScoutingData slicedData = GetSectorScoutingData(map);
+
+	const auto fullStart = std::chrono::steady_clock::now();
+	map->UpdateEnemyScoutingData();
+	const double fullTime = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - fullStart).count();
+
+	const SectorScoutingData fullData = GetSectorScoutingData(map);
+
+	const int buildingDifferences    = CountDifferences(slicedData.enemyBuildings,   fullData.enemyBuildings);
+	const int combatUnitDifferences  = CountDifferences(slicedData.enemyCombatUnits, fullData.enemyCombatUnits);
+	const int combatPowerDifferences = CountDifferences(slicedData.enemyCombatPower, fullData.enemyCombatPower);
+
+	const bool continentsEqual = (slicedData.enemyBuildingsOnLand == fullData.enemyBuildingsOnLand) && (slicedData.enemyBuildingsOnSea == fullData.enemyBuildingsOnSea);
+	const bool centerEqual     = (slicedData.centerOfEnemyBase.x == fullData.centerOfEnemyBase.x) && (slicedData.centerOfEnemyBase.y == fullData.centerOfEnemyBase.y);
+
+	const bool identical = (buildingDifferences == 0) && (combatUnitDifferences == 0) && (combatPowerDifferences == 0) && continentsEqual && centerEqual;
+
+	std::printf("\nSector update check: %i sectors, %i enemy buildings on land / %i on sea\n", AAIMap::xSectors * AAIMap::ySectors,
+	            fullData.enemyBuildingsOnLand, fullData.enemyBuildingsOnSea);
+	std::printf("Time for all sectors: %.1f us (%i slices, sectors without changes skipped) vs. %.1f us (all sectors at once)\n",
+	            sliceTime, AAIConstants::sectorUpdateSlices, fullTime);
+	std::printf("Differing values - enemy buildings: %i, enemy combat units: %i, enemy combat power: %i, buildings per continent type: %s, center of enemy base: %s\n",
+	            buildingDifferences, combatUnitDifferences, combatPowerDifferences, continentsEqual ? "no" : "yes", centerEqual ? "no" : "yes");
+	std::printf("Sliced update equivalent to update of all sectors: %s\n", identical ? "yes" : "NO");
+
+	return identical;
+}
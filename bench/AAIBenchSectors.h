@@ -0,0 +1,20 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_SECTORS_H
+#define AAI_BENCH_SECTORS_H
+
+class AAI;
+
+//! @brief Completes a round-robin pass of the sliced update of the scouting data of the sectors (AAIMap::UpdateSectorSlice()) and compares
+//!        the resulting sector data with the one obtained by updating all sectors at once (AAIMap::UpdateEnemyScoutingData()) in the same frame.
+//!        Prints the result (and the time needed by both variants) to stdout; returns whether the data of all sectors is identical.
+bool CheckSectorSliceUpdate(AAI* ai);
+
+#endif
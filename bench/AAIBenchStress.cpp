@@ -0,0 +1,156 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIBenchStress.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "AAI.h"
+
+#include "AAIBenchCallback.h"
+#include "AAIBenchWorld.h"
+
+//! An AAI instance playing in its own world
+struct StressInstance
+{
+	std::unique_ptr<AAIBenchWorld>          world;
+	std::unique_ptr<AAIBenchCallback>       callback;
+	std::unique_ptr<AAIBenchGlobalCallback> globalCallback;
+
+	//! Whether the instance has been initialized successfully (set by the thread playing the game)
+	bool initialized = false;
+};
+
+//! @brief Forwards the given event of the world to AAI
+static void DispatchEvent(AAI* ai, const BenchEvent& event)
+{
+	switch(event.type)
+	{
+		case EBenchEvent::UNIT_CREATED:
+			ai->UnitCreated(event.unit, event.otherUnit);
+			break;
+		case EBenchEvent::UNIT_FINISHED:
+			ai->UnitFinished(event.unit);
+			break;
+		case EBenchEvent::UNIT_IDLE:
+			ai->UnitIdle(event.unit);
+			break;
+		case EBenchEvent::UNIT_DAMAGED:
+			ai->UnitDamaged(event.unit, event.otherUnit, event.damage, ZeroVector);
+			break;
+		case EBenchEvent::UNIT_DESTROYED:
+			ai->UnitDestroyed(event.unit, event.otherUnit);
+			break;
+		case EBenchEvent::ENEMY_ENTER_LOS:
+			ai->EnemyEnterLOS(event.unit);
+			break;
+		case EBenchEvent::ENEMY_LEAVE_LOS:
+			ai->EnemyLeaveLOS(event.unit);
+			break;
+		case EBenchEvent::ENEMY_DESTROYED:
+			ai->EnemyDestroyed(event.unit, event.otherUnit);
+			break;
+	}
+}
+
+//! @brief Plays the game of the given instance; the game starts after all instances have been initialized so that their updates overlap
+static void PlayGame(StressInstance& instance, int frames, std::atomic<int>& initializedInstances, int numberOfInstances)
+{
+	AAIBenchCallback* callback = instance.callback.get();
+	AAI* ai = new AAI(callback->GetMySkirmishAIId(), callback->GetSkirmishAICallback());
+
+	ai->InitAI(instance.globalCallback.get(), callback->GetMyTeam());
+	instance.initialized = (ai->GetTaskScheduler() != nullptr);
+
+	++initializedInstances;
+
+	while(initializedInstances.load() < numberOfInstances)
+		std::this_thread::yield();
+
+	const int startUnit = instance.world->SpawnStartUnit();
+
+	if(instance.initialized && (startUnit > 0) )
+	{
+		ai->UnitCreated(startUnit, -1);
+		ai->UnitFinished(startUnit);
+
+		std::vector<BenchEvent> events;
+
+		for(int frame = 0; frame < frames; ++frame)
+		{
+			events.clear();
+			instance.world->Update(events);
+
+			for(const BenchEvent& event : events)
+				DispatchEvent(ai, event);
+
+			ai->Update();
+		}
+	}
+
+	// instances are shut down while other ones may still be running (the first one saves the learning data)
+	delete ai;
+}
+
+bool RunSharedDataStressTest(const BenchScenario& scenario, const std::string& dataDirectory, const std::string& outputDirectory, int instances, int frames)
+{
+	// all worlds and callbacks are created before the games start, as the callbacks register their world for the C callback
+	// functions (which are shared by all callbacks)
+	std::vector<StressInstance> stressInstances(instances);
+
+	for(int i = 0; i < instances; ++i)
+	{
+		StressInstance& instance = stressInstances[i];
+		instance.world.reset(new AAIBenchWorld(scenario));
+
+		if(instance.world->LoadUnitDefs(scenario.unitDefsFile) == false)
+		{
+			std::printf("Failed to load unit definitions from %s\n", scenario.unitDefsFile.c_str());
+			return false;
+		}
+
+		instance.world->GenerateMap();
+		instance.callback.reset(new AAIBenchCallback(instance.world.get(), dataDirectory, outputDirectory, i));
+		instance.globalCallback.reset(new AAIBenchGlobalCallback(instance.callback.get()));
+	}
+
+	std::atomic<int> initializedInstances(0);
+	std::vector<std::thread> threads;
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for(auto& instance : stressInstances)
+		threads.emplace_back(PlayGame, std::ref(instance), frames, std::ref(initializedInstances), instances);
+
+	for(auto& thread : threads)
+		thread.join();
+
+	const double totalTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	std::printf("\nShared data stress test: %i AAI instances on separate threads, %i frames, map %s (total time %.1f ms)\n",
+	            instances, frames, scenario.map.GetDescription().c_str(), totalTime);
+	std::printf("%-10s %-6s %-12s %10s %10s\n", "Instance", "Team", "Initialized", "Orders", "Units");
+
+	bool allInitialized(true);
+
+	for(auto& instance : stressInstances)
+	{
+		std::printf("%-10i %-6i %-12s %10i %10i\n", instance.callback->GetMySkirmishAIId(), instance.callback->GetMyTeam(),
+		            instance.initialized ? "yes" : "no", instance.callback->GetNumberOfOrders(), instance.world->GetNumberOfUnits(AAIBenchWorld::ownTeam));
+
+		allInitialized = allInitialized && instance.initialized;
+	}
+
+	return allInitialized;
+}
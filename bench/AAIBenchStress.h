@@ -0,0 +1,23 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_STRESS_H
+#define AAI_BENCH_STRESS_H
+
+#include <string>
+
+struct BenchScenario;
+
+//! @brief Plays the given scenario with several AAI instances at the same time, each one on its own thread and in its own copy of the
+//!        synthetic world. The instances share the static data of AAI (build tree, map data, learning data), i.e. a build with
+//!        -fsanitize=thread (see AAI_SANITIZER in CMakeLists.txt) reports data races on it. Prints the orders given by every instance
+//!        and the total time to stdout; returns whether all instances have been initialized successfully.
+bool RunSharedDataStressTest(const BenchScenario& scenario, const std::string& dataDirectory, const std::string& outputDirectory, int instances, int frames);
+
+#endif
@@ -0,0 +1,875 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#include "AAIBenchWorld.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+//! Map tiles are 8x8 units in size
+static constexpr int squareSize = 8;
+
+//! Frames per second of the simulation
+static constexpr int framesPerSecond = 30;
+
+//! Number of frames between two updates of combat/line of sight
+static constexpr int combatUpdateInterval = 15;
+static constexpr int losUpdateInterval    = 8;
+
+//! Frames a unit needs to execute a command that is not a move or build order
+static constexpr int otherCommandDuration = 90;
+
+//! Maximum distance between builder and construction site
+static constexpr float buildDistance = 128.0f;
+
+AAIBenchWorld::AAIBenchWorld(const BenchScenario& scenario) :
+	m_scenario(scenario),
+	m_xMapSize(0),
+	m_yMapSize(0),
+	m_mapHash(0),
+	m_nextUnitId(1),
+	m_frame(0),
+	m_ownStartPos(ZeroVector),
+	m_enemyStartPos(ZeroVector),
+	m_enemyWaves(0),
+	m_metal(1000.0f),
+	m_metalIncome(0.0f),
+	m_metalUsage(0.0f),
+	m_metalStorage(1000.0f),
+	m_energy(1000.0f),
+	m_energyIncome(0.0f),
+	m_energyUsage(0.0f),
+	m_energyStorage(1000.0f),
+	m_metalSpent(0.0f),
+	m_energySpent(0.0f),
+	m_randomNumberGenerator(scenario.seed)
+{
+	BenchMapParameters& map = m_scenario.map;
+	map.xSize = std::max(BenchMapParameters::minSize, std::min(map.xSize, BenchMapParameters::maxSize));
+	map.ySize = std::max(BenchMapParameters::minSize, std::min(map.ySize, BenchMapParameters::maxSize));
+
+	m_xMapSize = map.GetXTiles();
+	m_yMapSize = map.GetYTiles();
+}
+
+AAIBenchWorld::~AAIBenchWorld()
+{
+}
+
+bool AAIBenchWorld::LoadUnitDefs(const std::string& filename)
+{
+	std::ifstream file(filename);
+
+	if(file.is_open() == false)
+		return false;
+
+	// build options are resolved after all unit types have been read
+	std::vector<std::string> buildOptionsOfUnitType;
+
+	std::string line;
+	while(std::getline(file, line))
+	{
+		std::istringstream tokens(line);
+		std::string name;
+
+		if( !(tokens >> name) || (name[0] == '#') )
+			continue;
+
+		m_unitDefs.emplace_back(new UnitDef());
+		UnitDef* def = m_unitDefs.back().get();
+
+		def->id        = static_cast<int>(m_unitDefs.size());
+		def->name      = name;
+		def->humanName = name;
+		def->metalCost = 0.0f; def->energyCost = 0.0f; def->buildTime = 100.0f; def->health = 100.0f;
+		def->speed = 0.0f; def->buildSpeed = 0.0f; def->xsize = 2; def->zsize = 2; def->category = 0;
+		def->losRadius = 0.0f; def->airLosRadius = 0.0f; def->radarRadius = 0.0f; def->sonarRadius = 0.0f; def->seismicRadius = 0.0f;
+		def->jammerRadius = 0.0f; def->sonarJamRadius = 0.0f;
+		def->energyMake = 0.0f; def->metalMake = 0.0f; def->makesMetal = 0.0f; def->extractsMetal = 0.0f;
+		def->energyUpkeep = 0.0f; def->metalUpkeep = 0.0f; def->energyStorage = 0.0f; def->metalStorage = 0.0f;
+		def->windGenerator = 0.0f; def->tidalGenerator = 0.0f; def->minWaterDepth = -10e6f; def->maxWaterDepth = 10e6f;
+		def->canfly = false; def->canAssist = false; def->canResurrect = false; def->floater = false; def->needGeo = false;
+		def->isAirBase = false; def->stockpile = false; def->canCloak = false; def->isCommander = false;
+		def->highTrajectoryType = 0;
+		def->movedata = nullptr;
+
+		float weaponDamage(0.0f);
+		std::string buildOptions;
+		std::string keyValue;
+
+		while(tokens >> keyValue)
+		{
+			const size_t separator = keyValue.find('=');
+			const std::string key   = keyValue.substr(0, separator);
+			const std::string value = (separator != std::string::npos) ? keyValue.substr(separator+1) : std::string();
+			const float number = static_cast<float>(std::atof(value.c_str()));
+
+			if(key == "human")
+			{
+				def->humanName = value;
+				std::replace(def->humanName.begin(), def->humanName.end(), '_', ' ');
+			}
+			else if(key == "metal")        def->metalCost     = number;
+			else if(key == "energy")       def->energyCost    = number;
+			else if(key == "buildtime")    def->buildTime     = number;
+			else if(key == "health")       def->health        = number;
+			else if(key == "speed")        def->speed         = number;
+			else if(key == "buildspeed")   def->buildSpeed    = number;
+			else if(key == "los")          def->losRadius     = number;
+			else if(key == "radar")        def->radarRadius   = number;
+			else if(key == "sonar")        def->sonarRadius   = number;
+			else if(key == "jammer")       def->jammerRadius  = number;
+			else if(key == "energymake")   def->energyMake    = number;
+			else if(key == "metalmake")    def->metalMake     = number;
+			else if(key == "extractor")    def->extractsMetal = number;
+			else if(key == "energyupkeep") def->energyUpkeep  = number;
+			else if(key == "energystorage") def->energyStorage = number;
+			else if(key == "metalstorage") def->metalStorage  = number;
+			else if(key == "wind")         def->windGenerator = number;
+			else if(key == "tidal")        def->tidalGenerator = number;
+			else if(key == "water")        def->minWaterDepth = number;
+			else if(key == "fly")          def->canfly        = true;
+			else if(key == "floater")      def->floater       = true;
+			else if(key == "assist")       def->canAssist     = true;
+			else if(key == "commander")    def->isCommander   = true;
+			else if(key == "builds")       buildOptions       = value;
+			else if(key == "size")
+			{
+				std::sscanf(value.c_str(), "%i,%i", &def->xsize, &def->zsize);
+			}
+			else if(key == "move")
+			{
+				m_moveData.emplace_back(new MoveData());
+				MoveData* moveData = m_moveData.back().get();
+				moveData->moveFamily = (value == "kbot") ? MoveData::KBot : (value == "hover") ? MoveData::Hover : (value == "ship") ? MoveData::Ship : MoveData::Tank;
+				moveData->depth      = (value == "ship") ? 10e6f : 20.0f;
+				moveData->subMarine  = false;
+				def->movedata = moveData;
+
+				if(value == "ship")
+					def->minWaterDepth = 10.0f;
+			}
+			else if(key == "weapon")
+			{
+				// range,damage
+				float range(0.0f);
+				std::sscanf(value.c_str(), "%f,%f", &range, &weaponDamage);
+
+				m_weaponDefs.emplace_back(new WeaponDef());
+				WeaponDef* weaponDef = m_weaponDefs.back().get();
+				weaponDef->name         = name + "_weapon";
+				weaponDef->range        = range;
+				weaponDef->damages      = decltype(weaponDef->damages)(weaponDamage);
+				weaponDef->stockpile    = false;
+				weaponDef->noAutoTarget = false;
+				weaponDef->isShield     = false;
+				weaponDef->waterweapon  = false;
+
+				UnitDef::UnitDefWeapon weapon;
+				weapon.name = weaponDef->name;
+				weapon.def  = weaponDef;
+				def->weapons.push_back(weapon);
+			}
+		}
+
+		// same definition of power as used by the engine
+		def->power = def->metalCost + def->energyCost / 60.0f;
+
+		buildOptionsOfUnitType.push_back(buildOptions);
+		m_damageOfUnitType.resize(def->id + 1, 0.0f);
+		m_damageOfUnitType[def->id] = weaponDamage;
+	}
+
+	// resolve build options
+	for(size_t unitDefIndex = 0; unitDefIndex < m_unitDefs.size(); ++unitDefIndex)
+	{
+		std::istringstream buildOptions(buildOptionsOfUnitType[unitDefIndex]);
+		std::string buildOption;
+		int buildOptionIndex(0);
+
+		while(std::getline(buildOptions, buildOption, ','))
+		{
+			if(GetUnitDefByName(buildOption.c_str()) != nullptr)
+				m_unitDefs[unitDefIndex]->buildOptions[buildOptionIndex++] = buildOption;
+			else
+				std::printf("Warning: unknown build option %s of %s\n", buildOption.c_str(), m_unitDefs[unitDefIndex]->name.c_str());
+		}
+	}
+
+	return (m_unitDefs.empty() == false);
+}
+
+void AAIBenchWorld::GenerateMap()
+{
+	const int xSize = m_xMapSize;
+	const int ySize = m_yMapSize;
+
+	// FNV-1a hash of map parameters and seed
+	const std::string mapDescription = m_scenario.map.GetDescription() + " seed " + std::to_string(m_scenario.seed);
+	m_mapHash = 2166136261u;
+	for(const char c : mapDescription)
+		m_mapHash = (m_mapHash ^ static_cast<unsigned char>(c)) * 16777619u;
+
+	char mapName[64];
+	std::snprintf(mapName, sizeof(mapName), "AAIBenchMap-%08x.smf", m_mapHash);
+	m_mapName = mapName;
+
+	const AAIBenchMapGenerator mapGenerator(m_scenario.map, m_scenario.seed);
+	mapGenerator.GenerateHeightMap(m_heightMap);
+	mapGenerator.GenerateMetalMap(m_heightMap, m_metalMap);
+
+	m_losMap.assign( (xSize/losMapResolution) * (ySize/losMapResolution), 0);
+
+	m_ownStartPos   = float3(0.2f * xSize * squareSize, 0.0f, 0.2f * ySize * squareSize);
+	m_enemyStartPos = float3(0.8f * xSize * squareSize, 0.0f, 0.8f * ySize * squareSize);
+
+	m_ownStartPos.y   = GetElevation(m_ownStartPos.x, m_ownStartPos.z);
+	m_enemyStartPos.y = GetElevation(m_enemyStartPos.x, m_enemyStartPos.z);
+}
+
+int AAIBenchWorld::SpawnStartUnit()
+{
+	for(const auto& def : m_unitDefs)
+	{
+		if(def->isCommander)
+			return CreateUnit(def.get(), ownTeam, m_ownStartPos, -1);
+	}
+
+	return -1;
+}
+
+int AAIBenchWorld::SpawnEnemyUnitsInLOS(int numberOfUnits)
+{
+	std::vector<const UnitDef*> combatUnitTypes;
+
+	for(const auto& def : m_unitDefs)
+	{
+		if( (def->weapons.empty() == false) && (IsBuilding(def.get()) == false) && (def->isCommander == false) )
+			combatUnitTypes.push_back(def.get());
+	}
+
+	if(combatUnitTypes.empty())
+		return 0;
+
+	std::uniform_int_distribution<size_t> randomUnitType(0, combatUnitTypes.size()-1);
+	std::uniform_real_distribution<float> randomX(0.0f, static_cast<float>(m_xMapSize * squareSize));
+	std::uniform_real_distribution<float> randomZ(0.0f, static_cast<float>(m_yMapSize * squareSize));
+
+	int createdUnits(0);
+
+	for(int i = 0; i < numberOfUnits; ++i)
+	{
+		const float3 spawnPos(randomX(m_randomNumberGenerator), 0.0f, randomZ(m_randomNumberGenerator));
+		const int unitId = CreateUnit(combatUnitTypes[randomUnitType(m_randomNumberGenerator)], enemyTeam, spawnPos, -1);
+
+		if(unitId > 0)
+		{
+			m_units[unitId].inLOS = true;
+			++createdUnits;
+		}
+	}
+
+	return createdUnits;
+}
+
+void AAIBenchWorld::Update(std::vector<BenchEvent>& events)
+{
+	++m_frame;
+
+	for(int unitId : m_destroyedUnits)
+		RemoveUnit(unitId);
+	m_destroyedUnits.clear();
+
+	if(m_frame % m_scenario.enemyWaveInterval == 0)
+		SpawnEnemyWave();
+
+	UpdateResources();
+
+	UpdateUnits(events);
+
+	if(m_frame % combatUpdateInterval == 0)
+		UpdateCombat(events);
+
+	if(m_frame % losUpdateInterval == 0)
+		UpdateLOS(events);
+}
+
+void AAIBenchWorld::GiveOrder(int unitId, const Command& command)
+{
+	auto unit = m_units.find(unitId);
+
+	if(unit == m_units.end())
+		return;
+
+	const int commandId = command.GetID();
+
+	if(commandId == CMD_STOP)
+	{
+		unit->second.commands.clear();
+		return;
+	}
+
+	// state changes (fire state, on/off, cloak, ...) are not queued
+	const bool queuedCommand =    (commandId < 0) || (commandId == CMD_MOVE) || (commandId == CMD_PATROL) || (commandId == CMD_FIGHT)
+							   || (commandId == CMD_ATTACK) || (commandId == CMD_GUARD) || (commandId == CMD_REPAIR) || (commandId == CMD_RECLAIM)
+							   || (commandId == CMD_CAPTURE) || (commandId == CMD_RESTORE) || (commandId == CMD_LOAD_UNITS) || (commandId == CMD_UNLOAD_UNITS);
+
+	if(queuedCommand == false)
+		return;
+
+	if( (command.GetOpts() & SHIFT_KEY) == 0)
+		unit->second.commands.clear();
+
+	if(unit->second.commands.empty())
+		unit->second.commandStartFrame = m_frame;
+
+	unit->second.commands.push_back(command);
+}
+
+const BenchUnit* AAIBenchWorld::GetUnit(int unitId) const
+{
+	const auto unit = m_units.find(unitId);
+	return (unit != m_units.end()) ? &unit->second : nullptr;
+}
+
+const CCommandQueue* AAIBenchWorld::GetUnitCommands(int unitId) const
+{
+	const BenchUnit* unit = GetUnit(unitId);
+	return unit ? &unit->commands : &m_emptyCommandQueue;
+}
+
+int AAIBenchWorld::GetEnemyUnitsInLOS(int* unitIds, int maxUnits, const float3* pos, float radius) const
+{
+	int numberOfUnits(0);
+
+	for(const auto& unit : m_units)
+	{
+		if( (maxUnits >= 0) && (numberOfUnits >= maxUnits) )
+			break;
+
+		if( (unit.second.team == enemyTeam) && unit.second.inLOS && ( (pos == nullptr) || (unit.second.pos.SqDistance2D(*pos) < radius * radius) ) )
+			unitIds[numberOfUnits++] = unit.first;
+	}
+
+	return numberOfUnits;
+}
+
+int AAIBenchWorld::GetOwnUnits(int* unitIds, int maxUnits, const float3* pos, float radius) const
+{
+	int numberOfUnits(0);
+
+	for(const auto& unit : m_units)
+	{
+		if( (maxUnits >= 0) && (numberOfUnits >= maxUnits) )
+			break;
+
+		if( (unit.second.team == ownTeam) && ( (pos == nullptr) || (unit.second.pos.SqDistance2D(*pos) < radius * radius) ) )
+			unitIds[numberOfUnits++] = unit.first;
+	}
+
+	return numberOfUnits;
+}
+
+float AAIBenchWorld::GetElevation(float x, float z) const
+{
+	const float xTile = std::max(0.0f, std::min(x / squareSize, static_cast<float>(m_xMapSize - 2)));
+	const float yTile = std::max(0.0f, std::min(z / squareSize, static_cast<float>(m_yMapSize - 2)));
+
+	const int   x0 = static_cast<int>(xTile);
+	const int   y0 = static_cast<int>(yTile);
+	const float dx = xTile - static_cast<float>(x0);
+	const float dy = yTile - static_cast<float>(y0);
+
+	const int xSize = m_xMapSize;
+
+	const float h00 = m_heightMap[x0     +  y0    * xSize];
+	const float h10 = m_heightMap[x0 + 1 +  y0    * xSize];
+	const float h01 = m_heightMap[x0     + (y0+1) * xSize];
+	const float h11 = m_heightMap[x0 + 1 + (y0+1) * xSize];
+
+	return (1.0f - dy) * ( (1.0f - dx) * h00 + dx * h10) + dy * ( (1.0f - dx) * h01 + dx * h11);
+}
+
+bool AAIBenchWorld::CanBuildAt(const UnitDef* def, const float3& pos) const
+{
+	const float xHalfSize = 0.5f * static_cast<float>(def->xsize * squareSize);
+	const float zHalfSize = 0.5f * static_cast<float>(def->zsize * squareSize);
+
+	if(    (pos.x - xHalfSize < 0.0f) || (pos.x + xHalfSize >= static_cast<float>(m_xMapSize * squareSize))
+		|| (pos.z - zHalfSize < 0.0f) || (pos.z + zHalfSize >= static_cast<float>(m_yMapSize * squareSize)) )
+		return false;
+
+	// buildings for water (e.g. tidal generators) must be placed in water, others on land
+	const bool water = (GetElevation(pos.x, pos.z) < 0.0f);
+	const bool waterBuilding = (def->minWaterDepth > 0.0f) || def->floater;
+
+	if(water != waterBuilding)
+		return false;
+
+	for(const auto& unit : m_units)
+	{
+		if(IsBuilding(unit.second.def))
+		{
+			const float xMinDist = xHalfSize + 0.5f * static_cast<float>(unit.second.def->xsize * squareSize);
+			const float zMinDist = zHalfSize + 0.5f * static_cast<float>(unit.second.def->zsize * squareSize);
+
+			if( (std::fabs(unit.second.pos.x - pos.x) < xMinDist) && (std::fabs(unit.second.pos.z - pos.z) < zMinDist) )
+				return false;
+		}
+	}
+
+	return true;
+}
+
+float3 AAIBenchWorld::ClosestBuildSite(const UnitDef* def, const float3& pos, float searchRadius, int minDist) const
+{
+	const float stepSize = static_cast<float>(2 * squareSize);
+	const float padding  = static_cast<float>(minDist * squareSize);
+
+	// search in rings of increasing distance
+	for(float distance = 0.0f; distance <= searchRadius; distance += stepSize)
+	{
+		for(float x = pos.x - distance; x <= pos.x + distance; x += stepSize)
+		{
+			for(float z = pos.z - distance; z <= pos.z + distance; z += stepSize)
+			{
+				// only check border of ring
+				if( (std::fabs(x - pos.x) < distance) && (std::fabs(z - pos.z) < distance) )
+					continue;
+
+				const float3 buildsite(x, GetElevation(x, z), z);
+
+				if(    CanBuildAt(def, buildsite)
+					&& ( (padding <= 0.0f) || CanBuildAt(def, float3(x + padding, 0.0f, z + padding)) ) )
+					return buildsite;
+			}
+		}
+	}
+
+	return float3(-1.0f, 0.0f, 0.0f);
+}
+
+const UnitDef* AAIBenchWorld::GetUnitDefById(int unitDefId) const
+{
+	if( (unitDefId >= 1) && (unitDefId <= static_cast<int>(m_unitDefs.size())) )
+		return m_unitDefs[unitDefId-1].get();
+	else
+		return nullptr;
+}
+
+const UnitDef* AAIBenchWorld::GetUnitDefByName(const char* name) const
+{
+	for(const auto& def : m_unitDefs)
+	{
+		if(def->name == name)
+			return def.get();
+	}
+
+	return nullptr;
+}
+
+int AAIBenchWorld::GetLosMap(int* losValues, int maxValues) const
+{
+	const int size = static_cast<int>(m_losMap.size());
+
+	if(losValues != nullptr)
+		std::copy(m_losMap.begin(), m_losMap.begin() + std::min(size, maxValues), losValues);
+
+	return size;
+}
+
+int AAIBenchWorld::GetNumberOfUnits(int team) const
+{
+	return static_cast<int>( std::count_if(m_units.begin(), m_units.end(), [team](const std::pair<const int, BenchUnit>& unit) { return unit.second.team == team; }) );
+}
+
+int AAIBenchWorld::CreateUnit(const UnitDef* def, int team, const float3& pos, int builder)
+{
+	// find next free unit id
+	for(int attempt = 0; attempt < maxUnits; ++attempt)
+	{
+		if(m_nextUnitId >= maxUnits)
+			m_nextUnitId = 1;
+
+		if(m_units.count(m_nextUnitId) == 0)
+			break;
+
+		++m_nextUnitId;
+	}
+
+	if(m_units.count(m_nextUnitId) > 0)
+		return -1;
+
+	const int unitId = m_nextUnitId++;
+
+	BenchUnit& unit = m_units[unitId];
+	unit.id            = unitId;
+	unit.def           = def;
+	unit.team          = team;
+	unit.pos           = pos;
+	unit.pos.y         = GetElevation(pos.x, pos.z);
+	unit.health        = def->health;
+	unit.builder       = builder;
+	unit.inLOS         = false;
+	unit.lastShotFrame = 0;
+	unit.commandStartFrame = m_frame;
+
+	const BenchUnit* builderUnit = GetUnit(builder);
+
+	if(builderUnit && (builderUnit->def->buildSpeed > 0.0f))
+	{
+		const int buildFrames = static_cast<int>(framesPerSecond * def->buildTime / builderUnit->def->buildSpeed);
+		unit.remainingBuildFrames = std::max(15, std::min(buildFrames, 3600));
+	}
+	else
+		unit.remainingBuildFrames = 0;
+
+	unit.buildFrames = unit.remainingBuildFrames;
+
+	return unitId;
+}
+
+void AAIBenchWorld::RemoveUnit(int unitId)
+{
+	m_units.erase(unitId);
+}
+
+void AAIBenchWorld::SpawnEnemyWave()
+{
+	std::vector<const UnitDef*> combatUnitTypes;
+
+	for(const auto& def : m_unitDefs)
+	{
+		if( (def->weapons.empty() == false) && (IsBuilding(def.get()) == false) && (def->isCommander == false) && (def->minWaterDepth <= 0.0f) )
+			combatUnitTypes.push_back(def.get());
+	}
+
+	if(combatUnitTypes.empty())
+		return;
+
+	++m_enemyWaves;
+
+	const int waveSize = m_scenario.enemyWaveSize + m_enemyWaves / 4;
+
+	std::uniform_int_distribution<size_t> randomUnitType(0, combatUnitTypes.size()-1);
+	std::uniform_real_distribution<float> randomOffset(-200.0f, 200.0f);
+
+	for(int i = 0; i < waveSize; ++i)
+	{
+		const float3 spawnPos(m_enemyStartPos.x + randomOffset(m_randomNumberGenerator), 0.0f, m_enemyStartPos.z + randomOffset(m_randomNumberGenerator));
+		const int unitId = CreateUnit(combatUnitTypes[randomUnitType(m_randomNumberGenerator)], enemyTeam, spawnPos, -1);
+
+		if(unitId > 0)
+			m_units[unitId].commands.push_back(Command(CMD_MOVE, m_ownStartPos));
+	}
+}
+
+void AAIBenchWorld::UpdateUnits(std::vector<BenchEvent>& events)
+{
+	std::vector<int> finishedUnits;
+	std::vector<int> idleUnits;
+
+	struct Construction
+	{
+		const UnitDef* def;
+		int            builder;
+		float3         buildsite;
+	};
+	std::vector<Construction> requestedConstructions;
+
+	for(auto& unitEntry : m_units)
+	{
+		BenchUnit& unit = unitEntry.second;
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// construction progress (stalls if resources are missing)
+		//-----------------------------------------------------------------------------------------------------------------
+		if(unit.remainingBuildFrames > 0)
+		{
+			const float metalPerFrame  = unit.def->metalCost  / static_cast<float>(unit.buildFrames);
+			const float energyPerFrame = unit.def->energyCost / static_cast<float>(unit.buildFrames);
+
+			if( (unit.team == enemyTeam) || ( (m_metal >= metalPerFrame) && (m_energy >= energyPerFrame) ) )
+			{
+				if(unit.team == ownTeam)
+				{
+					m_metal  -= metalPerFrame;
+					m_energy -= energyPerFrame;
+					m_metalSpent  += metalPerFrame;
+					m_energySpent += energyPerFrame;
+				}
+
+				if(--unit.remainingBuildFrames == 0)
+					finishedUnits.push_back(unit.id);
+			}
+
+			continue;
+		}
+
+		if(unit.commands.empty())
+			continue;
+
+		//-----------------------------------------------------------------------------------------------------------------
+		// execute current command
+		//-----------------------------------------------------------------------------------------------------------------
+		const Command& command = unit.commands.front();
+		const int commandId = command.GetID();
+		bool commandFinished(false);
+
+		if(commandId < 0)
+		{
+			const UnitDef* constructedDef = GetUnitDefById(-commandId);
+
+			if(constructedDef == nullptr)
+				commandFinished = true;
+			// factories: one unit at a time
+			else if(IsBuilding(unit.def))
+			{
+				const bool unitUnderConstruction = std::any_of(m_units.begin(), m_units.end(), [&unit](const std::pair<const int, BenchUnit>& other) {
+																		return (other.second.builder == unit.id) && (other.second.remainingBuildFrames > 0); });
+
+				if( (unitUnderConstruction == false) && (unit.commandStartFrame < m_frame) )
+				{
+					const float3 exitPos(unit.pos.x, unit.pos.y, unit.pos.z + static_cast<float>(unit.def->zsize * squareSize));
+					requestedConstructions.push_back(Construction{constructedDef, unit.id, exitPos});
+					commandFinished = true;
+				}
+			}
+			// mobile builders: move to construction site first
+			else if(command.GetNumParams() >= 3)
+			{
+				const float3 buildsite(command.GetParam(0), command.GetParam(1), command.GetParam(2));
+
+				if(unit.pos.SqDistance2D(buildsite) > buildDistance * buildDistance)
+				{
+					float3 direction = buildsite - unit.pos;
+					direction.y = 0.0f;
+					direction.SafeNormalize();
+					unit.pos += direction * (unit.def->speed / framesPerSecond);
+				}
+				else
+				{
+					requestedConstructions.push_back(Construction{constructedDef, unit.id, buildsite});
+					commandFinished = true;
+				}
+			}
+			else
+				commandFinished = true;
+		}
+		else if( (commandId == CMD_MOVE) || (commandId == CMD_PATROL) || (commandId == CMD_FIGHT) || ( (commandId == CMD_ATTACK) && (command.GetNumParams() >= 3) ) )
+		{
+			const float3 destination(command.GetParam(0), command.GetParam(1), command.GetParam(2));
+			const float  stepSize = unit.def->speed / framesPerSecond;
+
+			if( (stepSize <= 0.0f) || (unit.pos.SqDistance2D(destination) <= stepSize * stepSize) )
+				commandFinished = true;
+			else
+			{
+				float3 direction = destination - unit.pos;
+				direction.y = 0.0f;
+				direction.SafeNormalize();
+				unit.pos += direction * stepSize;
+				unit.pos.y = GetElevation(unit.pos.x, unit.pos.z);
+			}
+		}
+		else
+			commandFinished = (m_frame - unit.commandStartFrame >= otherCommandDuration);
+
+		if(commandFinished)
+		{
+			unit.commands.pop_front();
+			unit.commandStartFrame = m_frame;
+
+			if(unit.commands.empty() && (unit.team == ownTeam))
+				idleUnits.push_back(unit.id);
+		}
+	}
+
+	for(const auto& construction : requestedConstructions)
+	{
+		// construction fails if buildsite is blocked (e.g. by a building that has been placed in the mean time)
+		if( IsBuilding(construction.def) && (CanBuildAt(construction.def, construction.buildsite) == false) )
+			continue;
+
+		const int team   = m_units[construction.builder].team;
+		const int unitId = CreateUnit(construction.def, team, construction.buildsite, construction.builder);
+
+		if( (unitId > 0) && (team == ownTeam) )
+			events.push_back(BenchEvent{EBenchEvent::UNIT_CREATED, unitId, construction.builder, 0.0f});
+	}
+
+	for(int unitId : finishedUnits)
+	{
+		BenchUnit& unit = m_units[unitId];
+
+		if(unit.team == ownTeam)
+		{
+			events.push_back(BenchEvent{EBenchEvent::UNIT_FINISHED, unitId, -1, 0.0f});
+
+			// units leaving a factory go idle
+			if(IsBuilding(unit.def) == false)
+				events.push_back(BenchEvent{EBenchEvent::UNIT_IDLE, unitId, -1, 0.0f});
+		}
+	}
+
+	for(int unitId : idleUnits)
+		events.push_back(BenchEvent{EBenchEvent::UNIT_IDLE, unitId, -1, 0.0f});
+}
+
+void AAIBenchWorld::UpdateCombat(std::vector<BenchEvent>& events)
+{
+	std::vector< std::pair<int, int> > shots;
+
+	for(const auto& attacker : m_units)
+	{
+		if( (attacker.second.remainingBuildFrames > 0) || attacker.second.def->weapons.empty())
+			continue;
+
+		const float range = GetMaxRange(attacker.second.def);
+
+		int   target(-1);
+		float minSquaredDist(range * range);
+
+		for(const auto& other : m_units)
+		{
+			if(other.second.team != attacker.second.team)
+			{
+				const float squaredDist = attacker.second.pos.SqDistance2D(other.second.pos);
+
+				if(squaredDist < minSquaredDist)
+				{
+					minSquaredDist = squaredDist;
+					target = other.first;
+				}
+			}
+		}
+
+		if(target > 0)
+			shots.push_back(std::make_pair(attacker.first, target));
+	}
+
+	for(const auto& shot : shots)
+	{
+		auto target = m_units.find(shot.second);
+
+		if( (target == m_units.end()) || (target->second.health <= 0.0f) )
+			continue;
+
+		const BenchUnit& attacker = m_units[shot.first];
+		const float damage = m_damageOfUnitType[attacker.def->id] * static_cast<float>(combatUpdateInterval) / static_cast<float>(framesPerSecond);
+
+		target->second.health -= damage;
+
+		if(target->second.team == ownTeam)
+			events.push_back(BenchEvent{EBenchEvent::UNIT_DAMAGED, shot.second, shot.first, damage});
+
+		if(target->second.health <= 0.0f)
+		{
+			if(target->second.team == ownTeam)
+				events.push_back(BenchEvent{EBenchEvent::UNIT_DESTROYED, shot.second, shot.first, 0.0f});
+			else if(target->second.inLOS)
+				events.push_back(BenchEvent{EBenchEvent::ENEMY_DESTROYED, shot.second, shot.first, 0.0f});
+
+			m_destroyedUnits.push_back(shot.second);
+		}
+	}
+}
+
+void AAIBenchWorld::UpdateLOS(std::vector<BenchEvent>& events)
+{
+	const int xLosMapSize  = m_xMapSize / losMapResolution;
+	const int yLosMapSize  = m_yMapSize / losMapResolution;
+	const float tileSize   = static_cast<float>(losMapResolution * squareSize);
+
+	std::fill(m_losMap.begin(), m_losMap.end(), 0);
+
+	for(const auto& unit : m_units)
+	{
+		if( (unit.second.team != ownTeam) || (unit.second.def->losRadius <= 0.0f) || (unit.second.health <= 0.0f) )
+			continue;
+
+		const int range = static_cast<int>(unit.second.def->losRadius / tileSize);
+		const int xPos  = static_cast<int>(unit.second.pos.x / tileSize);
+		const int yPos  = static_cast<int>(unit.second.pos.z / tileSize);
+
+		for(int y = std::max(yPos - range, 0); y <= std::min(yPos + range, yLosMapSize-1); ++y)
+		{
+			for(int x = std::max(xPos - range, 0); x <= std::min(xPos + range, xLosMapSize-1); ++x)
+			{
+				if( (x - xPos) * (x - xPos) + (y - yPos) * (y - yPos) <= range * range)
+					++m_losMap[x + y * xLosMapSize];
+			}
+		}
+	}
+
+	for(auto& unit : m_units)
+	{
+		if( (unit.second.team != enemyTeam) || (unit.second.health <= 0.0f) )
+			continue;
+
+		const int x = std::min(static_cast<int>(unit.second.pos.x / tileSize), xLosMapSize-1);
+		const int y = std::min(static_cast<int>(unit.second.pos.z / tileSize), yLosMapSize-1);
+		const bool inLOS = (m_losMap[x + y * xLosMapSize] > 0);
+
+		if(inLOS != unit.second.inLOS)
+		{
+			unit.second.inLOS = inLOS;
+			events.push_back(BenchEvent{inLOS ? EBenchEvent::ENEMY_ENTER_LOS : EBenchEvent::ENEMY_LEAVE_LOS, unit.first, -1, 0.0f});
+		}
+	}
+}
+
+void AAIBenchWorld::UpdateResources()
+{
+	float metalIncome(0.0f), energyIncome(0.0f), energyUpkeep(0.0f);
+	float metalStorage(1000.0f), energyStorage(1000.0f);
+
+	for(const auto& unit : m_units)
+	{
+		const UnitDef* def = unit.second.def;
+
+		if( (unit.second.team != ownTeam) || (unit.second.remainingBuildFrames > 0) )
+			continue;
+
+		metalIncome   += def->metalMake + 2000.0f * def->extractsMetal;
+		energyIncome  += def->energyMake + std::min(def->windGenerator, 12.0f) + ( (def->tidalGenerator > 0.0f) ? 15.0f : 0.0f);
+		energyUpkeep  += def->energyUpkeep;
+		metalStorage  += def->metalStorage;
+		energyStorage += def->energyStorage;
+	}
+
+	m_metalIncome   = metalIncome;
+	m_energyIncome  = energyIncome;
+	m_metalStorage  = metalStorage;
+	m_energyStorage = energyStorage;
+
+	m_metal  = std::min(m_metal  + metalIncome / framesPerSecond, metalStorage);
+	m_energy = std::max(std::min(m_energy + (energyIncome - energyUpkeep) / framesPerSecond, energyStorage), 0.0f);
+
+	// usage is derived from the resources spent on construction in the previous frame
+	m_metalUsage  = m_metalSpent  * framesPerSecond;
+	m_energyUsage = m_energySpent * framesPerSecond + energyUpkeep;
+
+	m_metalSpent  = 0.0f;
+	m_energySpent = 0.0f;
+}
+
+float AAIBenchWorld::GetMaxRange(const UnitDef* def)
+{
+	float range(0.0f);
+
+	for(const auto& weapon : def->weapons)
+		range = std::max(range, weapon.def->range);
+
+	return range;
+}
@@ -0,0 +1,264 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+#ifndef AAI_BENCH_WORLD_H
+#define AAI_BENCH_WORLD_H
+
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "System/float3.h"
+#include "LegacyCpp/UnitDef.h"
+#include "LegacyCpp/MoveData.h"
+#include "LegacyCpp/WeaponDef.h"
+#include "LegacyCpp/CommandQueue.h"
+
+#include "AAIBenchMapGenerator.h"
+
+using namespace springLegacyAI;
+
+//! Parameters of the synthetic game played by the benchmark
+struct BenchScenario
+{
+	//! Parameters of the procedurally generated map
+	BenchMapParameters map;
+
+	//! Seed for the random number generator (map generation, enemy waves)
+	unsigned int seed = 1;
+
+	//! Number of frames between two enemy waves
+	int   enemyWaveInterval = 900;
+
+	//! Number of enemy units per wave (increases by one every fourth wave)
+	int   enemyWaveSize = 4;
+
+	//! File containing the unit definitions (unitdefs.txt in the data directory if empty)
+	std::string unitDefsFile;
+};
+
+//! A unit of the synthetic game
+struct BenchUnit
+{
+	int            id;
+	const UnitDef* def;
+	int            team;
+	float3         pos;
+	float          health;
+
+	//! Number of frames until unit is finished (0 if finished)
+	int            remainingBuildFrames;
+
+	//! Total number of frames needed to construct the unit (costs are spent evenly over these frames)
+	int            buildFrames;
+
+	//! The unit that is constructing this unit (-1 if none)
+	int            builder;
+
+	//! Whether unit (only enemy units) is currently within line of sight of the own team
+	bool           inLOS;
+
+	//! Frame in which the unit fired the last time
+	int            lastShotFrame;
+
+	//! Frame in which the execution of the current command started
+	int            commandStartFrame;
+
+	//! The commands the unit is currently executing
+	CCommandQueue  commands;
+};
+
+//! Type of events the world reports to the AI
+enum class EBenchEvent : int
+{
+	UNIT_CREATED,
+	UNIT_FINISHED,
+	UNIT_IDLE,
+	UNIT_DAMAGED,
+	UNIT_DESTROYED,
+	ENEMY_ENTER_LOS,
+	ENEMY_LEAVE_LOS,
+	ENEMY_DESTROYED
+};
+
+struct BenchEvent
+{
+	EBenchEvent type;
+	int         unit;
+	int         otherUnit;
+	float       damage;
+};
+
+//! @brief A crude simulation of a game (map, units, resources, line of sight) that provides the data the AI queries via its callback
+//!        and generates the events the AI reacts on. The own team is team 0, the (scripted) enemy is team 1.
+class AAIBenchWorld
+{
+public:
+	AAIBenchWorld(const BenchScenario& scenario);
+	~AAIBenchWorld();
+
+	//! @brief Loads the unit definitions, returns false if file could not be read
+	bool LoadUnitDefs(const std::string& filename);
+
+	//! @brief Generates heightmap and metal map (see AAIBenchMapGenerator)
+	void GenerateMap();
+
+	//! @brief Creates the start unit of the own team (first unit def of the fixture with commander flag)
+	int SpawnStartUnit();
+
+	//! @brief Creates the given number of (finished) enemy combat units at random positions within line of sight, returns number of created units
+	int SpawnEnemyUnitsInLOS(int numberOfUnits);
+
+	//! @brief Advances the simulation by one frame and appends the resulting events
+	void Update(std::vector<BenchEvent>& events);
+
+	//! @brief Executes the given command of the given unit (build orders create new units, move orders move the unit)
+	void GiveOrder(int unitId, const Command& command);
+
+	//! @brief Returns the given unit (nullptr if it does not exist)
+	const BenchUnit* GetUnit(int unitId) const;
+
+	//! @brief Returns the command queue of the given unit (empty queue if unit does not exist)
+	const CCommandQueue* GetUnitCommands(int unitId) const;
+
+	//! @brief Returns the ids of the enemy units within line of sight (optionally only those within the given radius around pos)
+	int GetEnemyUnitsInLOS(int* unitIds, int maxUnits, const float3* pos = nullptr, float radius = 0.0f) const;
+
+	//! @brief Returns the ids of the own units (optionally only those within the given radius around pos)
+	int GetOwnUnits(int* unitIds, int maxUnits, const float3* pos = nullptr, float radius = 0.0f) const;
+
+	//! @brief Returns the ground height (interpolated) at the given position
+	float GetElevation(float x, float z) const;
+
+	//! @brief Returns whether the given unit type can be built at the given position
+	bool CanBuildAt(const UnitDef* def, const float3& pos) const;
+
+	//! @brief Returns the closest position to pos where the given unit type can be built (-1,0,0 if none found)
+	float3 ClosestBuildSite(const UnitDef* def, const float3& pos, float searchRadius, int minDist) const;
+
+	//! @brief Returns the unit definition with the given id/name (nullptr if unknown)
+	const UnitDef* GetUnitDefById(int unitDefId) const;
+	const UnitDef* GetUnitDefByName(const char* name) const;
+
+	int GetNumberOfUnitDefs() const { return static_cast<int>(m_unitDefs.size()); }
+
+	int GetCurrentFrame() const { return m_frame; }
+
+	int GetMapWidth()  const { return m_xMapSize; }
+	int GetMapHeight() const { return m_yMapSize; }
+
+	//! @brief Returns name/hash of the generated map (differ for different map parameters/seeds, i.e. AAI does not mix up cached map data)
+	const char*  GetMapName() const { return m_mapName.c_str(); }
+	unsigned int GetMapHash() const { return m_mapHash; }
+
+	const float*         GetHeightMap() const { return &m_heightMap[0]; }
+	const unsigned char* GetMetalMap()  const { return &m_metalMap[0]; }
+
+	//! @brief Writes the LOS map (one value per losMapResolution x losMapResolution tiles) to the given buffer, returns size of LOS map
+	int GetLosMap(int* losValues, int maxValues) const;
+
+	//! Resolution of the LOS map (number of map tiles per LOS map tile in each direction)
+	static constexpr int losMapResolution = 8;
+
+	float GetMetal()         const { return m_metal; }
+	float GetMetalIncome()   const { return m_metalIncome; }
+	float GetMetalUsage()    const { return m_metalUsage; }
+	float GetMetalStorage()  const { return m_metalStorage; }
+	float GetEnergy()        const { return m_energy; }
+	float GetEnergyIncome()  const { return m_energyIncome; }
+	float GetEnergyUsage()   const { return m_energyUsage; }
+	float GetEnergyStorage() const { return m_energyStorage; }
+
+	//! @brief Returns the maximum weapon range of the given unit type (0 if unarmed)
+	static float GetMaxRange(const UnitDef* def);
+
+	//! @brief Returns the number of own/enemy units currently alive
+	int GetNumberOfUnits(int team) const;
+
+	//! Id of the own and the enemy team
+	static constexpr int ownTeam   = 0;
+	static constexpr int enemyTeam = 1;
+
+	//! Maximum number of units (unit ids range from 1 to maxUnits-1)
+	static constexpr int maxUnits = 5000;
+
+private:
+	//! @brief Creates a new unit, returns its id
+	int CreateUnit(const UnitDef* def, int team, const float3& pos, int builder);
+
+	//! @brief Removes the given unit
+	void RemoveUnit(int unitId);
+
+	//! @brief Spawns a wave of enemy units heading towards the start position of the own team
+	void SpawnEnemyWave();
+
+	//! @brief Moves units, progresses construction
+	void UpdateUnits(std::vector<BenchEvent>& events);
+
+	//! @brief Lets units within weapon range of each other fight
+	void UpdateCombat(std::vector<BenchEvent>& events);
+
+	//! @brief Updates the line of sight of the own team and the enemy units within it
+	void UpdateLOS(std::vector<BenchEvent>& events);
+
+	//! @brief Updates income/usage/storage of the own team
+	void UpdateResources();
+
+	//! @brief Returns whether the given unit type is a static building
+	static bool IsBuilding(const UnitDef* def) { return (def->speed <= 0.0f); }
+
+	BenchScenario m_scenario;
+
+	//! Size of the map in map tiles (i.e. unit coordinates / 8)
+	int m_xMapSize;
+	int m_yMapSize;
+
+	//! The unit definitions (index = id - 1)
+	std::vector< std::unique_ptr<UnitDef> >   m_unitDefs;
+
+	//! Weapon and move definitions referenced by the unit definitions
+	std::vector< std::unique_ptr<WeaponDef> > m_weaponDefs;
+	std::vector< std::unique_ptr<MoveData> >  m_moveData;
+
+	//! Damage per shot of the weapons of a unit type (index = unit def id)
+	std::vector<float> m_damageOfUnitType;
+
+	std::string                m_mapName;
+	unsigned int               m_mapHash;
+
+	std::vector<float>         m_heightMap;
+	std::vector<unsigned char> m_metalMap;
+	std::vector<int>           m_losMap;
+
+	std::map<int, BenchUnit>   m_units;
+
+	//! Units destroyed in the last update; like in the engine, they can still be queried while the destroyed events are handled
+	std::vector<int>           m_destroyedUnits;
+
+	//! Commands that are returned for units that do not exist
+	CCommandQueue m_emptyCommandQueue;
+
+	int    m_nextUnitId;
+	int    m_frame;
+	float3 m_ownStartPos;
+	float3 m_enemyStartPos;
+	int    m_enemyWaves;
+
+	float  m_metal, m_metalIncome, m_metalUsage, m_metalStorage;
+	float  m_energy, m_energyIncome, m_energyUsage, m_energyStorage;
+
+	//! Resources spent on construction in the current frame
+	float  m_metalSpent, m_energySpent;
+
+	std::mt19937 m_randomNumberGenerator;
+};
+
+#endif
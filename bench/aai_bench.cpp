@@ -0,0 +1,355 @@
+// -------------------------------------------------------------------------
+// AAI
+//
+// A skirmish AI for the Spring engine.
+// Copyright Alexander Seizinger
+//
+// Released under GPL license: see LICENSE.html for more information.
+// -------------------------------------------------------------------------
+
+// Headless benchmark: plays a synthetic game (see AAIBenchWorld) for a given number of frames without the engine and reports
+// the wall time spent in the different entry points/scheduled tasks of AAI as well as percentiles of the time per frame.
+// The map is generated procedurally (see AAIBenchMapGenerator); map size is given in Spring map units (8 - 64).
+// With --csv, a single line (map parameters, startup time, frame time percentiles) is printed to allow plotting the
+// cost against map size and type over several runs.
+// The general config of the fixtures sets a fixed seed for the random numbers of AAI (RANDOM_SEED), i.e. decisions of AAI do not
+// depend on random numbers differing between runs.
+//
+// With --sector-check, a round-robin pass of the sliced update of the sector scouting data is completed after the game and the result is
+// compared with updating all sectors at once (see AAIBenchSectors); exit code is 1 if they differ.
+//
+// With --memory-report KB, the memory used by the subsystems of AAI is printed after the game (see AAIBenchMemory); exit code is 1 if
+// the memory used by the AAI instance (without the data shared by all instances) exceeds KB kilobytes.
+//
+// With --enemy-queries N, no game is played; instead local queries for enemy units are benchmarked with N enemy units within LOS
+// (engine callback vs. AAIEnemyUnitGrid, see AAIBenchEnemyQueries).
+//
+// With --log-bench DIR, no game is played; instead the time per frame spent on verbose logging (--log-messages N per frame) to log files
+// in DIR is measured for synchronous writes vs. AAILogger (see AAIBenchLogging). Place DIR on the drive to be tested (e.g. an HDD).
+//
+// With --governor-test BUDGET, no game is played; instead the task scheduler is run with synthetic tasks and a load spike with/without
+// AAIFrameTimeGovernor (see AAIBenchGovernor); exit code is 1 if the governor failed to keep the time per frame within BUDGET microseconds.
+//
+// With --stress-shared-data INSTANCES, the game is played by INSTANCES instances of AAI concurrently on separate threads (see AAIBenchStress);
+// build with -DAAI_SANITIZER=thread to check the data shared by the instances for data races.
+//
+// Usage: aai_bench [--frames N] [--seed S] [--map-size X[xY]] [--water RATIO] [--roughness R] [--plateaus N]
+//                  [--cliffs STEEPNESS] [--metal spots|uniform] [--metal-spots N] [--units FILE] [--data DIR] [--out DIR] [--csv]
+//                  [--sector-check] [--memory-report KB] [--enemy-queries N] [--log-bench DIR [--log-messages N]] [--governor-test BUDGET]
+//                  [--stress-shared-data INSTANCES]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "AAI.h"
+#include "AAITaskScheduler.h"
+
+#include "AAIBenchCallback.h"
+#include "AAIBenchEnemyQueries.h"
+#include "AAIBenchGovernor.h"
+#include "AAIBenchLogging.h"
+#include "AAIBenchMemory.h"
+#include "AAIBenchSectors.h"
+#include "AAIBenchStress.h"
+#include "AAIBenchWorld.h"
+
+// usually provided by AIExport.cpp (which is not part of the benchmark as it requires the engine)
+const char* aiexport_getVersion()
+{
+	return "bench";
+}
+
+//! Accumulates the time spent in one of the entry points of AAI
+struct BenchTimer
+{
+	BenchTimer(const char* name) : name(name), calls(0), totalTime(0.0), maxTime(0.0) {}
+
+	void Add(double time)
+	{
+		++calls;
+		totalTime += time;
+		maxTime = std::max(maxTime, time);
+	}
+
+	const char* name;
+	int         calls;
+	double      totalTime;
+	double      maxTime;
+};
+
+//! @brief Executes the given function and adds the elapsed time (in microseconds) to the given timer
+template<typename Function>
+void Measure(BenchTimer& timer, Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	timer.Add( std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() );
+}
+
+//! @brief Returns the given percentile of the (sorted) values
+static double GetPercentile(const std::vector<double>& sortedValues, double percentile)
+{
+	if(sortedValues.empty())
+		return 0.0;
+
+	const size_t index = std::min(static_cast<size_t>(percentile * static_cast<double>(sortedValues.size())), sortedValues.size() - 1);
+	return sortedValues[index];
+}
+
+static void PrintUsage()
+{
+	std::printf("Usage: aai_bench [--frames N] [--seed S] [--map-size X[xY]] [--water RATIO] [--roughness R] [--plateaus N]\n"
+	            "                 [--cliffs STEEPNESS] [--metal spots|uniform] [--metal-spots N] [--units FILE] [--data DIR] [--out DIR] [--csv]\n"
+	            "                 [--sector-check] [--memory-report KB] [--enemy-queries N] [--log-bench DIR [--log-messages N]] [--governor-test BUDGET]\n"
+	            "                 [--stress-shared-data INSTANCES]\n");
+}
+
+int main(int argc, char* argv[])
+{
+	BenchScenario scenario;
+	int frames(30 * 60 * 10);
+	std::string dataDirectory("bench/fixtures/");
+	std::string outputDirectory("bench_output/");
+	bool csvOutput(false);
+	bool sectorCheck(false);
+	int maxInstanceMemory(0);
+	int enemyQueryUnits(0);
+	std::string logBenchmarkDirectory;
+	int logMessagesPerFrame(200);
+	int governorTestBudget(0);
+	int stressTestInstances(0);
+
+	for(int i = 1; i < argc; ++i)
+	{
+		const bool hasValue = (i + 1 < argc);
+
+		if( (std::strcmp(argv[i], "--frames") == 0) && hasValue)
+			frames = std::atoi(argv[++i]);
+		else if( (std::strcmp(argv[i], "--seed") == 0) && hasValue)
+			scenario.seed = static_cast<unsigned int>(std::strtoul(argv[++i], nullptr, 10));
+		else if( (std::strcmp(argv[i], "--map-size") == 0) && hasValue)
+		{
+			if(std::sscanf(argv[++i], "%ix%i", &scenario.map.xSize, &scenario.map.ySize) == 1)
+				scenario.map.ySize = scenario.map.xSize;
+		}
+		else if( (std::strcmp(argv[i], "--water") == 0) && hasValue)
+			scenario.map.waterRatio = static_cast<float>(std::atof(argv[++i]));
+		else if( (std::strcmp(argv[i], "--roughness") == 0) && hasValue)
+			scenario.map.roughness = static_cast<float>(std::atof(argv[++i]));
+		else if( (std::strcmp(argv[i], "--plateaus") == 0) && hasValue)
+			scenario.map.plateauLevels = std::atoi(argv[++i]);
+		else if( (std::strcmp(argv[i], "--cliffs") == 0) && hasValue)
+			scenario.map.cliffSteepness = static_cast<float>(std::atof(argv[++i]));
+		else if( (std::strcmp(argv[i], "--metal") == 0) && hasValue)
+			scenario.map.metalType = (std::strcmp(argv[++i], "uniform") == 0) ? EBenchMetalType::UNIFORM : EBenchMetalType::SPOTS;
+		else if( (std::strcmp(argv[i], "--metal-spots") == 0) && hasValue)
+			scenario.map.metalSpots = std::atoi(argv[++i]);
+		else if(std::strcmp(argv[i], "--csv") == 0)
+			csvOutput = true;
+		else if(std::strcmp(argv[i], "--sector-check") == 0)
+			sectorCheck = true;
+		else if( (std::strcmp(argv[i], "--memory-report") == 0) && hasValue)
+			maxInstanceMemory = std::atoi(argv[++i]);
+		else if( (std::strcmp(argv[i], "--units") == 0) && hasValue)
+			scenario.unitDefsFile = argv[++i];
+		else if( (std::strcmp(argv[i], "--data") == 0) && hasValue)
+			dataDirectory = argv[++i];
+		else if( (std::strcmp(argv[i], "--out") == 0) && hasValue)
+			outputDirectory = argv[++i];
+		else if( (std::strcmp(argv[i], "--enemy-queries") == 0) && hasValue)
+			enemyQueryUnits = std::atoi(argv[++i]);
+		else if( (std::strcmp(argv[i], "--log-bench") == 0) && hasValue)
+			logBenchmarkDirectory = argv[++i];
+		else if( (std::strcmp(argv[i], "--log-messages") == 0) && hasValue)
+			logMessagesPerFrame = std::atoi(argv[++i]);
+		else if( (std::strcmp(argv[i], "--governor-test") == 0) && hasValue)
+			governorTestBudget = std::atoi(argv[++i]);
+		else if( (std::strcmp(argv[i], "--stress-shared-data") == 0) && hasValue)
+			stressTestInstances = std::atoi(argv[++i]);
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+
+	if(scenario.unitDefsFile.empty())
+		scenario.unitDefsFile = JoinPath(dataDirectory, "unitdefs.txt");
+
+	if(logBenchmarkDirectory.empty() == false)
+	{
+		RunLoggingBenchmark(logBenchmarkDirectory, 300, logMessagesPerFrame);
+		return 0;
+	}
+
+	if(governorTestBudget > 0)
+		return RunGovernorBenchmark(3000, governorTestBudget) ? 0 : 1;
+
+	if(stressTestInstances > 0)
+		return RunSharedDataStressTest(scenario, dataDirectory, outputDirectory, stressTestInstances, frames) ? 0 : 1;
+
+	AAIBenchWorld world(scenario);
+
+	if(world.LoadUnitDefs(scenario.unitDefsFile) == false)
+	{
+		std::printf("Failed to load unit definitions from %s\n", scenario.unitDefsFile.c_str());
+		return 1;
+	}
+
+	const auto mapGenerationStart = std::chrono::steady_clock::now();
+	world.GenerateMap();
+	const double mapGenerationTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mapGenerationStart).count();
+
+	AAIBenchCallback       callback(&world, dataDirectory, outputDirectory);
+	AAIBenchGlobalCallback globalCallback(&callback);
+
+	if(enemyQueryUnits > 0)
+	{
+		RunEnemyQueryBenchmark(world, callback, enemyQueryUnits, 10000, scenario.seed);
+		return 0;
+	}
+
+	BenchTimer initTimer("InitAI");
+	BenchTimer updateTimer("Update");
+	BenchTimer unitCreatedTimer("UnitCreated");
+	BenchTimer unitFinishedTimer("UnitFinished");
+	BenchTimer unitIdleTimer("UnitIdle");
+	BenchTimer unitDamagedTimer("UnitDamaged");
+	BenchTimer unitDestroyedTimer("UnitDestroyed");
+	BenchTimer enemyEnterLOSTimer("EnemyEnterLOS");
+	BenchTimer enemyLeaveLOSTimer("EnemyLeaveLOS");
+	BenchTimer enemyDestroyedTimer("EnemyDestroyed");
+
+	AAI* ai = new AAI(callback.GetMySkirmishAIId(), callback.GetSkirmishAICallback());
+
+	Measure(initTimer, [&]() { ai->InitAI(&globalCallback, callback.GetMyTeam()); });
+
+	// task scheduler is only created if InitAI() has been successful (e.g. config files found)
+	if(ai->GetTaskScheduler() == nullptr)
+	{
+		std::printf("AAI failed to initialize (see AAI log in %s)\n", outputDirectory.c_str());
+		delete ai;
+		return 1;
+	}
+
+	const int startUnit = world.SpawnStartUnit();
+
+	if(startUnit < 0)
+	{
+		std::printf("No start unit (commander) found in unit definitions\n");
+		delete ai;
+		return 1;
+	}
+
+	Measure(unitCreatedTimer,  [&]() { ai->UnitCreated(startUnit, -1); });
+	Measure(unitFinishedTimer, [&]() { ai->UnitFinished(startUnit); });
+
+	std::vector<double>     frameTimes;
+	std::vector<BenchEvent> events;
+	frameTimes.reserve(frames);
+
+	const auto benchStart = std::chrono::steady_clock::now();
+
+	for(int frame = 0; frame < frames; ++frame)
+	{
+		events.clear();
+		world.Update(events);
+
+		const auto frameStart = std::chrono::steady_clock::now();
+
+		for(const BenchEvent& event : events)
+		{
+			switch(event.type)
+			{
+				case EBenchEvent::UNIT_CREATED:
+					Measure(unitCreatedTimer, [&]() { ai->UnitCreated(event.unit, event.otherUnit); });
+					break;
+				case EBenchEvent::UNIT_FINISHED:
+					Measure(unitFinishedTimer, [&]() { ai->UnitFinished(event.unit); });
+					break;
+				case EBenchEvent::UNIT_IDLE:
+					Measure(unitIdleTimer, [&]() { ai->UnitIdle(event.unit); });
+					break;
+				case EBenchEvent::UNIT_DAMAGED:
+					Measure(unitDamagedTimer, [&]() { ai->UnitDamaged(event.unit, event.otherUnit, event.damage, ZeroVector); });
+					break;
+				case EBenchEvent::UNIT_DESTROYED:
+					Measure(unitDestroyedTimer, [&]() { ai->UnitDestroyed(event.unit, event.otherUnit); });
+					break;
+				case EBenchEvent::ENEMY_ENTER_LOS:
+					Measure(enemyEnterLOSTimer, [&]() { ai->EnemyEnterLOS(event.unit); });
+					break;
+				case EBenchEvent::ENEMY_LEAVE_LOS:
+					Measure(enemyLeaveLOSTimer, [&]() { ai->EnemyLeaveLOS(event.unit); });
+					break;
+				case EBenchEvent::ENEMY_DESTROYED:
+					Measure(enemyDestroyedTimer, [&]() { ai->EnemyDestroyed(event.unit, event.otherUnit); });
+					break;
+			}
+		}
+
+		Measure(updateTimer, [&]() { ai->Update(); });
+
+		frameTimes.push_back( std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - frameStart).count() );
+	}
+
+	const double totalTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - benchStart).count();
+
+	std::sort(frameTimes.begin(), frameTimes.end());
+
+	// verify that the sliced update of the sectors results in the same data as updating all sectors at once
+	const bool sectorCheckPassed = (sectorCheck == false) || CheckSectorSliceUpdate(ai);
+
+	// verify that the memory used by the AAI instance does not exceed the given limit
+	const bool memoryCheckPassed = (maxInstanceMemory <= 0) || CheckMemoryUsage(ai, maxInstanceMemory);
+
+	if(csvOutput)
+	{
+		// map x size, y size, water ratio, roughness, plateaus, cliff steepness, metal type, seed, frames, InitAI (ms), avg Update (us), p50, p90, p99, max (us)
+		std::printf("%i,%i,%.2f,%.2f,%i,%.2f,%s,%u,%i,%.2f,%.1f,%.1f,%.1f,%.1f,%.1f\n", scenario.map.xSize, scenario.map.ySize, scenario.map.waterRatio,
+		            scenario.map.roughness, scenario.map.plateauLevels, scenario.map.cliffSteepness,
+		            (scenario.map.metalType == EBenchMetalType::SPOTS) ? "spots" : "uniform", scenario.seed, frames, 0.001 * initTimer.totalTime,
+		            updateTimer.totalTime / static_cast<double>(std::max(updateTimer.calls, 1)), GetPercentile(frameTimes, 0.5), GetPercentile(frameTimes, 0.9),
+		            GetPercentile(frameTimes, 0.99), frameTimes.empty() ? 0.0 : frameTimes.back());
+		delete ai;
+		return (sectorCheckPassed && memoryCheckPassed) ? 0 : 1;
+	}
+
+	std::printf("\nAAI benchmark: %i frames, map %s, seed %u (map generated in %.1f ms)\n", frames, scenario.map.GetDescription().c_str(),
+	            scenario.seed, mapGenerationTime);
+	std::printf("Total time: %.1f ms (including simulation), orders given: %i, own units: %i, enemy units: %i\n", totalTime,
+	            callback.GetNumberOfOrders(), world.GetNumberOfUnits(AAIBenchWorld::ownTeam), world.GetNumberOfUnits(AAIBenchWorld::enemyTeam));
+
+	std::printf("\nTime per frame (in microseconds):\n");
+	std::printf("p50: %.1f  p90: %.1f  p99: %.1f  p99.9: %.1f  max: %.1f\n", GetPercentile(frameTimes, 0.5), GetPercentile(frameTimes, 0.9),
+	            GetPercentile(frameTimes, 0.99), GetPercentile(frameTimes, 0.999), frameTimes.empty() ? 0.0 : frameTimes.back());
+
+	std::printf("\n%-30s %10s %14s %12s %12s\n", "Entry point", "calls", "total (ms)", "avg (us)", "max (us)");
+
+	for(const BenchTimer* timer : {&initTimer, &updateTimer, &unitCreatedTimer, &unitFinishedTimer, &unitIdleTimer, &unitDamagedTimer,
+	                               &unitDestroyedTimer, &enemyEnterLOSTimer, &enemyLeaveLOSTimer, &enemyDestroyedTimer})
+	{
+		std::printf("%-30s %10i %14.2f %12.1f %12.1f\n", timer->name, timer->calls, 0.001 * timer->totalTime,
+		            timer->totalTime / static_cast<double>(std::max(timer->calls, 1)), timer->maxTime);
+	}
+
+	if(ai->GetTaskScheduler())
+	{
+		std::printf("\n%-30s %10s %14s %12s %12s %10s\n", "Scheduled task", "executions", "total (ms)", "avg (us)", "max (us)", "deferrals");
+
+		for(const auto& task : ai->GetTaskScheduler()->GetStatistics())
+		{
+			std::printf("%-30s %10i %14.2f %12.1f %12i %10i\n", task.name, task.executions, 0.001 * static_cast<double>(task.totalCost),
+			            static_cast<double>(task.totalCost) / static_cast<double>(std::max(task.executions, 1)), task.maxCost, task.deferrals);
+		}
+	}
+
+	delete ai;
+
+	return (sectorCheckPassed && memoryCheckPassed) ? 0 : 1;
+}